@@ -1,7 +1,7 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	RX64M グループ　DTCa 定義
+	@brief	RX64M/RX71M グループ・データトランスファコントローラ（DTCa）定義
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -9,35 +9,22 @@
 */
 //=====================================================================//
 #include "common/io_utils.hpp"
-#include "RX64M/peripheral.hpp"
-#include "RX64M/icu.hpp"
+#include "RX600/peripheral.hpp"
 
 namespace device {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  DTC 定義
-		@param[in]	base	ベース・アドレス
+		@brief  データトランスファコントローラ（DTCa）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <uint32_t base>
 	struct dtc_t {
 
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-		/*!
-			@brief  DTC モードレジスタ A（MRA）
-		*/
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-
-
-
-
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		/*!
 			@brief  DTC コントロールレジスタ（DTCCR）
-			@param[in]	base	ベース
 		*/
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		template <uint32_t base>
 		struct dtccr_t : public rw8_t<base> {
 			typedef rw8_t<base> io_;
@@ -48,24 +35,22 @@ namespace device {
 
 			bit_rw_t<io_, bitpos::B4> RRS;
 		};
-		static dtccr_t<base + 0x00> DTCCR;
+		static dtccr_t<0x00082400> DTCCR;
 
 
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		/*!
 			@brief  DTC ベクタベースレジスタ（DTCVBR）
-			@param[in]	base	ベース
 		*/
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-		static rw32_t<base + 0x04> DTCVBR;
+		//-----------------------------------------------------------------//
+		static rw32_t<0x00082404> DTCVBR;
 
 
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		/*!
 			@brief  DTC アドレスモードレジスタ（DTCADMOD）
-			@param[in]	base	ベース
 		*/
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		template <uint32_t base>
 		struct dtcadmod_t : public rw8_t<base> {
 			typedef rw8_t<base> io_;
@@ -76,15 +61,14 @@ namespace device {
 
 			bit_rw_t<io_, bitpos::B0> SHORT;
 		};
-		static dtcadmod_t<base + 0x08> DTCADMOD;
+		static dtcadmod_t<0x00082408> DTCADMOD;
 
 
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		/*!
 			@brief  DTC モジュール起動レジスタ（DTCST）
-			@param[in]	base	ベース
 		*/
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		template <uint32_t base>
 		struct dtcst_t : public rw8_t<base> {
 			typedef rw8_t<base> io_;
@@ -95,29 +79,52 @@ namespace device {
 
 			bit_rw_t<io_, bitpos::B0> DTCST;
 		};
-		static dtcst_t<base + 0x0C> DTCST;
+		static dtcst_t<0x0008240C> DTCST;
 
 
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		/*!
 			@brief  DTC ステータスレジスタ（DTCSTS）
-			@param[in]	base	ベース
 		*/
-		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		//-----------------------------------------------------------------//
 		template <uint32_t base>
-		struct dtcsts_t : public rw16_t<base> {
-			typedef rw16_t<base> io_;
-			using io_::operator =;
+		struct dtcsts_t : public ro16_t<base> {
+			typedef ro16_t<base> io_;
 			using io_::operator ();
-			using io_::operator |=;
-			using io_::operator &=;
 
-			bits_rw_t<io_, bitpos::B0, 8> VECN;
-			bit_rw_t <io_, bitpos::B15>   ACT;
+			bit_ro_t <io_, bitpos::B15>   ACT;
 		};
-		static dtcsts_t<base + 0x0E> DTCSTS;
+		static dtcsts_t<0x0008240E> DTCSTS;
 
-	};
 
-	typedef dtc_t<0x00082400, peripheral::DTC>  DTC;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  DTC 起動許可レジスタ（DTCERn）の設定 @n
+					※ICU の DTCER（0x00087100 ＋ ベクター番号）
+			@param[in]	vec	ベクター番号
+			@param[in]	ena	起動を許可しない場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		static void set_dtce(uint32_t vec, bool ena = true) { wr8_(0x00087100 + vec, ena); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  DTC 起動許可レジスタ（DTCERn）の取得
+			@param[in]	vec	ベクター番号
+			@return 起動許可なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool get_dtce(uint32_t vec) { return rd8_(0x00087100 + vec) & 1; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ペリフェラル型を返す
+			@return ペリフェラル型
+		*/
+		//-----------------------------------------------------------------//
+		static peripheral get_peripheral() { return peripheral::DTC; }
+	};
+	typedef dtc_t DTC;
 }
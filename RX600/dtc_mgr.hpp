@@ -0,0 +1,175 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RX64M/RX71M グループ・DTC マネージャー @n
+			ベクターテーブル（２５６エントリー）を RAM に持ち、@n
+			周辺機器の割り込み要因毎に転送情報（フルアドレスモード）を登録する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "RX600/dtc.hpp"
+#include "RX600/icu.hpp"
+#include "RX600/power_cfg.hpp"
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  DTC マネージャー・クラス
+		@param[in]	DTCU	DTC 定義クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class DTCU = DTC>
+	class dtc_mgr {
+	public:
+
+		//=================================================================//
+		/*!
+			@brief  転送情報（フルアドレスモード、４バイト・アライン）
+		*/
+		//=================================================================//
+		struct info_t {
+			uint32_t	mr;		///< MRA(31-24), MRB(23-16)
+			uint32_t	sar;	///< 転送元
+			uint32_t	dar;	///< 転送先
+			uint32_t	cr;		///< CRA(31-16), CRB(15-0)
+		} __attribute__ ((aligned(4)));
+
+
+		static const uint8_t MRA_SZ_8     = 0x00;	///< ８ビット転送
+		static const uint8_t MRA_SZ_16    = 0x10;	///< １６ビット転送
+		static const uint8_t MRA_SZ_32    = 0x20;	///< ３２ビット転送
+		static const uint8_t MRA_SM_INC   = 0x08;	///< 転送元を加算
+		static const uint8_t MRA_MD_REPEAT = 0x40;	///< リピート転送モード
+		static const uint8_t MRB_DM_INC   = 0x08;	///< 転送先を加算
+		static const uint8_t MRB_DTS      = 0x10;	///< 転送元をリピート領域にする
+		static const uint8_t MRB_DISEL    = 0x20;	///< 毎回 CPU に割り込み要求
+
+
+	private:
+		static volatile uint32_t vtbl_[256];
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  開始（ベクターテーブルの設定、モジュール起動）
+		*/
+		//-----------------------------------------------------------------//
+		static void start()
+		{
+			if(DTCU::DTCST.DTCST()) return;
+
+			power_cfg::turn(DTCU::get_peripheral());
+
+			DTCU::DTCVBR = reinterpret_cast<uint32_t>(&vtbl_[0]);
+			DTCU::DTCADMOD.SHORT = 0;
+			DTCU::DTCCR.RRS = 0;	// 転送情報は毎回読み直す（起動中に書き換える為）
+			DTCU::DTCST.DTCST = 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ノーマル転送情報を作成 @n
+					転送の終了（CRA が「０」）で DTCER がクリアされ、CPU に割り込みが入る
+			@param[out]	t	転送情報
+			@param[in]	mra	MRA（転送サイズ、転送元アドレスモード）
+			@param[in]	mrb	MRB（転送先アドレスモード）
+			@param[in]	src	転送元アドレス
+			@param[in]	dst	転送先アドレス
+			@param[in]	cnt	転送回数（１～６５５３６）
+		*/
+		//-----------------------------------------------------------------//
+		static void set_normal(info_t& t, uint8_t mra, uint8_t mrb, uint32_t src, uint32_t dst,
+			uint32_t cnt)
+		{
+			t.mr  = (static_cast<uint32_t>(mra) << 24) | (static_cast<uint32_t>(mrb) << 16);
+			t.sar = src;
+			t.dar = dst;
+			t.cr  = (cnt & 0xffff) << 16;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  リピート転送情報を作成 @n
+					リピート領域の終端で先頭に戻り、CPU への割り込みは入らない
+			@param[out]	t	転送情報
+			@param[in]	mra	MRA（転送サイズ、転送元アドレスモード）
+			@param[in]	mrb	MRB（転送先アドレスモード、DTS）
+			@param[in]	src	転送元アドレス
+			@param[in]	dst	転送先アドレス
+			@param[in]	cnt	リピートサイズ（１～２５６）
+		*/
+		//-----------------------------------------------------------------//
+		static void set_repeat(info_t& t, uint8_t mra, uint8_t mrb, uint32_t src, uint32_t dst,
+			uint32_t cnt)
+		{
+			cnt &= 0xff;
+			t.mr  = (static_cast<uint32_t>(mra | MRA_MD_REPEAT) << 24)
+				  | (static_cast<uint32_t>(mrb) << 16);
+			t.sar = src;
+			t.dar = dst;
+			t.cr  = ((cnt << 8) | cnt) << 16;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  残りの転送回数を取得（ノーマル転送）
+			@param[in]	t	転送情報
+			@return 残りの転送回数
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t get_count(const info_t& t)
+		{
+			return static_cast<uint16_t>(reinterpret_cast<const volatile uint32_t&>(t.cr) >> 16);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  転送情報を登録して、起動を許可する
+			@param[in]	vec	割り込みベクター
+			@param[in]	t	転送情報
+		*/
+		//-----------------------------------------------------------------//
+		static void enable(ICU::VECTOR vec, info_t& t)
+		{
+			vtbl_[static_cast<uint32_t>(vec)] = reinterpret_cast<uint32_t>(&t);
+			DTCU::set_dtce(static_cast<uint32_t>(vec), true);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  起動を禁止する
+			@param[in]	vec	割り込みベクター
+		*/
+		//-----------------------------------------------------------------//
+		static void disable(ICU::VECTOR vec)
+		{
+			DTCU::set_dtce(static_cast<uint32_t>(vec), false);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  起動が許可されているか（転送中か）
+			@param[in]	vec	割り込みベクター
+			@return 許可されていれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool probe(ICU::VECTOR vec)
+		{
+			return DTCU::get_dtce(static_cast<uint32_t>(vec));
+		}
+	};
+
+	// DTCVBR の下位１２ビットは「０」
+	template <class DTCU>
+		volatile uint32_t dtc_mgr<DTCU>::vtbl_[256] __attribute__ ((aligned(4096)));
+}
@@ -58,6 +58,7 @@ namespace device {
 			ADDRESS,	///< アドレス・エラー
 			TIMEOUT,	///< タイム・アウト・エラー
 			LOCK,		///< ロック・エラー
+			WRITE,		///< 書き込みエラー（FSTATR）
 		};
 
 	private:
@@ -228,6 +229,15 @@ namespace device {
 				return false;
 			}
 
+			// 書き込みの結果は FSTATR で判定する（読み出した値では判定しない）
+			if(device::FLASH::FSTATR.PRGERR() != 0 || device::FLASH::FSTATR.ILGERR() != 0
+			  || device::FLASH::FSTATR.FLWEERR() != 0) {
+				turn_break_();
+				error_ = error::WRITE;
+				debug_format("FACI 'write32_' program error\n");
+				return false;
+			}
+
 			if(device::FLASH::FASTAT.CMDLK() != 0) {
 				error_ = error::LOCK;
 				debug_format("FACI 'write32_' CMD Lock fail\n");
@@ -494,29 +504,21 @@ namespace device {
 
 			const uint8_t* p = static_cast<const uint8_t*>(src);
 			bool f = false;
-			int32_t l = static_cast<int32_t>(len);
-			while(l > 0) {
+			while(len > 0) {
 				uint32_t mod = org & 3;
-				if(mod != 0) {
-					uint8_t tmp[4];
-					tmp[0] = 0xFF;
-					tmp[1] = 0xFF;
-					tmp[2] = 0xFF;
-					tmp[3] = 0xFF;
-					l -= 4 - mod;
-					while(mod < 3) {
-						tmp[mod] = *p++;
-						++mod;
-					}
-					org &= 0xFFFFFFFC;
-					f = write32_(tmp, org);
+				uint32_t n = 4 - mod;
+				if(n > len) n = len;
+				if(n < 4) {  // 端数（ソースの範囲外は読まない）
+					uint8_t tmp[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+					std::memcpy(&tmp[mod], p, n);
+					f = write32_(tmp, org & 0xFFFFFFFC);
 				} else {
 					f = write32_(p, org);
-					p += 4;
-					l -= 4;
 				}
 				if(!f) break;
-				org += 4;
+				p += n;
+				len -= n;
+				org = (org & 0xFFFFFFFC) + 4;
 			}
 
 			if(f) {
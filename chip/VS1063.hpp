@@ -215,16 +215,17 @@ namespace chip {
 		/*!
 			@brief  再生
 			@param[in]	fp	ファイル・ディスクリプタ
+			@param[in]	close	再生後にファイルをクローズしない場合「false」
 			@return エラーなら「false」
 		*/
 		//----------------------------------------------------------------//
-		bool play(FIL* fp)
+		bool play(FIL* fp, bool close = true)
 		{
 			if(fp == nullptr) return false;
 
 			// ファイル・フォーマットを確認
 			if(!probe_mp3_(fp)) {
-				f_close(fp);
+				if(close) f_close(fp);
 				return false;
 			}
 
@@ -263,12 +264,28 @@ namespace chip {
 				DCS::P = 1;
 			}
 
-			f_close(fp);
+			if(close) f_close(fp);
 
 			return true;
 		}
 
 
+		//----------------------------------------------------------------//
+		/*!
+			@brief  再生（マップド・ファイル） @n
+					※高速シークが有効なので、ファイルはオープンしたまま保持される
+			@param[in]	map	マップド・ファイル（utils::sdc_map）
+			@return エラーなら「false」
+		*/
+		//----------------------------------------------------------------//
+		template <class MAP>
+		bool play(MAP& map)
+		{
+			if(!map.seek(0)) return false;
+			return play(map.at_fil(), false);
+		}
+
+
 		//----------------------------------------------------------------//
 		/*!
 			@brief  ボリュームを設定
@@ -9,6 +9,7 @@
 */
 //=====================================================================//
 #include <cstring>
+#include "common/tokenizer.hpp"
 
 extern "C" {
 	void sci_putch(char ch);
@@ -22,7 +23,8 @@ namespace utils {
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
     /*!
         @brief  command class
-		@param[in]	buffsize	バッファサイズ（最小でも９）
+		@param[in]	buffsize	バッファサイズ（最小でも９）@n
+								ワードは最大３２個（超えた分は無視される）
     */
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <int16_t buffsize>
@@ -37,6 +39,19 @@ namespace utils {
 
 		bool	tab_;
 
+		static const uint32_t words_max_ = (buffsize / 2) < 32 ? (buffsize / 2) : 32;
+		mutable tokenizer<words_max_>	tok_;
+		mutable bool	parse_;
+
+		// 行の分割は、内容が変わった後の最初の参照で一度だけ行う
+		const tokenizer<words_max_>& parse_words_() const {
+			if(!parse_) {
+				tok_.words(buff_);
+				parse_ = true;
+			}
+			return tok_;
+		}
+
 		// VT-100 ESC シーケンス 
 		static void clear_line_() {
 			sci_putch(0x1b);
@@ -66,7 +81,7 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		command() : bpos_(-1), pos_(0), len_(0), tab_top_(-1),
-			prompt_(nullptr), tab_(false) { buff_[0] = 0; }
+			prompt_(nullptr), tab_(false), tok_(), parse_(false) { buff_[0] = 0; }
 
 
         //-----------------------------------------------------------------//
@@ -92,6 +107,7 @@ namespace utils {
 			bpos_ = pos_;
 			tab_ = false;
 			while(sci_length()) {
+				parse_ = false;
 				if(pos_ >= (buffsize - 1)) {	///< バッファが溢れた・・
 					sci_putch('\\');		///< バックスラッシュ
 					buff_[buffsize - 1] = 0;
@@ -172,27 +188,19 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		uint8_t get_words() const {
-			const char* p = buff_;
-			char bc = ' ';
-			uint8_t n = 0;
-			bool esc = false;
-			while(1) {
-				char ch = *p++;
-				if(ch == 0) break;
-				if(esc) {
-					esc = false;
-					continue;
-				}
-				if(ch == '\\') {
-					esc = true;
-					continue;
-				} 
-				if(bc == ' ' && ch != ' ') {
-					++n;
-				}
-				bc = ch;
-			}
-			return n;
+			return parse_words_().size();
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  ワードを取得（コピーしない）
+			@param[in]	argc	ワード位置
+			@return ワード（無い場合は空）
+        */
+        //-----------------------------------------------------------------//
+		token_t get_token(uint8_t argc) const {
+			return parse_words_()[argc];
 		}
 
 
@@ -206,32 +214,10 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		bool get_word(uint8_t argc, uint8_t limit, char* word) const {
-			const char* p = buff_;
-			char bc = ' ';
-			const char* wd = p;
-			while(1) {
-				char ch = *p;
-				if(bc == ' ' && ch != ' ') {
-					wd = p;
-				}
-				if(bc != ' ' && (ch == ' ' || ch == 0)) {
-					if(argc == 0) {
-						uint8_t i;
-						for(i = 0; i < (p - wd); ++i) {
-							--limit;
-							if(limit == 0) break;
-							word[i] = wd[i];
-						}
-						word[i] = 0;
-						return true;
-					}
-					--argc;
-				}
-				if(ch == 0) break;
-				bc = ch;
-				++p;
-			}
-			return false;
+			const auto& tok = parse_words_();
+			if(argc >= tok.size()) return false;
+			tok[argc].copy(word, limit);
+			return true;
 		}
 
 
@@ -244,28 +230,9 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		bool cmp_word(uint8_t argc, const char* key) const {
-			if(key == nullptr) return false;
-			const char* p = buff_;
-			char bc = ' ';
-			int keylen = std::strlen(key);
-			const char* top = p;
-			while(1) {
-				char ch = *p;
-				if(bc == ' ' && ch != ' ') {
-					top = p;
-				}
-				if(bc != ' ' && (ch == ' ' || ch == 0)) {
-					int len = p - top;					
-					if(argc == 0 && len == keylen) {
-						return std::strncmp(key, top, keylen) == 0;
-					}
-					--argc;
-				}
-				if(ch == 0) break;
-				bc = ch;
-				++p;
-			}
-			return false;
+			const auto& tok = parse_words_();
+			if(argc >= tok.size()) return false;
+			return tok[argc].cmp(key);
 		}
 
 
@@ -295,6 +262,7 @@ namespace utils {
 		void injection_tab(const char* key) {
 			if(tab_top_ < 0) return;
 			std::strcpy(&buff_[tab_top_], key);
+			parse_ = false;
 
 			load_cursor_();
 			sci_puts(key);
@@ -0,0 +1,299 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ディレクトリー・インデックス・キャッシュ・クラス @n
+			一度読んだディレクトリーの内容（名前ハッシュ、サイズ、タイム・スタンプ、@n
+			属性、名前）をメモリーに保持し、再リストでカードを読まない。@n
+			キャッシュするのは、最後にリストした一つのディレクトリーで、@n
+			そのディレクトリーのファイル情報の取得（find、get）にも使える。@n
+			メモリーは外部から与える（RX64M では SDRAM 領域を指定できる）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "ff12b/src/ff.h"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ディレクトリー・インデックス・キャッシュ・クラス @n
+				エントリー配列はメモリーの先頭から、ディレクトリーのパスと @n
+				名前（FatFs の文字コード）は末尾から割り当てる。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class dir_cache {
+
+		struct entry_t {
+			uint32_t	hash_;
+			uint32_t	size_;
+			uint16_t	fdate_;
+			uint16_t	ftime_;
+			uint16_t	name_;		///< 名前の位置（メモリー末尾からのオフセット）
+			uint8_t		attr_;
+			uint8_t		pad_;
+		};
+
+		uint8_t*	mem_;
+		uint32_t	mem_size_;
+
+		uint32_t	root_;		///< キャッシュしているディレクトリーのハッシュ
+		uint32_t	root_len_;	///< ディレクトリーのパス長（パスはメモリーの末尾）
+		uint32_t	num_;
+		uint32_t	name_pos_;
+		uint32_t	gen_;		///< 世代（無効化、再構築で進む）
+
+		bool		valid_;
+		bool		build_;
+
+		entry_t* at_entry_(uint32_t idx) const noexcept {
+			return reinterpret_cast<entry_t*>(mem_) + idx;
+		}
+
+		static uint32_t hash_(const char* str, uint32_t len) noexcept
+		{
+			uint32_t h = 2166136261;
+			for(uint32_t i = 0; i < len; ++i) {
+				h ^= static_cast<uint8_t>(str[i]);
+				h *= 16777619;
+			}
+			return h;
+		}
+
+		// ディレクトリーのパス長（終端の「/」は含めない、ルートは「０」）
+		static uint32_t root_len_of_(const char* root, uint32_t len) noexcept
+		{
+			while(len > 0 && root[len - 1] == '/') --len;
+			return len;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	名前のハッシュ（FNV-1a）
+			@param[in]	str		文字列
+			@return ハッシュ値
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t hash(const char* str) noexcept
+		{
+			return hash_(str, std::strlen(str));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		dir_cache() noexcept : mem_(nullptr), mem_size_(0), root_(0), root_len_(0), num_(0),
+			name_pos_(0), gen_(0), valid_(false), build_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始（メモリーの割り当て）@n
+					※「nullptr」を与えるとキャッシュは無効
+			@param[in]	mem		キャッシュ・メモリー（４バイト・アライン）
+			@param[in]	size	メモリーサイズ（名前領域は最大６４Ｋバイト）
+		 */
+		//-----------------------------------------------------------------//
+		void start(void* mem, uint32_t size) noexcept
+		{
+			mem_ = static_cast<uint8_t*>(mem);
+			mem_size_ = mem != nullptr ? size : 0;
+			invalidate();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュが利用可能か
+			@return 利用可能なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool enable() const noexcept { return mem_ != nullptr; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	無効化（ディレクトリーの内容が変化した場合）
+		 */
+		//-----------------------------------------------------------------//
+		void invalidate() noexcept
+		{
+			valid_ = false;
+			build_ = false;
+			num_ = 0;
+			++gen_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	世代を取得
+			@return 世代
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_gen() const noexcept { return gen_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーがキャッシュされているか @n
+					※終端の「/」は無視する（「/」と「」はルート）
+			@param[in]	root	ディレクトリーのパス（FatFs の文字コード）
+			@param[in]	len		パスの長さ
+			@return キャッシュされていれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool probe(const char* root, uint32_t len) const noexcept
+		{
+			if(!valid_) return false;
+			len = root_len_of_(root, len);
+			if(len != root_len_ || hash_(root, len) != root_) return false;
+			return std::memcmp(root, &mem_[mem_size_ - root_len_], len) == 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーがキャッシュされているか
+			@param[in]	root	ディレクトリーのパス（FatFs の文字コード）
+			@return キャッシュされていれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool probe(const char* root) const noexcept { return probe(root, std::strlen(root)); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	構築開始
+			@param[in]	root	ディレクトリーのパス（FatFs の文字コード）
+			@return 世代
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t begin(const char* root) noexcept
+		{
+			invalidate();
+			if(mem_ == nullptr) return gen_;
+			uint32_t len = root_len_of_(root, std::strlen(root));
+			if(len > mem_size_ || len > 0xffff) return gen_;
+			root_ = hash_(root, len);
+			root_len_ = len;
+			std::memcpy(&mem_[mem_size_ - len], root, len);
+			name_pos_ = len;
+			build_ = true;
+			return gen_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリーの追加 @n
+					※メモリーが足りない場合、構築を中止する（リストは継続できる）
+			@param[in]	gen		構築開始時の世代
+			@param[in]	fi		ファイル情報
+		 */
+		//-----------------------------------------------------------------//
+		void add(uint32_t gen, const FILINFO& fi) noexcept
+		{
+			if(!build_ || gen != gen_) return;
+
+			uint32_t len = std::strlen(fi.fname) + 1;
+			uint32_t top = (num_ + 1) * sizeof(entry_t);
+			if((top + name_pos_ + len) > mem_size_ || (name_pos_ + len) > 0xffff) {
+				build_ = false;
+				return;
+			}
+			name_pos_ += len;
+			std::memcpy(&mem_[mem_size_ - name_pos_], fi.fname, len);
+
+			entry_t* e = at_entry_(num_);
+			e->hash_  = hash(fi.fname);
+			e->size_  = fi.fsize;
+			e->fdate_ = fi.fdate;
+			e->ftime_ = fi.ftime;
+			e->name_  = name_pos_;
+			e->attr_  = fi.fattrib;
+			++num_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	構築終了
+			@param[in]	gen		構築開始時の世代
+		 */
+		//-----------------------------------------------------------------//
+		void end(uint32_t gen) noexcept
+		{
+			if(gen != gen_) return;
+			valid_ = build_;
+			build_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリー数を取得
+			@return エントリー数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return valid_ ? num_ : 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリーの取得
+			@param[in]	idx		インデックス
+			@param[out]	fi		ファイル情報
+			@return 取得できたら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(uint32_t idx, FILINFO& fi) const noexcept
+		{
+			if(!valid_ || idx >= num_) return false;
+
+			const entry_t* e = at_entry_(idx);
+			fi.fsize   = e->size_;
+			fi.fdate   = e->fdate_;
+			fi.ftime   = e->ftime_;
+			fi.fattrib = e->attr_;
+#if _USE_LFN != 0
+			fi.altname[0] = 0;
+#endif
+			std::strcpy(fi.fname, reinterpret_cast<const char*>(&mem_[mem_size_ - e->name_]));
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	名前の検索 @n
+					※大文字、小文字、短い名前は区別するので、見つからない場合 @n
+					でも、ファイルが無いとは限らない
+			@param[in]	name	名前（FatFs の文字コード）
+			@return 見つからない場合「-1」
+		 */
+		//-----------------------------------------------------------------//
+		int32_t find(const char* name) const noexcept
+		{
+			if(!valid_) return -1;
+
+			uint32_t h = hash(name);
+			for(uint32_t i = 0; i < num_; ++i) {
+				const entry_t* e = at_entry_(i);
+				if(e->hash_ != h) continue;
+				if(std::strcmp(name, reinterpret_cast<const char*>(&mem_[mem_size_ - e->name_])) == 0) {
+					return i;
+				}
+			}
+			return -1;
+		}
+	};
+}
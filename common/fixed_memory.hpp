@@ -1,13 +1,20 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	固定サイズ・メモリー・クラス
+	@brief	固定サイズ・メモリー・クラス @n
+			サイズ・クラス（ALIGN × ２のべき乗）毎のフリー・リストで管理し、@n
+			確保、解放は O(1)、ヒープは使わない。@n
+			解放したブロックは同じサイズ・クラスでのみ再利用する。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
 
 namespace utils {
 
@@ -15,20 +22,39 @@ namespace utils {
 	/*!
 		@brief  固定サイズ・メモリー・クラス
 		@param[in]	SIZE	格納サイズ（バイト）
-		@param[in]	DNUM	分割最大数
+		@param[in]	DNUM	サイズ・クラス数（最大ブロックは ALIGN << (DNUM - 1)）
+		@param[in]	ALIGN	アライメント（最小ブロック、２のべき乗、DMA 用なら３２）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <uint32_t SIZE, uint32_t DNUM>
+	template <uint32_t SIZE, uint32_t DNUM, uint32_t ALIGN = 16>
 	class fixed_memory {
 
-		uint8_t	buff_[SIZE];
+		static_assert(ALIGN >= sizeof(void*) && (ALIGN & (ALIGN - 1)) == 0, "ALIGN must be power of 2");
+		static_assert(DNUM > 0 && DNUM < 32, "DNUM out of range");
+		static_assert((SIZE % ALIGN) == 0, "SIZE must be a multiple of ALIGN");
 
-		struct head {
-			uint16_t	pos_;
-			uint16_t	size_;
+		static const uint32_t GNUM = SIZE / ALIGN;
+
+		struct link {
+			link*	next_;
 		};
 
-		head	head_[DNUM];
+		uint8_t		buff_[SIZE] __attribute__ ((aligned(ALIGN)));
+		uint8_t		cls_[GNUM];		///< ブロック先頭グラニュールのサイズ・クラス＋１
+		link*		free_[DNUM];
+
+		uint32_t	top_;			///< 切り出し位置
+		uint32_t	used_;
+		uint32_t	peak_;
+		uint32_t	cache_;			///< フリー・リストにあるバイト数
+		uint32_t	fail_;
+
+		static uint32_t class_(uint32_t size) noexcept
+		{
+			uint32_t g = (size + ALIGN - 1) / ALIGN;
+			if(g <= 1) return 0;
+			return 32 - __builtin_clz(g - 1);
+		}
 
 	public:
 		//-----------------------------------------------------------------//
@@ -36,7 +62,24 @@ namespace utils {
 			@brief  コンストラクタ
 		*/
 		//-----------------------------------------------------------------//
-		fixed_memory() noexcept { }
+		fixed_memory() noexcept { clear(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  全て解放
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept
+		{
+			for(uint32_t i = 0; i < GNUM; ++i) cls_[i] = 0;
+			for(uint32_t i = 0; i < DNUM; ++i) free_[i] = nullptr;
+			top_ = 0;
+			used_ = 0;
+			peak_ = 0;
+			cache_ = 0;
+			fail_ = 0;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -48,30 +91,205 @@ namespace utils {
 		uint32_t capacity() const noexcept { return SIZE; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  確保できる最大ブロック・サイズを返す
+			@return 最大ブロック・サイズ
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t max_block() noexcept { return ALIGN << (DNUM - 1); }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  メモリー・アロケーション
 			@param[in]	size	アロケーション・サイズ
-			@return メモリー・ポインター
+			@return メモリー・ポインター（ALIGN でアライン、失敗なら「nullptr」）
 		*/
 		//-----------------------------------------------------------------//
-		void* alloc(uint16_t size)
+		void* alloc(uint32_t size) noexcept
 		{
-			uint8_t* ptr = nullptr;
-
+			if(size == 0 || size > max_block()) {
+				++fail_;
+				return nullptr;
+			}
+			uint32_t c = class_(size);
+			uint32_t bsz = ALIGN << c;
+			uint8_t* ptr;
+			if(free_[c] != nullptr) {
+				link* l = free_[c];
+				free_[c] = l->next_;
+				cache_ -= bsz;
+				ptr = reinterpret_cast<uint8_t*>(l);
+			} else {
+				if((top_ + bsz) > SIZE) {
+					++fail_;
+					return nullptr;
+				}
+				ptr = &buff_[top_];
+				top_ += bsz;
+			}
+			cls_[(ptr - buff_) / ALIGN] = c + 1;
+			used_ += bsz;
+			if(used_ > peak_) peak_ = used_;
 			return ptr;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  最大サイズを返す
-			@return 最大サイズ
+			@brief  メモリー解放
+			@param[in]	ptr	alloc で得たポインター（「nullptr」は何もしない）
+			@return 不正なポインター（二重解放を含む）なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool free(void* ptr) noexcept
+		{
+			if(ptr == nullptr) return true;
+			uint8_t* p = static_cast<uint8_t*>(ptr);
+			if(p < buff_ || p >= &buff_[top_]) return false;
+			uint32_t ofs = p - buff_;
+			if((ofs % ALIGN) != 0) return false;
+			uint32_t g = ofs / ALIGN;
+			if(cls_[g] == 0) return false;
+
+			uint32_t c = cls_[g] - 1;
+			cls_[g] = 0;
+			uint32_t bsz = ALIGN << c;
+			link* l = static_cast<link*>(ptr);
+			l->next_ = free_[c];
+			free_[c] = l;
+			used_ -= bsz;
+			cache_ += bsz;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のバイト数（ブロック単位）
+			@return 使用中のバイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t used() const noexcept { return used_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用バイト数の最大値（ハイ・ウォーター）
+			@return 最大値
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t peak() const noexcept { return peak_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  未使用領域（まだ切り出していない）のバイト数
+			@return 未使用領域のバイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t remain() const noexcept { return SIZE - top_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  フリー・リストにあるバイト数（他のサイズ・クラスには使えない、断片化の目安）
+			@return フリー・リストにあるバイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t cached() const noexcept { return cache_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  確保に失敗した回数
+			@return 失敗回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t fail() const noexcept { return fail_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  fixed_memory を使う std::allocator 互換クラス
+		@param[in]	T	要素の型
+		@param[in]	MEM	fixed_memory 型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class T, class MEM>
+	class fixed_allocator {
+
+		template <class U, class M> friend class fixed_allocator;
+
+		MEM*	mem_;
+
+	public:
+		typedef T value_type;
+
+		template <class U>
+		struct rebind {
+			typedef fixed_allocator<U, MEM> other;
+		};
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクタ
+			@param[in]	mem	fixed_memory の参照
+		*/
+		//-----------------------------------------------------------------//
+		fixed_allocator(MEM& mem) noexcept : mem_(&mem) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  別の要素型からのコンストラクタ
+		*/
+		//-----------------------------------------------------------------//
+		template <class U>
+		fixed_allocator(const fixed_allocator<U, MEM>& t) noexcept : mem_(t.mem_) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  メモリ確保（確保できない場合、例外が無効なら abort）
+			@param[in]	n	要素数
+			@return ポインター
 		*/
 		//-----------------------------------------------------------------//
-		void free(void* ptr)
+		T* allocate(std::size_t n)
 		{
+			void* p = mem_->alloc(sizeof(T) * n);
+			if(p == nullptr) {
+#ifdef __cpp_exceptions
+				throw std::bad_alloc();
+#else
+				std::abort();
+#endif
+			}
+			return static_cast<T*>(p);
+		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  メモリ解放
+			@param[in]	p	ポインター
+			@param[in]	n	要素数
+		*/
+		//-----------------------------------------------------------------//
+		void deallocate(T* p, std::size_t n) noexcept
+		{
+			static_cast<void>(n);
+			mem_->free(p);
 		}
+
+
+		template <class U>
+		bool operator == (const fixed_allocator<U, MEM>& t) const noexcept { return mem_ == t.mem_; }
+
+		template <class U>
+		bool operator != (const fixed_allocator<U, MEM>& t) const noexcept { return mem_ != t.mem_; }
 	};
 }
@@ -106,6 +106,29 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  文字列を追加（長さ指定）
+			@param[in]	str	文字列
+			@param[in]	len	長さ
+			@return 自分
+		*/
+		//-----------------------------------------------------------------//
+		fixed_string& append(const char* str, uint32_t len) {
+			if(str == nullptr) {
+				return *this;
+			}
+
+			if((pos_ + len) > (SIZE - 1)) {  // バッファが許す範囲でコピー
+				len = SIZE - 1 - pos_;
+			}
+			std::memcpy(&text_[pos_], str, len);
+			pos_ += len;
+			text_[pos_] = 0;
+			return *this;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  文字を追加
@@ -1,83 +1,328 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	Flash memory マネージャー
+	@brief	Flash memory マネージャー @n
+			データ・フラッシュを使ったログ構造のレコード・ストア @n
+			・レコードは追記のみ（CRC 付き）、同じ ID の最新レコードが有効 @n
+			・起動時に全セクターを走査して、ID → 最新レコードの索引を RAM に作る @n
+			・読み出しは索引から O(1) で位置が決まる @n
+			・空きセクターが無くなると、最も古いセクターの有効レコードを移動して消去する @n
+			  （セクターは順番に回るので、消去回数は平均化される） @n
+			・電源断で書き込み途中のレコードは CRC で無効になる
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
-#include "common/renesas.hpp"
+#include <cstdint>
 
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  flash_man class @n
-				データ列の構造：@n
+				セクターの構造：@n
+				+0:  MAGIC (4 bytes) @n
+				+4:  消去回数 (4 bytes) @n
+				+8:  シーケンス番号 (4 bytes)（消去状態なら空きセクター）@n
+				+12: シーケンス番号の反転 (4 bytes)（書き込み途中の検出）@n
+				+16: レコード... @n
+				レコードの構造：@n
 				+0: ID (2 bytes) @n
-				+2: TM (2 bytes) タイムスタンプ（数値が一番大きいものが最新）@n
-				+4: SZ (2 bytes) サイズ
-		@param[in]	FIO		フラッシュ I/O
-		@param[in]	OMAX	オープン最大
+				+2: SZ (2 bytes) サイズ（０は削除） @n
+				+4: データ（４バイト単位） @n
+				+n: CRC32 (4 bytes)（ヘッダーとデータ）
+		@param[in]	FIO		フラッシュ I/O（device::flash_io）
+		@param[in]	IMAX	ID の最大数（ID は ０～IMAX-1）
+		@param[in]	SECTOR	セクター・サイズ（消去ブロックの整数倍）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class FIO, uint32_t OMAX = 4>
+	template <class FIO, uint32_t IMAX = 32, uint32_t SECTOR = 1024>
 	class flash_man {
 
-		FIO&	fio_;
+		static_assert((SECTOR % FIO::data_flash_block) == 0, "SECTOR must be a multiple of the erase block");
+		static_assert((FIO::data_flash_size % SECTOR) == 0, "data flash size must be a multiple of SECTOR");
 
-		// 制限：　１ファイル、最大３２Ｋバイトまで
-		struct head_t {
-			uint16_t	id;		///< file ID
-			uint16_t	nx_sz;	///< (B15:1)next block, (B15:0)total size
+		static const uint32_t MAGIC = 0x464d414e;  // "FMAN"
+		static const uint32_t SNUM  = FIO::data_flash_size / SECTOR;
+		static const uint32_t HEAD  = 16;
+		static const uint32_t NONE  = 0xffffffff;
+
+		static_assert(SNUM >= 3, "SECTOR too large");
+
+		struct sec_t {
+			uint32_t	seq;	///< シーケンス番号（NONE なら空き）
+			uint32_t	count;	///< 消去回数
+			bool		fmt;	///< MAGIC と消去回数が書かれている
+		};
+
+		struct idx_t {
+			uint16_t	sec;
+			uint16_t	ofs;	///< ０ならレコード無し（削除レコードは len が０）
+			uint16_t	len;
+			bool		valid;
 		};
 
+		FIO&		fio_;
 
-		uint32_t free_()
+		sec_t		sec_[SNUM];
+		idx_t		idx_[IMAX];
+
+		uint32_t	seq_;
+		uint32_t	cur_;
+		uint32_t	ofs_;
+		bool		mount_;
+
+		static uint32_t crc32_(uint32_t crc, const void* src, uint32_t len) noexcept
 		{
-			uint32_t pos = 0;
-			while(pos < FIO::data_flash_size) {
-				if(fio_.erase_check(pos)) {
-					return pos;
+			static const uint32_t tbl[16] = {
+				0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+				0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+				0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+				0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+			};
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(uint32_t i = 0; i < len; ++i) {
+				crc ^= p[i];
+				crc = (crc >> 4) ^ tbl[crc & 15];
+				crc = (crc >> 4) ^ tbl[crc & 15];
+			}
+			return crc;
+		}
+
+		static uint32_t rec_size_(uint32_t len) noexcept { return 4 + ((len + 3) & ~3) + 4; }
+
+		uint32_t org_(uint32_t sec) const noexcept { return sec * SECTOR; }
+
+		uint32_t num_free_() const noexcept
+		{
+			uint32_t n = 0;
+			for(uint32_t i = 0; i < SNUM; ++i) {
+				if(sec_[i].seq == NONE) ++n;
+			}
+			return n;
+		}
+
+		bool erase_sector_(uint32_t sec) noexcept
+		{
+			for(uint32_t i = 0; i < SECTOR; i += FIO::data_flash_block) {
+				if(!fio_.erase(org_(sec) + i)) return false;
+			}
+			++sec_[sec].count;
+			sec_[sec].seq = NONE;
+			for(uint32_t id = 0; id < IMAX; ++id) {
+				idx_t& t = idx_[id];
+				if(t.sec == sec) {
+					t.ofs = 0;
+					t.valid = false;
 				}
-				pos += FIO::data_flash_block;
 			}
-			return FIO::data_flash_size;
+			uint32_t h[2] = { MAGIC, sec_[sec].count };
+			sec_[sec].fmt = fio_.write(org_(sec), h, sizeof(h));
+			return sec_[sec].fmt;
 		}
 
+		// データ（４バイト単位で書く、端数は 0xFF で埋める）
+		bool program_(uint32_t org, const void* src, uint32_t len) noexcept
+		{
+			uint32_t n = len & ~3;
+			if(n > 0 && !fio_.write(org, src, n)) return false;
+			if(n < len) {
+				uint8_t tmp[4] = { 0xff, 0xff, 0xff, 0xff };
+				const uint8_t* p = static_cast<const uint8_t*>(src);
+				for(uint32_t i = n; i < len; ++i) tmp[i - n] = p[i];
+				if(!fio_.write(org + n, tmp, 4)) return false;
+			}
+			return true;
+		}
 
-		uint32_t scan_(uint16_t id) const
+		// レコードを検査して長さを返す（NONE なら終端、０ならヘッダーが不正） @n
+		// CRC が合わない場合、id に IMAX を返す
+		uint32_t check_(uint32_t sec, uint32_t ofs, uint16_t& id, uint16_t& len) noexcept
 		{
+			uint32_t org = org_(sec) + ofs;
+			if(fio_.erase_check(org, 4)) return NONE;
+
+			uint16_t h[2];
+			fio_.read(org, h, 4);
+			id = h[0];
+			len = h[1];
+			uint32_t rs = rec_size_(len);
+			if(id >= IMAX || (ofs + rs) > SECTOR) return 0;
+
+			uint32_t crc = crc32_(0xffffffff, h, 4);
+			uint8_t tmp[32];
 			uint32_t pos = 0;
-			uint32_t match = FIO::data_flash_size;
-			while(pos < FIO::data_flash_size) {
-				uint32_t d = FIO::data_flash_block;
-				if(!fio_.erase_check(pos)) {
-					head_t h;
-					fio_.read(pos, &h, sizeof(head_t));
-					if(h.id == id) {
-						match = pos;
-						uint16_t s = h.size;
-						d = s / (FIO::data_flash_block - sizeof(head_t));
-						if(d == 0) ++d;
-						d *= FIO::data_flash_block;
-					}
+			while(pos < len) {
+				uint32_t l = len - pos;
+				if(l > sizeof(tmp)) l = sizeof(tmp);
+				fio_.read(org + 4 + pos, tmp, l);
+				crc = crc32_(crc, tmp, l);
+				pos += l;
+			}
+			uint32_t sum;
+			fio_.read(org + rs - 4, &sum, 4);
+			if(sum != ~crc) id = IMAX;
+			return rs;
+		}
+
+		// セクターを走査して索引を更新、書き込み位置を返す
+		uint32_t scan_(uint32_t sec) noexcept
+		{
+			uint32_t ofs = HEAD;
+			while(ofs < SECTOR) {
+				uint16_t id;
+				uint16_t len;
+				auto rs = check_(sec, ofs, id, len);
+				if(rs == NONE) return ofs;
+				if(rs == 0) return SECTOR;  // ヘッダーが壊れている、以降は使わない
+				if(id < IMAX) {  // CRC が合わない場合は書き込み途中のレコード
+					idx_t& t = idx_[id];
+					t.sec = sec;
+					t.ofs = ofs;
+					t.len = len;
+					t.valid = len != 0;
+				}
+				ofs += rs;
+			}
+			return SECTOR;
+		}
+
+		bool activate_(uint32_t sec) noexcept
+		{
+			++seq_;
+			if(seq_ == 0 || seq_ == NONE) seq_ = 1;  // 反転が消去状態にならない様に
+			bool f;
+			if(sec_[sec].fmt) {
+				uint32_t h[2] = { seq_, ~seq_ };
+				f = fio_.write(org_(sec) + 8, h, sizeof(h));
+			} else {
+				uint32_t h[4] = { MAGIC, sec_[sec].count, seq_, ~seq_ };
+				f = fio_.write(org_(sec), h, sizeof(h));
+				sec_[sec].fmt = true;
+			}
+			if(!f) return false;
+			sec_[sec].seq = seq_;
+			cur_ = sec;
+			ofs_ = HEAD;
+			return true;
+		}
+
+		// レコードの追記（書き込み位置に空きがある事）
+		bool append_(uint16_t id, const void* src, uint16_t len, uint32_t src_org) noexcept
+		{
+			uint32_t org = org_(cur_) + ofs_;
+			uint16_t h[2] = { id, len };
+			uint32_t crc = crc32_(0xffffffff, h, 4);
+			if(!fio_.write(org, h, 4)) return false;
+			if(src != nullptr) {
+				crc = crc32_(crc, src, len);
+				if(!program_(org + 4, src, len)) return false;
+			} else {  // フラッシュ内のコピー
+				uint8_t tmp[32];
+				uint32_t pos = 0;
+				while(pos < len) {
+					uint32_t l = len - pos;
+					if(l > sizeof(tmp)) l = sizeof(tmp);
+					fio_.read(src_org + pos, tmp, l);
+					crc = crc32_(crc, tmp, l);
+					if(!program_(org + 4 + pos, tmp, l)) return false;
+					pos += l;
 				}
-				pos += d;
 			}
-			return match;
+			crc = ~crc;
+			auto rs = rec_size_(len);
+			if(!fio_.write(org + rs - 4, &crc, 4)) return false;
+
+			idx_t& t = idx_[id];
+			t.sec = cur_;
+			t.ofs = ofs_;
+			t.len = len;
+			t.valid = len != 0;
+			ofs_ += rs;
+			return true;
+		}
+
+		// 移動が必要なレコードか（tomb が「true」なら削除レコードも）
+		bool keep_(const idx_t& t, uint32_t sec, bool tomb) const noexcept
+		{
+			if(t.sec != sec || t.ofs == 0) return false;
+			return t.valid || tomb;
 		}
 
+		uint32_t live_(uint32_t sec, bool tomb) const noexcept
+		{
+			uint32_t live = 0;
+			for(uint32_t id = 0; id < IMAX; ++id) {
+				const idx_t& t = idx_[id];
+				if(keep_(t, sec, tomb)) live += rec_size_(t.len);
+			}
+			return live;
+		}
+
+		// 古いセクターから、有効レコードが書き込み位置に収まるものを選び、@n
+		// 有効レコードを移動して消去する @n
+		// 最も古いセクター以外を消去する場合、それより古いセクターに残る @n
+		// 同じ ID のレコードが復活しない様に、削除レコードも移動する
+		bool collect_() noexcept
+		{
+			uint32_t victim = NONE;
+			uint32_t last = 0;
+			bool tomb = false;
+			while(1) {
+				uint32_t sec = NONE;
+				for(uint32_t i = 0; i < SNUM; ++i) {
+					if(i == cur_ || sec_[i].seq == NONE) continue;
+					if(victim != NONE && static_cast<int32_t>(sec_[i].seq - last) <= 0) continue;
+					if(sec == NONE || static_cast<int32_t>(sec_[i].seq - sec_[sec].seq) < 0) sec = i;
+				}
+				if(sec == NONE) return false;
+				tomb = victim != NONE;
+				victim = sec;
+				last = sec_[sec].seq;
+				if((ofs_ + live_(sec, tomb)) <= SECTOR) break;
+			}
+
+			for(uint32_t id = 0; id < IMAX; ++id) {
+				const idx_t& t = idx_[id];
+				if(keep_(t, victim, tomb)) {
+					if(!append_(id, nullptr, t.len, org_(victim) + t.ofs + 4)) return false;
+				}
+			}
+			return erase_sector_(victim);
+		}
+
+		// 新しいセクターを開く（消去回数の少ない空きセクターを選ぶ）
+		bool open_sector_() noexcept
+		{
+			uint32_t sec = NONE;
+			for(uint32_t i = 0; i < SNUM; ++i) {
+				if(sec_[i].seq != NONE) continue;
+				if(sec == NONE || sec_[i].count < sec_[sec].count) sec = i;
+			}
+			if(sec == NONE) {
+				if(!collect_()) return false;
+				return open_sector_();
+			}
+			if(!activate_(sec)) return false;
+
+			// 予備の空きセクターを一つ残す
+			while(num_free_() == 0) {
+				if(!collect_()) break;
+			}
+			return true;
+		}
 
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  コンストラクタ
+			@param[in]	fio	フラッシュ I/O
 		*/
 		//-----------------------------------------------------------------//
-		flash_man(FIO& fio) : fio_(fio) { }
+		flash_man(FIO& fio) noexcept : fio_(fio), sec_{ }, idx_{ }, seq_(0), cur_(0), ofs_(SECTOR),
+			mount_(false) { }
 
 
 		//-----------------------------------------------------------------//
@@ -86,67 +331,184 @@ namespace utils {
 			@return FIO
 		*/
 		//-----------------------------------------------------------------//
-		FIO& at_fio() { return fio_; }
+		FIO& at_fio() noexcept { return fio_; }
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  フリー領域の取得
-			@return フリー領域の取得
+			@brief  開始（マウント） @n
+					※FIO は開始済みである事 @n
+					※壊れたセクターは消去する
+			@return エラーなら「false」
 		*/
 		//-----------------------------------------------------------------//
-		uint32_t get_free() const {
-			uint32_t space = 0;
-			for(uint32_t i = 0; i < FIO::data_flash_bank; ++i) {
-				if(fio_.erase_check(i)) {
-					space += FIO::data_flash_block - sizeof(head_t);
+		bool start() noexcept
+		{
+			mount_ = false;
+			seq_ = 0;
+			for(uint32_t id = 0; id < IMAX; ++id) {
+				idx_[id].ofs = 0;
+				idx_[id].valid = false;
+			}
+
+			for(uint32_t i = 0; i < SNUM; ++i) {
+				sec_t& s = sec_[i];
+				s.seq = NONE;
+				s.count = 0;
+				s.fmt = false;
+				uint32_t h[4];
+				if(!fio_.erase_check(org_(i), 4)) {
+					fio_.read(org_(i), h, sizeof(h));
+				} else {
+					h[0] = 0;
+				}
+				if(h[0] == MAGIC) {
+					s.count = h[1];
+					s.fmt = true;
+					if(fio_.erase_check(org_(i) + 8, 8)) {
+						// 空きセクター
+					} else if(h[3] == ~h[2] && h[3] != NONE) {
+						s.seq = h[2];
+						if(static_cast<int32_t>(s.seq - seq_) > 0) seq_ = s.seq;
+					} else {  // シーケンス番号の書き込み途中
+						if(!erase_sector_(i)) return false;
+					}
+				} else if(!fio_.erase_check(org_(i), SECTOR)) {
+					if(!erase_sector_(i)) return false;
 				}
 			}
-			return space;
+
+			// 古い順に走査
+			uint32_t last = 0;
+			bool first = true;
+			cur_ = NONE;
+			while(1) {
+				uint32_t sec = NONE;
+				for(uint32_t i = 0; i < SNUM; ++i) {
+					if(sec_[i].seq == NONE) continue;
+					if(!first && static_cast<int32_t>(sec_[i].seq - last) <= 0) continue;
+					if(sec == NONE || static_cast<int32_t>(sec_[i].seq - sec_[sec].seq) < 0) sec = i;
+				}
+				if(sec == NONE) break;
+				first = false;
+				last = sec_[sec].seq;
+				cur_ = sec;
+				ofs_ = scan_(sec);
+			}
+
+			if(cur_ == NONE) {
+				cur_ = 0;
+				if(!open_sector_()) return false;
+			}
+			// 移動の途中で電源が落ちた場合
+			while(num_free_() == 0) {
+				if(!collect_()) break;
+			}
+			mount_ = true;
+			return true;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  ファイルがあるか？
-			@param[in]	id	ファイルＩＤ
+			@brief  全消去
+			@return エラーなら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool format() noexcept
+		{
+			for(uint32_t i = 0; i < SNUM; ++i) {
+				if(!erase_sector_(i)) return false;
+			}
+			return start();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  レコードがあるか？
+			@param[in]	id	ＩＤ
 			@return ある場合「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool probe(uint16_t id) const
+		bool probe(uint16_t id) const noexcept
+		{
+			return id < IMAX && idx_[id].valid;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  レコードのサイズ
+			@param[in]	id	ＩＤ
+			@return サイズ（無い場合「０」）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_size(uint16_t id) const noexcept
 		{
-			return scan_(id) < FIO::data_flash_size;
+			if(!probe(id)) return 0;
+			return idx_[id].len;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  書き込み
+			@brief  書き込める最大サイズ
+			@return 最大サイズ
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t get_max_size() noexcept { return SECTOR - HEAD - 8; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  セクターの最大消去回数
+			@return 最大消去回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_erase_count() const noexcept
+		{
+			uint32_t n = 0;
+			for(uint32_t i = 0; i < SNUM; ++i) {
+				if(sec_[i].count > n) n = sec_[i].count;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  書き込み（同じ ID のレコードは置き換わる）
 			@param[in]	id		ＩＤ
 			@param[in]	src		ソース
-			@param[in]	size	サイズ（バイト）
+			@param[in]	size	サイズ（バイト、０なら削除）
 			@return エラーなら「false」
 		*/
 		//-----------------------------------------------------------------//
-		bool write(uint16_t id, const void* src, uint32_t size)
+		bool write(uint16_t id, const void* src, uint32_t size) noexcept
 		{
-			uint32_t pos = free_();
-			if(pos >= FIO::data_flash_size) {
-				return false;
-			}
-			uint32_t fsb = (FIO::data_flash_size - pos) / FIO::data_flash_block;
-			uint32_t fs  = fsb * (FIO::data_flash_block - sizeof(head_t));
-			if(fs < size) {
-				return false;
-			}
-
-			head_t t;
-			t.id = id;
-//			t.size = 
+			if(!mount_ || id >= IMAX || size > get_max_size()) return false;
+			if(src == nullptr && size > 0) return false;
 
+			// 開いたセクターが移動したレコードで埋まった場合は、次を開く
+			for(uint32_t i = 0; (ofs_ + rec_size_(size)) > SECTOR; ++i) {
+				if(i >= SNUM || !open_sector_()) return false;
+			}
+			return append_(id, src, size, 0);
+		}
 
 
-			return false;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  削除
+			@param[in]	id		ＩＤ
+			@return エラーなら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool remove(uint16_t id) noexcept
+		{
+			if(!probe(id)) return false;
+			return write(id, nullptr, 0);
 		}
 
 
@@ -154,14 +516,17 @@ namespace utils {
 		/*!
 			@brief  読み込み
 			@param[in]	id		ＩＤ
-			@param[in]	dst		転送先
-			@param[in]	size	サイズ（バイト）
+			@param[out]	dst		転送先
+			@param[in]	size	サイズ（バイト、レコードより大きい場合はレコードのサイズ）
 			@return エラーなら「false」
 		*/
 		//-----------------------------------------------------------------//
-		bool read(int desc, void* dst, uint32_t size)
+		bool read(uint16_t id, void* dst, uint32_t size) noexcept
 		{
-			return false;
+			if(!probe(id) || dst == nullptr) return false;
+			const idx_t& t = idx_[id];
+			if(size > t.len) size = t.len;
+			return fio_.read(org_(t.sec) + t.ofs + 4, dst, size);
 		}
 	};
 }
@@ -12,13 +12,21 @@
 			+ 2017/06/11 20:00- 標準文字出力クラスの再定義、実装 @n 
 			+ 2017/06/11 21:00- 固定文字列クラス向け chaout、実装 @n
 			+ 2017/06/12 14:50- memory_chaoutと、専用コンストラクター実装 @n
-			+ 2017/06/14 05:34- memory_chaout size() のバグ修正
+			+ 2017/06/14 05:34- memory_chaout size() のバグ修正 @n
+			+ コンパイル時解析フォーマット（"..."_fmt）、実装 @n
+			Ex: utils::format::ct("%d: %s\n"_fmt) % 10 % "abc"; @n
+			+ 出力ファンクタの一括書き込み「write(const char*, uint32_t)」@n
+			  （任意、basic_format が検出して使う）、バッファ付き標準出力、@n
+			  FIFO 出力ファンクタ、実装 @n
+			+ 整数の２桁単位変換、６４ビット整数、float の正確な丸めと @n
+			  最短表現（%g、精度指定無し）、実装
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2013, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
 #include <type_traits>
 #include <unistd.h>
 #include <cstring>
@@ -52,6 +60,503 @@
 
 namespace utils {
 
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コンパイル時解析フォーマット・セグメント @n
+				変換指定の前にあるリテラル（位置、長さ）と、変換指定
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct format_seg {
+		uint16_t	org;		///< リテラルの開始位置
+		uint16_t	len;		///< リテラルの長さ
+		char		conv;		///< 変換文字（０ならリテラルのみ）
+		uint8_t		num;		///< 全桁数
+		uint8_t		point;		///< 小数部桁数
+		uint8_t		bitlen;		///< 固定小数点、ビット長さ
+		bool		zerosupp;	///< ゼロ・サプレス
+		bool		sign;		///< 「+」符号
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コンパイル時解析フォーマット・テーブル
+		@param[in]	LEN		リテラル領域の長さ
+		@param[in]	NUM		セグメント数（変換指定数＋１）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t LEN, uint32_t NUM>
+	struct format_table {
+		char		lit[LEN];	///< リテラル（「%%」は「%」に変換済み）
+		format_seg	seg[NUM];
+		bool		ok;
+
+		constexpr format_table() : lit{ }, seg{ }, ok(true) { }
+	};
+
+
+	constexpr bool format_flag_(char ch)
+	{
+		return ch == '+' || ch == '-' || ch == '.' || ch == ':' || (ch >= '0' && ch <= '9');
+	}
+
+
+	constexpr bool format_conv_(char ch)
+	{
+		return ch == 's' || ch == 'c' || ch == 'b' || ch == 'o' || ch == 'd' || ch == 'u'
+			|| ch == 'x' || ch == 'X' || ch == 'y' || ch == 'f' || ch == 'F'
+			|| ch == 'e' || ch == 'E' || ch == 'g' || ch == 'G';
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  変換指定の数を数える
+		@param[in]	s	フォーマット式
+		@return 変換指定の数（「%%」は含まない）
+	*/
+	//-----------------------------------------------------------------//
+	constexpr uint32_t format_count(const char* s)
+	{
+		uint32_t n = 0;
+		while(*s != 0) {
+			if(*s++ != '%') continue;
+			while(format_flag_(*s)) ++s;
+			if(*s == 0) break;
+			if(*s++ != '%') ++n;
+		}
+		return n;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  フォーマット式の解析（basic_format::next_ と同等）
+		@param[in]	s	フォーマット式
+		@return フォーマット・テーブル
+	*/
+	//-----------------------------------------------------------------//
+	template <uint32_t LEN, uint32_t NUM>
+	constexpr format_table<LEN, NUM> format_parse(const char* s)
+	{
+		format_table<LEN, NUM> t;
+		uint32_t pos = 0;
+		uint32_t idx = 0;
+		char ch = 0;
+		while((ch = *s++) != 0) {
+			if(ch != '%') {
+				t.lit[pos++] = ch;
+				continue;
+			}
+			format_seg& g = t.seg[idx];
+			uint8_t md = 0;  // 0: 全桁数、1: 小数部桁数、2: ビット長さ
+			while((ch = *s++) != 0) {
+				if(ch == '+') {
+					g.sign = true;
+				} else if(ch >= '0' && ch <= '9') {
+					uint8_t v = static_cast<uint8_t>(ch - '0');
+					if(md == 0) {
+						if(g.num == 0 && v == 0) g.zerosupp = true;
+						g.num = static_cast<uint8_t>(g.num * 10 + v);
+					} else if(md == 1) {
+						g.point = static_cast<uint8_t>(g.point * 10 + v);
+					} else {
+						g.bitlen = static_cast<uint8_t>(g.bitlen * 10 + v);
+					}
+				} else if(ch == '.') {
+					md = 1;
+				} else if(ch == ':') {
+					md = 2;
+				} else if(ch != '-') {  // 「-」は無視する
+					break;
+				}
+			}
+			if(ch == '%') {
+				t.lit[pos++] = ch;
+				g.num = 0;
+				g.point = 0;
+				g.bitlen = 0;
+				g.zerosupp = false;
+				g.sign = false;
+				continue;
+			}
+			if(!format_conv_(ch)) {
+				t.ok = false;
+				break;
+			}
+			g.conv = ch;
+			g.len = static_cast<uint16_t>(pos - g.org);
+			++idx;
+			t.seg[idx].org = static_cast<uint16_t>(pos);
+		}
+		t.seg[idx].len = static_cast<uint16_t>(pos - t.seg[idx].org);
+		return t;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  変換指定と引数の「型」が適合するか
+		@param[in]	conv	変換文字
+		@return 適合するなら「true」
+	*/
+	//-----------------------------------------------------------------//
+	template <typename T>
+	constexpr bool format_accept(char conv)
+	{
+		return conv == 's' ? (std::is_same<T, const char*>::value || std::is_same<T, char*>::value)
+			: conv == 'c' ? (std::is_integral<T>::value && sizeof(T) == 1)
+			: (conv == 'f' || conv == 'F' || conv == 'e' || conv == 'E' || conv == 'g' || conv == 'G')
+				? std::is_floating_point<T>::value
+			: std::is_integral<T>::value;
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コンパイル時解析フォーマット文字列 @n
+				※「"..."_fmt」で生成する
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <char... S>
+	struct format_string {
+		static constexpr char str[sizeof...(S) + 1] = { S..., 0 };
+		static constexpr uint32_t num = format_count(str);
+		static constexpr format_table<sizeof...(S) + 1, num + 1> table
+			= format_parse<sizeof...(S) + 1, num + 1>(str);
+		static_assert(table.ok, "format: illegal conversion");
+	};
+
+	template <char... S> constexpr char format_string<S...>::str[];
+	template <char... S> constexpr uint32_t format_string<S...>::num;
+	template <char... S> constexpr format_table<sizeof...(S) + 1, format_string<S...>::num + 1>
+		format_string<S...>::table;
+
+
+	template <class CHAOUT, class FMT, uint32_t IDX> class basic_format_ct;
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  float 十進変換クラス @n
+				多倍長整数による正確な変換（Steele & White / Dragon4）@n
+				最短表現（読み戻して同じ値になる最小桁数）、有効桁数指定、@n
+				小数部桁数指定で、最近接偶数丸めを行う。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class format_real {
+	public:
+		static const int32_t DIGITS_MAX = 120;	///< 最大桁数（float の十進展開は１１２桁以下）
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  変換タイプ
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class type : uint8_t {
+			SHORTEST,	///< 最短表現
+			DIGITS,		///< 有効桁数指定
+			FRACTION,	///< 小数部桁数指定
+		};
+
+	private:
+		static const uint32_t WORDS = 8;
+
+		struct big_t {
+			uint32_t	w[WORDS];
+		};
+
+		static void set_(big_t& a, uint32_t v) {
+			a.w[0] = v;
+			for(uint32_t i = 1; i < WORDS; ++i) a.w[i] = 0;
+		}
+
+		static void shl_(big_t& a, uint32_t n) {
+			uint32_t wn = n / 32;
+			uint32_t bn = n % 32;
+			for(int32_t i = WORDS - 1; i >= 0; --i) {
+				int32_t j = i - static_cast<int32_t>(wn);
+				uint32_t v = 0;
+				if(j >= 0) {
+					v = a.w[j] << bn;
+					if(bn != 0 && j > 0) v |= a.w[j - 1] >> (32 - bn);
+				}
+				a.w[i] = v;
+			}
+		}
+
+		static void mul_(big_t& a, uint32_t m) {
+			uint64_t c = 0;
+			for(uint32_t i = 0; i < WORDS; ++i) {
+				c += static_cast<uint64_t>(a.w[i]) * m;
+				a.w[i] = static_cast<uint32_t>(c);
+				c >>= 32;
+			}
+		}
+
+		static void pow10_(big_t& a, uint32_t n) {
+			static const uint32_t tbl[] = {
+				1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+			};
+			while(n >= 9) {
+				mul_(a, 1000000000);
+				n -= 9;
+			}
+			mul_(a, tbl[n]);
+		}
+
+		static void add_(big_t& a, const big_t& b) {
+			uint64_t c = 0;
+			for(uint32_t i = 0; i < WORDS; ++i) {
+				c += static_cast<uint64_t>(a.w[i]) + b.w[i];
+				a.w[i] = static_cast<uint32_t>(c);
+				c >>= 32;
+			}
+		}
+
+		static void sub_(big_t& a, const big_t& b) {
+			uint32_t br = 0;
+			for(uint32_t i = 0; i < WORDS; ++i) {
+				uint64_t t = static_cast<uint64_t>(a.w[i]) - b.w[i] - br;
+				a.w[i] = static_cast<uint32_t>(t);
+				br = static_cast<uint32_t>(t >> 63);
+			}
+		}
+
+		static int cmp_(const big_t& a, const big_t& b) {
+			for(int32_t i = WORDS - 1; i >= 0; --i) {
+				if(a.w[i] != b.w[i]) return a.w[i] < b.w[i] ? -1 : 1;
+			}
+			return 0;
+		}
+
+		static bool zero_(const big_t& a) {
+			for(uint32_t i = 0; i < WORDS; ++i) {
+				if(a.w[i] != 0) return false;
+			}
+			return true;
+		}
+
+		// (r + m) と s の比較
+		static int cmp_sum_(const big_t& r, const big_t& m, const big_t& s) {
+			big_t t = r;
+			add_(t, m);
+			return cmp_(t, s);
+		}
+
+		// 2r と s の比較（剰余の丸め判定）
+		static int cmp_half_(const big_t& r, const big_t& s) {
+			big_t t = r;
+			shl_(t, 1);
+			return cmp_(t, s);
+		}
+
+		static uint32_t digit_(big_t& r, const big_t& s) {
+			uint32_t d = 0;
+			while(cmp_(r, s) >= 0) {
+				sub_(r, s);
+				++d;
+			}
+			return d;
+		}
+
+		// 最下位桁に１を加える（桁上がりで全て０になった場合、指数を進める）
+		static void round_up_(char* dig, int32_t nd, int32_t& k) {
+			for(int32_t i = nd - 1; i >= 0; --i) {
+				if(dig[i] != '9') {
+					++dig[i];
+					return;
+				}
+				dig[i] = '0';
+			}
+			dig[0] = '1';
+			++k;
+		}
+
+		// 整数 q の数字列（q × 10^-n の十進指数を k に返す）
+		static int32_t udig_(uint64_t q, char* dig, int32_t n, int32_t& k) {
+			if(q == 0) {
+				k = -n;
+				return 0;
+			}
+			char tmp[20];
+			int32_t l = 0;
+			while(q != 0) {
+				tmp[l++] = (q % 10) + '0';
+				q /= 10;
+			}
+			for(int32_t i = 0; i < l; ++i) dig[i] = tmp[l - 1 - i];
+			k = l - n;
+			return l;
+		}
+
+		// 小数部桁数指定（９桁以下）で、６４ビット整数で正確に計算できる場合
+		static bool fraction_(uint32_t f, int32_t e, int32_t n, char* dig, int32_t& nd, int32_t& k) {
+			static const uint32_t tbl[] = {
+				1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+			};
+			if(e >= 0) {  // 整数（小数部は全て０）
+				if(e > 39) return false;
+				nd = udig_(static_cast<uint64_t>(f) << e, dig, 0, k);
+				return true;
+			}
+			if(n < 0 || n > 9 || e < -63) return false;
+			// f × 10^n / 2^-e を、最近接偶数に丸める（f × 10^n は ２^54 未満）
+			uint64_t v = static_cast<uint64_t>(f) * tbl[n];
+			uint32_t sh = -e;
+			uint64_t q = v >> sh;
+			uint64_t rem = v & ((static_cast<uint64_t>(1) << sh) - 1);
+			uint64_t half = static_cast<uint64_t>(1) << (sh - 1);
+			if(rem > half || (rem == half && (q & 1) != 0)) ++q;
+			nd = udig_(q, dig, n, k);
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  十進数字列の生成 @n
+					値 ＝ 0.d1d2d3... × 10^k
+			@param[in]	bits	float のビット・パターン（正、有限）
+			@param[out]	dig		数字列（DIGITS_MAX 以上の領域、終端は付かない）
+			@param[in]	t		変換タイプ
+			@param[in]	n		有効桁数、又は小数部桁数
+			@param[out]	k		十進指数
+			@return 桁数（末尾の省略された桁は０）
+		*/
+		//-----------------------------------------------------------------//
+		static int32_t gen(uint32_t bits, char* dig, type t, int32_t n, int32_t& k) noexcept
+		{
+			uint32_t f = bits & 0x7fffff;
+			int32_t be = (bits >> 23) & 0xff;
+			if(be == 0 && f == 0) {
+				dig[0] = '0';
+				k = 1;
+				return 1;
+			}
+
+			// 値 ＝ f × 2^e、丸め幅の下側が狭い場合（仮数が２のべき）は unequal
+			int32_t e = -149;
+			bool unequal = false;
+			if(be != 0) {
+				unequal = f == 0 && be > 1;
+				f |= 0x800000;
+				e = be - 150;
+			}
+			bool even = (f & 1) == 0;
+
+			if(t == type::FRACTION) {
+				int32_t nd;
+				if(fraction_(f, e, n, dig, nd, k)) return nd;
+			}
+
+			big_t r, s, mp, mm;
+			uint32_t u = unequal ? 1 : 0;
+			if(e >= 0) {
+				set_(r, f);
+				shl_(r, e + 1 + u);
+				set_(s, 2 << u);
+				set_(mp, 1);
+				shl_(mp, e + u);
+				set_(mm, 1);
+				shl_(mm, e);
+			} else {
+				set_(r, f);
+				shl_(r, 1 + u);
+				set_(s, 1);
+				shl_(s, 1 + u - e);
+				set_(mp, 1 << u);
+				set_(mm, 1);
+			}
+
+			// k の推定（log10(2) ≒ 1233 / 4096）、後で補正する
+			int32_t nb = 0;
+			for(uint32_t v = f; v != 0; v >>= 1) ++nb;
+			k = (((e + nb - 1) * 1233) >> 12) + 1;
+			if(k >= 0) {
+				pow10_(s, k);
+			} else {
+				pow10_(r, -k);
+				pow10_(mp, -k);
+				pow10_(mm, -k);
+			}
+
+			bool shortest = t == type::SHORTEST;
+			for(;;) {
+				big_t tr = r;
+				mul_(tr, 10);
+				if(cmp_(tr, s) >= 0) break;
+				r = tr;
+				mul_(mp, 10);
+				mul_(mm, 10);
+				--k;
+			}
+			for(;;) {
+				int c = shortest ? cmp_sum_(r, mp, s) : cmp_(r, s);
+				if(c < 0 || (c == 0 && shortest && !even)) break;
+				mul_(s, 10);
+				++k;
+			}
+
+			int32_t nd = 0;
+			if(shortest) {
+				for(;;) {
+					mul_(r, 10);
+					mul_(mp, 10);
+					mul_(mm, 10);
+					uint32_t d = digit_(r, s);
+					int cl = cmp_(r, mm);
+					int ch = cmp_sum_(r, mp, s);
+					bool low  = even ? cl <= 0 : cl < 0;
+					bool high = even ? ch >= 0 : ch > 0;
+					if(!low && !high && nd < (DIGITS_MAX - 1)) {
+						dig[nd++] = d + '0';
+						continue;
+					}
+					if(low && high) {
+						int c = cmp_half_(r, s);
+						if(c > 0 || (c == 0 && (d & 1) != 0)) ++d;
+					} else if(high) {
+						++d;
+					}
+					if(d >= 10) {
+						dig[nd++] = '9';
+						round_up_(dig, nd, k);
+					} else {
+						dig[nd++] = d + '0';
+					}
+					break;
+				}
+				while(nd > 1 && dig[nd - 1] == '0') --nd;
+				return nd;
+			}
+
+			int32_t cnt = n;
+			if(t == type::FRACTION) cnt += k;
+			else if(cnt < 1) cnt = 1;
+			if(cnt > DIGITS_MAX) cnt = DIGITS_MAX;
+			if(cnt <= 0) {  // 全ての桁が丸め位置より下
+				if(cnt == 0 && cmp_half_(r, s) > 0) {
+					dig[0] = '1';
+					++k;
+					return 1;
+				}
+				return 0;
+			}
+			while(nd < cnt) {
+				mul_(r, 10);
+				dig[nd++] = digit_(r, s) + '0';
+				if(zero_(r)) return nd;
+			}
+			int c = cmp_half_(r, s);
+			if(c > 0 || (c == 0 && ((dig[nd - 1] - '0') & 1) != 0)) {
+				round_up_(dig, nd, k);
+			}
+			return nd;
+		}
+	};
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  無効出力ファンクタ @n
@@ -64,6 +569,9 @@ namespace utils {
 		void operator() (char ch) {
 		}
 
+		void write(const char* str, uint32_t len) {
+		}
+
 		void clear() { };
 
 		uint32_t size() const { return 0; }
@@ -92,6 +600,10 @@ namespace utils {
 			++size_;
 		}
 
+		void write(const char* str, uint32_t len) {
+			size_ += len;
+		}
+
 		void clear() { size_ = 0; };
 
 		uint32_t size() const { return size_; }
@@ -117,16 +629,90 @@ namespace utils {
 
 		void operator() (char ch) {
 			char tmp = ch;
-			write(1, &tmp, 1);  // FD by stdout
+			::write(1, &tmp, 1);  // FD by stdout
 			++size_;
 		}
 
+		void write(const char* str, uint32_t len) {
+			if(len == 0) return;
+			::write(1, str, len);  // FD by stdout
+			size_ += len;
+		}
+
 		void clear() { size_ = 0; };
 
 		uint32_t size() const { return size_; }
 	};
 
 
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  バッファ付き標準出力ファンクタ @n
+				バッファが満杯、又は改行で、まとめて書き込む @n
+				残りは破棄（終了）時に書き込む。改行の無い出力（プロンプト等）@n
+				は「buffered_format::chaout().flush()」で書き込む
+		@param[in]	SIZE	バッファ・サイズ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t SIZE = 128>
+	class stdout_buffered_chaout {
+
+		uint32_t	size_;
+		uint32_t	pos_;
+		char		buff_[SIZE];
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		stdout_buffered_chaout() : size_(0), pos_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  デストラクター（残りを書き込む）
+		*/
+		//-----------------------------------------------------------------//
+		~stdout_buffered_chaout() { flush(); }
+
+		void operator() (char ch) {
+			buff_[pos_++] = ch;
+			++size_;
+			if(pos_ >= SIZE || ch == '\n') {
+				flush();
+			}
+		}
+
+		void write(const char* str, uint32_t len) {
+			size_ += len;
+			while(len > 0) {
+				uint32_t l = SIZE - pos_;
+				if(l > len) l = len;
+				std::memcpy(&buff_[pos_], str, l);
+				pos_ += l;
+				str += l;
+				len -= l;
+				if(pos_ >= SIZE || std::memchr(str - l, '\n', l) != nullptr) {
+					flush();
+				}
+			}
+		}
+
+		void flush() {
+			if(pos_ > 0) {
+				::write(1, buff_, pos_);  // FD by stdout
+				pos_ = 0;
+			}
+		}
+
+		void clear() { flush(); size_ = 0; };
+
+		uint32_t size() const { return size_; }
+	};
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  標準出力ターミネーター・ファンクタ
@@ -180,6 +766,20 @@ namespace utils {
 			}			
 		}
 
+		void write(const char* str, uint32_t len) {
+			while(len > 0) {
+				uint32_t l = str_.capacity() - str_.size();
+				if(l > len) l = len;
+				str_.append(str, l);
+				str += l;
+				len -= l;
+				if(str_.size() >= str_.capacity()) {
+					term_(str_.c_str(), str_.size());
+					str_.clear();
+				}
+			}
+		}
+
 		void clear() {
 			if(str_.size() > 0) {
 				term_(str_.c_str(), str_.size());
@@ -238,12 +838,81 @@ namespace utils {
 			}
 		}
 
+		void write(const char* str, uint32_t len) {
+			if(limit_ == 0 || pos_ >= (limit_ - 1)) return;
+			uint32_t l = limit_ - 1 - pos_;
+			if(l > len) l = len;
+			std::memcpy(&dst_[pos_], str, l);
+			pos_ += l;
+			dst_[pos_] = 0;
+		}
+
 		void clear() { pos_ = 0; }
 
 		uint32_t size() const { return pos_; }
 	};
 
 
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  FIFO 出力ファンクタ @n
+				リング・バッファ（net::memory、utils::fixed_fifo<char, N>）に @n
+				直接書き込む、空きが無い場合は捨てる。@n
+				一括格納「put(const char*, len)」があれば使う。
+		@param[in]	FIFO	リング・バッファ・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class FIFO>
+	class fifo_chaout {
+
+		FIFO*		fifo_;
+		uint32_t	size_;
+
+		template <class T>
+		static auto put_(T& f, const char* str, uint32_t len, int) -> decltype(f.put(str, len), void()) {
+			f.put(str, len);
+		}
+
+		template <class T>
+		static void put_(T& f, const char* str, uint32_t len, long) {
+			for(uint32_t i = 0; i < len; ++i) f.put(str[i]);
+		}
+
+		uint32_t space_() const {
+			if(fifo_ == nullptr) return 0;
+			return fifo_->size() - fifo_->length() - 1;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		fifo_chaout() : fifo_(nullptr), size_(0) { }
+
+		void set(FIFO& fifo) { fifo_ = &fifo; }
+
+		void operator () (char ch) {
+			if(space_() == 0) return;
+			put_(*fifo_, &ch, 1, 0);
+			++size_;
+		}
+
+		void write(const char* str, uint32_t len) {
+			uint32_t l = space_();
+			if(l > len) l = len;
+			if(l == 0) return;
+			put_(*fifo_, str, l, 0);
+			size_ += l;
+		}
+
+		void clear() { size_ = 0; }
+
+		uint32_t size() const { return size_; }
+	};
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  簡易 format クラス
@@ -279,7 +948,8 @@ namespace utils {
 			REAL,		///< 浮動小数点
 			EXPONENT_CAPS,	///< 浮動小数点 exp 形式(E)
 			EXPONENT,	///< 浮動小数点 exp 形式(e)
-			REAL_AUTO,	///< 浮動小数点自動
+			REAL_AUTO,	///< 浮動小数点自動（g）
+			REAL_AUTO_CAPS,	///< 浮動小数点自動（G）
 			NONE		///< 不明
 		};
 
@@ -287,7 +957,7 @@ namespace utils {
 
 		const char*	form_;
 
-		char		buff_[34];
+		char		buff_[64];
 
 		error		error_;
 
@@ -298,9 +968,50 @@ namespace utils {
 		bool		zerosupp_;
 		bool		sign_;
 
+		template <class T>
+		static auto write_(T& out, const char* str, uint32_t len, int) -> decltype(out.write(str, len), void()) {
+			out.write(str, len);
+		}
+
+		template <class T>
+		static void write_(T& out, const char* str, uint32_t len, long) {
+			for(uint32_t i = 0; i < len; ++i) out(str[i]);
+		}
+
 		void str_(const char* str) {
-			char ch;
-			while((ch = *str++) != 0) chaout_(ch);
+			write_(chaout_, str, std::strlen(str), 0);
+		}
+
+		void pad_(char ch, uint32_t n) {
+			static const char spc[] = { "                " };
+			static const char zero[] = { "0000000000000000" };
+			const char* s = ch == '0' ? zero : spc;
+			while(n > 0) {
+				uint32_t l = n;
+				if(l > (sizeof(spc) - 1)) l = sizeof(spc) - 1;
+				write_(chaout_, s, l, 0);
+				n -= l;
+			}
+		}
+
+		static mode conv_mode_(char ch) {
+			switch(ch) {
+			case 's': return mode::STR;
+			case 'c': return mode::CHA;
+			case 'b': return mode::BINARY;
+			case 'o': return mode::OCTAL;
+			case 'd': return mode::DECIMAL;
+			case 'u': return mode::U_DECIMAL;
+			case 'x': return mode::HEX;
+			case 'X': return mode::HEX_CAPS;
+			case 'y': return mode::FIXED_REAL;
+			case 'f': case 'F': return mode::REAL;
+			case 'e': return mode::EXPONENT;
+			case 'E': return mode::EXPONENT_CAPS;
+			case 'g': return mode::REAL_AUTO;
+			case 'G': return mode::REAL_AUTO_CAPS;
+			default: return mode::NONE;
+			}
 		}
 
 		void reset_() {
@@ -349,176 +1060,154 @@ namespace utils {
 						md = apmd::point;
 					} else if(ch == ':') {
 						md = apmd::bitlen;
-					} else if(ch == 's') {
-						mode_ = mode::STR;
-						return;
-					} else if(ch == 'c') {
-						mode_ = mode::CHA;
-						return;
-					} else if(ch == 'b') {
-						mode_ = mode::BINARY;
-						return;
-					} else if(ch == 'o') {
-						mode_ = mode::OCTAL;
-						return;
-					} else if(ch == 'd') {
-						mode_ = mode::DECIMAL;
-						return;
-					} else if(ch == 'u') {
-						mode_ = mode::U_DECIMAL;
-						return;
-					} else if(ch == 'x') {
-						mode_ = mode::HEX;
-						return;
-					} else if(ch == 'X') {
-						mode_ = mode::HEX_CAPS;
-						return;
-					} else if(ch == 'y') {
-						mode_ = mode::FIXED_REAL;
-						return;
-					} else if(ch == 'f' || ch == 'F') {
-						mode_ = mode::REAL;
-						return;
-					} else if(ch == 'e') {
-						mode_ = mode::EXPONENT;
-						return;
-					} else if(ch == 'E') {
-						mode_ = mode::EXPONENT_CAPS;
-						return;
-					} else if(ch == 'g' || ch == 'G') {
-						mode_ = mode::REAL_AUTO;
-						return;
 					} else if(ch == '%') {
 						chaout_(ch);
 						md = apmd::none;
 					} else if(ch == '-') {  // 無視する
 
 					} else {
-						error_ = error::unknown;
+						mode_ = conv_mode_(ch);
+						if(mode_ == mode::NONE) {
+							error_ = error::unknown;
+						}
 						return;
 					}
 				} else if(ch == '%') {
 					md = apmd::num;
-				} else {
-					chaout_(ch);
+				} else {  // 次の「%」までのリテラルをまとめて出力
+					const char* top = form_ - 1;
+					while(*form_ != 0 && *form_ != '%') ++form_;
+					write_(chaout_, top, form_ - top, 0);
 				}
 			}
 		}
 
 
-		void out_str_(const char* str, char sign, uint8_t n) {
+		void out_pad_(char sign, uint32_t n) {
+			if(sign != 0) ++n;
 			if(zerosupp_) {
 				if(sign != 0) { chaout_(sign); }
 			}
-			if(n && n < num_) {
-				uint8_t spc = num_ - n;
-				while(spc) {
-					--spc;
-					if(zerosupp_) chaout_('0');
-					else chaout_(' ');
-				}
+			if(n < num_) {
+				pad_(zerosupp_ ? '0' : ' ', num_ - n);
 			}
 			if(!zerosupp_) {
 				if(sign != 0) { chaout_(sign); }
 			}
-			str_(str);
 		}
 
 
-		void out_bin_(int32_t v) {
-			char* p = &buff_[sizeof(buff_) - 1];
-			*p = 0;
-			uint8_t n = 0;
-			do {
-				--p;
-				*p = (v & 1) + '0';
-				v >>= 1;
-				++n;
-			} while(v != 0) ;
-			out_str_(p, 0, n);
+		void out_str_(const char* str, char sign, uint32_t n) {
+			out_pad_(sign, n);
+			write_(chaout_, str, n, 0);
 		}
 
 
-		void out_oct_(int32_t v) {
-			char* p = &buff_[sizeof(buff_) - 1];
-			*p = 0;
-			uint8_t n = 0;
-			do {
-				--p;
-				*p = (v & 3) + '0';
-				v >>= 3;
-				++n;
-			} while(v != 0) ;
-			out_str_(p, 0, n);
+		static const char* dig2_() {
+			static const char tbl[] = {
+				"0001020304050607080910111213141516171819"
+				"2021222324252627282930313233343536373839"
+				"4041424344454647484950515253545556575859"
+				"6061626364656667686970717273747576777879"
+				"8081828384858687888990919293949596979899"
+			};
+			return tbl;
 		}
 
 
-		void out_udec_(uint32_t v, char sign) {
-			char* p = &buff_[sizeof(buff_) - 1];
-			*p = 0;
-			uint8_t n = 0;
-			do {
-				--p;
-				*p = (v % 10) + '0';
-				v /= 10;
-				++n;
-			} while(v != 0) ;
-			out_str_(p, sign, n);
+		// ２桁ずつ変換（p は終端、変換した先頭を返す）
+		static char* udec_(uint32_t v, char* p) {
+			const char* tbl = dig2_();
+			while(v >= 100) {
+				// v / 100 を逆数の乗算で求める
+				uint32_t q = static_cast<uint32_t>((static_cast<uint64_t>(v) * 0x51EB851F) >> 37);
+				uint32_t r = (v - q * 100) * 2;
+				*--p = tbl[r + 1];
+				*--p = tbl[r];
+				v = q;
+			}
+			if(v >= 10) {
+				*--p = tbl[v * 2 + 1];
+				*--p = tbl[v * 2];
+			} else {
+				*--p = v + '0';
+			}
+			return p;
 		}
 
 
-		void out_dec_(int32_t v) {
-			char sign = 0;
-			if(v < 0) { v = -v; sign = '-'; }
-			else if(sign_) { sign = '+'; }
-			out_udec_(v, sign);
+		// ６４ビットは１億で割って、３２ビット変換を繰り返す
+		static char* udec_(uint64_t v, char* p) {
+			while(v > 0xffffffff) {
+				uint64_t q = v / 100000000;
+				char* e = p - 8;
+				p = udec_(static_cast<uint32_t>(v - q * 100000000), p);
+				while(p > e) *--p = '0';
+				v = q;
+			}
+			return udec_(static_cast<uint32_t>(v), p);
 		}
 
 
-		void out_hex_(uint32_t v, char top) {
-			char* p = &buff_[sizeof(buff_) - 1];
-			*p = 0;
-			uint8_t n = 0;
+		template <typename U>
+		void out_udec_(U v, char sign) {
+			char* e = &buff_[sizeof(buff_)];
+			char* p = udec_(v, e);
+			out_str_(p, sign, e - p);
+		}
+
+
+		template <typename U>
+		void out_radix_(U v, uint8_t bits, char top) {
+			char* e = &buff_[sizeof(buff_)];
+			char* p = e;
+			U mask = (static_cast<U>(1) << bits) - 1;
 			do {
-				--p;
-				char ch = v & 15;
+				char ch = v & mask;
 				if(ch >= 10) ch += top - 10;
 				else ch += '0';
-				*p = ch;
-				v >>= 4;
-				++n;
+				*--p = ch;
+				v >>= bits;
 			} while(v != 0) ;
-			out_str_(p, 0, n);
+			out_str_(p, 0, e - p);
 		}
 
 
-		void decimal_(int32_t val, bool sign) {
+		template <typename T>
+		static bool neg_(T v, std::true_type) { return v < 0; }
+
+		template <typename T>
+		static bool neg_(T v, std::false_type) { return false; }
+
+
+		template <typename T>
+		void decimal_(T val) {
+			typedef typename std::conditional<(sizeof(T) > 4), uint64_t, uint32_t>::type U;
+			U uv = static_cast<U>(val);
+			bool neg = neg_(val, std::is_signed<T>());
+			U mag = neg ? static_cast<U>(0 - uv) : uv;
 			switch(mode_) {
 			case mode::BINARY:
-				out_bin_(val);
+				out_radix_(uv, 1, 0);
 				break;
 			case mode::OCTAL:
-				out_oct_(val);
+				out_radix_(uv, 3, 0);
 				break;
 			case mode::DECIMAL:
-				out_dec_(val);
+				out_udec_(mag, neg ? '-' : (sign_ ? '+' : 0));
 				break;
 			case mode::U_DECIMAL:
-				out_udec_(val, sign_ ? '+' : 0);
+				out_udec_(uv, sign_ ? '+' : 0);
 				break;
 			case mode::HEX:
-				out_hex_(static_cast<uint32_t>(val), 'a');
+				out_radix_(uv, 4, 'a');
 				break;
 			case mode::HEX_CAPS:
-				out_hex_(static_cast<uint32_t>(val), 'A');
+				out_radix_(uv, 4, 'A');
 				break;
 			case mode::FIXED_REAL:
 				if(num_ == 0) num_ = 6;
-				if(val < 0) {
-					sign = true;
-					val = -val;
-				}
-				out_fixed_point_<uint64_t>(val, bitlen_, sign);
+				out_fixed_point_<uint64_t>(mag, bitlen_, neg);
 				break;
 			default:
 				error_ = error::different;
@@ -540,7 +1229,6 @@ namespace utils {
 		template <typename VAL>
 		void out_fixed_point_(VAL v, uint8_t fixpoi, bool sign)
 		{
-// std::cout << "Shift: " << static_cast<int>(fixpoi) << std::endl;
 			// 四捨五入処理用 0.5
 			VAL m = 0;
 			if(fixpoi < (sizeof(VAL) * 8 - 4)) {
@@ -556,89 +1244,193 @@ namespace utils {
 			else if(sign_) sch = '+';
 			v += m;
 			if(num_ >= point_) num_ -= point_;
-			if(num_ > 0 && sch != 0) --num_;
 			if(num_ > 0 && point_ != 0) {
 				--num_;
 			}
 			if(fixpoi < (sizeof(VAL) * 8 - 4)) {
 				out_udec_(v >> fixpoi, sch);
 			} else {
-				out_udec_(0, sch);
+				out_udec_(static_cast<VAL>(0), sch);
 			}
 
 			if(point_ == 0) return;
 			chaout_('.');
 
+			// 小数部は buff_ に集めてから出力する
 			uint8_t l = 0;
+			uint32_t k = 0;
 			if(fixpoi < (sizeof(VAL) * 8 - 4)) {
 				VAL dec = v & make_mask_(fixpoi);
 				while(dec > 0) {
 					dec *= 10;
 					VAL n = dec >> fixpoi;
-					chaout_(n + '0');
+					buff_[k++] = n + '0';
+					if(k >= sizeof(buff_)) {
+						write_(chaout_, buff_, k, 0);
+						k = 0;
+					}
 					dec -= n << fixpoi;
 					++l;
 					if(l >= point_) break;
 				}
 			}
-			while(l < point_) {
+			write_(chaout_, buff_, k, 0);
+			pad_('0', point_ - l);
+		}
+
+
+		// 固定小数点形式（dig: 数字列、nd: 桁数、k: 十進指数、p: 小数部桁数）
+		void out_f_(const char* dig, int32_t nd, int32_t k, uint32_t p, char sch) {
+			uint32_t len = k > 0 ? k : 1;
+			if(p > 0) len += 1 + p;
+			out_pad_(sch, len);
+
+			if(k <= 0) {
 				chaout_('0');
-				++l;
+			} else {
+				uint32_t l = k < nd ? k : nd;
+				write_(chaout_, dig, l, 0);
+				pad_('0', k - l);
+			}
+			if(p == 0) return;
+
+			chaout_('.');
+			uint32_t z = 0;
+			if(k < 0) {
+				z = -k;
+				if(z > p) z = p;
+				pad_('0', z);
 			}
+			int32_t top = k < 0 ? 0 : k;
+			uint32_t l = 0;
+			if(top < nd) {
+				l = nd - top;
+				if(l > (p - z)) l = p - z;
+				write_(chaout_, &dig[top], l, 0);
+			}
+			pad_('0', p - z - l);
 		}
 
 
-		void out_real_(float v, char e) {
-			void* p = &v;
-			uint32_t fpv = *(uint32_t*)p;
-			bool sign = fpv >> 31;
-			int16_t exp = (fpv >> 23) & 0xff;
-			if(exp == 0xff) {
-				if(sign) chaout_('-');
-				str_("inf");
-				return;
+		// 指数形式（指数は２桁以上）
+		void out_e_(const char* dig, int32_t nd, int32_t k, uint32_t p, char sch, char e) {
+			int32_t x = k - 1;
+			uint32_t xa = x < 0 ? -x : x;
+			char tmp[4];
+			char* xp = udec_(xa, &tmp[4]);
+			if(xa < 10) *--xp = '0';
+			uint32_t xl = &tmp[4] - xp;
+
+			uint32_t len = 1 + 2 + xl;
+			if(p > 0) len += 1 + p;
+			out_pad_(sch, len);
+
+			chaout_(dig[0]);
+			if(p > 0) {
+				chaout_('.');
+				uint32_t l = nd - 1;
+				if(l > p) l = p;
+				write_(chaout_, &dig[1], l, 0);
+				pad_('0', p - l);
 			}
+			chaout_(e);
+			chaout_(x < 0 ? '-' : '+');
+			write_(chaout_, xp, xl, 0);
+		}
 
-			exp -= 127;	// bias (-127)
-			int32_t val = fpv & 0x7fffff;	// 23 bits
-			int16_t shift = 23;
-			if(val == 0 && exp == -127) ; // [0.0]
-			else {
-				val |= 0x800000; // add offset 1.0
-			}
-			shift -= exp;
 
-			// 64 ビットに拡張
-			uint64_t v64 = static_cast<uint64_t>(val);
-			if(shift < 28) {
-				shift += 32;
-				v64 <<= 32;
+		void out_real_(float v) {
+			uint32_t fpv;
+			std::memcpy(&fpv, &v, sizeof(fpv));
+			char sch = 0;
+			if(fpv >> 31) sch = '-';
+			else if(sign_) sch = '+';
+			fpv &= 0x7fffffff;
+			bool caps = mode_ == mode::EXPONENT_CAPS || mode_ == mode::REAL_AUTO_CAPS;
+
+			if((fpv >> 23) == 0xff) {
+				bool nan = (fpv & 0x7fffff) != 0;
+				zerosupp_ = false;
+				if(caps) out_str_(nan ? "NAN" : "INF", sch, 3);
+				else out_str_(nan ? "nan" : "inf", sch, 3);
+				return;
 			}
 
-			// エキスポーネント表記の場合
-			int8_t dexp = 0;
-			if(e != 0) {
-				if(v64 > (static_cast<uint64_t>(2) << shift)) {  // 2.0 以上の場合
-					while(v64 > (static_cast<uint64_t>(2) << shift)) {
-						v64 /= 10;
-						++dexp;
+			char dig[format_real::DIGITS_MAX];
+			int32_t k = 0;
+			int32_t nd;
+			switch(mode_) {
+			case mode::REAL:
+				nd = format_real::gen(fpv, dig, format_real::type::FRACTION, point_, k);
+				out_f_(dig, nd, k, point_, sch);
+				break;
+			case mode::EXPONENT:
+			case mode::EXPONENT_CAPS:
+				nd = format_real::gen(fpv, dig, format_real::type::DIGITS, point_ + 1, k);
+				out_e_(dig, nd, k, point_, sch, caps ? 'E' : 'e');
+				break;
+			case mode::REAL_AUTO:
+			case mode::REAL_AUTO_CAPS:
+				{
+					// 精度指定が無い場合、最短表現
+					int32_t prec = 9;
+					if(point_ == 0) {
+						nd = format_real::gen(fpv, dig, format_real::type::SHORTEST, 0, k);
+					} else {
+						prec = point_;
+						nd = format_real::gen(fpv, dig, format_real::type::DIGITS, prec, k);
+						while(nd > 1 && dig[nd - 1] == '0') --nd;
 					}
-				} else if(v64 < (static_cast<uint64_t>(1) << shift)) {  // 1.0 以下
-					while(v64 < (static_cast<uint64_t>(1) << shift)) {
-						v64 *= 10;
-						--dexp;
+					int32_t x = k - 1;
+					if(x < -4 || x >= prec) {
+						out_e_(dig, nd, k, nd - 1, sch, caps ? 'E' : 'e');
+					} else {
+						out_f_(dig, nd, k, nd > k ? nd - k : 0, sch);
 					}
 				}
+				break;
+			default:
+				error_ = error::different;
+				break;
+			}
+		}
+
+
+		void out_(const char* val) {
+			if(mode_ == mode::STR) {
+				if(val == nullptr) {
+					static const char* nullstr = { "(nullptr)" };
+					out_str_(nullstr, 0, std::strlen(nullstr));					
+				} else {
+					zerosupp_ = false;
+					out_str_(val, 0, std::strlen(val));
+				}
+			} else {
+				error_ = error::different;
 			}
+		}
+
+
+		void out_(char* val) { out_(static_cast<const char*>(val)); }
 
-			out_fixed_point_<uint64_t>(v64, shift, sign);
 
-			if(e) {
-				chaout_(e);
-				zerosupp_ = true;
-				sign_ = true;
-				num_ = 3;
-				out_dec_(dexp);
+		template <typename T>
+		void out_(T val) {
+			if(std::is_integral<T>::value) {
+				if(mode_ == mode::CHA && sizeof(T) == 1) {
+					chaout_(val);
+				} else {
+					decimal_(val);
+				}
+			} else if(std::is_floating_point<T>::value) {
+				if(mode_ != mode::REAL_AUTO && mode_ != mode::REAL_AUTO_CAPS
+					&& num_ == 0 && !zerosupp_ && point_ == 0) {
+					num_ = 6;
+					point_ = 6;
+				}
+				out_real_(static_cast<float>(val));
+			} else {
+				error_ = error::unknown;
 			}
 		}
 
@@ -720,6 +1512,77 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		int size() const noexcept { return chaout_.size(); }
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  リテラルの出力（コンパイル時解析フォーマット用）
+			@param[in]	str	文字列
+			@param[in]	len	長さ
+		*/
+		//-----------------------------------------------------------------//
+		void literal(const char* str, uint32_t len) noexcept
+		{
+			if(error_ != error::none || len == 0) {
+				return;
+			}
+			write_(chaout_, str, len, 0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  解析済み変換指定による値の出力（コンパイル時解析フォーマット用）
+			@param[in]	seg	セグメント
+			@param[in]	val	値
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		void put(const format_seg& seg, T val) noexcept
+		{
+			if(error_ != error::none) {
+				return;
+			}
+			num_ = seg.num;
+			point_ = seg.point;
+			bitlen_ = seg.bitlen;
+			mode_ = conv_mode_(seg.conv);
+			zerosupp_ = seg.zerosupp;
+			sign_ = seg.sign;
+			out_(val);
+			reset_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンパイル時解析フォーマットの生成
+			@param[in]	fmt	フォーマット文字列（"..."_fmt）
+			@return コンパイル時解析フォーマット
+		*/
+		//-----------------------------------------------------------------//
+		template <char... S>
+		static basic_format_ct<CHAOUT, format_string<S...>, 0> ct(format_string<S...> fmt) noexcept
+		{
+			return basic_format_ct<CHAOUT, format_string<S...>, 0>();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンパイル時解析フォーマットの生成
+			@param[in]	fmt		フォーマット文字列（"..."_fmt）
+			@param[in]	buff	文字バッファ
+			@param[in]	size	文字バッファサイズ
+			@param[in]	append	文字バッファに追加する場合「true」
+			@return コンパイル時解析フォーマット
+		*/
+		//-----------------------------------------------------------------//
+		template <char... S>
+		static basic_format_ct<CHAOUT, format_string<S...>, 0> ct(format_string<S...> fmt,
+			char* buff, uint32_t size, bool append = false) noexcept
+		{
+			return basic_format_ct<CHAOUT, format_string<S...>, 0>(buff, size, append);
+		}
+
 
 		//-----------------------------------------------------------------//
 		/*!
@@ -734,20 +1597,7 @@ namespace utils {
 				return *this;
 			}
 
-			if(mode_ == mode::STR) {
-				if(val == nullptr) {
-					static const char* nullstr = { "(nullptr)" };
-					out_str_(nullstr, 0, std::strlen(nullstr));					
-				} else {
-					zerosupp_ = false;
-					uint8_t n = 0;
-					const char* p = val;
-					while((*p++) != 0) { ++n; }
-					out_str_(val, 0, n);
-				}
-			} else {
-				error_ = error::different;
-			}
+			out_(val);
 
 			reset_();
 			next_();
@@ -768,20 +1618,7 @@ namespace utils {
 				return *this;
 			}
 
-			if(mode_ == mode::STR) {
-				if(val == nullptr) {
-					static const char* nullstr = { "(nullptr)" };
-					out_str_(nullstr, 0, strlen(nullstr));					
-				} else {
-					zerosupp_ = false;
-					uint8_t n = 0;
-					const char* p = val;
-					while((*p++) != 0) { ++n; }
-					out_str_(val, 0, n);
-				}
-			} else {
-				error_ = error::different;
-			}
+			out_(static_cast<const char*>(val));
 
 			reset_();
 			next_();
@@ -803,37 +1640,7 @@ namespace utils {
 				return *this;
 			}
 
-			if(std::is_integral<T>::value) {
-				if(mode_ == mode::CHA && sizeof(T) == 1) {
-					chaout_(val);
-				} else {
-					decimal_(static_cast<int32_t>(val), std::is_signed<T>::value);
-				}
-			} else if(std::is_floating_point<T>::value) {
-				if(num_ == 0 && !zerosupp_ && point_ == 0) {
-					num_ = 6;
-					point_ = 6;
-				}
-				switch(mode_) {
-				case mode::REAL:
-					out_real_(val, 0);
-					break;
-				case mode::EXPONENT_CAPS:
-					out_real_(val, 'E');
-					break;
-				case mode::EXPONENT:
-					out_real_(val, 'e');
-					break;
-				case mode::REAL_AUTO:
-					out_real_(val, 0);
-					break;
-				default:
-					error_ = error::different;
-					break;
-				}
-			} else {
-				error_ = error::unknown;
-			}
+			out_(val);
 
 			reset_();
 			next_();
@@ -843,8 +1650,122 @@ namespace utils {
 
 	template <class CHAOUT> CHAOUT basic_format<CHAOUT>::chaout_;
 
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コンパイル時解析 format クラス @n
+				フォーマット式はコンパイル時に解析され、引数の数と「型」も @n
+				コンパイル時に検査される。リテラルはまとめて出力する。@n
+				※ basic_format::ct で生成する @n
+				変換の状態は最初のオブジェクト（IDX = 0）が持ち、「%」が返す @n
+				オブジェクトはその参照だけを持つ（引数毎に状態をコピーしない）。@n
+				その為、ct から「%」の連鎖は一つの式の中で使う事。
+		@param[in]	CHAOUT	文字出力ファンクタ
+		@param[in]	FMT		フォーマット文字列（format_string）
+		@param[in]	IDX		次の引数の位置
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class CHAOUT, class FMT, uint32_t IDX>
+	class basic_format_ct {
+
+		template <class, class, uint32_t> friend class basic_format_ct;
+
+		typedef basic_format<CHAOUT> format_type;
+		typedef typename std::conditional<IDX == 0, format_type, format_type&>::type state_type;
+
+		state_type	fmt_;
+
+		void literal_(uint32_t idx) noexcept {
+			const format_seg& seg = FMT::table.seg[idx];
+			fmt_.literal(&FMT::table.lit[seg.org], seg.len);
+		}
+
+		basic_format_ct(format_type& fmt) noexcept : fmt_(fmt) { }
+
+	public:
+		typedef typename format_type::error error;
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		basic_format_ct() noexcept : fmt_("") { literal_(0); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	buff	文字バッファ
+			@param[in]	size	文字バッファサイズ
+			@param[in]	append	文字バッファに追加する場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		basic_format_ct(char* buff, uint32_t size, bool append) noexcept :
+			fmt_("", buff, size, append) { literal_(0); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  エラー種別を返す
+			@return エラー
+		*/
+		//-----------------------------------------------------------------//
+		error get_error() const noexcept { return fmt_.get_error(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  変換ステータスを返す
+			@return 変換が全て正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool status() const noexcept { return fmt_.status(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  出力サイズを返す
+			@return 出力サイズ
+		*/
+		//-----------------------------------------------------------------//
+		int size() const noexcept { return fmt_.size(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」
+			@param[in]	val	値
+			@return	次の引数を受け取るオブジェクト（状態の参照）
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		basic_format_ct<CHAOUT, FMT, IDX + 1> operator % (T val) noexcept
+		{
+			static_assert(IDX < FMT::num, "format: too many arguments");
+			static_assert(format_accept<T>(FMT::table.seg[IDX < FMT::num ? IDX : 0].conv),
+				"format: argument type mismatch");
+
+			fmt_.put(FMT::table.seg[IDX], val);
+			basic_format_ct<CHAOUT, FMT, IDX + 1> t(fmt_);
+			t.literal_(IDX + 1);
+			return t;
+		}
+	};
+
 	typedef basic_format<stdout_chaout> format;
+	typedef basic_format<stdout_buffered_chaout<> > buffered_format;
 	typedef basic_format<memory_chaout> sformat;
 	typedef basic_format<null_chaout> null_format;
 	typedef basic_format<size_chaout> size_format;
 }
+
+
+//-----------------------------------------------------------------//
+/*!
+	@brief  コンパイル時解析フォーマット文字列リテラル @n
+			Ex: utils::sformat::ct("%d,%s"_fmt, buff, sizeof(buff)) % 10 % "abc";
+*/
+//-----------------------------------------------------------------//
+template <typename C, C... S>
+constexpr utils::format_string<S...> operator "" _fmt() noexcept { return utils::format_string<S...>(); }
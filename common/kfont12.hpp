@@ -9,7 +9,11 @@
 */
 //=====================================================================//
 #include <cstdint>
-#include "ff12a/src/ff.h"
+#include "common/sdc_map.hpp"
+
+extern "C" {
+	extern volatile uint32_t fs_modify_count;	///< syscalls.c の変更カウンター
+}
 
 namespace graphics {
 
@@ -30,6 +34,9 @@ namespace graphics {
 
 		bool	mount_;
 
+		utils::sdc_map<16>	map_;  ///< フォント・ファイル（オープンしたまま保持）
+		uint32_t	map_count_;	///< オープンした時の変更カウンター
+
 		static uint16_t sjis_to_liner_(uint16_t sjis)
 		{
 			uint16_t code;
@@ -62,7 +69,7 @@ namespace graphics {
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		kfont12() : cash_idx_(0), mount_(false) {
+		kfont12() : cash_idx_(0), mount_(false), map_count_(0) {
 			for(uint8_t i = 0; i < CASH_SIZE; ++i) {
 				cash_[i].code = 0;
 			}
@@ -90,7 +97,10 @@ namespace graphics {
 			@brief	マウント状態の設定
 		*/
 		//-----------------------------------------------------------------//
-		void set_mount(bool f) { mount_ = f; }
+		void set_mount(bool f) {
+			mount_ = f;
+			if(!f) map_.close();
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -104,6 +114,14 @@ namespace graphics {
 
 			if(code == 0) return nullptr;
 
+			// オープン後にファイルの書き換え、削除があれば、開き直す
+			if(map_.probe() && map_count_ != fs_modify_count) {
+				map_.close();
+				for(uint8_t i = 0; i < CASH_SIZE; ++i) {
+					cash_[i].code = 0;
+				}
+			}
+
 			// キャッシュ内検索
 			int8_t n = -1;
 			for(uint8_t i = 0; i < CASH_SIZE; ++i) {
@@ -132,25 +150,18 @@ namespace graphics {
 				return nullptr;
 			}
 
-			FIL fp;
-			if(f_open(&fp, "/kfont12.bin", FA_READ) != FR_OK) {
-				return nullptr;
-			}
- 
-			if(f_lseek(&fp, lin * 18) != FR_OK) {
-				f_close(&fp);
-				return nullptr;
+			if(!map_.probe()) {
+				if(!map_.open("/kfont12.bin")) {
+					return nullptr;
+				}
+				map_count_ = fs_modify_count;
 			}
 
-			UINT rs;
-			if(f_read(&fp, &cash_[cash_idx_].bitmap[0], 18, &rs) != FR_OK) {
-				f_close(&fp);
+			if(map_.read(lin * 18, &cash_[cash_idx_].bitmap[0], 18) != 18) {
 				return nullptr;
 			}
 			cash_[cash_idx_].code = code;
 
-			f_close(&fp);
-
 			return &cash_[cash_idx_].bitmap[0];
 		}
 	};
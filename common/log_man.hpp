@@ -2,7 +2,12 @@
 //=====================================================================//
 /*!	@file
 	@brief	ログ・マネージャー・クラス @n
-			・バックアップ可能な、領域を使ったログメモリー
+			・バックアップ可能な、領域を使ったログメモリー @n
+			・ヘッダーは二重化し、シーケンス番号の新しい有効な方を使う @n
+			・データを書いた後にヘッダーを書くので、電源断でもログは壊れない @n
+			  （書き込み途中のブロックが失われるだけ） @n
+			・putch はバッファに貯め、改行かバッファが一杯で書き込む @n
+			・write、puts はすぐに書き込む（貯めた putch の分も一緒に）
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -10,36 +15,100 @@
 */
 //=====================================================================//
 #include <cstdint>
+#include <cstring>
 
 namespace utils {
 
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
     /*!
-        @brief  log_man クラス
+        @brief  log_man クラス @n
+				MEMIO は以下を持つ事（device::standby_ram 等）@n
+				・static const uint32_t SIZE @n
+				・static void start() @n
+				・static uint32_t copy(const void* src, uint32_t len, uint32_t dst)（書き込み）@n
+				・static uint32_t copy(uint32_t src, uint32_t len, void* dst)（読み出し）
 		@param[in]	MEMIO	メモリー入出力
+		@param[in]	BUFF	putch のバッファ・サイズ
     */
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class MEMIO>
+	template <class MEMIO, uint32_t BUFF = 64>
 	class log_man {
 
-		static const uint32_t offset_ = 8;
 		static const uint32_t uniq_id_ = 0x1a3c5976;  // 初期化判定ユニークコード
 
 		struct area_t {
 			uint32_t	id_;
+			uint32_t	seq_;
 			uint16_t	pos_;
 			uint16_t	len_;
+			uint32_t	sum_;
 		};
 
+		static const uint32_t head_ = sizeof(area_t) * 2;
+		static const uint32_t limit_ = MEMIO::SIZE - head_;
+
+		static_assert(MEMIO::SIZE > head_ && limit_ <= 65535, "MEMIO::SIZE out of range");
+
 		area_t		area_;
 
+		char		buff_[BUFF];
+		uint32_t	bpos_;
+
+		static uint32_t sum_(const area_t& a) noexcept
+		{
+			uint32_t s = a.id_ ^ 0x5a5a5a5a;
+			s = (s << 5) + (s >> 27) + a.seq_;
+			s = (s << 5) + (s >> 27) + a.pos_;
+			s = (s << 5) + (s >> 27) + a.len_;
+			return s;
+		}
+
+		static bool valid_(const area_t& a) noexcept
+		{
+			return a.id_ == uniq_id_ && a.sum_ == sum_(a) && a.pos_ < limit_ && a.len_ <= limit_;
+		}
+
+		// シーケンス番号を進めて、古い方のヘッダーに書く
+		void commit_() noexcept
+		{
+			++area_.seq_;
+			area_.sum_ = sum_(area_);
+			MEMIO::copy(&area_, sizeof(area_t), (area_.seq_ & 1) * sizeof(area_t));
+		}
+
+		void write_(const char* src, uint32_t len) noexcept
+		{
+			if(len == 0) return;
+			if(len > limit_) {
+				src += len - limit_;
+				len = limit_;
+			}
+			// 記録済みのデータを上書きする場合、先にヘッダーから外す
+			if((area_.len_ + len) > limit_) {
+				area_.len_ = limit_ - len;
+				commit_();
+			}
+			uint32_t pos = area_.pos_;
+			uint32_t l = limit_ - pos;
+			if(l > len) l = len;
+			MEMIO::copy(src, l, head_ + pos);
+			if(l < len) {
+				MEMIO::copy(src + l, len - l, head_);
+			}
+			pos += len;
+			if(pos >= limit_) pos -= limit_;
+			area_.pos_ = pos;
+			area_.len_ += len;
+			commit_();
+		}
+
 	public:
         //-----------------------------------------------------------------//
         /*!
             @brief  コンストラクター
         */
         //-----------------------------------------------------------------//
-		log_man() noexcept { }
+		log_man() noexcept : area_(), bpos_(0) { }
 
 
         //-----------------------------------------------------------------//
@@ -52,7 +121,8 @@ namespace utils {
 			area_.id_ = uniq_id_;
 			area_.pos_ = 0;
 			area_.len_ = 0;
-			MEMIO::copy(&area_, sizeof(area_t), 0x0000);
+			bpos_ = 0;
+			commit_();
 		}
 
 
@@ -66,36 +136,78 @@ namespace utils {
 		bool start() noexcept
 		{
 			MEMIO::start();
-			MEMIO::copy(0x0000, sizeof(area_t), &area_);
-			if(area_.id_ == uniq_id_) {
-				return true;
+			bpos_ = 0;
+			area_t a[2];
+			MEMIO::copy(0x0000, sizeof(a), &a[0]);
+			bool va = valid_(a[0]);
+			bool vb = valid_(a[1]);
+			if(va && vb) {
+				area_ = static_cast<int32_t>(a[1].seq_ - a[0].seq_) > 0 ? a[1] : a[0];
+			} else if(va) {
+				area_ = a[0];
+			} else if(vb) {
+				area_ = a[1];
+			} else {
+				area_.seq_ = 0;
+				clear();
+				return false;
+			}
+			return true;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  バッファの書き込み
+        */
+        //-----------------------------------------------------------------//
+		void flush() noexcept
+		{
+			write_(buff_, bpos_);
+			bpos_ = 0;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  ブロック追加（すぐに書き込む）@n
+					putch で貯めた分とバッファに収まる場合、ヘッダーの更新は一回
+			@param[in]	src	ソース
+			@param[in]	len	長さ
+        */
+        //-----------------------------------------------------------------//
+		void write(const char* src, uint32_t len) noexcept
+		{
+			if(src == nullptr) return;
+
+			if(bpos_ > 0 && (bpos_ + len) <= BUFF) {  // 貯めた分と一緒に書く
+				std::memcpy(&buff_[bpos_], src, len);
+				bpos_ += len;
+				flush();
+			} else {
+				flush();
+				write_(src, len);
 			}
-			clear();
-			return false;
 		}
 
 
         //-----------------------------------------------------------------//
         /*!
-            @brief  文字追加
+            @brief  文字追加（改行か、バッファが一杯で書き込む）
 			@param[in]	ch	文字
         */
         //-----------------------------------------------------------------//
 		void putch(char ch) noexcept
 		{
-			MEMIO::put(sizeof(area_t) + area_.pos_, ch);
-			++area_.pos_;
-			uint16_t limit = MEMIO::SIZE - sizeof(area_t);
-			if(area_.pos_ >= limit) area_.pos_ = 0;
-			++area_.len_;
-			if(area_.len_ > limit) area_.len_ = limit;
-			MEMIO::copy(&area_, sizeof(area_t), 0x0000);
+			buff_[bpos_] = ch;
+			++bpos_;
+			if(ch == '\n' || bpos_ >= BUFF) flush();
 		}
 
 
         //-----------------------------------------------------------------//
         /*!
-            @brief  文字列追加
+            @brief  文字列追加（すぐに書き込む）
 			@param[in]	s	文字列
         */
         //-----------------------------------------------------------------//
@@ -103,17 +215,13 @@ namespace utils {
 		{
 			if(s == nullptr) return;
 
-			char ch;
-			while((ch = *s) != 0) {
-				putch(ch);
-				++s;
-			}
+			write(s, std::strlen(s));
 		}
 
 
         //-----------------------------------------------------------------//
         /*!
-            @brief  記録長の取得
+            @brief  記録長の取得（書き込み済みの分）
 			@return 記録長
         */
         //-----------------------------------------------------------------//
@@ -129,16 +237,39 @@ namespace utils {
         //-----------------------------------------------------------------//
 		char getch(uint16_t pos) const noexcept
 		{
-			if(area_.len_ == 0) return 0;
+			if(pos >= area_.len_) return 0;
 
-			pos += area_.pos_ - area_.len_;
-			pos %= MEMIO::SIZE - sizeof(area_t);
-			uint8_t data;
-			if(MEMIO::get(pos + sizeof(area_t), data)) {
-				return static_cast<char>(data);
-			} else {
-				return 0;
+			uint32_t p = area_.pos_ + limit_ - area_.len_ + pos;
+			if(p >= limit_) p -= limit_;
+			char ch = 0;
+			MEMIO::copy(head_ + p, 1, &ch);
+			return ch;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  ブロックの取得
+			@param[in]	pos	取得位置
+			@param[out]	dst	コピー先
+			@param[in]	len	長さ
+			@return 取得した長さ
+        */
+        //-----------------------------------------------------------------//
+		uint32_t read(uint16_t pos, char* dst, uint32_t len) const noexcept
+		{
+			if(pos >= area_.len_ || dst == nullptr) return 0;
+			if(len > static_cast<uint32_t>(area_.len_ - pos)) len = area_.len_ - pos;
+
+			uint32_t p = area_.pos_ + limit_ - area_.len_ + pos;
+			if(p >= limit_) p -= limit_;
+			uint32_t l = limit_ - p;
+			if(l > len) l = len;
+			MEMIO::copy(head_ + p, l, dst);
+			if(l < len) {
+				MEMIO::copy(head_, len - l, dst + l);
 			}
+			return len;
 		}
 	};
 }
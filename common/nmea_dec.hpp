@@ -11,9 +11,15 @@
 #include <cstdint>
 #include <cstring>
 #include "common/time.h"
+#include "common/tokenizer.hpp"
 
 namespace utils {
 
+	namespace nmea {
+		static constexpr const char* key_tbl[] = { "GPGGA", "GPRMC", "GPGSV", "GPVTG" };
+		static constexpr auto key = make_key_hash(key_tbl);
+	}
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  NMEA デコード・クラス
@@ -81,22 +87,6 @@ namespace utils {
 		uint32_t	id_;
 		uint32_t	iid_;
 
-		static uint16_t word_(const char* src)
-		{
-			const char* top = src;
-			char ch;
-			while((ch = *src++) != 0) {
-				if(ch == ',' || ch == '*') return src - top;
-			}
-			return 0;
-		}
-
-		static void copy_word_(char* dst, const char* src, uint16_t len)
-		{
-			std::strncpy(dst, src, len);
-			dst[len] = 0;
-		}
-
 		static int32_t get_dec_(const char* t, uint16_t n = 0)
 		{
 			int32_t val = 0;
@@ -120,51 +110,34 @@ namespace utils {
 		{
 			if(line_[0] != '$') return false;
 
-			if(std::strncmp(&line_[1], "GPGGA,", 6) == 0) {
-				const char* p = &line_[7];
-				uint16_t n = 0;
-				uint16_t l;
-				while((l = word_(p)) != 0) {
-					if(n == 0) copy_word_(time_, p, l - 1);
-					else if(n == 1) copy_word_(lat_, p, l - 1);
-					else if(n == 2) copy_word_(ns_, p, l - 1);
-					else if(n == 3) copy_word_(lon_, p, l - 1);
-					else if(n == 4) copy_word_(ew_, p, l - 1);
-					else if(n == 5) copy_word_(q_, p, l - 1);
-					else if(n == 6) copy_word_(satellite_, p, l - 1);
-					else if(n == 7) copy_word_(hq_, p, l - 1);
-					else if(n == 8) copy_word_(alt_, p, l - 1);
-					else if(n == 9) copy_word_(alt_unit_, p, l - 1);
-					else {
-						break;
-					}
-					p += l;
-					++n;
-				}
-			} else if(std::strncmp(&line_[1], "GPRMC,", 6) == 0) {
-				const char* p = &line_[7];
-				uint16_t n = 0;
-				uint16_t l;
-				while((l = word_(p)) != 0) {
-					if(n == 8) copy_word_(date_, p, l - 1);
-					p += l;
-					++n;
-				}
-			} else if(std::strncmp(&line_[1], "GPGSV,", 6) == 0) {
-				const char* p = &line_[7];
-				uint16_t n = 0;
-				uint16_t l;
-				while((l = word_(p)) != 0) {
-					if(n == 0) ;
-					else if(n == 1) ;
-// std::strncpy(date_, p, l - 1);
-					p += l;
-					++n;
+			tokenizer<16> tok;
+			auto n = tok.fields(&line_[1], ',', '*');
+			switch(nmea::key.find(tok[0])) {
+			case 0:  // GPGGA
+				if(n > 10) {
+					tok[1].copy(time_, sizeof(time_));
+					tok[2].copy(lat_, sizeof(lat_));
+					tok[3].copy(ns_, sizeof(ns_));
+					tok[4].copy(lon_, sizeof(lon_));
+					tok[5].copy(ew_, sizeof(ew_));
+					tok[6].copy(q_, sizeof(q_));
+					tok[7].copy(satellite_, sizeof(satellite_));
+					tok[8].copy(hq_, sizeof(hq_));
+					tok[9].copy(alt_, sizeof(alt_));
+					tok[10].copy(alt_unit_, sizeof(alt_unit_));
 				}
+				break;
+			case 1:  // GPRMC
+				if(n > 9) tok[9].copy(date_, sizeof(date_));
+				break;
+			case 2:  // GPGSV
 				++iid_;
-			} else if(std::strncmp(&line_[1], "GPVTG,", 6) == 0) {
+				break;
+			case 3:  // GPVTG
 				++id_;
 				return true;
+			default:
+				break;
 			}
 			return false;
 		}
@@ -357,7 +330,7 @@ namespace utils {
 					pos_ = 0;
 				} else {
 					if(ch >= ' ' && ch <= 0x7f) {
-						if(pos_ < sizeof(line_)) {
+						if(pos_ < (sizeof(line_) - 1)) {
 							line_[pos_] = ch;
 							++pos_;
 						}
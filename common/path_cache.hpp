@@ -0,0 +1,164 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	パス解決キャッシュ・クラス @n
+			フル・パスをキーに、ファイル・エントリー（サイズ、タイム・スタンプ、@n
+			属性、存在の有無）を LRU で保持する。@n
+			探索は６４ビットのハッシュ（FNV-1a、djb2 を連結）で絞り、保存した @n
+			パスと比較するので、ハッシュが衝突しても別のファイルの情報は返さない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "ff12b/src/ff.h"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  パス解決キャッシュ・テンプレート
+		@param[in]	NUM			エントリー数
+		@param[in]	PATH_LEN	パスの最大長（終端を含む、これより長いパスは保持しない）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t NUM = 16, uint32_t PATH_LEN = 64>
+	class path_cache {
+
+		struct file_t {
+			uint64_t	hash_;
+			uint32_t	size_;
+			uint32_t	tick_;
+			uint16_t	fdate_;
+			uint16_t	ftime_;
+			uint8_t		attr_;
+			bool		exist_;
+			bool		valid_;
+			char		path_[PATH_LEN];
+		};
+
+		file_t		file_[NUM];
+		uint32_t	tick_;
+
+		file_t* find_(const char* path, uint64_t hash) noexcept
+		{
+			for(uint32_t i = 0; i < NUM; ++i) {
+				file_t& t = file_[i];
+				if(t.valid_ && t.hash_ == hash && std::strcmp(t.path_, path) == 0) return &t;
+			}
+			return nullptr;
+		}
+
+		file_t* lru_() noexcept
+		{
+			file_t* p = &file_[0];
+			for(uint32_t i = 0; i < NUM; ++i) {
+				if(!file_[i].valid_) return &file_[i];
+				if(file_[i].tick_ < p->tick_) p = &file_[i];
+			}
+			return p;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	パスのハッシュ（上位 FNV-1a、下位 djb2）
+			@param[in]	path	パス
+			@param[out]	len		パスの長さ
+			@return ハッシュ値
+		 */
+		//-----------------------------------------------------------------//
+		static uint64_t hash(const char* path, uint32_t& len) noexcept
+		{
+			uint32_t h = 2166136261;
+			uint32_t d = 5381;
+			const char* p = path;
+			char ch;
+			while((ch = *p++) != 0) {
+				h ^= static_cast<uint8_t>(ch);
+				h *= 16777619;
+				d = d * 33 + static_cast<uint8_t>(ch);
+			}
+			len = p - path - 1;
+			return (static_cast<uint64_t>(h) << 32) | d;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		path_cache() noexcept : file_{ }, tick_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全エントリーの無効化（書き込み、削除、名前変更、マウント変化時）
+		 */
+		//-----------------------------------------------------------------//
+		void invalidate() noexcept
+		{
+			for(uint32_t i = 0; i < NUM; ++i) file_[i].valid_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル・エントリーの取得
+			@param[in]	path	フル・パス
+			@param[out]	fi		ファイル情報（fname は設定されない）
+			@param[out]	exist	ファイルが存在する場合「true」
+			@return キャッシュにあれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(const char* path, FILINFO& fi, bool& exist) noexcept
+		{
+			uint32_t len;
+			uint64_t h = hash(path, len);
+			if(len >= PATH_LEN) return false;
+			file_t* t = find_(path, h);
+			if(t == nullptr) return false;
+
+			t->tick_ = ++tick_;
+			exist = t->exist_;
+			fi.fsize   = t->size_;
+			fi.fdate   = t->fdate_;
+			fi.ftime   = t->ftime_;
+			fi.fattrib = t->attr_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル・エントリーの登録
+			@param[in]	path	フル・パス
+			@param[in]	fi		ファイル情報（存在しない場合「nullptr」）
+		 */
+		//-----------------------------------------------------------------//
+		void set(const char* path, const FILINFO* fi) noexcept
+		{
+			uint32_t len;
+			uint64_t h = hash(path, len);
+			if(len >= PATH_LEN) return;
+			file_t* t = find_(path, h);
+			if(t == nullptr) t = lru_();
+
+			t->hash_  = h;
+			t->tick_  = ++tick_;
+			t->valid_ = true;
+			t->exist_ = fi != nullptr;
+			std::memcpy(t->path_, path, len + 1);
+			if(fi != nullptr) {
+				t->size_  = fi->fsize;
+				t->fdate_ = fi->fdate;
+				t->ftime_ = fi->ftime;
+				t->attr_  = fi->fattrib;
+			}
+		}
+	};
+}
@@ -76,6 +76,7 @@
 #include "RX600/port_map.hpp"
 #include "RX600/power_cfg.hpp"
 #include "RX600/icu_mgr.hpp"
+#include "RX600/dtc_mgr.hpp"
 #include "RX600/s12adc.hpp"
 #include "RX600/adc_io.hpp"
 #include "RX600/r12da.hpp"
@@ -113,6 +114,7 @@
 #include "RX600/port_map.hpp"
 #include "RX600/power_cfg.hpp"
 #include "RX600/icu_mgr.hpp"
+#include "RX600/dtc_mgr.hpp"
 #include "RX600/s12adc.hpp"
 #include "RX600/adc_io.hpp"
 #include "RX600/r12da.hpp"
@@ -151,6 +153,7 @@
 #include "RX600/port_map.hpp"
 #include "RX600/power_cfg.hpp"
 #include "RX600/icu_mgr.hpp"
+#include "RX600/dtc_mgr.hpp"
 #include "RX600/s12adc.hpp"
 #include "RX600/adc_io.hpp"
 #include "RX600/r12da.hpp"
@@ -8,6 +8,7 @@
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstring>
 #include "common/renesas.hpp"
 #include "common/vect.h"
 
@@ -20,10 +21,14 @@ namespace device {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  SCI I/O 制御クラス
+		@brief  SCI I/O 制御クラス @n
+				RX64M/RX71M では、送信を DTC で行える（連続領域毎に転送し、@n
+				CPU への割り込みはブロック毎）@n
+				受信も DTC で受信バッファに直接転送できる（CPU への割り込みは @n
+				バッファ一周毎、受信の途切れはタイマーから recv_service で検出）
 		@param[in]	SCI	SCI 定義クラス
-		@param[in]	RECV_BUFF	受信バッファクラス
-		@param[in]	SEND_BUFF	送信バッファクラス
+		@param[in]	RECV_BUFF	受信バッファクラス（utils::fifo）
+		@param[in]	SEND_BUFF	送信バッファクラス（utils::fifo）
 		@param[in]	PSEL		ポート選択
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -35,14 +40,128 @@ namespace device {
 		static SEND_BUFF send_;
 		static volatile bool send_stall_;
 
-		uint8_t	level_;
-		bool	crlf_;
+		static void (*recv_notify_)();
+		static volatile uint32_t recv_mark_;
+		static volatile bool recv_act_;
+		static volatile bool recv_idle_;
+
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+		typedef dtc_mgr<DTC> DTC_MGR;
+		static typename DTC_MGR::info_t send_info_;
+		static volatile uint32_t send_dtc_len_;
+		static bool send_dtc_;
+
+		// 送信バッファの連続領域を DTC に渡す
+		static bool send_dtc_start_()
+		{
+			uint32_t n;
+			const auto* p = send_.get_region(n);
+			if(n == 0) return false;
+			if(n > 65536) n = 65536;
+			send_dtc_len_ = n;
+			DTC_MGR::set_normal(send_info_, DTC_MGR::MRA_SM_INC, 0,
+				reinterpret_cast<uintptr_t>(p), SCI::TDR.address(), n);
+			DTC_MGR::enable(SCI::get_tx_vec(), send_info_);
+			return true;
+		}
+
+		static typename DTC_MGR::info_t recv_info_;
+		static uint32_t recv_base_;
+		static bool recv_dtc_;
+		static volatile uint32_t recv_lap_;	// DTC がバッファを一周した回数
+		static uint32_t recv_sync_lap_;		// 格納位置に反映した周回数
+
+		// 受信バッファの先頭から一周分を DTC に渡す
+		static void recv_dtc_start_()
+		{
+			DTC_MGR::set_normal(recv_info_, DTC_MGR::MRA_SZ_8, DTC_MGR::MRB_DM_INC,
+				SCI::RDR.address(), recv_base_, recv_.size());
+			DTC_MGR::enable(SCI::get_rx_vec(), recv_info_);
+		}
+
+		// DTC の転送位置（一周の終端では「サイズ」）
+		static uint32_t recv_dtc_raw_()
+		{
+			return reinterpret_cast<const volatile uint32_t&>(recv_info_.dar) - recv_base_;
+		}
+
+		// DTC の転送位置
+		static uint32_t recv_dtc_pos_()
+		{
+			uint32_t pos = recv_dtc_raw_();
+			if(pos >= recv_.size()) pos -= recv_.size();
+			return pos;
+		}
+#endif
+
+		// 受信位置（DTC の場合は転送先アドレスから）
+		static uint32_t recv_pos_()
+		{
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			if(recv_dtc_) return recv_dtc_pos_();
+#endif
+			return recv_.pos_put();
+		}
+
+		// DTC が受信したデータを受信バッファに反映（読み出し側から呼ぶ）
+		// DTC が読み出し位置を追い越した場合（オーバーラン）は、未読のデータを
+		// 捨てて、取得位置と格納位置を DTC の転送位置に合わせる
+		void recv_sync_()
+		{
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			if(!recv_dtc_) return;
+			if(SCI::SSR.ORER()) {  // DTC の転送が間に合わなかった
+				SCI::SSR.ORER = 0;
+				++recv_overrun_;
+			}
+			// 一周の割り込みと競合しない様に、周回数と転送位置を読む
+			uint32_t lap;
+			uint32_t pos;
+			do {
+				lap = recv_lap_;
+				pos = recv_dtc_raw_();
+			} while(lap != recv_lap_);
+			if(pos >= recv_.size()) {  // 終端に達し、割り込みの前
+				pos -= recv_.size();
+				++lap;
+			}
+			uint32_t put = recv_.pos_put();
+			uint32_t n = pos >= put ? pos - put : recv_.size() + pos - put;
+			uint32_t laps = lap - recv_sync_lap_;
+			recv_sync_lap_ = lap;
+			// 前回から DTC が書いた数は「laps * サイズ + pos - put」
+			bool over = laps > 1 || (laps == 1 && pos >= put)
+				|| recv_.length() + n >= recv_.size();
+			if(over) {
+				++recv_overrun_;
+				recv_.put_go(n);
+				recv_.get_go(recv_.length());
+			} else if(n > 0) {
+				recv_.put_go(n);
+			}
+#endif
+		}
+
+		uint8_t		level_;
+		bool		crlf_;
+		bool		send_block_;
+		uint32_t	send_drop_;
+		uint32_t	recv_overrun_;
 
 		// ※必要なら、実装する
 		void sleep_() { asm("nop"); }
 
 		static INTERRUPT_FUNC void recv_task_()
 		{
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			if(recv_dtc_) {
+				// バッファの終端まで転送した（RDR は DTC が読んでいる）
+				recv_dtc_start_();
+				++recv_lap_;
+				if(recv_notify_ != nullptr) (*recv_notify_)();
+				return;
+			}
+#endif
 			bool err = false;
 			if(SCI::SSR.ORER()) {	///< 受信オーバランエラー状態確認
 				SCI::SSR.ORER = 0;	///< 受信オーバランエラークリア
@@ -64,6 +183,16 @@ namespace device {
 		static INTERRUPT_FUNC void send_task_()
 		{
 #if defined(SIG_RX64M) || defined(SIG_RX71M)
+			if(send_dtc_) {
+				// ブロックの最後のデータは TDR にあり、次の TXI で DTC が起動する
+				send_.get_go(send_dtc_len_);
+				send_dtc_len_ = 0;
+				if(!send_dtc_start_()) {
+					SCI::SCR.TIE = 0;
+					send_stall_ = true;
+				}
+				return;
+			}
 			if(send_.length() > 0) {
 				SCI::TDR = send_.get();
 			}
@@ -98,6 +227,64 @@ namespace device {
 			icu_mgr::set_level(SCI::get_peripheral(), level_);
 		}
 
+		// 送信割り込みの起動
+		void send_kick_()
+		{
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			SCI::SCR.TIE = 0;
+			if(send_stall_) {
+				while(SCI::SSR.TEND() == 0) sleep_();
+				SCI::TDR = send_.get();
+				if(send_dtc_) {
+					if(send_dtc_start_()) {
+						send_stall_ = false;
+					}
+				} else if(send_.length() > 0) {
+					send_stall_ = false;
+				}
+			}
+			SCI::SCR.TIE = !send_stall_;
+#else
+			if(SCI::SCR.TEIE() == 0) {
+				SCI::SCR.TEIE = 1;
+			}
+#endif
+		}
+
+		// 送信バッファへの格納（空きが出来た分だけ待つ）
+		uint32_t put_(const char* src, uint32_t len)
+		{
+			if(level_ == 0) {
+				for(uint32_t i = 0; i < len; ++i) {
+					while(SCI::SSR.TEND() == 0) sleep_();
+					SCI::TDR = src[i];
+				}
+				return len;
+			}
+
+			volatile bool b = SCI::SSR.ORER();
+			if(b) {
+				SCI::SSR.ORER = 0;
+			}
+			uint32_t all = 0;
+			while(len > 0) {
+				if(send_.space() == 0) {
+					if(!send_block_) {
+						send_drop_ += len;
+						break;
+					}
+					sleep_();
+					continue;
+				}
+				uint32_t n = send_.put(src, len);
+				src += n;
+				len -= n;
+				all += n;
+				send_kick_();
+			}
+			return all;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -105,7 +292,8 @@ namespace device {
 			@param[in]	crlf	LF 時、CR の送出をしないばあい「false」
 		*/
 		//-----------------------------------------------------------------//
-		sci_io(bool crlf = true) : level_(0), crlf_(crlf) { }
+		sci_io(bool crlf = true) : level_(0), crlf_(crlf), send_block_(true), send_drop_(0),
+			recv_overrun_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -114,11 +302,28 @@ namespace device {
 					※RX63T では、ポーリングはサポート外
 			@param[in]	baud	ボーレート
 			@param[in]	level	割り込みレベル（０の場合ポーリング）
+			@param[in]	send_dtc	送信に DTC を使う場合「true」（RX64M/RX71M）
+			@param[in]	recv_dtc	受信に DTC を使う場合「true」（RX64M/RX71M）
 			@return エラーなら「false」
 		*/
 		//-----------------------------------------------------------------//
-		bool start(uint32_t baud, uint8_t level = 0) {
+		bool start(uint32_t baud, uint8_t level = 0, bool send_dtc = false, bool recv_dtc = false) {
 			send_stall_ = true;
+			recv_act_ = false;
+			recv_idle_ = false;
+			recv_.clear();
+			recv_mark_ = 0;
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			send_dtc_ = send_dtc && level != 0;
+			send_dtc_len_ = 0;
+			recv_dtc_ = recv_dtc && level != 0;
+			recv_base_ = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&recv_.put_at()));
+			recv_lap_ = 0;
+			recv_sync_lap_ = 0;
+			if(send_dtc_ || recv_dtc_) {
+				DTC_MGR::start();
+			}
+#endif
 #if SIG_RX63T
 			if(level == 0) return false;
 #endif
@@ -141,6 +346,11 @@ namespace device {
 			power_cfg::turn(SCI::get_peripheral());
 
 			set_intr_();
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			if(recv_dtc_) {
+				recv_dtc_start_();
+			}
+#endif
 
 			// 8 bits, 1 stop bit, no-parrity
 			SCI::SMR = cks;
@@ -170,6 +380,10 @@ namespace device {
 		bool start_spi(bool master, uint32_t bps, uint8_t level = 0)
 		{
 			send_stall_ = true;
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+			send_dtc_ = false;
+			recv_dtc_ = false;
+#endif
 			level_ = level;
 
 			SCI::SCR = 0x00;			// TE, RE disable.
@@ -235,6 +449,78 @@ brr = 1;
 		void auto_crlf(bool f = true) { crlf_ = f; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信バッファに空きが無い場合の動作
+			@param[in]	f	「false」なら待たずに捨てる（捨てた数を数える）
+		 */
+		//-----------------------------------------------------------------//
+		void set_send_block(bool f = true) { send_block_ = f; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信で捨てたデータ数を取得
+			@return 捨てたデータ数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_send_drop() const { return send_drop_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信のオーバーラン回数を取得 @n
+					DTC 受信で、読み出しが間に合わずに未読のデータを捨てた回数 @n
+					（SCI のオーバーランエラーを含む）
+			@return オーバーラン回数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_recv_overrun() const { return recv_overrun_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信通知関数を設定 @n
+					DTC 受信でバッファが一周した時（割り込み）と、@n
+					recv_service で受信の途切れを検出した時に呼ばれる
+			@param[in]	func	通知関数（「nullptr」なら通知しない）
+		 */
+		//-----------------------------------------------------------------//
+		void set_recv_notify(void (*func)()) { recv_notify_ = func; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信の途切れ検出サービス @n
+					タイマー割り込み等から周期的に呼ぶ（周期が途切れの判定時間になる）
+		 */
+		//-----------------------------------------------------------------//
+		void recv_service() {
+			uint32_t pos = recv_pos_();
+			if(pos != recv_mark_) {
+				recv_mark_ = pos;
+				recv_act_ = true;
+			} else if(recv_act_) {
+				recv_act_ = false;
+				recv_idle_ = true;
+				if(recv_notify_ != nullptr) (*recv_notify_)();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信の途切れを取得（取得するとクリア）
+			@return 受信後に途切れた場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get_recv_idle() {
+			bool f = recv_idle_;
+			if(f) recv_idle_ = false;
+			return f;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	SCI 出力バッファのサイズを返す
@@ -258,38 +544,39 @@ brr = 1;
 		//-----------------------------------------------------------------//
 		void putch(char ch) {
 			if(crlf_ && ch == '\n') {
-				putch('\r');
+				put_("\r\n", 2);
+			} else {
+				put_(&ch, 1);
 			}
+		}
 
-			if(level_) {
-				volatile bool b = SCI::SSR.ORER();
-				if(b) {
-					SCI::SSR.ORER = 0;
-				}
-				/// 送信バッファの容量が７／８の場合は、空になるまで待つ。
-				if(send_.length() >= (send_.size() * 7 / 8)) {
-					while(send_.length() != 0) sleep_();
-				}
-				send_.put(ch);
-#if defined(SIG_RX64M) || defined(SIG_RX71M)
-				SCI::SCR.TIE = 0;
-				if(send_stall_) {
-					while(SCI::SSR.TEND() == 0) sleep_();
-					SCI::TDR = send_.get();
-					if(send_.length() > 0) {
-						send_stall_ = false;
-					}
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	SCI 一括出力（CR 自動送出は putch と同じ）
+			@param[in]	src	ソース
+			@param[in]	len	長さ
+			@return 送信バッファに格納した数（捨てた分は含まない）
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t write(const void* src, uint32_t len) {
+			const char* p = static_cast<const char*>(src);
+			const char* end = p + len;
+			uint32_t n = 0;
+			while(p < end) {
+				const char* q = end;
+				if(crlf_) {
+					q = static_cast<const char*>(std::memchr(p, '\n', end - p));
+					if(q == nullptr) q = end;
 				}
-				SCI::SCR.TIE = !send_stall_;
-#else
-				if(SCI::SCR.TEIE() == 0) {
-					SCI::SCR.TEIE = 1;
+				n += put_(p, q - p);
+				if(q < end) {
+					if(put_("\r\n", 2) == 2) ++n;
+					++q;
 				}
-#endif
-			} else {
-				while(SCI::SSR.TEND() == 0) sleep_();
-				SCI::TDR = ch;
+				p = q;
 			}
+			return n;
 		}
 
 
@@ -301,6 +588,7 @@ brr = 1;
 		//-----------------------------------------------------------------//
 		uint32_t recv_length() {
 			if(level_) {
+				recv_sync_();
 				return recv_.length();
 			} else {
 				if(SCI::SSR.ORER()) {	///< 受信オーバランエラー状態確認
@@ -324,7 +612,7 @@ brr = 1;
 		//-----------------------------------------------------------------//
 		char getch() {
 			if(level_) {
-				while(recv_.length() == 0) sleep_();
+				while(recv_length() == 0) sleep_();
 				return recv_.get();
 			} else {
 				char ch;
@@ -342,10 +630,7 @@ brr = 1;
 		 */
 		//-----------------------------------------------------------------//
 		void puts(const char* s) {
-			char ch;
-			while((ch = *s++) != 0) {
-				putch(ch);
-			}
+			write(s, std::strlen(s));
 		}
 
 
@@ -388,19 +673,26 @@ brr = 1;
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  シリアル受信
+			@brief  シリアル受信 @n
+					割り込み時は、受信バッファから一括で取得する（待たない）
 			@param[out]	dst	受信先
-			@param[in]	cnt	受信サイズ
+			@param[in]	size	受信サイズ
+			@return 受信した数
 		*/
 		//-----------------------------------------------------------------//
-		void recv(void* dst, uint16_t size)
+		uint32_t recv(void* dst, uint32_t size)
 		{
+			if(level_) {
+				recv_sync_();
+				return recv_.get(static_cast<char*>(dst), size);
+			}
 			uint8_t* p = static_cast<uint8_t*>(dst);
 			auto end = p + size;
 			while(p < end) {
 				*p = xchg();
 				++p;
 			}
+			return size;
 		}
 	};
 
@@ -410,4 +702,32 @@ brr = 1;
 		SEND_BUFF sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::send_;
 	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
 		volatile bool sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::send_stall_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		void (*sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_notify_)() = nullptr;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		volatile uint32_t sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_mark_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		volatile bool sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_act_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		volatile bool sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_idle_;
+#if defined(SIG_RX64M) || defined(SIG_RX71M)
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		typename sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::DTC_MGR::info_t
+			sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::send_info_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		volatile uint32_t sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::send_dtc_len_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		bool sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::send_dtc_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		typename sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::DTC_MGR::info_t
+			sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_info_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		uint32_t sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_base_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		bool sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_dtc_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		volatile uint32_t sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_lap_;
+	template<class SCI, class RECV_BUFF, class SEND_BUFF, port_map::option PSEL>
+		uint32_t sci_io<SCI, RECV_BUFF, SEND_BUFF, PSEL>::recv_sync_lap_;
+#endif
 }
@@ -12,8 +12,16 @@
 #include "common/renesas.hpp"
 #include "common/format.hpp"
 #include "common/string_utils.hpp"
+#include "common/sdc_stream.hpp"
+#include "common/sdc_map.hpp"
+#include "common/dir_cache.hpp"
+#include "common/path_cache.hpp"
 #include "ff12b/mmc_io.hpp"
 
+extern "C" {
+	extern volatile uint32_t fs_modify_count;	///< syscalls.c の変更カウンター
+}
+
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -43,6 +51,8 @@ namespace utils {
 		typedef void (*dir_loop_func)(const char* name, const FILINFO* fi, bool dir, void* option);
 
 	private:
+		typedef path_cache<16, 64> path_cache_type;
+
 		FATFS	fatfs_;  ///< FatFS コンテキスト
 
 		SPI&	spi_;
@@ -161,6 +171,59 @@ namespace utils {
 		}
 
 
+		void drop_cache_() const noexcept
+		{
+			dir_cache_.invalidate();
+			path_cache_.invalidate();
+		}
+
+
+		// sdc_io 経由の変更：キャッシュを捨て、変更カウンターを進める
+		void invalidate_() const noexcept
+		{
+			drop_cache_();
+			modify_count_ = ++fs_modify_count;
+		}
+
+
+		// sdc_io を経由しない変更（fopen、remove 等）があれば、キャッシュを捨てる
+		void sync_cache_() const noexcept
+		{
+			uint32_t n = fs_modify_count;
+			if(modify_count_ != n) {
+				modify_count_ = n;
+				drop_cache_();
+			}
+		}
+
+
+		// ファイル情報の取得（キャッシュ付き f_stat）
+		// リストしたディレクトリーのファイルは、ディレクトリー・キャッシュから
+		bool stat_(const char* path, FILINFO& fno) const noexcept
+		{
+			char full[_MAX_LFN + 1];
+			create_fatfs_path_(path, full, sizeof(full));
+
+			sync_cache_();
+			bool exist;
+			if(path_cache_.get(full, fno, exist)) return exist;
+
+			int32_t idx = -1;
+			const char* name = std::strrchr(full, '/');
+			if(name != nullptr && dir_cache_.probe(full, name - full)) {
+				idx = dir_cache_.find(name + 1);
+			}
+			bool ret;
+			if(idx >= 0) {
+				ret = dir_cache_.get(idx, fno);
+			} else {  // 見つからない場合も、大文字、小文字の違い等があるので f_stat
+				ret = f_stat(full, &fno) == FR_OK;
+			}
+			path_cache_.set(full, ret ? &fno : nullptr);
+			return ret;
+		}
+
+
 #if 0
 		bool check_dir_(const char* path) const noexcept
 		{
@@ -213,17 +276,48 @@ namespace utils {
 			uint32_t	limit_;
 			char*		ptr_;
 
+			dir_cache*	cache_;
+			uint32_t	gen_;
+			uint32_t	idx_;
+			uint32_t	root_len_;
+
 			bool		init_;
+			bool		from_cache_;
 
 			char full_[_MAX_LFN + 1];
 
+			// キャッシュからのリスト中にキャッシュが無効になったら、カードから読む @n
+			// 返した数のエントリーを読み飛ばし（キャッシュに登録し直す）、続きから
+			bool fallback_()
+			{
+				char back = full_[root_len_];
+				full_[root_len_] = 0;
+				auto st = f_opendir(&dir_, full_);
+				if(st == FR_OK) gen_ = cache_->begin(full_);
+				full_[root_len_] = back;
+				if(st != FR_OK) return false;
+
+				from_cache_ = false;
+				for(uint32_t i = 0; i < idx_; ++i) {
+					FILINFO fi;
+					if(f_readdir(&dir_, &fi) != FR_OK) {
+						f_closedir(&dir_);
+						return false;
+					}
+					if(!fi.fname[0]) break;  // 減った場合、次の f_readdir で終了
+					cache_->add(gen_, fi);
+				}
+				return true;
+			}
+
 		public:
 			//-----------------------------------------------------------------//
 			/*!
 				@brief	コンストラクター
 			 */
 			//-----------------------------------------------------------------//
-			dir_list() : total_(0), limit_(10), ptr_(nullptr), init_(false) { }
+			dir_list() : total_(0), limit_(10), ptr_(nullptr),
+				cache_(nullptr), gen_(0), idx_(0), root_len_(0), init_(false), from_cache_(false) { }
 
 
 			//-----------------------------------------------------------------//
@@ -247,22 +341,40 @@ namespace utils {
 			//-----------------------------------------------------------------//
 			/*!
 				@brief	ディレクトリーリスト開始 @n
-						※「probe()」関数が「false」になるまで「service()」を呼ぶ
+						※「probe()」関数が「false」になるまで「service()」を呼ぶ @n
+						※キャッシュにある場合はカードを読まず、無い場合は読みながら登録する
 				@param[in]	root	ルート・パス
+				@param[in]	cache	ディレクトリー・キャッシュ（無い場合「nullptr」）
 				@return エラー無ければ「true」
 			 */
 			//-----------------------------------------------------------------//
-			bool start(const char* root)
+			bool start(const char* root, dir_cache* cache = nullptr)
 			{
 				total_ = 0;
 
 				std::strncpy(full_, root, sizeof(full_));
 
-				auto st = f_opendir(&dir_, full_);
-				if(st != FR_OK) {
-					return false;
+				cache_ = nullptr;
+				from_cache_ = false;
+				if(cache != nullptr && cache->enable()) {
+					cache_ = cache;
+					from_cache_ = cache_->probe(full_);
+				}
+
+				if(from_cache_) {
+					gen_ = cache_->get_gen();
+					idx_ = 0;
+				} else {
+					auto st = f_opendir(&dir_, full_);
+					if(st != FR_OK) {
+						return false;
+					}
+					if(cache_ != nullptr) {
+						gen_ = cache_->begin(full_);
+					}
 				}
 
+				root_len_ = std::strlen(full_);
 				std::strcat(full_, "/");
 				ptr_ = &full_[std::strlen(full_)];
 				init_ = true;
@@ -287,15 +399,32 @@ namespace utils {
 
 				for(uint32_t i = 0; i < num; ++i) {
 					FILINFO fi;
-					// Read a directory item
-					if(f_readdir(&dir_, &fi) != FR_OK) {
-						init_ = false;
-						return false;
+					if(from_cache_ && cache_->get_gen() != gen_) {  // 途中でキャッシュが無効
+						if(!fallback_()) {
+							init_ = false;
+							return false;
+						}
 					}
-					if(!fi.fname[0]) {
-						f_closedir(&dir_);
-						init_ = false;
-						break;
+					if(from_cache_) {
+						if(!cache_->get(idx_, fi)) {
+							init_ = false;
+							break;
+						}
+						++idx_;
+					} else {
+						// Read a directory item
+						if(f_readdir(&dir_, &fi) != FR_OK) {
+							f_closedir(&dir_);
+							init_ = false;
+							return false;
+						}
+						if(!fi.fname[0]) {
+							f_closedir(&dir_);
+							if(cache_ != nullptr) cache_->end(gen_);
+							init_ = false;
+							break;
+						}
+						if(cache_ != nullptr) cache_->add(gen_, fi);
 					}
 
 					if(func != nullptr) {
@@ -320,6 +449,9 @@ namespace utils {
 
 
 		dir_list	dir_list_;
+		mutable dir_cache	dir_cache_;
+		mutable path_cache_type	path_cache_;
+		mutable uint32_t	modify_count_;
 
 		dir_loop_func	dir_func_;
 		bool			dir_todir_;
@@ -335,7 +467,7 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		sdc_io(SPI& spi, uint32_t limitc) : spi_(spi), mmc_(spi_, limitc),
 			mount_delay_(0), select_wait_(0), cd_(false), mount_(false),
-			dir_list_limit_(10),
+			dir_list_limit_(10), modify_count_(0),
 			dir_func_(nullptr), dir_todir_(false), dir_option_(nullptr) { }
 
 
@@ -388,11 +520,8 @@ namespace utils {
 			if(!mount_) return false;
 			if(path == nullptr) return false;
 
-			char full[_MAX_LFN + 1];
-			create_fatfs_path_(path, full, sizeof(full));
-
 			FILINFO fno;
-			return f_stat(full, &fno) == FR_OK;
+			return stat_(path, fno);
 		}
 
 
@@ -411,6 +540,7 @@ namespace utils {
 			char full[_MAX_LFN + 1];
 			create_full_path_(path, full, sizeof(full));
 
+			invalidate_();
 			if(!build_dir_path_(full)) {
 				return false;
 			}
@@ -435,10 +565,72 @@ namespace utils {
 			char full[_MAX_LFN + 1];
 			create_fatfs_path_(path, full, sizeof(full));
 
-			if(f_open(fp, full, mode) != FR_OK) {
-				return false;
+			if(mode & (FA_WRITE | FA_CREATE_NEW | FA_CREATE_ALWAYS | FA_OPEN_ALWAYS)) {
+				invalidate_();
 			}
-			return true;
+			auto ret = f_open(fp, full, mode);
+			return ret == FR_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	連続領域を事前確保したストリーム・ファイルのオープン @n
+					※ログ・ファイル等、追記のみで大きくなるファイル向け
+			@param[in]	st		ストリーム（utils::sdc_stream）
+			@param[in]	path	ファイル名
+			@param[in]	alloc	事前確保サイズ（バイト）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		template <class STREAM>
+		bool open_stream(STREAM& st, const char* path, uint32_t alloc) const noexcept
+		{
+			if(!mount_) return false;
+			if(path == nullptr) return false;
+
+			char full[_MAX_LFN + 1];
+			create_fatfs_path_(path, full, sizeof(full));
+
+			invalidate_();
+			return st.open(full, alloc);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリーム・ファイルのクローズ
+			@param[in]	st		ストリーム（utils::sdc_stream）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		template <class STREAM>
+		bool close_stream(STREAM& st) noexcept
+		{
+			invalidate_();
+			return st.close();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	マップド・ファイル（高速シーク）のオープン @n
+					※フォント、MP3、HTTP Range 等、ランダム・アクセスするファイル向け
+			@param[in]	map		マップド・ファイル（utils::sdc_map）
+			@param[in]	path	ファイル名
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		template <class MAP>
+		bool open_map(MAP& map, const char* path) const noexcept
+		{
+			if(!mount_) return false;
+			if(path == nullptr) return false;
+
+			char full[_MAX_LFN + 1];
+			create_fatfs_path_(path, full, sizeof(full));
+
+			return map.open(full);
 		}
 
 
@@ -454,6 +646,9 @@ namespace utils {
 			if(!mount_) return false;
 			if(fp == nullptr) return false;
 
+			if(fp->flag & FA_WRITE) {  // サイズ、タイム・スタンプが変化する
+				invalidate_();
+			}
 			return f_close(fp) == FR_OK;
 		}
 
@@ -471,11 +666,8 @@ namespace utils {
 			if(!mount_) return false;
 			if(path == nullptr) return false;
 
-			char full[_MAX_LFN + 1];
-			create_fatfs_path_(path, full, sizeof(full));
-
 			FILINFO fno;
-			if(f_stat(full, &fno) != FR_OK) {
+			if(!stat_(path, fno)) {
 				return 0;
 			}
 
@@ -495,11 +687,8 @@ namespace utils {
 			if(!mount_) return 0;
 			if(path == nullptr) return 0;
 
-			char full[_MAX_LFN + 1];
-			create_fatfs_path_(path, full, sizeof(full));
-
 			FILINFO fno;
-			if(f_stat(full, &fno) != FR_OK) {
+			if(!stat_(path, fno)) {
 				return 0;
 			}
 
@@ -522,7 +711,9 @@ namespace utils {
 			char full[_MAX_LFN + 1];
 			create_fatfs_path_(path, full, sizeof(full));
 
-			return f_unlink(full) == FR_OK;
+			auto ret = f_unlink(full);
+			invalidate_();
+			return ret == FR_OK;
 		}
 
 
@@ -544,6 +735,7 @@ namespace utils {
 			char new_full[_MAX_LFN + 1];
 			create_fatfs_path_(new_path, new_full, sizeof(new_full));
 
+			invalidate_();
 			return f_rename(org_full, new_full) == FR_OK;
 		}
 
@@ -563,6 +755,7 @@ namespace utils {
 			char full[_MAX_LFN + 1];
 			create_fatfs_path_(path, full, sizeof(full));
 
+			invalidate_();
 			return f_mkdir(full) == FR_OK;
 		}
 
@@ -674,7 +867,73 @@ namespace utils {
 #if _USE_LFN != 0
 			str::utf8_to_sjis(full, full, sizeof(full));
 #endif
-			return dir_list_.start(full);
+			sync_cache_();
+			return dir_list_.start(full, &dir_cache_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー・キャッシュの設定 @n
+					一度リストしたディレクトリーをメモリーに保持し、@n
+					再リスト、ファイル名検索でカードを読まない。@n
+					※RX64M では SDRAM 領域を与える事もできる
+			@param[in]	mem		キャッシュ・メモリー（「nullptr」なら無効）
+			@param[in]	size	メモリー・サイズ
+		 */
+		//-----------------------------------------------------------------//
+		void set_dir_cache(void* mem, uint32_t size) { dir_cache_.start(mem, size); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー・キャッシュ、パス解決キャッシュの無効化 @n
+					syscalls.c（fopen、remove 等）による変更は自動で反映される。@n
+					※FatFs を直接使って変更した場合に呼ぶ
+		 */
+		//-----------------------------------------------------------------//
+		void invalidate_cache() { invalidate_(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	変更カウンターを取得 @n
+					ファイルの書き込み、削除、リネーム、カードの抜き差し等で @n
+					進むので、オープンしたまま保持するファイルの検証に使う
+			@return 変更カウンター
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_modify_count() const noexcept { return fs_modify_count; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	SD カードのディレクトリーでタスクを実行する（一括）
+			@param[in]	root	ルート・パス
+			@param[in]	func	実行関数
+			@param[in]	todir  「true」の場合、ディレクトリーも関数を呼ぶ
+			@param[in]	option	オプション・ポインター
+			@return ファイル数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t dir_loop(const char* root, dir_loop_func func = nullptr, bool todir = false,
+			void* option = nullptr)
+		{
+			if(!mount_) return 0;
+
+			dir_list dl;
+			char full[_MAX_LFN + 1];
+			create_full_path_(root, full, sizeof(full));
+#if _USE_LFN != 0
+			str::utf8_to_sjis(full, full, sizeof(full));
+#endif
+			sync_cache_();
+			if(!dl.start(full, &dir_cache_)) return 0;
+
+			do {
+				dl.service(dir_list_limit_, func, todir, option);
+			} while(dl.probe()) ;
+			return dl.get_total();
 		}
 
 
@@ -713,7 +972,8 @@ namespace utils {
 #if _USE_LFN != 0
 			str::utf8_to_sjis(full, full, sizeof(full));
 #endif
-			if(!dl.start(full)) return 0;
+			sync_cache_();
+			if(!dl.start(full, &dir_cache_)) return 0;
 
 			do {
 				dl.service(10, dir_list_func_, true);
@@ -768,6 +1028,7 @@ namespace utils {
 				SELECT::P = 1;
 ///				format("Card ditect\n");
 			} else if(cd_ && select_wait_ == 0) {
+				invalidate_();
 				f_mount(&fatfs_, "", 0);
 				spi_.destroy();
 ///				POWER::P = 1;
@@ -790,6 +1051,7 @@ namespace utils {
 						mount_ = false;
 					} else {
 						strcpy(current_, "/");
+						invalidate_();
 						mount_ = true;
 					}
 				}
@@ -0,0 +1,184 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SD カード・マップド・ファイル・クラス @n
+			ファイルをオープンしたまま保持し、FatFs の高速シーク用 @n
+			クラスタ・リンク・マップ・テーブル（CLMT）を一度だけ作成する。@n
+			以後のシーク・リードは FAT チェーンを辿らない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include "ff12b/src/ff.h"
+
+#if _USE_FASTSEEK == 0
+#error "sdc_map.hpp requires _USE_FASTSEEK (ffconf.h)"
+#endif
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  SD カード・マップド・ファイル・テンプレート
+		@param[in]	CLMT_NUM	CLMT のサイズ（断片数 × ２ ＋ １ 以上）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t CLMT_NUM = 64>
+	class sdc_map {
+
+		FIL		fil_;
+		DWORD	clmt_[CLMT_NUM];
+		bool	open_;
+		bool	fast_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		sdc_map() noexcept : fil_(), clmt_{ 0 }, open_(false), fast_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		 */
+		//-----------------------------------------------------------------//
+		~sdc_map() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン @n
+					※パスは FatFs で認識できる形式（sdc_io::open_map を使う事）@n
+					※断片が多く CLMT に収まらない場合、通常のシークで動作する
+			@param[in]	path	ファイル・パス
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool open(const char* path) noexcept
+		{
+			close();
+			if(path == nullptr) return false;
+
+			if(f_open(&fil_, path, FA_READ) != FR_OK) {
+				return false;
+			}
+			fil_.cltbl = clmt_;
+			clmt_[0] = CLMT_NUM;
+			fast_ = f_lseek(&fil_, CREATE_LINKMAP) == FR_OK;
+			if(!fast_) {
+				fil_.cltbl = nullptr;
+			}
+			open_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		 */
+		//-----------------------------------------------------------------//
+		void close() noexcept
+		{
+			if(!open_) return;
+			f_close(&fil_);
+			fil_.cltbl = nullptr;
+			open_ = false;
+			fast_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン状態の確認
+			@return オープンしていれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool probe() const noexcept { return open_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	高速シークが有効か確認
+			@return 有効なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_fast() const noexcept { return fast_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル・サイズを取得
+			@return ファイル・サイズ
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept {
+			if(!open_) return 0;
+			return f_size(&fil_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	シーク
+			@param[in]	ofs		ファイル先頭からのオフセット
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool seek(uint32_t ofs) noexcept
+		{
+			if(!open_) return false;
+			return f_lseek(&fil_, ofs) == FR_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リード（現在位置から）
+			@param[out]	dst		読み込み先
+			@param[in]	len		長さ
+			@return 読み込んだバイト数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t read(void* dst, uint32_t len) noexcept
+		{
+			if(!open_ || dst == nullptr) return 0;
+			UINT rs = 0;
+			if(f_read(&fil_, dst, len, &rs) != FR_OK) {
+				return 0;
+			}
+			return rs;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リード（位置指定）
+			@param[in]	ofs		ファイル先頭からのオフセット
+			@param[out]	dst		読み込み先
+			@param[in]	len		長さ
+			@return 読み込んだバイト数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t read(uint32_t ofs, void* dst, uint32_t len) noexcept
+		{
+			if(!seek(ofs)) return 0;
+			return read(dst, len);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIL 構造体を参照する（ストリーム再生など）
+			@return FIL 構造体のポインター
+		 */
+		//-----------------------------------------------------------------//
+		FIL* at_fil() noexcept { return open_ ? &fil_ : nullptr; }
+	};
+}
@@ -0,0 +1,236 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SD カード連続領域ストリーム書き込みクラス @n
+			f_expand で連続クラスタを事前確保し、FAT を辿らずに @n
+			計算したセクターへ直接マルチブロック書き込みを行う。@n
+			クローズ時に未使用領域を切り詰める。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "ff12b/src/diskio.h"
+#include "ff12b/src/ff.h"
+
+#if _USE_EXPAND == 0
+#error "sdc_stream.hpp requires _USE_EXPAND (ffconf.h)"
+#endif
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  SD カード連続領域ストリーム書き込みテンプレート
+		@param[in]	SECN	バッファ・セクター数（５１２バイト単位）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t SECN = 8>
+	class sdc_stream {
+
+		static const uint32_t SECTOR_SIZE = 512;
+		static const uint32_t BUFF_SIZE = SECTOR_SIZE * SECN;
+
+		FIL			fil_;
+
+		DWORD		lba_org_;	///< 確保領域の先頭セクター
+		DWORD		lba_;		///< 次に書き込むセクター
+		DWORD		lba_end_;	///< 確保領域の終端セクター
+		uint32_t	size_;		///< 書き込み済みバイト数（バッファ含む）
+		uint32_t	pos_;		///< バッファ内の位置
+		bool		open_;
+
+		uint8_t		buff_[BUFF_SIZE] __attribute__ ((aligned(4)));
+
+		bool write_sector_(const void* src, uint32_t num)
+		{
+			if((lba_ + num) > lba_end_) return false;
+			if(disk_write(fil_.obj.fs->drv, static_cast<const BYTE*>(src), lba_, num) != RES_OK) {
+				return false;
+			}
+			lba_ += num;
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		sdc_stream() noexcept : fil_(), lba_org_(0), lba_(0), lba_end_(0), size_(0), pos_(0),
+			open_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		 */
+		//-----------------------------------------------------------------//
+		~sdc_stream() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン @n
+					※パスは FatFs で認識できる形式（sdc_io::open_stream を使う事）
+			@param[in]	path	ファイル・パス
+			@param[in]	alloc	事前確保サイズ（バイト）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool open(const char* path, uint32_t alloc) noexcept
+		{
+			if(open_ || path == nullptr || alloc == 0) return false;
+
+			if(f_open(&fil_, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+				return false;
+			}
+			// 連続クラスタを確保
+			if(f_expand(&fil_, alloc, 1) != FR_OK) {
+				f_close(&fil_);
+				return false;
+			}
+
+			const FATFS* fs = fil_.obj.fs;
+			lba_org_ = fs->database + (fil_.obj.sclust - 2) * fs->csize;
+			lba_ = lba_org_;
+			DWORD cn = (alloc + fs->csize * SECTOR_SIZE - 1) / (fs->csize * SECTOR_SIZE);
+			lba_end_ = lba_ + cn * fs->csize;
+			size_ = 0;
+			pos_ = 0;
+			open_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン状態の確認
+			@return オープンしていれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool probe() const noexcept { return open_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み済みサイズを取得
+			@return 書き込み済みサイズ
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return size_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	残り容量を取得
+			@return 残り容量（バイト）
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t space() const noexcept {
+			if(!open_) return 0;
+			return (lba_end_ - lba_) * SECTOR_SIZE - pos_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み @n
+					バッファが満杯になったら、まとめて（CMD25）書き込む。@n
+					バッファが空で、セクター以上のデータは直接書き込む。
+			@param[in]	src		ソース
+			@param[in]	len		長さ
+			@return 書き込んだバイト数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t write(const void* src, uint32_t len) noexcept
+		{
+			if(!open_ || src == nullptr) return 0;
+
+			if(len > space()) len = space();
+
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			uint32_t n = len;
+			while(n > 0) {
+				if(pos_ == 0 && n >= SECTOR_SIZE) {
+					uint32_t num = n / SECTOR_SIZE;
+					if(!write_sector_(p, num)) break;
+					num *= SECTOR_SIZE;
+					p += num;
+					n -= num;
+					size_ += num;
+					continue;
+				}
+				uint32_t l = BUFF_SIZE - pos_;
+				if(l > n) l = n;
+				std::memcpy(&buff_[pos_], p, l);
+				pos_ += l;
+				p += l;
+				n -= l;
+				size_ += l;
+				if(pos_ >= BUFF_SIZE) {
+					if(!write_sector_(buff_, SECN)) break;
+					pos_ = 0;
+				}
+			}
+			return len - n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フラッシュ @n
+					バッファ中のセクター単位のデータを書き出す（端数は保持）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool flush() noexcept
+		{
+			if(!open_) return false;
+
+			uint32_t num = pos_ / SECTOR_SIZE;
+			if(num == 0) return true;
+			if(!write_sector_(buff_, num)) return false;
+			num *= SECTOR_SIZE;
+			pos_ -= num;
+			std::memmove(buff_, &buff_[num], pos_);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ @n
+					端数を FatFs 経由で書き込み、未使用のクラスタを開放する。
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool close() noexcept
+		{
+			if(!open_) return false;
+
+			bool ret = flush();
+			open_ = false;
+			// 書き込み済みセクターの後に端数を書き、ファイルを切り詰める
+			// （エラー時は、書き込めたセクターまでを残す）
+			if(f_lseek(&fil_, (lba_ - lba_org_) * SECTOR_SIZE) != FR_OK) {
+				ret = false;
+			} else {
+				UINT bw = 0;
+				if(ret && pos_ > 0) {
+					if(f_write(&fil_, buff_, pos_, &bw) != FR_OK || bw != pos_) {
+						ret = false;
+					}
+				}
+				if(f_truncate(&fil_) != FR_OK) ret = false;
+			}
+			if(f_close(&fil_) != FR_OK) ret = false;
+			pos_ = 0;
+			return ret;
+		}
+	};
+}
@@ -0,0 +1,355 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SPSC（single producer single consumer）リング・バッファ・テンプレート @n
+			書き込み側（割り込み、又はメイン）と、読み出し側がそれぞれ一つの場合、@n
+			ロック無しで安全に受け渡しができる。@n
+			・格納位置はデータを書いた後に、取得位置はデータを読んだ後に更新する @n
+			・インデックスは３２ビット（６４Ｋを超えるサイズが可能）@n
+			・最大格納数は「サイズ－１」@n
+			・一括格納、一括取得、連続領域の参照と確定（ゼロ・コピー）@n
+			・SIZE に「０」を指定すると、バッファを外部から与える
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <algorithm>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  リング・バッファ領域（固定サイズ）
+		@param[in]	UNIT	基本形
+		@param[in]	SIZE	バッファサイズ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class UNIT, uint32_t SIZE>
+	class spsc_ring_buff {
+	protected:
+		UNIT	buff_[SIZE];
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バッファのサイズを返す
+			@return	バッファのサイズ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return SIZE; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  リング・バッファ領域（外部バッファ）
+		@param[in]	UNIT	基本形
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class UNIT>
+	class spsc_ring_buff<UNIT, 0> {
+	protected:
+		UNIT*		buff_;
+		uint32_t	size_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	buff	バッファのポインター
+			@param[in]	size	バッファのサイズ
+		*/
+		//-----------------------------------------------------------------//
+		spsc_ring_buff(UNIT* buff = nullptr, uint32_t size = 0) noexcept :
+			buff_(buff), size_(size) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バッファを設定（クリアしてから使う事）
+			@param[in]	buff	バッファのポインター
+			@param[in]	size	バッファのサイズ
+		*/
+		//-----------------------------------------------------------------//
+		void set_buff(UNIT* buff, uint32_t size) noexcept
+		{
+			buff_ = buff;
+			size_ = size;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バッファのサイズを返す
+			@return	バッファのサイズ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return size_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  SPSC リング・バッファ・クラス @n
+				put 系は書き込み側、get 系は読み出し側からのみ呼ぶ事
+		@param[in]	UNIT	基本形
+		@param[in]	SIZE	バッファサイズ（「０」なら外部バッファ）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class UNIT, uint32_t SIZE = 0>
+	class spsc_ring : public spsc_ring_buff<UNIT, SIZE> {
+
+		typedef spsc_ring_buff<UNIT, SIZE> base;
+
+		volatile uint32_t	get_ = 0;
+		volatile uint32_t	put_ = 0;
+
+		// RX は単一コアなので、コンパイラの並べ替えを防ぐだけで良い
+		static void fence_() noexcept {
+#ifdef __RX__
+			asm volatile ("" : : : "memory");
+#else
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+		}
+
+		static uint32_t load_(const volatile uint32_t& idx) noexcept {
+			uint32_t v = idx;
+			fence_();
+			return v;
+		}
+
+		static void store_(volatile uint32_t& idx, uint32_t v) noexcept {
+			fence_();
+			idx = v;
+		}
+
+		uint32_t next_(uint32_t pos, uint32_t n) const noexcept {
+			pos += n;
+			if(pos >= base::size()) pos -= base::size();
+			return pos;
+		}
+
+	public:
+		using base::base;
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  長さを返す
+			@return	長さ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t length() const noexcept {
+			uint32_t put = load_(put_);
+			uint32_t get = load_(get_);
+			if(put >= get) return (put - get);
+			else return (base::size() + put - get);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  空き（格納できる数）を返す
+			@return	空き
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t space() const noexcept {
+			if(base::size() == 0) return 0;
+			return base::size() - length() - 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  クリア（書き込み、読み出しが止まっている事）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept { get_ = put_ = 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の格納参照を得る
+			@return 値の格納参照
+		*/
+		//-----------------------------------------------------------------//
+		UNIT& put_at() noexcept { return this->buff_[put_]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  格納ポイントの移動（確定）
+			@param[in]	n	移動量
+		*/
+		//-----------------------------------------------------------------//
+		void put_go(uint32_t n = 1) noexcept { store_(put_, next_(put_, n)); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の格納（空きの確認は呼び出し側で行う）
+			@param[in]	v	値
+		*/
+		//-----------------------------------------------------------------//
+		void put(const UNIT& v) noexcept {
+			this->buff_[put_] = v;
+			put_go();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  一括書き込み（格納ポイントは移動しない）
+			@param[in]	src	ソース
+			@param[in]	n	数
+			@return 書き込んだ数（空きで制限される）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t poke(const UNIT* src, uint32_t n) noexcept {
+			uint32_t spc = space();
+			if(n > spc) n = spc;
+			uint32_t pos = put_;
+			uint32_t l = base::size() - pos;
+			if(l > n) l = n;
+			std::copy(src, src + l, &this->buff_[pos]);
+			std::copy(src + l, src + n, &this->buff_[0]);
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  一括格納
+			@param[in]	src	ソース
+			@param[in]	n	数
+			@return 格納した数（空きで制限される）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t put(const UNIT* src, uint32_t n) noexcept {
+			n = poke(src, n);
+			if(n > 0) put_go(n);
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  格納できる連続領域を得る（ゼロ・コピー）@n
+					書いた後に put_go(n) で確定する
+			@param[out]	n	連続領域の数
+			@return 連続領域の先頭
+		*/
+		//-----------------------------------------------------------------//
+		UNIT* put_region(uint32_t& n) noexcept {
+			uint32_t pos = put_;
+			uint32_t spc = space();
+			n = base::size() - pos;
+			if(n > spc) n = spc;
+			return &this->buff_[pos];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の取得参照を得る
+			@return	値の取得参照
+		*/
+		//-----------------------------------------------------------------//
+		const UNIT& get_at() const noexcept { return this->buff_[get_]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  取得ポイントの移動（確定）
+			@param[in]	n	移動量
+		*/
+		//-----------------------------------------------------------------//
+		void get_go(uint32_t n = 1) noexcept { store_(get_, next_(get_, n)); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の取得（データの確認は呼び出し側で行う）
+			@return	値
+		*/
+		//-----------------------------------------------------------------//
+		UNIT get() noexcept {
+			UNIT v = this->buff_[get_];
+			get_go();
+			return v;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  一括読み出し（取得ポイントは移動しない）
+			@param[out]	dst	コピー先
+			@param[in]	n	数
+			@return 読み出した数（長さで制限される）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t peek(UNIT* dst, uint32_t n) const noexcept {
+			uint32_t len = length();
+			if(n > len) n = len;
+			uint32_t pos = get_;
+			uint32_t l = base::size() - pos;
+			if(l > n) l = n;
+			std::copy(&this->buff_[pos], &this->buff_[pos + l], dst);
+			std::copy(&this->buff_[0], &this->buff_[n - l], dst + l);
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  一括取得
+			@param[out]	dst	コピー先
+			@param[in]	n	数
+			@return 取得した数（長さで制限される）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get(UNIT* dst, uint32_t n) noexcept {
+			n = peek(dst, n);
+			if(n > 0) get_go(n);
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  読み出せる連続領域を得る（ゼロ・コピー）@n
+					読んだ後に get_go(n) で確定する
+			@param[out]	n	連続領域の数
+			@return 連続領域の先頭
+		*/
+		//-----------------------------------------------------------------//
+		const UNIT* get_region(uint32_t& n) const noexcept {
+			uint32_t pos = get_;
+			uint32_t len = length();
+			n = base::size() - pos;
+			if(n > len) n = len;
+			return &this->buff_[pos];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  get 位置を返す
+			@return	位置
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t pos_get() const noexcept { return get_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  put 位置を返す
+			@return	位置
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t pos_put() const noexcept { return put_; }
+	};
+}
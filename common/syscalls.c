@@ -56,6 +56,155 @@ unsigned long millis(void) { return 0; }
 static FIL file_obj_[OPEN_MAX_ - STD_OFS_];
 static char fd_pads_[OPEN_MAX_];
 
+// fd_pads_ の状態
+#define FD_OPEN_	(1)		// オープン中
+#define FD_DIRTY_	(2)		// 書き込みがあり、変更カウンターに未反映
+
+// ファイル毎のバッファ・サイズ（５１２の倍数、通常 Makefile で定義）
+// ※定義しない場合、バッファリングしない
+// #define FAT_FS_BUFF_SIZE 1024
+#ifdef FAT_FS_BUFF_SIZE
+#if (FAT_FS_BUFF_SIZE == 0) || ((FAT_FS_BUFF_SIZE % 512) != 0)
+#error "FAT_FS_BUFF_SIZE must be a multiple of 512"
+#endif
+
+// バッファ・プールの数（足りない場合、そのファイルはバッファリングしない）
+#ifndef FAT_FS_BUFF_NUM
+#define FAT_FS_BUFF_NUM (OPEN_MAX_ - STD_OFS_)
+#endif
+
+typedef struct {
+	uint8_t*	buf;	// バッファ（NULL ならバッファリングしない）
+	uint32_t	pos;	// 読み出し位置
+	uint32_t	len;	// 有効データ長（先読み、又は書き込み待ち）
+	char		wr;		// 書き込み待ちの場合「1」
+} fd_buff_t;
+
+static uint8_t fd_buff_pool_[FAT_FS_BUFF_NUM][FAT_FS_BUFF_SIZE] __attribute__ ((aligned(4)));
+static char fd_buff_use_[FAT_FS_BUFF_NUM];
+static fd_buff_t fd_buff_[OPEN_MAX_ - STD_OFS_];
+
+
+static void buff_alloc_(fd_buff_t* fb)
+{
+	fb->buf = NULL;
+	fb->pos = 0;
+	fb->len = 0;
+	fb->wr = 0;
+	for(int i = 0; i < FAT_FS_BUFF_NUM; ++i) {
+		if(fd_buff_use_[i] == 0) {
+			fd_buff_use_[i] = 1;
+			fb->buf = fd_buff_pool_[i];
+			break;
+		}
+	}
+}
+
+
+static void buff_free_(fd_buff_t* fb)
+{
+	if(fb->buf != NULL) {
+		fd_buff_use_[(fb->buf - &fd_buff_pool_[0][0]) / FAT_FS_BUFF_SIZE] = 0;
+		fb->buf = NULL;
+	}
+}
+
+
+// バッファ境界までの長さ（セクター・アライメントを保つ）
+static uint32_t buff_limit_(const FIL* fp)
+{
+	return FAT_FS_BUFF_SIZE - (uint32_t)(fp->fptr % FAT_FS_BUFF_SIZE);
+}
+
+
+// 書き込み待ちを書き出す、又は、未読の先読み分だけ戻す
+static FRESULT buff_sync_(FIL* fp, fd_buff_t* fb)
+{
+	FRESULT res = FR_OK;
+	if(fb->wr != 0) {
+		UINT bw;
+		res = f_write(fp, fb->buf, fb->len, &bw);
+		if(res == FR_OK && bw != fb->len) res = FR_DENIED;
+	} else if(fb->pos < fb->len) {
+		res = f_lseek(fp, fp->fptr - (fb->len - fb->pos));
+	}
+	fb->pos = 0;
+	fb->len = 0;
+	fb->wr = 0;
+	return res;
+}
+
+
+static FRESULT buff_read_(FIL* fp, fd_buff_t* fb, void* ptr, uint32_t len, uint32_t* rl)
+{
+	FRESULT res = FR_OK;
+	if(fb->wr != 0) {
+		res = buff_sync_(fp, fb);
+		if(res != FR_OK) return res;
+	}
+
+	uint8_t* dst = ptr;
+	uint32_t n = 0;
+	while(n < len) {
+		uint32_t l = fb->len - fb->pos;
+		if(l > 0) {
+			if(l > (len - n)) l = len - n;
+			memcpy(dst + n, fb->buf + fb->pos, l);
+			fb->pos += l;
+			n += l;
+			continue;
+		}
+		fb->pos = 0;
+		fb->len = 0;
+		UINT br;
+		if((len - n) >= FAT_FS_BUFF_SIZE) {  // 大きい要求は直接読む
+			res = f_read(fp, dst + n, len - n, &br);
+			if(res == FR_OK) n += br;
+			break;
+		}
+		res = f_read(fp, fb->buf, buff_limit_(fp), &br);
+		if(res != FR_OK || br == 0) break;
+		fb->len = br;
+	}
+	*rl = n;
+	return res;
+}
+
+
+static FRESULT buff_write_(FIL* fp, fd_buff_t* fb, const void* ptr, uint32_t len, uint32_t* wl)
+{
+	FRESULT res = FR_OK;
+	if(fb->wr == 0 && fb->len > 0) {
+		res = buff_sync_(fp, fb);
+		if(res != FR_OK) return res;
+	}
+
+	const uint8_t* src = ptr;
+	uint32_t n = 0;
+	while(n < len) {
+		uint32_t lim = buff_limit_(fp);
+		if(fb->len == 0 && (len - n) >= lim) {  // 境界を越える大きい要求は直接書く
+			UINT bw;
+			res = f_write(fp, src + n, len - n, &bw);
+			if(res == FR_OK) n += bw;
+			break;
+		}
+		uint32_t l = lim - fb->len;
+		if(l > (len - n)) l = len - n;
+		memcpy(fb->buf + fb->len, src + n, l);
+		fb->len += l;
+		fb->wr = 1;
+		n += l;
+		if(fb->len >= lim) {
+			res = buff_sync_(fp, fb);
+			if(res != FR_OK) break;
+		}
+	}
+	*wl = n;
+	return res;
+}
+#endif
+
 #endif
 
 // システムコール関係のデバッグ用
@@ -67,6 +216,12 @@ static char fd_pads_[OPEN_MAX_];
 static char debug_tmp_[256];
 #endif
 
+// ファイル・システムの変更カウンター @n
+// 作成（切り詰め）オープン、書き込んだファイルのクローズ（fsync）、@n
+// 削除、名前変更で進む（読み出しだけのファイルでは進まない） @n
+// ※sdc_io は、この値が変わったらキャッシュを捨てる
+volatile uint32_t fs_modify_count = 0;
+
 #ifdef LOGGING_FS
 uint32_t fs_open_w_max = 0;
 uint32_t fs_open_w_cnt = 0;
@@ -129,6 +284,7 @@ int open(const char *path, int flags, ...)
 
 	if(flags & O_TRUNC) mode |= FA_CREATE_ALWAYS;
 	else if(flags & O_CREAT) mode |= FA_CREATE_NEW;
+	if(mode & (FA_CREATE_ALWAYS | FA_CREATE_NEW | FA_OPEN_ALWAYS)) ++fs_modify_count;
 
 #if _USE_LFN != 0
 	char tmp[_MAX_LFN + 1];
@@ -138,7 +294,10 @@ int open(const char *path, int flags, ...)
 	FRESULT res = f_open(&file_obj_[file - STD_OFS_], path, mode);
 #endif
 	if(res == FR_OK) {
-		fd_pads_[file] = 1;
+		fd_pads_[file] = FD_OPEN_;
+#ifdef FAT_FS_BUFF_SIZE
+		buff_alloc_(&fd_buff_[file - STD_OFS_]);
+#endif
 		errno = 0;
 #ifdef SYSCALLS_DEBUG
 		sprintf(debug_tmp_, "syscalls: open ok.(%d): '%s' at 0x%08X\n", file, path, mode);
@@ -205,7 +364,18 @@ int read(int file, void *ptr, int len)
 			sprintf(debug_tmp_, "syscalls: read(%d): request: %d at %08X\n", file, len, (int)ptr);
 			sci_puts(debug_tmp_);
 #endif
+#ifdef FAT_FS_BUFF_SIZE
+			fd_buff_t* fb = &fd_buff_[file - STD_OFS_];
+			if(fb->buf != NULL) {
+				uint32_t n;
+				res = buff_read_(&file_obj_[file - STD_OFS_], fb, ptr, (uint32_t)len, &n);
+				rl = n;
+			} else {
+				res = f_read(&file_obj_[file - STD_OFS_], ptr, len, &rl);
+			}
+#else
 			res = f_read(&file_obj_[file - STD_OFS_], ptr, len, &rl);
+#endif
 			if(res == FR_OK) {
 #ifdef SYSCALLS_READ_DEBUG
 				sprintf(debug_tmp_, "syscalls: read(%d): %d->%d\n", file, len, rl);
@@ -261,7 +431,20 @@ int write(int file, const void *ptr, int len)
 	else if(file < OPEN_MAX_) {
 		if(fd_pads_[file] != 0) {
 			UINT rl;
+			fd_pads_[file] |= FD_DIRTY_;
+#ifdef FAT_FS_BUFF_SIZE
+			FRESULT res;
+			fd_buff_t* fb = &fd_buff_[file - STD_OFS_];
+			if(fb->buf != NULL) {
+				uint32_t n;
+				res = buff_write_(&file_obj_[file - STD_OFS_], fb, ptr, (uint32_t)len, &n);
+				rl = n;
+			} else {
+				res = f_write(&file_obj_[file - STD_OFS_], ptr, len, &rl);
+			}
+#else
 			FRESULT res = f_write(&file_obj_[file - STD_OFS_], ptr, len, &rl);
+#endif
 			if(res == FR_OK) {
 				errno = 0;
 				l = (int)rl;
@@ -310,6 +493,13 @@ int lseek(int file, int offset, int dir)
 
 		if(fd_pads_[file] != 0) {
 			fp = &file_obj_[file - STD_OFS_];
+#ifdef FAT_FS_BUFF_SIZE
+			res = buff_sync_(fp, &fd_buff_[file - STD_OFS_]);
+			if(res != FR_OK) {
+				errno = EIO;
+				return -1;
+			}
+#endif
 			if(dir == SEEK_SET) {
 				ofs = (DWORD)offset;
 			} else if(dir == SEEK_CUR) {
@@ -320,7 +510,8 @@ int lseek(int file, int offset, int dir)
 				errno = EINVAL;
 				return -1;
 			}
-			if(ofs < 0 || ofs >= f_size(fp)) {
+			// ファイル終端（ftell、SEEK_END）は有効
+			if(ofs < 0 || ofs > f_size(fp)) {
 				errno = EINVAL;
 				return -1;
 			}
@@ -368,6 +559,7 @@ int link(const char *oldpath, const char *newpath)
 #else
 	FRESULT res = f_rename(oldpath, newpath);
 #endif
+	++fs_modify_count;
 	if(res == FR_OK) {
 
 		errno = 0;
@@ -402,6 +594,7 @@ int unlink(const char *path)
 #else
 	FRESULT res = f_unlink(path);
 #endif
+	++fs_modify_count;
 	if(res == FR_OK) {
 		errno = 0;
 		return 0;
@@ -520,9 +713,18 @@ int close(int file)
 		errno = EBADF;
 		return -1;
 	} else if(file < OPEN_MAX_) {
+		if(fd_pads_[file] & FD_DIRTY_) ++fs_modify_count;
 		fd_pads_[file] = 0;
 
+#ifdef FAT_FS_BUFF_SIZE
+		fd_buff_t* fb = &fd_buff_[file - STD_OFS_];
+		FRESULT sres = buff_sync_(&file_obj_[file - STD_OFS_], fb);
+		buff_free_(fb);
 		res = f_close(&file_obj_[file - STD_OFS_]);
+		if(sres != FR_OK) res = sres;
+#else
+		res = f_close(&file_obj_[file - STD_OFS_]);
+#endif
 		if(res == FR_OK) {
 			errno = 0;
 #ifdef SYSCALLS_DEBUG
@@ -556,6 +758,45 @@ int close(int file)
 }
 
 
+//-----------------------------------------------------------------//
+/*!
+	@brief	ファイル記述子で指定されたファイルの書き込みを確定する
+	@param[in]	file	ファイル記述子
+	@return		成功なら「０」を返す。
+*/
+//-----------------------------------------------------------------//
+int fsync(int file)
+{
+	if(file >= 0 && file <= 2) {
+		errno = 0;
+		return 0;
+	}
+#ifdef FAT_FS
+	else if(file < OPEN_MAX_ && fd_pads_[file] != 0) {
+		FIL* fp = &file_obj_[file - STD_OFS_];
+#ifdef FAT_FS_BUFF_SIZE
+		FRESULT res = buff_sync_(fp, &fd_buff_[file - STD_OFS_]);
+		if(res == FR_OK) res = f_sync(fp);
+#else
+		FRESULT res = f_sync(fp);
+#endif
+		if(fd_pads_[file] & FD_DIRTY_) {
+			fd_pads_[file] &= ~FD_DIRTY_;
+			++fs_modify_count;
+		}
+		if(res == FR_OK) {
+			errno = 0;
+			return 0;
+		}
+		errno = EIO;
+		return -1;
+	}
+#endif
+	errno = EBADF;
+	return -1;
+}
+
+
 //-----------------------------------------------------------------//
 /*!
 	@brief	ファイルディスクリプタが端末を参照しているかをチェックする
@@ -0,0 +1,341 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	行／レコード・トークナイザー @n
+			・一回の走査で、行をトークン（位置と長さ）に分割する @n
+			・元の行はコピーも変更もしない（作業領域はトークン表のみ）@n
+			・キーワードの検索には、コンパイル時に作る完全ハッシュ表を使う
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  トークン（元の行の一部を指す）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct token_t {
+		const char*	ptr;
+		uint16_t	len;
+
+		constexpr token_t(const char* p = nullptr, uint16_t l = 0) noexcept : ptr(p), len(l) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  空か？
+			@return 空なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool empty() const noexcept { return len == 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  比較
+			@param[in]	key		比較文字列
+			@return 一致したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool cmp(const char* key) const noexcept
+		{
+			if(key == nullptr) return false;
+			if(std::strlen(key) != len) return false;
+			return len == 0 || std::memcmp(ptr, key, len) == 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  文字列としてコピー（終端を付ける）
+			@param[out]	dst		コピー先
+			@param[in]	size	コピー先のサイズ（終端を含む）
+			@return 全て入らない場合「false」（入る分だけコピーする）
+		*/
+		//-----------------------------------------------------------------//
+		bool copy(char* dst, uint32_t size) const noexcept
+		{
+			if(dst == nullptr || size == 0) return false;
+			uint32_t l = len;
+			if(l >= size) l = size - 1;
+			if(l > 0) std::memcpy(dst, ptr, l);
+			dst[l] = 0;
+			return l == len;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  先頭の１０進数を取得
+			@return 値
+		*/
+		//-----------------------------------------------------------------//
+		int32_t get_dec() const noexcept
+		{
+			int32_t val = 0;
+			for(uint16_t i = 0; i < len; ++i) {
+				char ch = ptr[i];
+				if(ch < '0' || ch > '9') break;
+				val *= 10;
+				val += ch - '0';
+			}
+			return val;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  トークナイザー・クラス @n
+				トークンは分割した行が有効な間だけ使える
+		@param[in]	NUM		トークンの最大数（超えた分は捨てる）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t NUM>
+	class tokenizer {
+
+		token_t		tok_[NUM];
+		uint32_t	num_;
+
+		void add_(const char* top, const char* end) noexcept
+		{
+			if(num_ < NUM) {
+				tok_[num_] = token_t(top, end - top);
+				++num_;
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		tokenizer() noexcept : tok_{ }, num_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  空白で分割 @n
+					連続する空白は一つの区切り、「\」の次の文字では区切らない
+			@param[in]	src		行
+			@param[in]	len		行の長さ（０なら終端まで）
+			@return トークン数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t words(const char* src, uint32_t len = 0) noexcept
+		{
+			num_ = 0;
+			if(src == nullptr) return 0;
+			const char* end = len > 0 ? src + len : nullptr;
+			const char* top = nullptr;
+			const char* p = src;
+			while(p != end) {
+				char ch = *p;
+				if(ch == 0) break;
+				if(ch == ' ') {
+					if(top != nullptr) {
+						add_(top, p);
+						top = nullptr;
+					}
+				} else {
+					if(top == nullptr) top = p;
+					if(ch == '\\' && (p + 1) != end && p[1] != 0) ++p;
+				}
+				++p;
+			}
+			if(top != nullptr) add_(top, p);
+			return num_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  区切り文字で分割（空のフィールドも数える）
+			@param[in]	src		行
+			@param[in]	delim	区切り文字
+			@param[in]	term	終端文字（「０」なら行の終端まで）
+			@return トークン数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t fields(const char* src, char delim, char term = 0) noexcept
+		{
+			num_ = 0;
+			if(src == nullptr) return 0;
+			const char* top = src;
+			const char* p = src;
+			while(1) {
+				char ch = *p;
+				if(ch == 0 || ch == term) break;
+				if(ch == delim) {
+					add_(top, p);
+					top = p + 1;
+				}
+				++p;
+			}
+			add_(top, p);
+			return num_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  トークン数を返す
+			@return トークン数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  [] オペレーター
+			@param[in]	idx		トークン位置
+			@return トークン（範囲外なら空）
+		*/
+		//-----------------------------------------------------------------//
+		token_t operator[] (uint32_t idx) const noexcept
+		{
+			if(idx >= num_) return token_t();
+			return tok_[idx];
+		}
+	};
+
+
+	constexpr uint32_t key_hash_size_(uint32_t n, uint32_t m = 4) noexcept
+	{
+		return m >= (n * 4) ? m : key_hash_size_(n, m * 2);
+	}
+
+	void key_hash_no_seed_();  // 定義しない（コンパイル時に種が見つからない場合のエラー）
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  キーワード完全ハッシュ表 @n
+				キーワードは constexpr の静的配列で与え、表はコンパイル時に作る。@n
+				検索はハッシュ一回と比較一回で終わる。
+		@param[in]	N	キーワード数
+		@param[in]	M	表の大きさ（２のべき乗）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t N, uint32_t M = key_hash_size_(N)>
+	class key_hash {
+
+		static_assert(N < 255, "too many keys");
+		static_assert((M & (M - 1)) == 0, "M must be a power of 2");
+
+		const char* const*	key_;
+		uint32_t			seed_;
+		uint8_t				slot_[M];
+
+		static constexpr uint32_t len_(const char* s) noexcept
+		{
+			uint32_t n = 0;
+			while(s[n] != 0) ++n;
+			return n;
+		}
+
+		static constexpr uint32_t hash_(const char* s, uint32_t len, uint32_t seed) noexcept
+		{
+			uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+			for(uint32_t i = 0; i < len; ++i) {
+				h ^= static_cast<uint8_t>(s[i]);
+				h *= 16777619u;
+			}
+			h ^= h >> 15;
+			h *= 0x2c1b3c6du;
+			h ^= h >> 12;
+			return h & (M - 1);
+		}
+
+		constexpr bool build_(uint32_t seed) noexcept
+		{
+			for(uint32_t i = 0; i < M; ++i) slot_[i] = 0xff;
+			for(uint32_t i = 0; i < N; ++i) {
+				uint32_t h = hash_(key_[i], len_(key_[i]), seed);
+				if(slot_[h] != 0xff) return false;
+				slot_[h] = i;
+			}
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（衝突しない種を探す）
+			@param[in]	key	キーワード表（重複が無い事）
+		*/
+		//-----------------------------------------------------------------//
+		constexpr key_hash(const char* const (&key)[N]) noexcept : key_(key), seed_(0), slot_{ }
+		{
+			while(!build_(seed_)) {
+				++seed_;
+				if(seed_ >= 0x10000) key_hash_no_seed_();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  検索
+			@param[in]	s	文字列
+			@param[in]	len	長さ
+			@return キーワード表の位置（無い場合「-1」）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t find(const char* s, uint32_t len) const noexcept
+		{
+			if(s == nullptr) return -1;
+			uint8_t i = slot_[hash_(s, len, seed_)];
+			if(i == 0xff) return -1;
+			const char* k = key_[i];
+			if(std::strncmp(k, s, len) != 0 || k[len] != 0) return -1;
+			return i;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  検索
+			@param[in]	t	トークン
+			@return キーワード表の位置（無い場合「-1」）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t find(const token_t& t) const noexcept { return find(t.ptr, t.len); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  検索
+			@param[in]	s	文字列
+			@return キーワード表の位置（無い場合「-1」）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t find(const char* s) const noexcept
+		{
+			if(s == nullptr) return -1;
+			return find(s, std::strlen(s));
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  キーワード完全ハッシュ表を作る
+		@param[in]	key	キーワード表
+		@return キーワード完全ハッシュ表
+	*/
+	//-----------------------------------------------------------------//
+	template <uint32_t N>
+	constexpr key_hash<N> make_key_hash(const char* const (&key)[N]) noexcept
+	{
+		return key_hash<N>(key);
+	}
+}
@@ -0,0 +1,316 @@
+//=====================================================================//
+/*!	@file
+	@brief	fixed_memory のファズ・テスト、ベンチマーク（ホスト） @n
+			ランダムな確保、解放（不正なポインター、二重解放を含む）を、@n
+			影のモデル（サイズ・クラス毎のフリー数、切り出し位置）と比較する。@n
+			・アライメント、領域内、ブロックが重ならない事 @n
+			・ブロックの内容が他の操作で壊れない事 @n
+			・二重解放、不正なポインターは「false」で、状態を変えない事 @n
+			・used、peak、remain、cached、fail が、モデルと一致する事 @n
+			・fixed_allocator を使う std::map を、通常の std::map と比較 @n
+			・malloc/free と速度を比較
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "common/fixed_memory.hpp"
+
+namespace {
+
+	static const uint32_t SIZE = 65536;
+	static const uint32_t DNUM = 8;
+	static const uint32_t ALIGN = 32;
+	typedef utils::fixed_memory<SIZE, DNUM, ALIGN> MEMORY;
+
+	int		bad_ = 0;
+
+	// 最適化で結果が消えないように
+	volatile uintptr_t	sink_;
+
+	void check_(bool ok, const char* what, uint32_t n)
+	{
+		if(ok) return;
+		if(bad_ < 10) printf("NG %s (%u)\n", what, n);
+		++bad_;
+	}
+
+	uint32_t class_(uint32_t size)
+	{
+		uint32_t c = 0;
+		while((ALIGN << c) < size) ++c;
+		return c;
+	}
+
+	struct block_t {
+		uint32_t	size;		///< 要求サイズ
+		uint32_t	cls;		///< サイズ・クラス
+		uint8_t		fill;		///< 内容
+	};
+
+	// 影のモデル
+	struct model_t {
+		std::map<uint8_t*, block_t>	live;
+		std::set<uint8_t*>			freed[DNUM];	///< フリー・リストにあるブロック
+		uint32_t	top = 0;
+		uint32_t	used = 0;
+		uint32_t	peak = 0;
+		uint32_t	cached = 0;
+		uint32_t	fail = 0;
+	};
+
+
+	bool filled_(const uint8_t* p, uint32_t len, uint8_t v)
+	{
+		for(uint32_t i = 0; i < len; ++i) {
+			if(p[i] != v) return false;
+		}
+		return true;
+	}
+
+
+	void alloc_(MEMORY& mem, model_t& m, uint32_t size, uint32_t n)
+	{
+		void* ptr = mem.alloc(size);
+		uint8_t* p = static_cast<uint8_t*>(ptr);
+		if(size == 0 || size > MEMORY::max_block()) {
+			check_(p == nullptr, "alloc out of range size", n);
+			++m.fail;
+			return;
+		}
+		uint32_t c = class_(size);
+		uint32_t bsz = ALIGN << c;
+		if(!m.freed[c].empty()) {
+			// 同じサイズ・クラスのフリー・リストから
+			check_(m.freed[c].count(p) == 1, "alloc reuse", n);
+			m.freed[c].erase(p);
+			m.cached -= bsz;
+		} else if((m.top + bsz) <= SIZE) {
+			check_(p == reinterpret_cast<uint8_t*>(&mem) + m.top, "alloc carve", n);
+			m.top += bsz;
+		} else {
+			check_(p == nullptr, "alloc full", n);
+			++m.fail;
+			return;
+		}
+		if(p == nullptr) return;
+
+		check_((reinterpret_cast<uintptr_t>(p) % ALIGN) == 0, "alignment", n);
+		const uint8_t* org = reinterpret_cast<const uint8_t*>(&mem);
+		check_(p >= org && (p + bsz) <= (org + SIZE), "inside the pool", n);
+		// 前後のブロックと重ならない
+		auto it = m.live.lower_bound(p);
+		if(it != m.live.end()) {
+			check_((p + bsz) <= it->first, "overlap next", n);
+		}
+		if(it != m.live.begin()) {
+			--it;
+			check_((it->first + (ALIGN << it->second.cls)) <= p, "overlap prev", n);
+		}
+		uint8_t fill = n * 37 + 1;
+		std::memset(p, fill, bsz);  // ブロック全体が使える事
+		m.live[p] = block_t { size, c, fill };
+		m.used += bsz;
+		if(m.used > m.peak) m.peak = m.used;
+	}
+
+
+	void free_(MEMORY& mem, model_t& m, uint8_t* p, uint32_t n)
+	{
+		auto it = m.live.find(p);
+		if(it == m.live.end()) {
+			check_(!mem.free(p), "invalid free accepted", n);
+			return;
+		}
+		uint32_t bsz = ALIGN << it->second.cls;
+		check_(filled_(p, bsz, it->second.fill), "block contents", n);
+		check_(mem.free(p), "free", n);
+		m.freed[it->second.cls].insert(p);
+		m.used -= bsz;
+		m.cached += bsz;
+		m.live.erase(it);
+	}
+
+
+	void compare_(const MEMORY& mem, const model_t& m, uint32_t n)
+	{
+		check_(mem.used() == m.used, "used", n);
+		check_(mem.peak() == m.peak, "peak", n);
+		check_(mem.remain() == SIZE - m.top, "remain", n);
+		check_(mem.cached() == m.cached, "cached", n);
+		check_(mem.fail() == m.fail, "fail", n);
+	}
+
+
+	void fuzz_test_(uint32_t seed, uint32_t loops)
+	{
+		std::mt19937 rng(seed);
+		static MEMORY mem;
+		model_t m;
+		static uint8_t dummy[ALIGN * 2] __attribute__ ((aligned(ALIGN)));
+		std::vector<uint8_t*> dead;		// 解放したポインター（二重解放用）
+		uint32_t dfree = 0;
+		uint32_t ifree = 0;
+		for(uint32_t n = 0; n < loops; ++n) {
+			uint32_t r = rng() % 100;
+			if(r < 45) {
+				uint32_t size;
+				uint32_t k = rng() % 16;
+				if(k == 0) size = 0;
+				else if(k == 1) size = MEMORY::max_block() + 1 + rng() % 100;
+				else if(k < 6) size = ALIGN << (rng() % DNUM);  // クラスの境界
+				else if(k < 9) size = (ALIGN << (rng() % DNUM)) + 1;
+				else size = 1 + rng() % 600;
+				alloc_(mem, m, size, n);
+			} else if(r < 85) {
+				if(m.live.empty()) continue;
+				auto it = m.live.begin();
+				std::advance(it, rng() % m.live.size());
+				uint8_t* p = it->first;
+				free_(mem, m, p, n);
+				dead.push_back(p);
+			} else if(r < 93) {
+				// 二重解放（同じ場所が再び確保されていれば、正しい解放になる）
+				if(dead.empty()) continue;
+				uint8_t* p = dead[rng() % dead.size()];
+				if(m.live.count(p) == 0) ++dfree;
+				free_(mem, m, p, n);
+			} else {
+				// 不正なポインター（ブロックの途中、アラインしていない、範囲外）
+				uint8_t* org = reinterpret_cast<uint8_t*>(&mem);
+				uint8_t* p;
+				uint32_t k = rng() % 4;
+				if(k == 0) p = org + (rng() % SIZE) + 1;
+				else if(k == 1) p = org + SIZE + ALIGN * (rng() % 4);
+				else if(k == 2) p = &dummy[ALIGN];  // 別の領域
+				else p = nullptr;
+				if(p == nullptr) {
+					check_(mem.free(p), "free nullptr", n);
+					continue;
+				}
+				if(m.live.count(p) != 0) continue;
+				++ifree;
+				free_(mem, m, p, n);
+			}
+			compare_(mem, m, n);
+		}
+		// 全て解放
+		while(!m.live.empty()) {
+			free_(mem, m, m.live.begin()->first, loops);
+		}
+		compare_(mem, m, loops);
+		check_(mem.used() == 0, "used after free all", loops);
+		printf("  fuzz: %u ops, %u double frees, %u invalid frees, peak %u, remain %u, cached %u, fail %u\n",
+			loops, dfree, ifree, mem.peak(), mem.remain(), mem.cached(), mem.fail());
+	}
+
+
+	void allocator_test_(uint32_t seed, uint32_t loops)
+	{
+		typedef utils::fixed_memory<65536, 6, 16> POOL;
+		static POOL pool;
+		typedef utils::fixed_allocator<std::pair<const uint16_t, uint32_t>, POOL> ALLOC;
+		std::mt19937 rng(seed);
+		{
+			std::map<uint16_t, uint32_t, std::less<uint16_t>, ALLOC> map(ALLOC { pool });
+			std::map<uint16_t, uint32_t> ref;
+			for(uint32_t n = 0; n < loops; ++n) {
+				uint16_t key = rng() % 1000;
+				uint32_t v = rng();
+				if((v & 3) == 0) {
+					check_(map.erase(key) == ref.erase(key), "map erase", n);
+				} else {
+					map[key] = v;
+					ref[key] = v;
+				}
+			}
+			check_(map.size() == ref.size(), "map size", loops);
+			check_(std::equal(map.begin(), map.end(), ref.begin()), "map contents", loops);
+			check_(pool.used() > 0 && pool.fail() == 0, "map pool", loops);
+			printf("  fixed_allocator map: %u entries, used %u, peak %u, cached %u\n",
+				static_cast<uint32_t>(map.size()), pool.used(), pool.peak(), pool.cached());
+		}
+		check_(pool.used() == 0, "map pool after destroy", loops);
+	}
+
+
+	// 確保、解放のパターン（同じものを pool と malloc で使う）
+	struct op_t {
+		uint32_t	size;	///< 「０」なら解放
+		uint32_t	slot;
+	};
+
+	void bench_(uint32_t seed, uint32_t loops)
+	{
+		static const uint32_t SLOTS = 256;
+		std::mt19937 rng(seed);
+		std::vector<op_t> ops;
+		bool used[SLOTS] = { };
+		for(uint32_t n = 0; n < loops; ++n) {
+			uint32_t s = rng() % SLOTS;
+			if(used[s]) {
+				ops.push_back(op_t { 0, s });
+			} else {
+				uint32_t sz = 16 + rng() % 240;  // ネットワークのバッファ程度
+				ops.push_back(op_t { sz, s });
+			}
+			used[s] = !used[s];
+		}
+		for(uint32_t s = 0; s < SLOTS; ++s) {
+			if(used[s]) ops.push_back(op_t { 0, s });
+		}
+
+		static MEMORY mem;
+		mem.clear();
+		void* ptr[SLOTS];
+		uintptr_t sum = 0;
+		auto t = std::chrono::steady_clock::now();
+		for(const auto& op : ops) {
+			if(op.size) {
+				ptr[op.slot] = mem.alloc(op.size);
+				sum += reinterpret_cast<uintptr_t>(ptr[op.slot]);
+			} else {
+				mem.free(ptr[op.slot]);
+			}
+		}
+		double tp = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t).count();
+		check_(mem.fail() == 0 && mem.used() == 0, "bench pool", 0);
+
+		t = std::chrono::steady_clock::now();
+		for(const auto& op : ops) {
+			if(op.size) {
+				ptr[op.slot] = std::malloc(op.size);
+				sum += reinterpret_cast<uintptr_t>(ptr[op.slot]);
+			} else {
+				std::free(ptr[op.slot]);
+			}
+		}
+		double tm = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t).count();
+		printf("  bench: %u ops (16-255 bytes, %u slots): fixed_memory %.1f ns/op, malloc %.1f ns/op (%.2fx)\n",
+			static_cast<uint32_t>(ops.size()), SLOTS, tp / ops.size(), tm / ops.size(), tm / tp);
+		sink_ = sum;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+
+	printf("fixed_memory: seed %u (size %u, %u classes, align %u)\n", seed, SIZE, DNUM, ALIGN);
+	fuzz_test_(seed, 200000);
+	allocator_test_(seed, 20000);
+	bench_(seed, 2000000);
+
+	printf("fixed_memory: errors %d\n", bad_);
+	return bad_ != 0;
+}
@@ -0,0 +1,192 @@
+//=====================================================================//
+/*!	@file
+	@brief	flash_man の電源断テスト（ホスト） @n
+			FIO をメモリーで模擬し、書き込み、消去の途中で電源を落として、@n
+			再マウント後のレコードを、確定した書き込み、削除と照合する。@n
+			・電源断の書き込みは、途中までのビットが落ちる @n
+			・電源断の消去は、ブロックがランダムな値になる @n
+			・電源断で途中の ID は、新旧どちらの値でも良い
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <map>
+#include <vector>
+#include "common/flash_man.hpp"
+
+namespace {
+
+	// データ・フラッシュの模擬（RX64M 相当の 64 バイト・ブロック、４バイト書き込み）
+	struct fio_sim {
+		static const uint32_t data_flash_block = 64;
+		static const uint32_t data_flash_size = 8192;
+
+		uint8_t		mem_[data_flash_size];
+		uint32_t	count_[data_flash_size / data_flash_block];
+		long		budget_;	///< 電源断までの書き込み、消去の回数（負なら無制限）
+		std::mt19937&	rng_;
+
+		fio_sim(std::mt19937& rng) : count_{ 0 }, budget_(-1), rng_(rng) {
+			memset(mem_, 0xff, sizeof(mem_));
+		}
+
+		bool op_() {
+			if(budget_ == 0) return false;
+			if(budget_ > 0) --budget_;
+			return true;
+		}
+
+		bool erase_check(uint32_t org, uint32_t len = data_flash_block) const {
+			for(uint32_t i = 0; i < len; ++i) {
+				if(mem_[org + i] != 0xff) return false;
+			}
+			return true;
+		}
+
+		bool erase(uint32_t org) {
+			if(!op_()) {
+				for(uint32_t i = 0; i < data_flash_block; ++i) {
+					if(rng_() & 1) mem_[org + i] = rng_();
+				}
+				return false;
+			}
+			memset(&mem_[org], 0xff, data_flash_block);
+			++count_[org / data_flash_block];
+			return true;
+		}
+
+		bool write(uint32_t org, const void* src, uint32_t len) {
+			if((org & 3) != 0 || (len & 3) != 0) {
+				printf("unaligned write: %08X, %u\n", org, len);
+				exit(1);
+			}
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(uint32_t i = 0; i < len; i += 4) {
+				if(!op_()) {
+					mem_[org + i] &= rng_();
+					return false;
+				}
+				for(uint32_t j = 0; j < 4; ++j) {
+					if(mem_[org + i + j] != 0xff) {
+						printf("overwrite: %08X\n", org + i + j);
+						exit(1);
+					}
+					mem_[org + i + j] = p[i + j];
+				}
+			}
+			return true;
+		}
+
+		bool read(uint32_t org, void* dst, uint32_t len) const {
+			memcpy(dst, &mem_[org], len);
+			return true;
+		}
+	};
+
+	static const uint32_t IMAX = 16;
+	typedef utils::flash_man<fio_sim, IMAX, 512> FLASH_MAN;
+
+	// 確定した値（空なら削除済み）
+	typedef std::map<uint32_t, std::vector<uint8_t> > REF;
+
+	std::vector<uint8_t> get_(FLASH_MAN& fm, uint32_t id)
+	{
+		std::vector<uint8_t> b;
+		if(fm.probe(id)) {
+			b.resize(fm.get_size(id));
+			fm.read(id, b.data(), b.size());
+		}
+		return b;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 2;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+	std::mt19937 rng(seed);
+	static fio_sim fio(rng);
+
+	// 電源断の頻度：「4 回に 1 回、3000 操作以内」と「毎回、400 操作以内」
+	static const struct { int rounds; int every; uint32_t budget; } pass[2] = {
+		{  3000, 4, 3000 },
+		{ 30000, 1,  400 },
+	};
+
+	REF ref;
+	int bad = 0;
+	int writes = 0;
+	int removes = 0;
+	for(int round = 0; round < (pass[0].rounds + pass[1].rounds); ++round) {
+		const auto& ps = pass[round < pass[0].rounds ? 0 : 1];
+		fio.budget_ = -1;
+		FLASH_MAN fm(fio);
+		if(!fm.start()) {
+			printf("mount fail: round %d\n", round);
+			return 1;
+		}
+		for(const auto& r : ref) {
+			if(get_(fm, r.first) != r.second) {
+				printf("%s: id %u, round %d\n", r.second.empty() ? "revived" : "mismatch",
+					r.first, round);
+				++bad;
+			}
+		}
+
+		if((round % ps.every) == (ps.every - 1)) {
+			fio.budget_ = rng() % ps.budget;
+		} else {
+			fio.budget_ = -1;
+		}
+		std::vector<uint32_t> lost;
+		for(int k = 0; k < 50; ++k) {
+			uint32_t id = rng() % IMAX;
+			bool ok;
+			std::vector<uint8_t> d;
+			if((rng() % 4) == 0) {
+				if(!fm.probe(id)) continue;
+				ok = fm.remove(id);
+				if(ok) ++removes;
+			} else {
+				// 小さい ID は大きなレコード（古いセクターに有効レコードが多く残る）
+				d.resize(id < 4 ? rng() % 200 + 100 : rng() % 60 + 1);
+				for(auto& c : d) c = rng();
+				ok = fm.write(id, d.data(), d.size());
+				if(ok) ++writes;
+			}
+			if(ok) {
+				ref[id] = d;
+			} else if(fio.budget_ != 0) {
+				printf("write fail: round %d, id %u\n", round, id);
+				return 1;
+			} else {
+				lost.push_back(id);  // 電源断：この ID は不確定
+				break;
+			}
+		}
+
+		// 不確定な ID は、次のマウント後の値を基準にする
+		if(!lost.empty()) {
+			fio.budget_ = -1;
+			FLASH_MAN t(fio);
+			t.start();
+			for(auto id : lost) ref[id] = get_(t, id);
+		}
+	}
+
+	uint32_t mn = 0xffffffff;
+	uint32_t mx = 0;
+	for(auto c : fio.count_) {
+		if(c < mn) mn = c;
+		if(c > mx) mx = c;
+	}
+	printf("flash_man: seed %u, writes %d, removes %d, erase %u-%u, errors %d\n",
+		seed, writes, removes, mn, mx, bad);
+	return bad != 0;
+}
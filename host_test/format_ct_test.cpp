@@ -0,0 +1,170 @@
+//=====================================================================//
+/*!	@file
+	@brief	format のコンパイル時解析のテスト、ベンチマーク（ホスト） @n
+			utils::sformat::ct（"..."_fmt）の出力を、実行時に解析する @n
+			utils::sformat の出力と比較し、速度を比較する。@n
+			・整数、文字列、固定小数点、「%%」、リテラルのみ @n
+			・文字バッファへの追加（append）@n
+			・「%」の連鎖は状態の参照だけを持つ事（引数毎にコピーしない）@n
+			・ign_cmd::wdm_send_、http_server::make_info と同じフォーマット
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include "common/format.hpp"
+
+namespace {
+
+	char	ct_[256];
+	char	rt_[256];
+	int		bad_ = 0;
+
+	// 最適化で結果が消えないように
+	volatile uint32_t	sink_;
+
+	static const char* wday_[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	static const char* mon_[] = {
+		"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+	};
+
+	// 二つ目以降の段は、状態（basic_format）の参照だけを持つ
+	typedef decltype("%d,%d"_fmt) FMT2;
+	static_assert(sizeof(utils::basic_format_ct<utils::memory_chaout, FMT2, 1>) == sizeof(void*),
+		"format_ct: the state is copied per argument");
+	static_assert(sizeof(utils::basic_format_ct<utils::memory_chaout, FMT2, 0>)
+		== sizeof(utils::sformat), "format_ct: the first stage owns the state");
+
+	void check_(const char* what, uint32_t n)
+	{
+		if(std::strcmp(ct_, rt_) == 0) return;
+		if(bad_ < 10) printf("NG %s (%u): '%s', runtime '%s'\n", what, n, ct_, rt_);
+		++bad_;
+	}
+
+
+	void date_ct_(char* out, uint32_t size, uint32_t n)
+	{
+		utils::sformat::ct("Date: %s, %02d %s %4d %02d:%02d:%02d GMT\n"_fmt, out, size)
+			% wday_[n % 7] % (n % 31 + 1) % mon_[n % 12] % (1970 + n % 100)
+			% (n % 24) % (n % 60) % (n / 7 % 60);
+	}
+
+
+	void date_rt_(char* out, uint32_t size, uint32_t n)
+	{
+		utils::sformat("Date: %s, %02d %s %4d %02d:%02d:%02d GMT\n", out, size)
+			% wday_[n % 7] % (n % 31 + 1) % mon_[n % 12] % (1970 + n % 100)
+			% (n % 24) % (n % 60) % (n / 7 % 60);
+	}
+
+
+	void compare_test_(uint32_t seed, uint32_t loops)
+	{
+		std::mt19937 rng(seed);
+		for(uint32_t n = 0; n < loops; ++n) {
+			uint16_t w = rng();
+			utils::sformat::ct("%04X"_fmt, ct_, sizeof(ct_)) % w;
+			utils::sformat("%04X", rt_, sizeof(rt_)) % w;
+			check_("%04X", n);
+
+			uint32_t d = rng();
+			date_ct_(ct_, sizeof(ct_), d);
+			date_rt_(rt_, sizeof(rt_), d);
+			check_("date", n);
+
+			int32_t s = rng();
+			const char* str = mon_[rng() % 12];
+			utils::sformat::ct("%d,%s"_fmt, ct_, sizeof(ct_)) % s % str;
+			utils::sformat("%d,%s", rt_, sizeof(rt_)) % s % str;
+			check_("%d,%s", n);
+
+			float f = static_cast<float>(static_cast<int32_t>(rng() % 200000) - 100000) / 100.0f;
+			utils::sformat::ct("%3.2f"_fmt, ct_, sizeof(ct_)) % f;
+			utils::sformat("%3.2f", rt_, sizeof(rt_)) % f;
+			check_("%3.2f", n);
+
+			uint32_t a = rng() % 100;
+			uint32_t b = rng();
+			utils::sformat::ct("Keep-Alive: timeout=%u,max=%u\n"_fmt, ct_, sizeof(ct_)) % a % b;
+			utils::sformat("Keep-Alive: timeout=%u,max=%u\n", rt_, sizeof(rt_)) % a % b;
+			check_("keep-alive", n);
+
+			// 追加
+			utils::sformat::ct("%d,"_fmt, ct_, sizeof(ct_)) % a;
+			utils::sformat::ct("%x%%"_fmt, ct_, sizeof(ct_), true) % b;
+			utils::sformat::ct(",end"_fmt, ct_, sizeof(ct_), true);
+			utils::sformat("%d,", rt_, sizeof(rt_)) % a;
+			utils::sformat("%x%%", rt_, sizeof(rt_), true) % b;
+			utils::sformat(",end", rt_, sizeof(rt_), true);
+			check_("append", n);
+		}
+
+		// 状態は連鎖の最後まで引き継がれる
+		bool ok = (utils::sformat::ct("%d:%d:%d"_fmt, ct_, sizeof(ct_)) % 1 % 2 % 3).size() == 5;
+		std::strcpy(rt_, ok ? "1:2:3" : "size");
+		check_("chain", 0);
+	}
+
+
+	template <class F>
+	double time_(F func, uint32_t loops)
+	{
+		auto t = std::chrono::steady_clock::now();
+		for(uint32_t n = 0; n < loops; ++n) {
+			func(n);
+		}
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t).count()
+			/ loops;
+	}
+
+
+	void bench_(uint32_t loops)
+	{
+		static const char* title = "  %-12s runtime %7.1f ns, ct %7.1f ns (%.2fx)\n";
+		uint32_t sum = 0;
+		double rt = time_([&](uint32_t n) {
+			utils::sformat("%04X", rt_, sizeof(rt_)) % static_cast<uint16_t>(n);
+			sum += rt_[3];
+		}, loops);
+		double ct = time_([&](uint32_t n) {
+			utils::sformat::ct("%04X"_fmt, ct_, sizeof(ct_)) % static_cast<uint16_t>(n);
+			sum += ct_[3];
+		}, loops);
+		printf(title, "%04X", rt, ct, rt / ct);
+
+		rt = time_([&](uint32_t n) { date_rt_(rt_, sizeof(rt_), n); sum += rt_[10]; }, loops);
+		ct = time_([&](uint32_t n) { date_ct_(ct_, sizeof(ct_), n); sum += ct_[10]; }, loops);
+		printf(title, "http date", rt, ct, rt / ct);
+
+		rt = time_([&](uint32_t n) {
+			utils::sformat("Content-Type: text/html\n\n", rt_, sizeof(rt_));
+			sum += rt_[n & 15];
+		}, loops);
+		ct = time_([&](uint32_t n) {
+			utils::sformat::ct("Content-Type: text/html\n\n"_fmt, ct_, sizeof(ct_));
+			sum += ct_[n & 15];
+		}, loops);
+		printf(title, "literal", rt, ct, rt / ct);
+		sink_ = sum;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+
+	printf("format_ct: seed %u\n", seed);
+	compare_test_(seed, 100000);
+	bench_(2000000);
+
+	printf("format_ct: errors %d\n", bad_);
+	return bad_ != 0;
+}
@@ -0,0 +1,218 @@
+//=====================================================================//
+/*!	@file
+	@brief	format の変換テスト（ホスト） @n
+			utils::sformat の出力を、libc の snprintf と比較する。@n
+			・固定小数点（%f）、指数（%e）、自動（%g）の精度１～９ @n
+			・精度無しの %g は、最短で元の値に戻る表記である事 @n
+			・整数（６４ビットを含む）、幅、符号、０埋め @n
+			・変換の速度（snprintf と比較）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include "common/format.hpp"
+
+namespace {
+
+	char	ours_[512];
+	char	libc_[512];
+	int		fails_ = 0;
+
+	void check_(const char* what, float v)
+	{
+		if(std::strcmp(ours_, libc_) == 0) return;
+		if(fails_ < 30) {
+			printf("NG %s %a: '%s', libc '%s'\n", what, v, ours_, libc_);
+		}
+		++fails_;
+	}
+
+	// 有効数字の数（先頭の０、整数部の末尾の０は数えない）
+	int digits_(const char* s)
+	{
+		const char* p = s;
+		if(*p == '-') ++p;
+		while(*p == '0' || *p == '.') ++p;
+		int n = 0;
+		for(; *p != 0 && *p != 'e'; ++p) {
+			if(*p >= '0' && *p <= '9') ++n;
+		}
+		if(std::strchr(s, 'e') == nullptr && std::strchr(s, '.') == nullptr) {
+			for(const char* z = s + std::strlen(s) - 1; z > s && *z == '0'; --z) --n;
+		}
+		return n;
+	}
+
+	void real_test_(std::mt19937& rng)
+	{
+		static const char conv[3] = { 'f', 'e', 'g' };
+		for(int i = 0; i < 300000; ++i) {
+			uint32_t bits = rng();
+			if(((bits >> 23) & 0xff) == 0xff) continue;
+			if((i % 3) == 0) {  // 普通の範囲
+				bits = (bits & 0x807fffff) | ((100 + rng() % 60) << 23);
+			}
+			float v;
+			std::memcpy(&v, &bits, sizeof(v));
+
+			int prec = 1 + rng() % 9;
+			for(auto c : conv) {
+				char form[16];
+				snprintf(form, sizeof(form), "%%.%d%c", prec, c);
+				utils::sformat(form, ours_, sizeof(ours_)) % v;
+				snprintf(libc_, sizeof(libc_), form, static_cast<double>(v));
+				check_(form, v);
+			}
+
+			// 精度無しの %g：元に戻り、最短である事
+			utils::sformat("%g", ours_, sizeof(ours_)) % v;
+			if(strtof(ours_, nullptr) != v) {
+				if(fails_ < 30) printf("NG round trip %a: '%s'\n", v, ours_);
+				++fails_;
+				continue;
+			}
+			for(int d = 1; d < 9; ++d) {
+				snprintf(libc_, sizeof(libc_), "%.*e", d - 1, static_cast<double>(v));
+				if(strtof(libc_, nullptr) != v) continue;
+				if(digits_(ours_) > d) {
+					if(fails_ < 30) printf("NG shortest %a: '%s', %d digits\n", v, ours_, d);
+					++fails_;
+				}
+				break;
+			}
+		}
+
+		static const char* form[] = { "%8.3f", "%08.3f", "%+.2f", "%+08.2e", "%12.3e" };
+		static const float vals[] = {
+			3.14159f, -2.5f, 0.0f, -0.0f, 1e30f, 1.5e-40f, 0.5f, 2.5f, 1e-5f, 123456789.0f,
+			INFINITY, -INFINITY, NAN
+		};
+		for(auto f : form) {
+			for(auto v : vals) {
+				utils::sformat(f, ours_, sizeof(ours_)) % v;
+				snprintf(libc_, sizeof(libc_), f, static_cast<double>(v));
+				check_(f, v);
+			}
+		}
+	}
+
+	void integer_test_(std::mt19937& rng)
+	{
+		for(int i = 0; i < 200000; ++i) {
+			uint64_t u = (static_cast<uint64_t>(rng()) << 32) | rng();
+			u >>= rng() % 64;
+			int64_t s = static_cast<int64_t>(u) * ((i & 1) ? -1 : 1);
+			uint32_t u32 = rng() >> (rng() % 32);
+			int32_t s32 = static_cast<int32_t>(rng());
+			utils::sformat("%d %u %x %X %o %d %u %d %5d %d %08d %+d", ours_, sizeof(ours_))
+				% s % u % u % u % u32 % s32 % u32 % static_cast<int16_t>(s32)
+				% static_cast<int8_t>(s32) % 7 % -42 % 5;
+			snprintf(libc_, sizeof(libc_), "%lld %llu %llx %llX %o %d %u %d %5d %d %08d %+d",
+				static_cast<long long>(s), static_cast<unsigned long long>(u),
+				static_cast<unsigned long long>(u), static_cast<unsigned long long>(u),
+				u32, s32, u32, static_cast<int16_t>(s32), static_cast<int8_t>(s32), 7, -42, 5);
+			check_("integer", 0);
+		}
+
+		utils::sformat("%d|%d|%u", ours_, sizeof(ours_)) % INT32_MIN % INT64_MIN % UINT64_MAX;
+		std::strcpy(libc_, "-2147483648|-9223372036854775808|18446744073709551615");
+		check_("limits", 0);
+	}
+
+
+	// 最適化で結果が消えないように
+	volatile uint32_t	sink_;
+
+	template <class F>
+	double time_(F func, uint32_t loops)
+	{
+		auto t = std::chrono::steady_clock::now();
+		for(uint32_t n = 0; n < loops; ++n) {
+			func(n);
+		}
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t).count()
+			/ loops;
+	}
+
+
+	void bench_(std::mt19937& rng, uint32_t loops)
+	{
+		static const uint32_t NUM = 1024;
+		uint32_t u32[NUM];
+		uint64_t u64[NUM];
+		float real[NUM];
+		for(uint32_t i = 0; i < NUM; ++i) {
+			u32[i] = rng() >> (rng() % 32);
+			u64[i] = ((static_cast<uint64_t>(rng()) << 32) | rng()) >> (rng() % 64);
+			real[i] = static_cast<float>(static_cast<int32_t>(rng())) / static_cast<float>(1 + rng() % 100000);
+		}
+
+		static const char* title = "  %-6s %7.1f ns, snprintf %7.1f ns (%.2fx)\n";
+		uint32_t sum = 0;
+		double ours = time_([&](uint32_t n) {
+			utils::sformat("%u", ours_, sizeof(ours_)) % u32[n % NUM];
+			sum += ours_[0];
+		}, loops);
+		double libc = time_([&](uint32_t n) {
+			snprintf(libc_, sizeof(libc_), "%u", u32[n % NUM]);
+			sum += libc_[0];
+		}, loops);
+		printf(title, "%u", ours, libc, libc / ours);
+
+		ours = time_([&](uint32_t n) {
+			utils::sformat("%d", ours_, sizeof(ours_)) % static_cast<int64_t>(u64[n % NUM]);
+			sum += ours_[0];
+		}, loops);
+		libc = time_([&](uint32_t n) {
+			snprintf(libc_, sizeof(libc_), "%lld", static_cast<long long>(u64[n % NUM]));
+			sum += libc_[0];
+		}, loops);
+		printf(title, "%d 64", ours, libc, libc / ours);
+
+		ours = time_([&](uint32_t n) {
+			utils::sformat("%08X", ours_, sizeof(ours_)) % u32[n % NUM];
+			sum += ours_[0];
+		}, loops);
+		libc = time_([&](uint32_t n) {
+			snprintf(libc_, sizeof(libc_), "%08X", u32[n % NUM]);
+			sum += libc_[0];
+		}, loops);
+		printf(title, "%08X", ours, libc, libc / ours);
+
+		static const char* form[] = { "%.3f", "%.6e", "%g" };
+		for(auto f : form) {
+			ours = time_([&](uint32_t n) {
+				utils::sformat(f, ours_, sizeof(ours_)) % real[n % NUM];
+				sum += ours_[0];
+			}, loops);
+			libc = time_([&](uint32_t n) {
+				snprintf(libc_, sizeof(libc_), f, static_cast<double>(real[n % NUM]));
+				sum += libc_[0];
+			}, loops);
+			printf(title, f, ours, libc, libc / ours);
+		}
+		sink_ = sum;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+	std::mt19937 rng(seed);
+
+	real_test_(rng);
+	integer_test_(rng);
+	bench_(rng, 1000000);
+
+	printf("format: seed %u, errors %d\n", seed, fails_);
+	return fails_ != 0;
+}
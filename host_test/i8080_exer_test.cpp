@@ -0,0 +1,648 @@
+//=====================================================================//
+/*!	@file
+	@brief	I8080 の命令テスト（エクササイザー）、ベンチマーク（ホスト） @n
+			８０８０のデータシートから書いた参照 CPU（ref_cpu）と、I8080 を @n
+			ランダムな状態から１命令ずつ実行し、結果を比較する。@n
+			・全ての公式な命令（２４４）、レジスター、PC、SP、メモリーへの書き込み、@n
+			  ポート、割り込み許可 @n
+			・フラグは S、Z、CY を全ての命令で比較する。P、AC は、I8080 が Z80 と @n
+			  同じ規則で作る命令（算術演算の P はオーバーフロー、減算の AC は @n
+			  ハーフ・ボロー等）を除いて比較し、除いた違いの数を表示する @n
+			・F のビット１、３、５（I8080 では N、未使用、割り込み許可）は比較しない @n
+			・サイクル数は I8080 の表（Z80 に近い）なので比較しない @n
+			・プログラム（１６ビット乗算、BCD 加算）の結果を C の計算と比較 @n
+			・エミュレーションの速度（MHz）を、run()、runBlocks() で測る
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include "rx64m_SIDE/side/i8080.h"
+#include "rx64m_SIDE/side/i8080mem.h"
+
+namespace {
+
+	enum flag : uint8_t {
+		CY = 0x01,
+		P  = 0x04,
+		AC = 0x10,
+		Z  = 0x40,
+		S  = 0x80,
+		ALL = S | Z | AC | P | CY
+	};
+
+	unsigned char	mem_[0x10000];
+
+	struct write_t {
+		uint16_t	adr;
+		uint8_t		val;
+	};
+
+	// 書き込みの記録（メモリーは変えない、１命令で最大２バイト）
+	struct log_t {
+		write_t		w[2];
+		uint32_t	num;
+		uint32_t	port;
+		uint32_t	out;
+		void clear() { num = 0; port = 0xffff; out = 0; }
+		void write(unsigned adr, unsigned char val) {
+			if(num < 2) w[num] = write_t { static_cast<uint16_t>(adr & 0xffff), val };
+			++num;
+		}
+	};
+
+	uint8_t port_in_(unsigned port) { return (port * 7) ^ 0x5a; }
+
+
+	// I8080 の環境（メモリーは読むだけで、書き込みは記録する）
+	struct env {
+		log_t	log;
+		unsigned char readByte(unsigned addr) { return mem_[addr & 0xffff]; }
+		unsigned readWord(unsigned addr) { return readByte(addr) | (readByte(addr + 1) << 8); }
+		void writeByte(unsigned addr, unsigned char b) { log.write(addr, b); }
+		void writeWord(unsigned addr, unsigned value) {
+			writeByte(addr, value & 0xff);
+			writeByte(addr + 1, value >> 8);
+		}
+		unsigned char readPort(unsigned port) { return port_in_(port); }
+		void writePort(unsigned port, unsigned char value) { log.port = port; log.out = value; }
+	};
+
+	typedef I8080<env> cpu;
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  参照 8080（Intel 8080 Microcomputer Systems User's Manual）@n
+				HLT は、I8080 と同じく PC を HLT に留める
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ref_cpu {
+		uint8_t		r[8];	///< B、C、D、E、H、L、（M）、A
+		uint8_t		f;
+		uint16_t	pc;
+		uint16_t	sp;
+		bool		ie;
+		log_t		log;
+
+		enum { B, C, D, E, H, L, M, A };
+
+		uint8_t rd(uint16_t adr) const { return mem_[adr]; }
+		uint16_t rd16(uint16_t adr) const { return rd(adr) | (rd(adr + 1) << 8); }
+		void wr(uint16_t adr, uint8_t v) { log.write(adr, v); }
+		uint16_t hl() const { return (r[H] << 8) | r[L]; }
+		uint8_t fetch() { return rd(pc++); }
+		uint16_t fetch16() { uint16_t v = rd16(pc); pc += 2; return v; }
+
+		uint8_t get(uint32_t n) const { return n == M ? rd(hl()) : r[n]; }
+		void set(uint32_t n, uint8_t v) { if(n == M) wr(hl(), v); else r[n] = v; }
+
+		// rp: 0 BC、1 DE、2 HL、3 SP
+		uint16_t rp(uint32_t n) const {
+			if(n == 3) return sp;
+			return (r[n * 2] << 8) | r[n * 2 + 1];
+		}
+		void set_rp(uint32_t n, uint16_t v) {
+			if(n == 3) sp = v;
+			else {
+				r[n * 2] = v >> 8;
+				r[n * 2 + 1] = v;
+			}
+		}
+
+		void push(uint16_t v) {
+			sp -= 2;
+			wr(sp + 1, v >> 8);
+			wr(sp, v);
+		}
+		uint16_t pop() {
+			uint16_t v = rd16(sp);
+			sp += 2;
+			return v;
+		}
+
+		void szp(uint8_t v) {
+			uint32_t n = 0;
+			for(uint32_t b = v; b != 0; b >>= 1) n += b & 1;
+			f &= ~(S | Z | P);
+			if(v & 0x80) f |= S;
+			if(v == 0) f |= Z;
+			if((n & 1) == 0) f |= P;
+		}
+		void flag(uint8_t bit, bool on) { if(on) f |= bit; else f &= ~bit; }
+
+		bool cond(uint32_t c) const {
+			switch(c) {
+			case 0: return !(f & Z);
+			case 1: return f & Z;
+			case 2: return !(f & CY);
+			case 3: return f & CY;
+			case 4: return !(f & P);
+			case 5: return f & P;
+			case 6: return !(f & S);
+			default: return f & S;
+			}
+		}
+
+		// a + b + c（減算は補数の加算）
+		uint8_t add(uint8_t a, uint8_t b, uint32_t c) {
+			uint32_t x = a + b + c;
+			flag(AC, ((a & 0xf) + (b & 0xf) + c) > 0xf);
+			flag(CY, x > 0xff);
+			szp(x);
+			return x;
+		}
+
+		void alu(uint32_t op, uint8_t v) {
+			uint8_t& a = r[A];
+			switch(op) {
+			case 0: a = add(a, v, 0); break;							// ADD
+			case 1: a = add(a, v, (f & CY) ? 1 : 0); break;				// ADC
+			case 2: a = add(a, ~v, 1); f ^= CY; break;					// SUB
+			case 3: a = add(a, ~v, (f & CY) ? 0 : 1); f ^= CY; break;	// SBB
+			case 4:														// ANA
+				flag(AC, ((a | v) & 0x08) != 0);
+				a &= v;
+				f &= ~CY;
+				szp(a);
+				break;
+			case 5: a ^= v; f &= ~(CY | AC); szp(a); break;				// XRA
+			case 6: a |= v; f &= ~(CY | AC); szp(a); break;				// ORA
+			default: add(a, ~v, 1); f ^= CY; break;						// CMP
+			}
+		}
+
+		void daa() {
+			uint8_t a = r[A];
+			uint8_t corr = 0;
+			bool c = f & CY;
+			if((a & 0xf) > 9 || (f & AC)) corr |= 0x06;
+			if((a >> 4) > 9 || c || ((a >> 4) >= 9 && (a & 0xf) > 9)) {
+				corr |= 0x60;
+				c = true;
+			}
+			r[A] = add(a, corr, 0);
+			flag(CY, c);
+		}
+
+		void step() {
+			uint8_t op = fetch();
+			uint32_t ddd = (op >> 3) & 7;
+			uint32_t sss = op & 7;
+			uint32_t rpn = (op >> 4) & 3;
+			if(op == 0x76) {		// HLT
+				--pc;
+				return;
+			}
+			if((op & 0xc0) == 0x40) {
+				set(ddd, get(sss));
+				return;
+			}
+			if((op & 0xc0) == 0x80) {
+				alu(ddd, get(sss));
+				return;
+			}
+			if((op & 0xc0) == 0x00) {
+				switch(sss) {
+				case 0: return;		// NOP
+				case 1:
+					if(op & 8) {	// DAD
+						uint32_t x = hl() + rp(rpn);
+						flag(CY, x > 0xffff);
+						set_rp(2, x);
+					} else {		// LXI
+						set_rp(rpn, fetch16());
+					}
+					return;
+				case 2:
+					switch(op) {
+					case 0x02: case 0x12: wr(rp(rpn), r[A]); break;		// STAX
+					case 0x0a: case 0x1a: r[A] = rd(rp(rpn)); break;	// LDAX
+					case 0x22: {		// SHLD
+							uint16_t adr = fetch16();
+							wr(adr, r[L]);
+							wr(adr + 1, r[H]);
+						}
+						break;
+					case 0x2a: {		// LHLD
+							uint16_t adr = fetch16();
+							r[L] = rd(adr);
+							r[H] = rd(adr + 1);
+						}
+						break;
+					case 0x32: wr(fetch16(), r[A]); break;				// STA
+					default: r[A] = rd(fetch16()); break;				// LDA
+					}
+					return;
+				case 3: set_rp(rpn, rp(rpn) + ((op & 8) ? -1 : 1)); return;	// INX、DCX
+				case 4: {			// INR
+						uint8_t v = get(ddd);
+						flag(AC, (v & 0xf) == 0xf);
+						set(ddd, ++v);
+						szp(v);
+					}
+					return;
+				case 5: {			// DCR（v + 0xFF）
+						uint8_t v = get(ddd);
+						flag(AC, (v & 0xf) != 0);
+						set(ddd, --v);
+						szp(v);
+					}
+					return;
+				case 6: set(ddd, fetch()); return;	// MVI
+				default: {
+						uint8_t& a = r[A];
+						bool c = f & CY;
+						switch(ddd) {
+						case 0: flag(CY, a & 0x80); a = (a << 1) | (a >> 7); break;	// RLC
+						case 1: flag(CY, a & 1); a = (a >> 1) | (a << 7); break;	// RRC
+						case 2: flag(CY, a & 0x80); a = (a << 1) | c; break;		// RAL
+						case 3: flag(CY, a & 1); a = (a >> 1) | (c << 7); break;	// RAR
+						case 4: daa(); break;
+						case 5: a = ~a; break;			// CMA
+						case 6: f |= CY; break;			// STC
+						default: f ^= CY; break;		// CMC
+						}
+					}
+					return;
+				}
+			}
+			switch(sss) {
+			case 0: if(cond(ddd)) pc = pop(); return;		// Rcc
+			case 1:
+				switch(op) {
+				case 0xc9: pc = pop(); break;				// RET
+				case 0xe9: pc = hl(); break;				// PCHL
+				case 0xf9: sp = hl(); break;				// SPHL
+				case 0xf1: {								// POP PSW
+						uint16_t v = pop();
+						f = v & ALL;
+						r[A] = v >> 8;
+					}
+					break;
+				default: set_rp(rpn, pop()); break;			// POP
+				}
+				return;
+			case 2: {										// Jcc
+					uint16_t adr = fetch16();
+					if(cond(ddd)) pc = adr;
+				}
+				return;
+			case 3:
+				switch(op) {
+				case 0xc3: pc = fetch16(); break;			// JMP
+				case 0xd3: log.port = fetch(); log.out = r[A]; break;	// OUT
+				case 0xdb: r[A] = port_in_(fetch()); break;	// IN
+				case 0xe3: {								// XTHL
+						uint8_t l = rd(sp);
+						uint8_t h = rd(sp + 1);
+						wr(sp, r[L]);
+						wr(sp + 1, r[H]);
+						r[L] = l;
+						r[H] = h;
+					}
+					break;
+				case 0xeb: {								// XCHG
+						uint16_t t = rp(1);
+						set_rp(1, hl());
+						set_rp(2, t);
+					}
+					break;
+				case 0xf3: ie = false; break;				// DI
+				default: ie = true; break;					// EI
+				}
+				return;
+			case 4: {										// Ccc
+					uint16_t adr = fetch16();
+					if(cond(ddd)) {
+						push(pc);
+						pc = adr;
+					}
+				}
+				return;
+			case 5:
+				if(op == 0xcd) {							// CALL
+					uint16_t adr = fetch16();
+					push(pc);
+					pc = adr;
+				} else if(op == 0xf5) {						// PUSH PSW
+					push((r[A] << 8) | (f & ALL) | 0x02);
+				} else {
+					push(rp(rpn));
+				}
+				return;
+			case 6: alu(ddd, fetch()); return;
+			default: push(pc); pc = ddd * 8; return;		// RST
+			}
+		}
+	};
+
+
+	bool documented_(uint32_t op)
+	{
+		switch(op) {
+		case 0x08: case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+		case 0xcb: case 0xd9: case 0xdd: case 0xed: case 0xfd:
+			return false;
+		}
+		return true;
+	}
+
+
+	// I8080 が Z80 と同じ規則で作るフラグを除いた、比較するフラグ
+	uint8_t flag_mask_(uint32_t op)
+	{
+		uint32_t alu = (op & 0xc0) == 0x80 ? (op >> 3) & 7
+			: (op & 0xc7) == 0xc6 ? (op >> 3) & 7 : 8;
+		if(alu == 0 || alu == 1 || (op & 0xc7) == 0x04) return ALL & ~P;			// ADD、ADC、INR
+		if(alu == 2 || alu == 3 || alu == 7 || (op & 0xc7) == 0x05) return ALL & ~(P | AC);	// SUB、SBB、CMP、DCR
+		if(alu == 4) return ALL & ~AC;												// ANA
+		switch(op) {
+		case 0x07: case 0x0f: case 0x17: case 0x1f:	// RLC、RRC、RAL、RAR
+		case 0x27: case 0x2f:						// DAA、CMA
+		case 0x09: case 0x19: case 0x29: case 0x39:	// DAD
+			return ALL & ~AC;
+		}
+		return ALL;
+	}
+
+
+	int		bad_ = 0;
+	uint32_t	masked_[2];	///< 除いた違い（P、AC）
+
+	void report_(uint32_t op, const char* what, const cpu& c, const ref_cpu& r)
+	{
+		if(bad_ < 20) {
+			printf("NG %02X %s: AF %04X/%02X%02X BC %04X/%02X%02X DE %04X/%02X%02X HL %04X/%02X%02X"
+				" PC %04X/%04X SP %04X/%04X\n", op, what,
+				c.AF(), r.r[ref_cpu::A], r.f, c.BC(), r.r[0], r.r[1], c.DE(), r.r[2], r.r[3],
+				c.HL(), r.r[4], r.r[5], c.PC, r.pc, c.SP & 0xffff, r.sp);
+		}
+		++bad_;
+	}
+
+
+	// fadr: PUSH PSW のフラグを書くアドレス（他は 0x10000）
+	bool same_log_(const log_t& a, const log_t& b, uint32_t fadr, uint8_t fmask)
+	{
+		if(a.num != b.num || a.port != b.port || a.out != b.out) return false;
+		for(uint32_t i = 0; i < a.num; ++i) {
+			const write_t* w = nullptr;
+			for(uint32_t j = 0; j < b.num; ++j) {
+				if(b.w[j].adr == a.w[i].adr) w = &b.w[j];
+			}
+			if(w == nullptr) return false;
+			uint8_t m = 0xff;
+			if(a.w[i].adr == fadr) {
+				m = fmask;
+				if(((a.w[i].val ^ w->val) & ALL & ~fmask) != 0) ++masked_[0];
+			}
+			if(((a.w[i].val ^ w->val) & m) != 0) return false;
+		}
+		return true;
+	}
+
+
+	void exer_test_(uint32_t seed, uint32_t loops)
+	{
+		std::mt19937 rng(seed);
+		for(auto& m : mem_) m = rng();
+
+		env e;
+		cpu c(e);
+		ref_cpu r;
+		uint32_t num = 0;
+		for(uint32_t op = 0; op < 256; ++op) {
+			if(!documented_(op)) continue;
+			uint8_t fmask = flag_mask_(op);
+			for(uint32_t n = 0; n < loops; ++n) {
+				uint16_t pc = rng();
+				mem_[pc] = op;
+				for(uint32_t i = 0; i < 8; ++i) r.r[i] = rng();
+				r.f = rng();
+				r.pc = pc;
+				r.sp = rng();
+				// 小さいアドレスと、スタックのラップを時々
+				if((n & 15) == 0) r.r[4] = 0;
+				if((n & 31) == 1) r.sp = rng() & 3;
+				r.ie = (r.f & 0x20) != 0;
+				r.log.clear();
+
+				c.B = r.r[0]; c.C = r.r[1]; c.D = r.r[2]; c.E = r.r[3];
+				c.H = r.r[4]; c.L = r.r[5]; c.A = r.r[7]; c.F = r.f;
+				c.PC = r.pc;
+				c.SP = r.sp;
+				e.log.clear();
+
+				c.step();
+				r.step();
+				++num;
+
+				bool ok = c.A == r.r[7] && c.B == r.r[0] && c.C == r.r[1] && c.D == r.r[2]
+					&& c.E == r.r[3] && c.H == r.r[4] && c.L == r.r[5];
+				if(!ok) { report_(op, "register", c, r); continue; }
+				if(c.PC != r.pc || (c.SP & 0xffff) != r.sp) { report_(op, "PC/SP", c, r); continue; }
+				uint8_t d = (c.F ^ r.f) & ALL;
+				if((d & fmask) != 0) { report_(op, "flags", c, r); continue; }
+				if(d & P) ++masked_[0];
+				if(d & AC) ++masked_[1];
+				// POP PSW は、I8080 では割り込み許可（F のビット５）も戻す
+				if(op != 0xf1 && ((c.F & 0x20) != 0) != r.ie) { report_(op, "interrupt enable", c, r); continue; }
+				uint32_t fadr = op == 0xf5 ? r.sp : 0x10000;
+				if(!same_log_(e.log, r.log, fadr, fmask)) { report_(op, "memory/port", c, r); continue; }
+			}
+		}
+		printf("  exerciser: %u instructions (%u cases each), Z80 style flags: P %u, AC %u\n",
+			num, loops, masked_[0], masked_[1]);
+	}
+
+
+	// ＲＡＭ だけの環境で、HLT まで実行
+	struct ram_env : public I8080Memory {
+		unsigned char readPort(unsigned port) { return 0; }
+		void writePort(unsigned port, unsigned char value) { }
+	};
+
+	unsigned char	ram_[0x10000];
+
+	void load_(uint16_t org, const uint8_t* src, uint32_t len)
+	{
+		std::memcpy(&ram_[org], src, len);
+	}
+
+	// 0100: 16 ビット乗算（HL = [2000] × [2002]、シフトと加算）
+	const uint8_t mul_prog_[] = {
+		0x31, 0x00, 0xF0,		// LXI  SP,F000
+		0x2A, 0x00, 0x20,		// LHLD 2000
+		0xEB,					// XCHG
+		0x21, 0x00, 0x00,		// LXI  H,0
+		0x3E, 0x10,				// MVI  A,16
+		0x32, 0x06, 0x20,		// STA  2006
+		0x29,					// 010F: DAD  H
+		0x3A, 0x02, 0x20,		// LDA  2002
+		0x87,					// ADD  A
+		0x32, 0x02, 0x20,		// STA  2002
+		0x3A, 0x03, 0x20,		// LDA  2003
+		0x8F,					// ADC  A
+		0x32, 0x03, 0x20,		// STA  2003
+		0xD2, 0x22, 0x01,		// JNC  0122
+		0x19,					// DAD  D
+		0x3A, 0x06, 0x20,		// 0122: LDA  2006
+		0x3D,					// DCR  A
+		0x32, 0x06, 0x20,		// STA  2006
+		0xC2, 0x0F, 0x01,		// JNZ  010F
+		0x22, 0x08, 0x20,		// SHLD 2008
+		0x76					// HLT
+	};
+
+	// 0200: BCD 加算（[2018] = [2010] + [2014]、４バイト、下位から）
+	const uint8_t bcd_prog_[] = {
+		0x21, 0x10, 0x20,		// LXI  H,2010
+		0x11, 0x14, 0x20,		// LXI  D,2014
+		0x01, 0x18, 0x20,		// LXI  B,2018
+		0x3E, 0x04,				// MVI  A,4
+		0x32, 0x1C, 0x20,		// STA  201C
+		0xB7,					// ORA  A
+		0x1A,					// 020F: LDAX D
+		0x8E,					// ADC  M
+		0x27,					// DAA
+		0x02,					// STAX B
+		0x23,					// INX  H
+		0x13,					// INX  D
+		0x03,					// INX  B
+		0x3A, 0x1C, 0x20,		// LDA  201C
+		0x3D,					// DCR  A
+		0x32, 0x1C, 0x20,		// STA  201C
+		0xC2, 0x0F, 0x02,		// JNZ  020F
+		0x76					// HLT
+	};
+
+	uint32_t to_bcd_(uint32_t v)
+	{
+		uint32_t b = 0;
+		for(uint32_t i = 0; i < 8; ++i) {
+			b |= (v % 10) << (i * 4);
+			v /= 10;
+		}
+		return b;
+	}
+
+	void put32_(uint16_t adr, uint32_t v)
+	{
+		for(uint32_t i = 0; i < 4; ++i) ram_[adr + i] = v >> (i * 8);
+	}
+
+	uint32_t get32_(uint16_t adr)
+	{
+		uint32_t v = 0;
+		for(uint32_t i = 0; i < 4; ++i) v |= ram_[adr + i] << (i * 8);
+		return v;
+	}
+
+
+	void prog_test_(uint32_t seed, uint32_t loops)
+	{
+		std::mt19937 rng(seed);
+		static ram_env e;
+		e.mapRAM(0, 0x10000, ram_);
+		I8080<ram_env> c(e);
+		load_(0x0100, mul_prog_, sizeof(mul_prog_));
+		load_(0x0200, bcd_prog_, sizeof(bcd_prog_));
+		uint32_t err = 0;
+		for(uint32_t n = 0; n < loops; ++n) {
+			uint16_t a = rng();
+			uint16_t b = rng();
+			ram_[0x2000] = a; ram_[0x2001] = a >> 8;
+			ram_[0x2002] = b; ram_[0x2003] = b >> 8;
+			c.reset();
+			c.PC = 0x0100;
+			c.run(100000);
+			uint16_t m = ram_[0x2008] | (ram_[0x2009] << 8);
+			if(m != static_cast<uint16_t>(a * b)) ++err;
+
+			uint32_t x = rng() % 100000000;
+			uint32_t y = rng() % 100000000;
+			put32_(0x2010, to_bcd_(x));
+			put32_(0x2014, to_bcd_(y));
+			c.reset();
+			c.PC = 0x0200;
+			c.run(100000);
+			if(get32_(0x2018) != to_bcd_(x + y) || ((c.F & CY) != 0) != ((x + y) >= 100000000)) {
+				if(err < 5) printf("NG BCD %08u + %08u: %08X\n", x, y, get32_(0x2018));
+				++err;
+			}
+		}
+		if(err) {
+			printf("NG programs: %u errors\n", err);
+			++bad_;
+		}
+		printf("  programs: %u multiplies, %u BCD additions\n", loops, loops);
+	}
+
+
+	// 0000: メモリーの加算を繰り返す
+	const uint8_t bench_prog_[] = {
+		0x21, 0x00, 0x40,		// LXI  H,4000
+		0x11, 0x00, 0x60,		// LXI  D,6000
+		0x01, 0x00, 0x10,		// LXI  B,1000
+		0x1A,					// 0009: LDAX D
+		0x86,					// ADD  M
+		0x77,					// MOV  M,A
+		0x23,					// INX  H
+		0x13,					// INX  D
+		0x0B,					// DCX  B
+		0x78,					// MOV  A,B
+		0xB1,					// ORA  C
+		0xC2, 0x09, 0x00,		// JNZ  0009
+		0xCD, 0x00, 0x01,		// CALL 0100（乗算、HLT の代わりに RET）
+		0xC3, 0x00, 0x00,		// JMP  0000
+	};
+
+	void bench_(uint32_t cycles)
+	{
+		static ram_env e;
+		e.mapRAM(0, 0x10000, ram_);
+		std::memset(ram_, 0, sizeof(ram_));
+		load_(0x0000, bench_prog_, sizeof(bench_prog_));
+		load_(0x0100, mul_prog_, sizeof(mul_prog_));
+		ram_[0x0100 + sizeof(mul_prog_) - 1] = 0xC9;  // RET
+		ram_[0x0100] = 0x00;  // LXI SP を使わない
+		ram_[0x0101] = 0x00;
+		ram_[0x0102] = 0x00;
+		static I8080<ram_env>::Block blocks[1024];
+		for(int mode = 0; mode < 2; ++mode) {
+			I8080<ram_env> c(e);
+			c.SP = 0xF000;
+			if(mode) c.setBlocks(blocks, 1024);
+			auto t = std::chrono::steady_clock::now();
+			for(uint32_t n = 0; n < cycles; n += 33333) {
+				c.runBlocks(33333);  // Space Invaders の１割り込み分
+				c.setCycles(c.getCycles() - 33333);
+			}
+			double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+			double mhz = cycles / sec / 1e6;
+			printf("  %-10s %7.1f MHz (%.0fx of the 2 MHz 8080)\n", mode ? "runBlocks" : "run", mhz,
+				mhz / 2.0);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+
+	printf("i8080_exer: seed %u\n", seed);
+	exer_test_(seed, 4000);
+	prog_test_(seed, 2000);
+	bench_(400000000);
+
+	printf("i8080_exer: errors %d\n", bad_);
+	return bad_ != 0;
+}
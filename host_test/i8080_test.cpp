@@ -0,0 +1,135 @@
+//=====================================================================//
+/*!	@file
+	@brief	I8080 の実行テスト（ホスト） @n
+			runBlocks()（プリデコード）と run() を、同じメモリーで並べて @n
+			実行し、レジスター、サイクル、メモリーが一致する事を確かめる。@n
+			・ROM の大きさ（０、8K、64K）を変え、RAM 上のコードも実行する @n
+			・割り込み、外からのメモリー変更（flushBlocks()）@n
+			・自己書き換えコード
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "rx64m_SIDE/side/i8080.h"
+#include "rx64m_SIDE/side/i8080mem.h"
+
+namespace {
+
+	struct env : public I8080Memory {
+		unsigned char readPort(unsigned port) { return port * 3; }
+		void writePort(unsigned port, unsigned char value) { }
+	};
+
+	typedef I8080<env> cpu;
+
+	unsigned char	mem_[2][0x10000];
+	cpu::Block		blocks_[1024];
+
+	bool same_(const cpu& a, const cpu& b)
+	{
+		return a.AF() == b.AF() && a.BC() == b.BC() && a.DE() == b.DE() && a.HL() == b.HL()
+			&& a.PC == b.PC && a.SP == b.SP && a.getCycles() == b.getCycles();
+	}
+
+
+	// ランダムなメモリー（命令）を、run() と runBlocks() で実行して比較
+	int lockstep_test_(uint32_t seed, unsigned romsize)
+	{
+		std::mt19937 rng(seed);
+		for(unsigned i = 0; i < 0x10000; ++i) {
+			mem_[0][i] = mem_[1][i] = rng();
+		}
+
+		static env e[2];
+		for(int i = 0; i < 2; ++i) {
+			e[i].unmap(0, 0x10000);
+			e[i].mapROM(0, romsize, mem_[i]);
+			e[i].mapRAM(romsize, 0x10000 - romsize, &mem_[i][romsize]);
+		}
+		cpu a(e[0]);
+		cpu b(e[1]);
+		b.setBlocks(blocks_, sizeof(blocks_) / sizeof(blocks_[0]));
+
+		for(int k = 0; k < 5000; ++k) {
+			unsigned lim = 100 + rng() % 20000;
+			a.run(lim);
+			b.runBlocks(lim);
+			if(!same_(a, b)) {
+				printf("NG rom %x chunk %d: PC %04X/%04X, cycles %u/%u\n",
+					romsize, k, a.PC, b.PC, a.getCycles(), b.getCycles());
+				return 1;
+			}
+			a.setCycles(a.getCycles() - lim);
+			b.setCycles(b.getCycles() - lim);
+			unsigned irq = (k & 1) ? 0x10 : 0x08;
+			a.interrupt(irq);
+			b.interrupt(irq);
+			// CPU の外からの書き込み（DMA 等）
+			if((k % 997) == 0 && romsize < 0x10000) {
+				unsigned adr = romsize + rng() % (0x10000 - romsize);
+				mem_[0][adr] = mem_[1][adr] = rng();
+				b.flushBlocks();
+			}
+		}
+		if(memcmp(mem_[0], mem_[1], sizeof(mem_[0])) != 0) {
+			printf("NG rom %x: memory\n", romsize);
+			return 1;
+		}
+		return 0;
+	}
+
+
+	// 自分の即値を書き換えるループ
+	int smc_test_()
+	{
+		// 3000: LDA 3008; XRI 08; STA 3008; INR B; JMP 3000
+		static const unsigned char prog[] = {
+			0x3A, 0x08, 0x30, 0xEE, 0x08, 0x32, 0x08, 0x30, 0x04, 0xC3, 0x00, 0x30
+		};
+		unsigned res[2][3];
+		for(int mode = 0; mode < 2; ++mode) {
+			memset(mem_[mode], 0, sizeof(mem_[mode]));
+			memcpy(&mem_[mode][0x3000], prog, sizeof(prog));
+			static env e;
+			e.mapRAM(0, 0x10000, mem_[mode]);
+			cpu c(e);
+			if(mode) c.setBlocks(blocks_, 256);
+			c.PC = 0x3000;
+			for(int i = 0; i < 1000; ++i) {
+				c.runBlocks(1001);
+				c.setCycles(c.getCycles() - 1001);
+			}
+			res[mode][0] = c.B;
+			res[mode][1] = c.C;
+			res[mode][2] = c.getCycles();
+		}
+		if(memcmp(res[0], res[1], sizeof(res[0])) != 0) {
+			printf("NG self-modifying: B %u/%u, cycles %u/%u\n",
+				res[0][0], res[1][0], res[0][2], res[1][2]);
+			return 1;
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+
+	int bad = 0;
+	static const unsigned romsize[] = { 0x2000, 0x10000, 0 };
+	for(auto size : romsize) {
+		bad += lockstep_test_(seed++, size);
+	}
+	bad += smc_test_();
+
+	printf("i8080: seed %u, errors %d\n", seed - 3, bad);
+	return bad != 0;
+}
@@ -0,0 +1,135 @@
+//=====================================================================//
+/*!	@file
+	@brief	log_man のテスト（ホスト） @n
+			・write、puts はすぐに、putch は改行で書き込まれる事 @n
+			・書き込みの途中で電源を落としても、ログが壊れない事 @n
+			  （先頭の行が欠けるのは可、それ以外の行は完全である事）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include "common/log_man.hpp"
+
+namespace {
+
+	// バックアップ・メモリーの模擬（budget バイト書くと電源断）
+	struct mem_sim {
+		static const uint32_t SIZE = 256;
+		static uint8_t	mem_[SIZE];
+		static long		budget_;
+
+		static void start() { }
+
+		static uint32_t copy(const void* src, uint32_t len, uint32_t dst) {
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(uint32_t i = 0; i < len; ++i) {
+				if(budget_ == 0) return i;
+				if(budget_ > 0) --budget_;
+				mem_[dst + i] = p[i];
+			}
+			return len;
+		}
+
+		static uint32_t copy(uint32_t src, uint32_t len, void* dst) {
+			std::memcpy(dst, &mem_[src], len);
+			return len;
+		}
+	};
+	uint8_t mem_sim::mem_[mem_sim::SIZE];
+	long mem_sim::budget_ = -1;
+
+	typedef utils::log_man<mem_sim> LOG_MAN;
+
+	// 再起動した時に見えるログ
+	std::string reboot_()
+	{
+		LOG_MAN l;
+		l.start();
+		std::string s;
+		for(uint32_t i = 0; i < l.get_length(); ++i) s += l.getch(i);
+		return s;
+	}
+
+	int commit_test_()
+	{
+		int bad = 0;
+		LOG_MAN l;
+		l.clear();
+		l.write("abc", 3);
+		if(reboot_() != "abc") { printf("write: not committed\n"); ++bad; }
+		l.puts("def");
+		if(reboot_() != "abcdef") { printf("puts: not committed\n"); ++bad; }
+		l.putch('g');
+		if(reboot_() != "abcdef") { printf("putch: committed before LF\n"); ++bad; }
+		l.puts("h");
+		if(reboot_() != "abcdefgh") { printf("puts: putch data not committed\n"); ++bad; }
+		l.putch('i');
+		l.putch('\n');
+		if(reboot_() != "abcdefghi\n") { printf("putch: LF not committed\n"); ++bad; }
+		return bad;
+	}
+
+	int power_test_(uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		int bad = 0;
+		for(int t = 0; t < 20000; ++t) {
+			mem_sim::budget_ = -1;
+			LOG_MAN l;
+			l.start();
+			// 全ての行は "<t>:xxxx\n" の形
+			mem_sim::budget_ = rng() % 2000;
+			for(int k = 0; k < 40 && mem_sim::budget_ != 0; ++k) {
+				std::string s = std::to_string(t) + ':' + std::string(rng() % 30, 'a' + k % 26) + '\n';
+				switch(rng() % 3) {
+				case 0:
+					l.write(s.c_str(), s.size());
+					break;
+				case 1:
+					l.puts(s.c_str());
+					break;
+				default:
+					for(auto ch : s) l.putch(ch);
+					break;
+				}
+			}
+			mem_sim::budget_ = -1;
+			std::string s = reboot_();
+			size_t q = s.find('\n');
+			if(q == std::string::npos) continue;
+			++q;
+			while(q < s.size()) {
+				size_t e = s.find('\n', q);
+				size_t c = s.find(':', q);
+				bool ok = e != std::string::npos && c < e;
+				for(size_t i = c + 1; ok && i < e; ++i) {
+					if(s[i] != s[c + 1]) ok = false;
+				}
+				if(!ok) {
+					printf("broken line: %d\n", t);
+					++bad;
+					break;
+				}
+				q = e + 1;
+			}
+		}
+		return bad;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 3;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+
+	int bad = commit_test_();
+	bad += power_test_(seed);
+	printf("log_man: seed %u, errors %d\n", seed, bad);
+	return bad != 0;
+}
@@ -0,0 +1,140 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RAM ディスク（ホスト） @n
+			FatFs の diskio をメモリー上のディスク・イメージで実装する。@n
+			コマンド数、セクター数を数え、SD カードの転送を見積もる。@n
+			※FatFs（ff.c）とリンクする、一つのテストでだけインクルードする事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "ff12b/src/diskio.h"
+#include "ff12b/src/ff.h"
+
+namespace host {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	RAM ディスク・クラス（１６M バイト、FAT16）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ram_disk {
+		static const uint32_t SECTORS = 32768;
+		static const uint32_t CLUSTER = 4;		///< クラスターのセクター数
+		static const uint32_t FAT_SIZE = 33;	///< FAT のセクター数
+		static const uint32_t ROOT_ENT = 512;
+
+		uint8_t		image[SECTORS * 512];
+
+		uint32_t	rd_cmd;		///< 読み出しコマンド数
+		uint32_t	rd_sec;		///< 読み出しセクター数
+		uint32_t	wr_cmd;		///< 書き込みコマンド数
+		uint32_t	wr_sec;		///< 書き込みセクター数
+
+		void clear_count() { rd_cmd = rd_sec = wr_cmd = wr_sec = 0; }
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	フォーマット（区画無し、FAT16）
+		*/
+		//-------------------------------------------------------------//
+		void format() {
+			memset(image, 0, sizeof(image));
+			uint8_t* bs = image;
+			static const uint8_t jmp[] = { 0xEB, 0x3C, 0x90 };
+			memcpy(&bs[0], jmp, 3);
+			memcpy(&bs[3], "MSDOS5.0", 8);
+			set16_(&bs[11], 512);
+			bs[13] = CLUSTER;
+			set16_(&bs[14], 1);			// 予約セクター
+			bs[16] = 2;					// FAT の数
+			set16_(&bs[17], ROOT_ENT);
+			set16_(&bs[19], 0);
+			bs[21] = 0xF8;
+			set16_(&bs[22], FAT_SIZE);
+			set16_(&bs[24], 63);
+			set16_(&bs[26], 255);
+			set32_(&bs[32], SECTORS);
+			bs[36] = 0x80;
+			bs[38] = 0x29;
+			set32_(&bs[39], 0x12345678);
+			memcpy(&bs[43], "HOST       ", 11);
+			memcpy(&bs[54], "FAT16   ", 8);
+			bs[510] = 0x55;
+			bs[511] = 0xAA;
+			for(uint32_t i = 0; i < 2; ++i) {
+				uint8_t* fat = &image[(1 + i * FAT_SIZE) * 512];
+				set16_(&fat[0], 0xFFF8);
+				set16_(&fat[2], 0xFFFF);
+			}
+			clear_count();
+		}
+
+	private:
+		static void set16_(uint8_t* p, uint32_t v) {
+			p[0] = v;
+			p[1] = v >> 8;
+		}
+
+		static void set32_(uint8_t* p, uint32_t v) {
+			set16_(p, v);
+			set16_(p + 2, v >> 16);
+		}
+	};
+
+	ram_disk	disk_;
+}
+
+extern "C" {
+
+	DSTATUS disk_initialize(BYTE pdrv) { return 0; }
+
+	DSTATUS disk_status(BYTE pdrv) { return 0; }
+
+	DRESULT disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+	{
+		if(sector + count > host::ram_disk::SECTORS) return RES_PARERR;
+		memcpy(buff, &host::disk_.image[sector * 512], count * 512);
+		++host::disk_.rd_cmd;
+		host::disk_.rd_sec += count;
+		return RES_OK;
+	}
+
+	DRESULT disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+	{
+		if(sector + count > host::ram_disk::SECTORS) return RES_PARERR;
+		memcpy(&host::disk_.image[sector * 512], buff, count * 512);
+		++host::disk_.wr_cmd;
+		host::disk_.wr_sec += count;
+		return RES_OK;
+	}
+
+	DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+	{
+		switch(cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+		case GET_SECTOR_COUNT:
+			*static_cast<DWORD*>(buff) = host::ram_disk::SECTORS;
+			return RES_OK;
+		case GET_SECTOR_SIZE:
+			*static_cast<WORD*>(buff) = 512;
+			return RES_OK;
+		case GET_BLOCK_SIZE:
+			*static_cast<DWORD*>(buff) = 1;
+			return RES_OK;
+		default:
+			return RES_PARERR;
+		}
+	}
+
+	DWORD get_fattime(void)
+	{
+		return (37UL << 25) | (1UL << 21) | (1UL << 16);	// 2017/01/01 00:00:00
+	}
+}
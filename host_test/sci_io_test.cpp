@@ -0,0 +1,291 @@
+//=====================================================================//
+/*!	@file
+	@brief	sci_io の送受信テスト（ホスト） @n
+			common/sci_io.hpp（RX64M）を、SCI、DTC の模擬（sci_sim.hpp）で動かす。@n
+			・DTC 送信は、送信バッファの連続領域毎の転送で、CPU の割り込みは @n
+			  ブロック毎（リングの終端で分かれる）@n
+			・送信バッファが一杯の場合、ブロック・モードでは空くまで待ち、@n
+			  ノン・ブロック・モードでは捨てて、捨てた数を数える @n
+			・送信したデータが、書き込んだデータ（CR 自動送出を含む）と一致する事 @n
+			・DTC 受信は、受信バッファ一周毎に CPU に割り込み、データが連続する事 @n
+			・一周の割り込みから DTC の再起動までの間に受信しても失わない事 @n
+			・DTC が終端に達し、一周の割り込みの前に読み出しても正しい事 @n
+			・読み出しが一周以上遅れた場合は、オーバーランとして数える事 @n
+			・ボーレート毎の割り込みの頻度（割り込み毎の受信数から見積もる）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#define SIG_RX64M
+#define F_PCLKB 60000000
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "sci_sim.hpp"
+#include "common/fifo.hpp"
+#include "common/sci_io.hpp"
+
+namespace {
+
+	typedef utils::fifo<uint16_t, 256> buffer;
+	typedef device::sci_io<host::sim_sci, buffer, buffer> SCI_IO;
+
+	int		bad_ = 0;
+
+	void check_(bool ok, const char* what)
+	{
+		if(ok) return;
+		if(bad_ < 10) printf("NG %s\n", what);
+		++bad_;
+	}
+
+	// 送信の終了を待つ（送信が止まった場合は「false」）
+	bool drain_(SCI_IO& sci)
+	{
+		uint32_t num = host::sim_.tx_num;
+		uint32_t t = host::sim_.slots;
+		while(sci.send_length() > 0 || !host::sim_.tend()) {
+			if(num != host::sim_.tx_num) {
+				num = host::sim_.tx_num;
+				t = host::sim_.slots;
+			} else if((host::sim_.slots - t) > 10000) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool same_(const std::string& ref)
+	{
+		if(host::sim_.tx_num != ref.size()) return false;
+		return std::memcmp(host::sim_.tx_log, ref.data(), ref.size()) == 0;
+	}
+
+	// 改行を含むランダムなデータ
+	std::string make_(std::mt19937& rng, uint32_t len)
+	{
+		std::string s;
+		for(uint32_t i = 0; i < len; ++i) {
+			uint32_t r = rng();
+			s += (r % 23) == 0 ? '\n' : static_cast<char>(' ' + (r >> 8) % 95);
+		}
+		return s;
+	}
+
+
+	void block_test_(uint32_t seed, bool dtc, uint32_t writes)
+	{
+		std::mt19937 rng(seed);
+		host::sim_.reset();
+		SCI_IO sci;
+		sci.start(115200, 1, dtc);
+		host::sim_.start();
+
+		std::string ref;
+		uint32_t total = 0;
+		for(uint32_t i = 0; i < writes; ++i) {
+			uint32_t len = 1 + rng() % 700;  // バッファ（２５５）より長い場合がある
+			std::string s = make_(rng, len);
+			uint32_t n = sci.write(s.data(), len);
+			check_(n == len, "block write length");
+			for(char ch : s) {
+				if(ch == '\n') ref += '\r';
+				ref += ch;
+			}
+			total += len;
+		}
+		check_(drain_(sci), "block stall");
+		host::sim_.stop();
+
+		check_(same_(ref), dtc ? "DTC block data" : "block data");
+		check_(sci.get_send_drop() == 0, "block drop");
+		if(dtc) {
+			// CPU の割り込みは、DTC のブロック毎（空になった時も同じ割り込み）
+			check_(host::sim_.tx_isr == host::sim_.tx_block, "DTC interrupt per block");
+			check_(host::sim_.tx_dtc + host::sim_.tx_block >= ref.size() / 2, "DTC transfer");
+		} else {
+			check_(host::sim_.tx_isr + 1 >= ref.size() / 2, "interrupt per byte");
+		}
+		printf("  %-4s block:     %7u bytes, %5u blocks, %7u interrupts (%.1f bytes/interrupt)\n",
+			dtc ? "DTC" : "CPU", static_cast<uint32_t>(ref.size()), host::sim_.tx_block,
+			host::sim_.tx_isr, static_cast<double>(ref.size()) / host::sim_.tx_isr);
+	}
+
+
+	void drop_test_(uint32_t seed, bool dtc, uint32_t writes)
+	{
+		std::mt19937 rng(seed);
+		host::sim_.reset();
+		SCI_IO sci(false);
+		sci.start(115200, 1, dtc);
+		sci.set_send_block(false);
+		host::sim_.start();
+
+		std::string ref;
+		uint32_t drop = 0;
+		uint32_t part = 0;
+		for(uint32_t i = 0; i < writes; ++i) {
+			uint32_t len = 1 + rng() % 100;
+			std::string s = make_(rng, len);
+			uint32_t n = sci.write(s.data(), len);
+			check_(n <= len, "non-block write length");
+			ref.append(s, 0, n);
+			drop += len - n;
+			if(n > 0 && n < len) ++part;
+		}
+		check_(drain_(sci), "non-block stall");
+		host::sim_.stop();
+
+		check_(same_(ref), dtc ? "DTC non-block data" : "non-block data");
+		check_(sci.get_send_drop() == drop, "non-block drop count");
+		check_(drop > 0, "non-block no drop");
+		printf("  %-4s non-block: %7u bytes, %7u dropped (%u partial writes)\n",
+			dtc ? "DTC" : "CPU", static_cast<uint32_t>(ref.size()), drop, part);
+	}
+
+
+	uint32_t notify_;
+	void notify_task_() { ++notify_; }
+
+	uint32_t inject_;
+	// 一周の割り込みの中（DTC を再起動する前）で、次のデータが届く
+	void inject_task_(device::ICU::VECTOR vec)
+	{
+		if(!host::sim_.in_isr || vec != device::ICU::VECTOR::RXI0) return;
+		if(host::sim_.rx_seq >= host::sim_.rx_end) return;
+		host::sim_.arrive();
+		++inject_;
+	}
+
+	struct recv_t {
+		uint32_t	bytes;		///< 受信した数
+		uint32_t	gaps;		///< データの不連続
+		uint32_t	isr;		///< CPU の割り込み数
+	};
+
+	// 受信して、連番（下位８ビット）が続いているか調べる
+	// stall: 途中で読み出しを止める文字時間
+	recv_t recv_run_(bool dtc, uint32_t num, uint32_t stall, bool inject, SCI_IO& sci,
+		bool hold = false)
+	{
+		host::sim_.reset();
+		host::sim_.rx_hold = hold;
+		notify_ = 0;
+		inject_ = 0;
+		sci.start(115200, 1, false, dtc);
+		sci.set_recv_notify(notify_task_);
+		if(inject) host::sci_sim::DTC_MGR::enable_hook_ = inject_task_;
+		host::sim_.rx_end = num;
+		host::sim_.start();
+
+		recv_t r = { 0, 0, 0 };
+		uint8_t next = 0;
+		bool stop = stall > 0;
+		while(1) {
+			if(stop && host::sim_.rx_seq > num / 2) {
+				uint32_t t = host::sim_.slots;
+				while((host::sim_.slots - t) < stall) ;
+				stop = false;
+			}
+			bool end = host::sim_.rx_seq >= host::sim_.rx_end;
+			char tmp[64];
+			uint32_t n = sci.recv(tmp, sizeof(tmp));
+			for(uint32_t i = 0; i < n; ++i) {
+				if(static_cast<uint8_t>(tmp[i]) != next) ++r.gaps;
+				next = tmp[i] + 1;
+			}
+			r.bytes += n;
+			if(n == 0 && end) break;
+		}
+		host::sim_.stop();
+		r.isr = host::sim_.rx_isr;
+		sci.set_recv_notify(nullptr);
+		return r;
+	}
+
+
+	void recv_test_(uint32_t num)
+	{
+		SCI_IO sci;
+		{
+			auto r = recv_run_(true, num, 0, false, sci);
+			check_(r.bytes == num && r.gaps == 0, "DTC recv data");
+			check_(sci.get_recv_overrun() == 0, "DTC recv overrun");
+			check_(r.isr == host::sim_.rx_block && notify_ == r.isr, "DTC interrupt per lap");
+			check_(r.isr == num / 256, "DTC laps");
+			printf("  DTC  recv:      %7u bytes, %5u laps, %7u interrupts\n", r.bytes,
+				host::sim_.rx_block, r.isr);
+		}
+		{
+			auto r = recv_run_(true, num, 0, true, sci);
+			check_(inject_ > 0, "DTC recv inject");
+			check_(r.bytes == num && r.gaps == 0, "DTC recv data (byte before re-arm)");
+			check_(sci.get_recv_overrun() == 0 && host::sim_.rx_orer == 0,
+				"DTC recv overrun (byte before re-arm)");
+			printf("  DTC  re-arm:    %7u bytes, %5u bytes before re-arm, %u overrun\n",
+				r.bytes, inject_, sci.get_recv_overrun());
+		}
+		{
+			auto r = recv_run_(true, num, 0, false, sci, true);
+			check_(r.bytes == num && r.gaps == 0, "DTC recv data (lap end before interrupt)");
+			check_(sci.get_recv_overrun() == 0, "DTC recv overrun (lap end before interrupt)");
+			printf("  DTC  lap end:   %7u bytes, %5u laps with the interrupt held, %u overrun\n",
+				r.bytes, host::sim_.rx_block, sci.get_recv_overrun());
+		}
+		{
+			auto r = recv_run_(true, num, 256 * 3, false, sci);
+			uint32_t ovr = sci.get_recv_overrun();
+			check_(ovr > 0 && r.bytes < num, "DTC recv stall overrun");
+			check_(r.gaps <= ovr, "DTC recv stall data");
+			printf("  DTC  stall:     %7u bytes, %5u lost, %u overrun, %u gaps\n",
+				r.bytes, num - r.bytes, ovr, r.gaps);
+		}
+		{
+			auto r = recv_run_(false, num, 0, false, sci);
+			check_(r.bytes == num && r.gaps == 0, "recv data");
+			check_(r.isr == num, "interrupt per byte");
+			printf("  CPU  recv:      %7u bytes, %7u interrupts\n", r.bytes, r.isr);
+		}
+	}
+
+
+	// 割り込みの頻度（割り込み毎の受信数は模擬の結果から）
+	void load_bench_(uint32_t num)
+	{
+		SCI_IO sci;
+		auto cpu = recv_run_(false, num, 0, false, sci);
+		auto dtc = recv_run_(true, num, 0, false, sci);
+		static const uint32_t iclk = 120000000;
+		static const uint32_t baud[] = { 115200, 921600, 3000000, 6000000 };
+		printf("  receive interrupt load (ICLK %u MHz, 8N1, buffer 256):\n", iclk / 1000000);
+		printf("      baud   CPU irq/s  cycles/irq   DTC irq/s  cycles/irq  lap (us)\n");
+		for(uint32_t b : baud) {
+			double cps = b / 10.0;
+			double ci = cps * cpu.isr / cpu.bytes;
+			double di = cps * dtc.isr / dtc.bytes;
+			printf("  %8u  %10.0f  %10.0f  %10.0f  %10.0f  %8.1f\n", b, ci, iclk / ci, di, iclk / di,
+				256 * 1e6 / cps);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+
+	printf("sci_io: seed %u (send buffer 255, %u chars per 50 us)\n", seed, 8);
+	block_test_(seed, true, 400);
+	block_test_(seed, false, 100);
+	drop_test_(seed, true, 100000);
+	drop_test_(seed, false, 100000);
+	recv_test_(200000);
+	load_bench_(100000);
+
+	printf("sci_io: errors %d\n", bad_);
+	return bad_ != 0;
+}
@@ -0,0 +1,479 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SCI、DTC の模擬（ホスト） @n
+			common/sci_io.hpp の SCI クラスとして使い、RX64M の SCI（TDR、TSR、@n
+			RDR、TXI、RXI）と DTC のノーマル転送（転送回数、転送元、転送先）を @n
+			模擬する。@n
+			・時間は「文字時間」単位で進め、インターバル・タイマー（SIGALRM）@n
+			  の割り込み毎に chars 文字分進める（メインのループを割り込む為）@n
+			・割り込みは遅れ無しで受け付け、割り込み関数は割り込みの中で呼ぶ @n
+			・TXI は TDR から TSR への転送と、TDR が空の時の TIE の 0 -> 1 で発生 @n
+			・DTCE が「１」なら要求は DTC が受け付け、転送回数が「０」になると @n
+			  DTCE をクリアして、CPU に割り込む @n
+			・rx_hold が「true」なら、DTC 受信の終了の割り込みを次のタイマー割り込み @n
+			  まで遅らせる（DTC が終端に達し、割り込みの前の状態をメインから見る）@n
+			・レジスターの操作中のタイマー割り込みは、操作の後で処理する @n
+			・送受信が IDLE_LIMIT 文字時間止まるか、送信が LOG_SIZE を超えたら、@n
+			  テストを止める（ドライバーの待ちループから戻れない為）@n
+			※一つのテストでだけインクルードする事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <csignal>
+#include <sys/time.h>
+#include <unistd.h>
+#include "common/renesas.hpp"
+
+namespace host {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	SCI、DTC の模擬クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct sci_sim {
+		typedef device::dtc_mgr<device::DTC> DTC_MGR;
+
+		static const uint32_t LOG_SIZE = 1 << 20;	///< 送信ログのサイズ
+		static const uint32_t IDLE_LIMIT = 1000000;	///< 送受信が止まった判定
+		static const uint32_t TDR_ADR = 0x0008A003;	///< SCI0.TDR
+		static const uint32_t RDR_ADR = 0x0008A005;	///< SCI0.RDR
+		static const uint32_t RXI = static_cast<uint32_t>(device::ICU::VECTOR::RXI0);
+		static const uint32_t TXI = static_cast<uint32_t>(device::ICU::VECTOR::TXI0);
+
+		static const uint8_t SCR_TIE = 0x80;
+		static const uint8_t SCR_RIE = 0x40;
+		static const uint8_t SCR_RE  = 0x10;
+
+		static const uint8_t SSR_TEND = 0x04;
+		static const uint8_t SSR_PER  = 0x08;
+		static const uint8_t SSR_FER  = 0x10;
+		static const uint8_t SSR_ORER = 0x20;
+		static const uint8_t SSR_RDRF = 0x40;
+		static const uint8_t SSR_TDRE = 0x80;
+
+		volatile int		tdr;	///< 送信データ（-1 は空）
+		volatile int		tsr;	///< 送信シフト（-1 は空）
+		volatile int		rdr;	///< 受信データ（-1 は空）
+		volatile uint8_t	scr;
+		volatile uint8_t	err;	///< ORER、FER、PER
+		volatile bool		txi;	///< 割り込み要求（ICU の IR）
+		volatile bool		rxi;
+		bool				rx_hold;	///< DTC 受信の終了の割り込みを遅らせる
+		volatile bool		rx_held;
+
+		void (*task[256])();
+
+		uint8_t				tx_log[LOG_SIZE];
+		volatile uint32_t	tx_num;		///< 送信した数
+
+		volatile uint32_t	rx_seq;		///< 受信した数（データは下位８ビット）
+		volatile uint32_t	rx_end;		///< 受信する数
+
+		uint32_t			chars;		///< タイマー割り込み毎の文字数
+		volatile uint32_t	slots;		///< 経過した文字時間
+		uint32_t			idle;		///< 送受信が止まっている文字時間
+
+		volatile uint32_t	tx_isr;		///< CPU の TXI 割り込み数
+		volatile uint32_t	rx_isr;		///< CPU の RXI 割り込み数
+		volatile uint32_t	tx_dtc;		///< DTC の送信転送数
+		volatile uint32_t	rx_dtc;		///< DTC の受信転送数
+		volatile uint32_t	tx_block;	///< DTC の送信ブロック数（転送回数が「０」）
+		volatile uint32_t	rx_block;	///< DTC の受信ブロック数
+		volatile uint32_t	rx_orer;	///< SCI のオーバーラン
+
+		volatile sig_atomic_t	busy;
+		volatile sig_atomic_t	missed;
+		volatile bool			in_isr;
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	状態を初期化（タイマーは止めておく）
+			@param[in]	ch	タイマー割り込み毎の文字数
+		*/
+		//-------------------------------------------------------------//
+		void reset(uint32_t ch = 8) {
+			tdr = tsr = rdr = -1;
+			scr = 0;
+			err = 0;
+			txi = rxi = false;
+			rx_hold = rx_held = false;
+			tx_num = 0;
+			rx_seq = rx_end = 0;
+			chars = ch;
+			slots = 0;
+			idle = 0;
+			tx_isr = rx_isr = tx_dtc = rx_dtc = tx_block = rx_block = rx_orer = 0;
+			busy = missed = 0;
+			in_isr = false;
+			for(uint32_t i = 0; i < 256; ++i) {
+				DTC_MGR::vtbl_[i] = nullptr;
+				DTC_MGR::dtce_[i] = false;
+			}
+			DTC_MGR::enable_hook_ = nullptr;
+		}
+
+
+		// 転送情報のアドレス（下位３２ビット）をホストのポインターに戻す
+		template <typename T>
+		static T* ptr_(uint32_t adr) {
+			static const uint8_t anchor = 0;
+			uintptr_t hi = reinterpret_cast<uintptr_t>(&anchor) & ~static_cast<uintptr_t>(0xffffffff);
+			return reinterpret_cast<T*>(hi | adr);
+		}
+
+		static uint32_t count_(const DTC_MGR::info_t& t) {
+			uint32_t n = t.cr >> 16;
+			return n == 0 ? 65536 : n;
+		}
+
+		void call_(uint32_t vec) {
+			if(task[vec] == nullptr) return;
+			in_isr = true;
+			(*task[vec])();
+			in_isr = false;
+		}
+
+		void dtc_tx_() {
+			auto& t = *DTC_MGR::vtbl_[TXI];
+			tdr = *ptr_<const uint8_t>(t.sar);
+			++t.sar;
+			++tx_dtc;
+			uint32_t n = count_(t) - 1;
+			t.cr = (n & 0xffff) << 16;
+			if(n == 0) {
+				DTC_MGR::dtce_[TXI] = false;
+				++tx_block;
+				txi = true;
+			}
+		}
+
+		void dtc_rx_() {
+			auto& t = *DTC_MGR::vtbl_[RXI];
+			*ptr_<uint8_t>(t.dar) = rdr;
+			rdr = -1;
+			++t.dar;
+			++rx_dtc;
+			uint32_t n = count_(t) - 1;
+			t.cr = (n & 0xffff) << 16;
+			if(n == 0) {
+				DTC_MGR::dtce_[RXI] = false;
+				++rx_block;
+				if(rx_hold) rx_held = true;
+				else rxi = true;
+			}
+		}
+
+		// 割り込み要求を DTC か CPU に渡す
+		void dispatch_() {
+			bool loop = true;
+			while(loop) {
+				loop = false;
+				if(txi) {
+					txi = false;
+					loop = true;
+					if(DTC_MGR::dtce_[TXI]) dtc_tx_();
+					else { ++tx_isr; call_(TXI); }
+				}
+				if(rxi) {
+					rxi = false;
+					loop = true;
+					if(DTC_MGR::dtce_[RXI]) dtc_rx_();
+					else { ++rx_isr; call_(RXI); }
+				}
+			}
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	１文字受信（RDR が空で無い場合はオーバーラン）
+		*/
+		//-------------------------------------------------------------//
+		void arrive() {
+			uint8_t d = rx_seq;
+			++rx_seq;
+			if(rdr >= 0) {
+				err = err | SSR_ORER;
+				++rx_orer;
+				return;
+			}
+			rdr = d;
+			if(scr & SCR_RIE) rxi = true;
+		}
+
+
+		// １文字時間を進める
+		void slot_() {
+			++slots;
+			++idle;
+			if(tsr >= 0 || rx_seq < rx_end) idle = 0;
+			if(tsr >= 0) {
+				if(tx_num < LOG_SIZE) tx_log[tx_num] = tsr;
+				++tx_num;
+				tsr = -1;
+			}
+			if(tdr >= 0) {
+				tsr = tdr;
+				tdr = -1;
+				if(scr & SCR_TIE) txi = true;
+			}
+			if(rx_seq < rx_end && (scr & SCR_RE) != 0) {
+				arrive();
+			}
+			dispatch_();
+		}
+
+		void run_() {
+			if(rx_held) {
+				rx_held = false;
+				rxi = true;
+				dispatch_();
+			}
+			for(uint32_t i = 0; i < chars; ++i) {
+				slot_();
+				if(rx_held) break;
+			}
+		}
+
+		static void tick_(int sig);
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	タイマーを開始
+			@param[in]	usec	割り込みの周期（マイクロ秒）
+		*/
+		//-------------------------------------------------------------//
+		void start(uint32_t usec = 50) {
+			struct sigaction sa;
+			sa.sa_handler = tick_;
+			sigemptyset(&sa.sa_mask);
+			sa.sa_flags = SA_RESTART;
+			sigaction(SIGALRM, &sa, nullptr);
+			struct itimerval it;
+			it.it_interval.tv_sec = 0;
+			it.it_interval.tv_usec = usec;
+			it.it_value = it.it_interval;
+			setitimer(ITIMER_REAL, &it, nullptr);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	タイマーを停止
+		*/
+		//-------------------------------------------------------------//
+		void stop() {
+			struct itimerval it = { };
+			setitimer(ITIMER_REAL, &it, nullptr);
+		}
+
+
+		// レジスターの操作（メインと割り込みの両方から）
+		void enter_() { ++busy; }
+
+		void leave_() {
+			if(busy == 1 && !in_isr) {
+				dispatch_();
+				while(missed > 0) {
+					--missed;
+					run_();
+				}
+			}
+			--busy;
+		}
+
+		bool tend() const { return tdr < 0 && tsr < 0; }
+
+		uint8_t ssr() const {
+			uint8_t v = err;
+			if(tend()) v |= SSR_TEND;
+			if(rdr >= 0) v |= SSR_RDRF;
+			if(tdr < 0) v |= SSR_TDRE;
+			return v;
+		}
+
+		void set_ssr(uint8_t v) {
+			// エラーフラグは「０」の書き込みでクリア、その他は読み出し専用
+			err = err & (v | ~(SSR_ORER | SSR_FER | SSR_PER));
+		}
+
+		void set_scr(uint8_t v) {
+			enter_();
+			uint8_t org = scr;
+			scr = v;
+			if((org & SCR_TIE) == 0 && (v & SCR_TIE) != 0 && tdr < 0) txi = true;
+			leave_();
+		}
+
+		void set_tdr(uint8_t v) {
+			enter_();
+			tdr = v;
+			leave_();
+		}
+
+		uint8_t get_rdr() {
+			enter_();
+			uint8_t v = rdr < 0 ? 0 : rdr;
+			rdr = -1;
+			leave_();
+			return v;
+		}
+	};
+
+	sci_sim	sim_;
+
+	void sci_sim::tick_(int sig)
+	{
+		if(sim_.busy) {
+			++sim_.missed;
+			return;
+		}
+		++sim_.busy;
+		sim_.run_();
+		--sim_.busy;
+		if(sim_.idle >= sci_sim::IDLE_LIMIT || sim_.tx_num > sci_sim::LOG_SIZE) {
+			static const char msg[] = "NG sci_sim: transfer stalled or runaway\n";
+			write(1, msg, sizeof(msg) - 1);
+			_exit(1);
+		}
+	}
+
+
+	// レジスターのビット
+	template <class REG, uint8_t POS, uint8_t LEN = 1>
+	struct sim_bits {
+		static const uint8_t MASK = ((1 << LEN) - 1) << POS;
+		static uint8_t b(uint8_t v = 1) { return (v << POS) & MASK; }
+		uint8_t operator()() const { return (REG::read() & MASK) >> POS; }
+		void operator=(uint8_t v) { REG::write((REG::read() & ~MASK) | b(v)); }
+	};
+
+	// 振る舞いの無いレジスター
+	template <uint32_t ID>
+	struct sim_reg {
+		static uint8_t& value() { static uint8_t v; return v; }
+		static uint8_t read() { return value(); }
+		static void write(uint8_t v) { value() = v; }
+		uint8_t operator()() const { return read(); }
+		void operator=(uint8_t v) { write(v); }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	SCI 定義クラス（RX600/sci.hpp の sci_t と同じ名前）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct sim_sci {
+
+		struct tdr_t {
+			void operator=(uint8_t v) { sim_.set_tdr(v); }
+			uint32_t address() const { return sci_sim::TDR_ADR; }
+		};
+		static tdr_t TDR;
+
+		struct rdr_t {
+			uint8_t operator()() { return sim_.get_rdr(); }
+			uint32_t address() const { return sci_sim::RDR_ADR; }
+		};
+		static rdr_t RDR;
+
+		struct ssr_io {
+			static uint8_t read() { return sim_.ssr(); }
+			static void write(uint8_t v) { sim_.set_ssr(v); }
+		};
+		struct ssr_t : public ssr_io {
+			uint8_t operator()() const { return read(); }
+			void operator=(uint8_t v) { write(v); }
+			sim_bits<ssr_io, 2> TEND;
+			sim_bits<ssr_io, 3> PER;
+			sim_bits<ssr_io, 4> FER;
+			sim_bits<ssr_io, 5> ORER;
+			sim_bits<ssr_io, 6> RDRF;
+			sim_bits<ssr_io, 7> TDRE;
+		};
+		static ssr_t SSR;
+
+		struct scr_io {
+			static uint8_t read() { return sim_.scr; }
+			static void write(uint8_t v) { sim_.set_scr(v); }
+		};
+		struct scr_t : public scr_io {
+			uint8_t operator()() const { return read(); }
+			void operator=(uint8_t v) { write(v); }
+			sim_bits<scr_io, 0, 2> CKE;
+			sim_bits<scr_io, 2> TEIE;
+			sim_bits<scr_io, 4> RE;
+			sim_bits<scr_io, 5> TE;
+			sim_bits<scr_io, 6> RIE;
+			sim_bits<scr_io, 7> TIE;
+		};
+		static scr_t SCR;
+
+		struct smr_t : public sim_reg<0> {
+			using sim_reg<0>::operator=;
+			sim_bits<sim_reg<0>, 7> CM;
+		};
+		static smr_t SMR;
+
+		struct semr_t : public sim_reg<1> {
+			using sim_reg<1>::operator=;
+			sim_bits<sim_reg<1>, 4> ABCS;
+		};
+		static semr_t SEMR;
+
+		static sim_reg<2> BRR;
+
+		struct scmr_t : public sim_reg<3> {
+			using sim_reg<3>::operator=;
+			sim_bits<sim_reg<3>, 3> SDIR;
+		};
+		static scmr_t SCMR;
+
+		struct simr1_t : public sim_reg<4> {
+			using sim_reg<4>::operator=;
+			sim_bits<sim_reg<4>, 0> IICM;
+		};
+		static simr1_t SIMR1;
+
+		struct spmr_t : public sim_reg<5> {
+			using sim_reg<5>::operator=;
+			sim_bits<sim_reg<5>, 0> SSE;
+			sim_bits<sim_reg<5>, 2> MSS;
+			sim_bits<sim_reg<5>, 6> CKPOL;
+			sim_bits<sim_reg<5>, 7> CKPH;
+		};
+		static spmr_t SPMR;
+
+		static device::peripheral get_peripheral() { return device::peripheral::SCI0; }
+		static device::ICU::VECTOR get_tx_vec() { return device::ICU::VECTOR::TXI0; }
+		static device::ICU::VECTOR get_rx_vec() { return device::ICU::VECTOR::RXI0; }
+	};
+
+	sim_sci::tdr_t sim_sci::TDR;
+	sim_sci::rdr_t sim_sci::RDR;
+	sim_sci::ssr_t sim_sci::SSR;
+	sim_sci::scr_t sim_sci::SCR;
+	sim_sci::smr_t sim_sci::SMR;
+	sim_sci::semr_t sim_sci::SEMR;
+	sim_reg<2> sim_sci::BRR;
+	sim_sci::scmr_t sim_sci::SCMR;
+	sim_sci::simr1_t sim_sci::SIMR1;
+	sim_sci::spmr_t sim_sci::SPMR;
+}
+
+extern "C" {
+
+	void set_interrupt_task(void (*task)(void), uint32_t idx)
+	{
+		host::sim_.task[idx & 255] = task;
+	}
+}
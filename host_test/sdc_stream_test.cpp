@@ -0,0 +1,187 @@
+//=====================================================================//
+/*!	@file
+	@brief	sdc_stream のテスト、ベンチマーク（ホスト） @n
+			RAM ディスク上の FatFs で、seeda::write_file と同じ CSV（１分 @n
+			毎のファイル、１行を８チャネルに分けて書く）を、sdc_stream と @n
+			f_write で書き、内容、ディスクのコマンド数、時間を比較する。@n
+			・読み戻した内容とサイズが、書いたデータと同じ事 @n
+			・クローズで、使わなかったクラスターが開放される事 @n
+			・事前確保を超える書き込みは、確保した分だけ書ける事 @n
+			・二重のオープン、確保サイズ０は失敗する事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "ram_disk.hpp"
+#include "common/sdc_stream.hpp"
+
+namespace {
+
+	// seeda::write_file と同じ
+	static const uint32_t FILE_ALLOC = 1024 + 60 * 8 * 512;
+	typedef utils::sdc_stream<8> STREAM;
+
+	FATFS	fatfs_;
+	STREAM	stream_;
+	int		bad_ = 0;
+
+	void check_(bool ok, const char* what, uint32_t n)
+	{
+		if(ok) return;
+		if(bad_ < 10) printf("NG %s (%u)\n", what, n);
+		++bad_;
+	}
+
+
+	uint32_t free_clusters_()
+	{
+		DWORD n = 0;
+		FATFS* fs;
+		if(f_getfree("", &n, &fs) != FR_OK) return 0;
+		return n;
+	}
+
+
+	// １分のファイル（ヘッダーと、６０行 × ８チャネル）@n
+	// write_file と同じく、ヘッダー、チャネル毎に分けて書く
+	std::vector<std::string> make_csv_(std::mt19937& rng)
+	{
+		std::vector<std::string> v;
+		std::string s = "DATE,TIME";
+		for(int i = 0; i < 8; ++i) s += ",CH,MAX,MIN,AVE,MEDIAN,COUNTUP";
+		v.push_back(s + '\n');
+		for(uint32_t sec = 0; sec < 60; ++sec) {
+			for(uint32_t ch = 0; ch < 8; ++ch) {
+				char tmp[128];
+				if(ch == 0) snprintf(tmp, sizeof(tmp), "2017/06/01,12:34:%02u,", sec);
+				else strcpy(tmp, ",");
+				s = tmp;
+				uint32_t d[6];
+				for(auto& x : d) x = rng() % 65536;
+				snprintf(tmp, sizeof(tmp), "%u,%u,%u,%u.%02u,%u,%u%s", ch,
+					d[0], d[1], d[2], d[3] % 100, d[4], d[5] % 1000, ch == 7 ? "\n" : "");
+				v.push_back(s + tmp);
+			}
+		}
+		return v;
+	}
+
+
+	bool read_back_(const char* path, const std::string& ref)
+	{
+		FIL fil;
+		if(f_open(&fil, path, FA_READ) != FR_OK) return false;
+		bool ok = f_size(&fil) == ref.size();
+		std::string s(ref.size(), 0);
+		UINT br = 0;
+		if(f_read(&fil, &s[0], s.size(), &br) != FR_OK || br != s.size()) ok = false;
+		f_close(&fil);
+		return ok && s == ref;
+	}
+
+
+	struct result_t {
+		double		ms;
+		uint32_t	wr_cmd;
+		uint32_t	wr_sec;
+		uint32_t	rd_cmd;
+	};
+
+	result_t write_files_(bool stream, uint32_t files, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		result_t r { 0.0, 0, 0, 0 };
+		for(uint32_t n = 0; n < files; ++n) {
+			char path[32];
+			snprintf(path, sizeof(path), "%c%04u.csv", stream ? 'S' : 'F', n);
+			auto v = make_csv_(rng);
+			std::string csv;
+			for(const auto& l : v) csv += l;
+
+			uint32_t fc = free_clusters_();
+			host::disk_.clear_count();
+			auto t = std::chrono::steady_clock::now();
+			if(stream) {
+				if(!stream_.open(path, FILE_ALLOC)) {
+					check_(false, "stream open", n);
+					break;
+				}
+				for(const auto& l : v) {
+					check_(stream_.write(l.data(), l.size()) == l.size(), "stream write", n);
+				}
+				check_(stream_.close(), "stream close", n);
+			} else {
+				FIL fil;
+				if(f_open(&fil, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+					check_(false, "f_open", n);
+					break;
+				}
+				for(const auto& l : v) {
+					UINT bw = 0;
+					check_(f_write(&fil, l.data(), l.size(), &bw) == FR_OK && bw == l.size(), "f_write", n);
+				}
+				f_close(&fil);
+			}
+			r.ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+			r.wr_cmd += host::disk_.wr_cmd;
+			r.wr_sec += host::disk_.wr_sec;
+			r.rd_cmd += host::disk_.rd_cmd;
+
+			check_(read_back_(path, csv), "read back", n);
+			// 使わなかった事前確保は開放される
+			uint32_t bytes = host::ram_disk::CLUSTER * 512;
+			check_(fc - free_clusters_() == (csv.size() + bytes - 1) / bytes, "truncate", n);
+		}
+		return r;
+	}
+
+
+	void limit_test_()
+	{
+		uint8_t tmp[5000];
+		for(uint32_t i = 0; i < sizeof(tmp); ++i) tmp[i] = i * 7;
+		check_(!stream_.open("zero.bin", 0), "alloc 0", 0);
+		check_(stream_.open("limit.bin", 4096), "open", 0);
+		check_(!stream_.open("twice.bin", 4096), "open twice", 0);
+		// 確保はクラスター単位（２Ｋ）
+		check_(stream_.space() == 4096, "space", 0);
+		check_(stream_.write(tmp, 1000) == 1000, "write", 0);
+		check_(stream_.write(&tmp[1000], 4000) == 3096, "write over", 0);
+		check_(stream_.space() == 0, "space full", 0);
+		check_(stream_.close(), "close", 0);
+		check_(read_back_("limit.bin", std::string(reinterpret_cast<char*>(tmp), 4096)), "limit read", 0);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+	uint32_t files = 60;  // １時間分
+
+	host::disk_.format();
+	if(f_mount(&fatfs_, "", 1) != FR_OK) {
+		printf("sdc_stream: mount error\n");
+		return 1;
+	}
+
+	printf("sdc_stream: seed %u, %u CSV files (1 minute each, write_file pattern)\n", seed, files);
+	limit_test_();
+	auto f = write_files_(false, files, seed);
+	auto s = write_files_(true, files, seed);
+	static const char* title = "  %-10s %7.2f ms, write %5u cmd, %5u sect, read %5u cmd\n";
+	printf(title, "f_write", f.ms, f.wr_cmd, f.wr_sec, f.rd_cmd);
+	printf(title, "sdc_stream", s.ms, s.wr_cmd, s.wr_sec, s.rd_cmd);
+
+	printf("sdc_stream: errors %d\n", bad_);
+	return bad_ != 0;
+}
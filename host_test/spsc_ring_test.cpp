@@ -0,0 +1,170 @@
+//=====================================================================//
+/*!	@file
+	@brief	spsc_ring のテスト、ベンチマーク（ホスト） @n
+			書き込み側と読み出し側を別のスレッドで動かし、連番が欠けず、@n
+			重複せず、順番通りに届く事を調べ、転送速度を表示する。@n
+			・一括格納（put）、一括取得（get）@n
+			・連続領域の参照と確定（put_region/put_go、get_region/get_go）@n
+			・一つずつの put/get（以前の fifo と同じ使い方）@n
+			・外部バッファ（SIZE = 0）、６４Ｋを超えるサイズ
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "common/spsc_ring.hpp"
+
+namespace {
+
+	int		bad_ = 0;
+
+	enum class mode {
+		single,		///< 一つずつ
+		bulk,		///< 一括（コピー）
+		region,		///< 連続領域（ゼロ・コピー）
+	};
+
+	const char* name_(mode m)
+	{
+		switch(m) {
+		case mode::single: return "single";
+		case mode::bulk:   return "bulk";
+		case mode::region: return "region";
+		}
+		return "";
+	}
+
+
+	template <class RING>
+	void producer_(RING& ring, mode m, uint32_t num, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		uint32_t seq = 0;
+		uint32_t tmp[512];
+		while(seq < num) {
+			if(m == mode::single) {
+				if(ring.space() == 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				ring.put(seq);
+				++seq;
+			} else if(m == mode::bulk) {
+				uint32_t n = 1 + rng() % 512;
+				if(n > (num - seq)) n = num - seq;
+				for(uint32_t i = 0; i < n; ++i) tmp[i] = seq + i;
+				uint32_t l = ring.put(tmp, n);
+				if(l == 0) std::this_thread::yield();
+				seq += l;
+			} else {
+				uint32_t n;
+				auto* p = ring.put_region(n);
+				if(n == 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				uint32_t lim = 1 + rng() % 512;
+				if(n > lim) n = lim;
+				if(n > (num - seq)) n = num - seq;
+				for(uint32_t i = 0; i < n; ++i) p[i] = seq + i;
+				ring.put_go(n);
+				seq += n;
+			}
+		}
+	}
+
+
+	// 読み出し側（エラーの数を返す）
+	template <class RING>
+	uint32_t consumer_(RING& ring, mode m, uint32_t num, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		uint32_t seq = 0;
+		uint32_t err = 0;
+		uint32_t tmp[512];
+		while(seq < num) {
+			if(m == mode::single) {
+				if(ring.length() == 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				if(ring.get() != seq) ++err;
+				++seq;
+			} else if(m == mode::bulk) {
+				uint32_t n = ring.get(tmp, 1 + rng() % 512);
+				if(n == 0) std::this_thread::yield();
+				for(uint32_t i = 0; i < n; ++i) {
+					if(tmp[i] != seq) ++err;
+					++seq;
+				}
+			} else {
+				uint32_t n;
+				const auto* p = ring.get_region(n);
+				if(n == 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				uint32_t lim = 1 + rng() % 512;
+				if(n > lim) n = lim;
+				for(uint32_t i = 0; i < n; ++i) {
+					if(p[i] != seq) ++err;
+					++seq;
+				}
+				ring.get_go(n);
+			}
+		}
+		if(ring.length() != 0) ++err;
+		return err;
+	}
+
+
+	template <class RING>
+	void run_(const char* title, RING& ring, mode m, uint32_t num, uint32_t seed)
+	{
+		ring.clear();
+		uint32_t err = 0;
+		auto t = std::chrono::steady_clock::now();
+		std::thread th([&] { err = consumer_(ring, m, num, seed + 1); });
+		producer_(ring, m, num, seed);
+		th.join();
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+
+		if(err != 0) {
+			printf("NG %s %s: %u errors\n", title, name_(m), err);
+			++bad_;
+		}
+		double mb = static_cast<double>(num) * sizeof(uint32_t) / (1024.0 * 1024.0);
+		printf("  %-10s %-6s %9u words, %8.1f M words/s, %8.1f MB/s\n", title, name_(m), num,
+			num / sec / 1e6, mb / sec);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seed = 1;
+	if(argc > 1) seed = strtoul(argv[1], nullptr, 0);
+	uint32_t num = 4000000;
+
+	printf("spsc_ring: seed %u, %u hardware threads\n", seed, std::thread::hardware_concurrency());
+
+	static utils::spsc_ring<uint32_t, 256> small;
+	static utils::spsc_ring<uint32_t, 100000> large;  // ６４Ｋを超える、２の累乗で無い
+	std::vector<uint32_t> buff(4099);
+	utils::spsc_ring<uint32_t> ext(&buff[0], buff.size());
+
+	for(auto m : { mode::single, mode::bulk, mode::region }) {
+		run_("256", small, m, num, seed);
+		run_("100000", large, m, num, seed);
+		run_("ext 4099", ext, m, num, seed);
+	}
+
+	printf("spsc_ring: errors %d\n", bad_);
+	return bad_ != 0;
+}
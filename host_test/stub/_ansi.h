@@ -0,0 +1,2 @@
+#pragma once
+// ホストで common/syscalls.c をコンパイルする為の空ヘッダー（newlib の内部ヘッダー）
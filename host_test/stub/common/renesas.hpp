@@ -0,0 +1,112 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ホストで common/sci_io.hpp を動かす為の device 定義（RX64M 相当）@n
+			SCI と DTC の動作は sci_sim.hpp で模擬する。@n
+			dtc_mgr は転送情報の登録と DTCE だけを持ち、転送は sci_sim が行う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include "common/vect.h"
+
+namespace device {
+
+	enum class peripheral : uint8_t {
+		SCI0,
+		DTC,
+	};
+
+	struct ICU {
+		enum class VECTOR : uint8_t {
+			NONE = 0,
+			RXI0 = 58,
+			TXI0 = 59,
+		};
+	};
+
+	struct port_map {
+		enum class option : uint8_t {
+			FIRST,
+			SECOND,
+		};
+		static bool turn(peripheral t, bool ena = true, option opt = option::FIRST) { return true; }
+	};
+
+	struct power_cfg {
+		static void turn(peripheral t, bool ena = true) { }
+	};
+
+	struct icu_mgr {
+		static bool set_level(peripheral t, uint8_t lvl) { return true; }
+	};
+
+	struct DTC { };
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  DTC マネージャー（RX600/dtc_mgr.hpp と同じインターフェース）
+		@param[in]	DTCU	DTC 定義クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class DTCU = DTC>
+	class dtc_mgr {
+	public:
+		struct info_t {
+			uint32_t	mr;		///< MRA(31-24), MRB(23-16)
+			uint32_t	sar;	///< 転送元（ホストのアドレスの下位３２ビット）
+			uint32_t	dar;	///< 転送先（ホストのアドレスの下位３２ビット）
+			uint32_t	cr;		///< CRA(31-16), CRB(15-0)
+		};
+
+		static const uint8_t MRA_SZ_8     = 0x00;
+		static const uint8_t MRA_SZ_16    = 0x10;
+		static const uint8_t MRA_SZ_32    = 0x20;
+		static const uint8_t MRA_SM_INC   = 0x08;
+		static const uint8_t MRA_MD_REPEAT = 0x40;
+		static const uint8_t MRB_DM_INC   = 0x08;
+		static const uint8_t MRB_DTS      = 0x10;
+		static const uint8_t MRB_DISEL    = 0x20;
+
+		static info_t* volatile vtbl_[256];		///< 登録された転送情報
+		static volatile bool dtce_[256];		///< 起動許可
+		static void (*enable_hook_)(ICU::VECTOR);	///< enable の直前に呼ぶ（テスト用）
+
+		static void start() { }
+
+		static void set_normal(info_t& t, uint8_t mra, uint8_t mrb, uint32_t src, uint32_t dst,
+			uint32_t cnt)
+		{
+			t.mr  = (static_cast<uint32_t>(mra) << 24) | (static_cast<uint32_t>(mrb) << 16);
+			t.sar = src;
+			t.dar = dst;
+			t.cr  = (cnt & 0xffff) << 16;
+		}
+
+		static uint32_t get_count(const info_t& t)
+		{
+			return static_cast<uint16_t>(reinterpret_cast<const volatile uint32_t&>(t.cr) >> 16);
+		}
+
+		static void enable(ICU::VECTOR vec, info_t& t)
+		{
+			if(enable_hook_ != nullptr) (*enable_hook_)(vec);
+			vtbl_[static_cast<uint32_t>(vec)] = &t;
+			dtce_[static_cast<uint32_t>(vec)] = true;
+		}
+
+		static void disable(ICU::VECTOR vec) { dtce_[static_cast<uint32_t>(vec)] = false; }
+
+		static bool probe(ICU::VECTOR vec) { return dtce_[static_cast<uint32_t>(vec)]; }
+	};
+
+	template <class DTCU>
+		typename dtc_mgr<DTCU>::info_t* volatile dtc_mgr<DTCU>::vtbl_[256];
+	template <class DTCU>
+		volatile bool dtc_mgr<DTCU>::dtce_[256];
+	template <class DTCU>
+		void (*dtc_mgr<DTCU>::enable_hook_)(ICU::VECTOR) = nullptr;
+}
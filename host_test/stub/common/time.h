@@ -0,0 +1,5 @@
+#pragma once
+// ホストで common/time.h を使うヘッダーをコンパイルする為の代わり（struct tm がホストと衝突する）
+#include <ctime>
+
+time_t mktime_gmt(const struct tm *tmp);
@@ -0,0 +1,13 @@
+#pragma once
+// ホストで common/sci_io.hpp をコンパイルする為の代わり（割り込み関数は普通の関数、登録は sci_sim.hpp）
+#include <stdint.h>
+
+#define INTERRUPT_FUNC
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+	void set_interrupt_task(void (*task)(void), uint32_t idx);
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,210 @@
+//=====================================================================//
+/*!	@file
+	@brief	syscalls の FatFs ファイルのテスト（ホスト） @n
+			common/syscalls.c を、ファイル毎のバッファ有り（buff_）と、@n
+			無し（raw_）でコンパイルし、RAM ディスク上の FatFs で動かす。@n
+			・変更カウンターは、作成、書き込んだファイルのクローズ、fsync、@n
+			  削除、名前変更でだけ進む事（読み出しでは進まない）@n
+			・行単位の書き込み、読み出しの速度、ディスクのコマンド数の比較
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <fcntl.h>
+#include "ram_disk.hpp"
+
+#define SYSCALLS_(pfx) \
+	int pfx##open(const char* path, int flags, ...); \
+	int pfx##read(int file, void* ptr, int len); \
+	int pfx##write(int file, const void* ptr, int len); \
+	int pfx##lseek(int file, int offset, int dir); \
+	int pfx##close(int file); \
+	int pfx##fsync(int file); \
+	int pfx##link(const char* oldpath, const char* newpath); \
+	int pfx##unlink(const char* path); \
+	extern volatile uint32_t pfx##fs_modify_count;
+
+extern "C" {
+	SYSCALLS_(buff_)
+	SYSCALLS_(raw_)
+
+	void utf8_to_sjis(const char* src, char* dst, uint16_t dsz)
+	{
+		strncpy(dst, src, dsz - 1);
+		dst[dsz - 1] = 0;
+	}
+}
+
+namespace {
+
+	struct io_t {
+		const char*	name;
+		int (*open)(const char* path, int flags, ...);
+		int (*read)(int file, void* ptr, int len);
+		int (*write)(int file, const void* ptr, int len);
+		int (*lseek)(int file, int offset, int dir);
+		int (*close)(int file);
+		int (*fsync)(int file);
+		int (*link)(const char* oldpath, const char* newpath);
+		int (*unlink)(const char* path);
+		volatile uint32_t*	count;
+	};
+
+#define IO_(pfx) { #pfx, pfx##open, pfx##read, pfx##write, pfx##lseek, pfx##close, \
+		pfx##fsync, pfx##link, pfx##unlink, &pfx##fs_modify_count }
+
+	const io_t io_tbl_[] = { IO_(buff_), IO_(raw_) };
+
+	FATFS	fatfs_;
+	int		bad_ = 0;
+
+	void check_(const io_t& io, bool ok, const char* what)
+	{
+		if(ok) return;
+		printf("NG %s: %s\n", io.name, what);
+		++bad_;
+	}
+
+
+	// 変更カウンターが進む操作
+	void count_test_(const io_t& io)
+	{
+		char tmp[64];
+		uint32_t c = *io.count;
+		int fd = io.open("/count.txt", O_WRONLY | O_CREAT | O_TRUNC);
+		check_(io, fd >= 0, "open write");
+		check_(io, *io.count == c + 1, "create");
+		io.write(fd, "abc\n", 4);
+		io.write(fd, "def\n", 4);
+		check_(io, *io.count == c + 1, "write");
+		io.fsync(fd);
+		check_(io, *io.count == c + 2, "fsync");
+		io.fsync(fd);
+		check_(io, *io.count == c + 2, "fsync (clean)");
+		io.write(fd, "ghi\n", 4);
+		io.close(fd);
+		check_(io, *io.count == c + 3, "close (written)");
+
+		fd = io.open("/count.txt", O_RDONLY);
+		check_(io, io.read(fd, tmp, sizeof(tmp)) == 12, "read");
+		io.close(fd);
+		fd = io.open("/count.txt", O_RDWR);
+		io.read(fd, tmp, sizeof(tmp));
+		io.close(fd);
+		check_(io, *io.count == c + 3, "read only");
+
+		check_(io, io.link("/count.txt", "/count2.txt") == 0, "link");
+		check_(io, *io.count == c + 4, "rename");
+		check_(io, io.unlink("/count2.txt") == 0, "unlink");
+		check_(io, *io.count == c + 5, "remove");
+	}
+
+
+	// CSV の一行
+	int make_line_(std::mt19937& rng, char* dst, uint32_t size, uint32_t n)
+	{
+		uint32_t a = rng() % 100000;
+		int b = static_cast<int>(rng() % 2001) - 1000;
+		uint32_t c = rng() % 1000;
+		uint32_t d = rng() % 100;
+		return snprintf(dst, size, "%u,%u,%d,%u.%02u\n", n, a, b, c, d);
+	}
+
+	double msec_(std::chrono::steady_clock::time_point t)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+	}
+
+
+	// 行単位の書き込み、読み出し（64 バイト単位）
+	void line_test_(const io_t& wio, const io_t& rio, uint32_t lines)
+	{
+		char path[32];
+		snprintf(path, sizeof(path), "/%s.csv", wio.name);
+		std::mt19937 rng(lines);
+		char tmp[64];
+
+		host::disk_.clear_count();
+		auto t = std::chrono::steady_clock::now();
+		int fd = wio.open(path, O_WRONLY | O_CREAT | O_TRUNC);
+		uint32_t total = 0;
+		for(uint32_t i = 0; i < lines; ++i) {
+			int len = make_line_(rng, tmp, sizeof(tmp), i);
+			if(wio.write(fd, tmp, len) != len) {
+				check_(wio, false, "line write");
+				break;
+			}
+			total += len;
+		}
+		check_(wio, wio.close(fd) == 0, "close");
+		double wt = msec_(t);
+		uint32_t wcmd = host::disk_.wr_cmd;
+		uint32_t wsec = host::disk_.wr_sec;
+
+		host::disk_.clear_count();
+		rng.seed(lines);
+		char line[64];
+		int llen = 0;
+		uint32_t n = 0;
+		uint32_t rtotal = 0;
+		t = std::chrono::steady_clock::now();
+		fd = rio.open(path, O_RDONLY);
+		while(1) {
+			int len = rio.read(fd, tmp, sizeof(tmp));
+			if(len <= 0) break;
+			rtotal += len;
+			for(int i = 0; i < len; ++i) {
+				line[llen++] = tmp[i];
+				if(tmp[i] != '\n') continue;
+				char ref[64];
+				int rlen = make_line_(rng, ref, sizeof(ref), n);
+				if(rlen != llen || memcmp(ref, line, llen) != 0) {
+					if(bad_ < 10) printf("NG %s -> %s: line %u\n", wio.name, rio.name, n);
+					++bad_;
+				}
+				++n;
+				llen = 0;
+			}
+		}
+		rio.close(fd);
+		double rt = msec_(t);
+		check_(rio, n == lines && rtotal == total, "line count");
+
+		printf("  write %-5s %7.2f ms, %5u cmd, %5u sect;  read %-5s %7.2f ms, %5u cmd, %5u sect\n",
+			wio.name, wt, wcmd, wsec, rio.name, rt, host::disk_.rd_cmd, host::disk_.rd_sec);
+		rio.unlink(path);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t lines = 50000;
+	if(argc > 1) lines = strtoul(argv[1], nullptr, 0);
+
+	host::disk_.format();
+	if(f_mount(&fatfs_, "", 1) != FR_OK) {
+		printf("syscalls: mount error\n");
+		return 1;
+	}
+
+	for(const auto& io : io_tbl_) {
+		count_test_(io);
+	}
+
+	printf("syscalls: %u lines (CSV, line write, 64 byte read)\n", lines);
+	for(const auto& w : io_tbl_) {
+		for(const auto& r : io_tbl_) {
+			line_test_(w, r, lines);
+		}
+	}
+
+	printf("syscalls: errors %d\n", bad_);
+	return bad_ != 0;
+}
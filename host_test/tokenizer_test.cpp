@@ -0,0 +1,427 @@
+//=====================================================================//
+/*!	@file
+	@brief	tokenizer のテスト、ベンチマーク（ホスト） @n
+			GPS の１秒分の出力（NMEA）と、ブラウザの要求（HTTP）を模した @n
+			トレースを、以前のパーサー（strncmp の連鎖、一文字ずつの走査）と、@n
+			tokenizer、key_hash を使う現在のパーサーで解析し、結果と時間を比較する。@n
+			・NMEA：以前の nmea_dec::decode_ と、現在の utils::nmea_dec @n
+			・HTTP：以前の http_server の要求行、ヘッダー解析と、現在の方法
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "common/nmea_dec.hpp"
+
+namespace {
+
+	int		bad_ = 0;
+
+	void check_(bool ok, const char* what, uint32_t n)
+	{
+		if(ok) return;
+		if(bad_ < 10) printf("NG %s (%u)\n", what, n);
+		++bad_;
+	}
+
+	double nsec_(std::chrono::steady_clock::time_point t)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t).count();
+	}
+
+	// 最適化で結果が消えないように
+	volatile uint32_t	sink_;
+
+	//-----------------------------------------------------------------//
+	// NMEA
+	//-----------------------------------------------------------------//
+
+	// GPS モジュールの１秒分の出力（時刻、位置を進めて繰り返す）
+	std::string make_nmea_(uint32_t sec)
+	{
+		uint32_t h = (sec / 3600) % 24;
+		uint32_t m = (sec / 60) % 60;
+		uint32_t s = sec % 60;
+		char body[8][128];
+		snprintf(body[0], 128, "GPGGA,%02u%02u%02u.000,3540.%04u,N,13945.%04u,E,1,%02u,0.9,%u.%u,M,39.4,M,,",
+			h, m, s, 1234 + sec % 100, 5678 + sec % 50, 7 + sec % 5, 40 + sec % 10, sec % 10);
+		snprintf(body[1], 128, "GPGSA,A,3,17,28,01,11,19,08,30,07,,,,,1.6,0.9,1.3");
+		snprintf(body[2], 128, "GPGSV,3,1,12,17,68,038,46,28,57,307,45,01,49,145,44,11,34,054,42");
+		snprintf(body[3], 128, "GPGSV,3,2,12,19,31,108,41,08,24,274,38,30,21,185,36,07,16,320,33");
+		snprintf(body[4], 128, "GPGSV,3,3,12,22,08,043,,03,06,248,,42,44,221,35,50,46,199,37");
+		snprintf(body[5], 128, "GPRMC,%02u%02u%02u.000,A,3540.%04u,N,13945.%04u,E,0.%02u,%u.%02u,%02u0617,,,A",
+			h, m, s, 1234 + sec % 100, 5678 + sec % 50, sec % 100, sec % 360, sec % 100,
+			1 + (sec / 86400) % 28);
+		snprintf(body[6], 128, "GPVTG,%u.%02u,T,,M,0.%02u,N,0.%02u,K,A", sec % 360, sec % 100,
+			sec % 100, (sec * 2) % 100);
+		snprintf(body[7], 128, "GPZDA,%02u%02u%02u.000,%02u,06,2017,,", h, m, s,
+			1 + (sec / 86400) % 28);
+		std::string out;
+		for(auto b : body) {
+			uint8_t sum = 0;
+			for(const char* p = b; *p != 0; ++p) sum ^= static_cast<uint8_t>(*p);
+			char tmp[8];
+			snprintf(tmp, sizeof(tmp), "*%02X\r\n", sum);
+			out += '$';
+			out += b;
+			out += tmp;
+		}
+		return out;
+	}
+
+
+	// SCI の模擬（トレースを受信する）
+	struct sci_sim {
+		const char*	ptr_;
+		const char*	end_;
+
+		uint32_t recv_length() const { return end_ - ptr_; }
+		char getch() { return *ptr_++; }
+		void putch(char ch) { }
+	};
+
+
+	// 以前の nmea_dec のデコーダー
+	class old_nmea {
+		sci_sim&	sci_;
+
+		uint16_t	pos_;
+		char		line_[128];
+
+	public:
+		char		time_[12];
+		char		lat_[12];
+		char		ns_[2];
+		char		lon_[12];
+		char		ew_[2];
+		char		q_[2];
+		char		satellite_[4];
+		char		hq_[4];
+		char		alt_[6];
+		char		alt_unit_[2];
+		char		date_[8];
+
+		uint32_t	id_;
+		uint32_t	iid_;
+
+	private:
+		static uint16_t word_(const char* src)
+		{
+			const char* top = src;
+			char ch;
+			while((ch = *src++) != 0) {
+				if(ch == ',' || ch == '*') return src - top;
+			}
+			return 0;
+		}
+
+		static void copy_word_(char* dst, const char* src, uint16_t len)
+		{
+			std::strncpy(dst, src, len);
+			dst[len] = 0;
+		}
+
+		bool decode_()
+		{
+			if(line_[0] != '$') return false;
+
+			if(std::strncmp(&line_[1], "GPGGA,", 6) == 0) {
+				const char* p = &line_[7];
+				uint16_t n = 0;
+				uint16_t l;
+				while((l = word_(p)) != 0) {
+					if(n == 0) copy_word_(time_, p, l - 1);
+					else if(n == 1) copy_word_(lat_, p, l - 1);
+					else if(n == 2) copy_word_(ns_, p, l - 1);
+					else if(n == 3) copy_word_(lon_, p, l - 1);
+					else if(n == 4) copy_word_(ew_, p, l - 1);
+					else if(n == 5) copy_word_(q_, p, l - 1);
+					else if(n == 6) copy_word_(satellite_, p, l - 1);
+					else if(n == 7) copy_word_(hq_, p, l - 1);
+					else if(n == 8) copy_word_(alt_, p, l - 1);
+					else if(n == 9) copy_word_(alt_unit_, p, l - 1);
+					else {
+						break;
+					}
+					p += l;
+					++n;
+				}
+			} else if(std::strncmp(&line_[1], "GPRMC,", 6) == 0) {
+				const char* p = &line_[7];
+				uint16_t n = 0;
+				uint16_t l;
+				while((l = word_(p)) != 0) {
+					if(n == 8) copy_word_(date_, p, l - 1);
+					p += l;
+					++n;
+				}
+			} else if(std::strncmp(&line_[1], "GPGSV,", 6) == 0) {
+				const char* p = &line_[7];
+				uint16_t n = 0;
+				uint16_t l;
+				while((l = word_(p)) != 0) {
+					p += l;
+					++n;
+				}
+				++iid_;
+			} else if(std::strncmp(&line_[1], "GPVTG,", 6) == 0) {
+				++id_;
+				return true;
+			}
+			return false;
+		}
+
+	public:
+		old_nmea(sci_sim& sci) : sci_(sci), pos_(0), time_{ }, lat_{ }, ns_{ }, lon_{ }, ew_{ },
+			q_{ }, satellite_{ }, hq_{ }, alt_{ }, alt_unit_{ }, date_{ }, id_(0), iid_(0) { }
+
+		bool service()
+		{
+			char ch;
+			bool ret = false;
+			while(sci_.recv_length() > 0) {
+				ch = sci_.getch();
+				if(ch == 0x0d) {
+					line_[pos_] = 0;
+					ret = decode_();
+					pos_ = 0;
+				} else {
+					if(ch >= ' ' && ch <= 0x7f) {
+						if(pos_ < (sizeof(line_) - 1)) {
+							line_[pos_] = ch;
+							++pos_;
+						}
+					}
+				}
+			}
+			return ret;
+		}
+	};
+
+	typedef utils::nmea_dec<sci_sim> new_nmea;
+
+
+	void nmea_test_(uint32_t epochs)
+	{
+		std::vector<std::string> trace;
+		uint32_t bytes = 0;
+		for(uint32_t i = 0; i < epochs; ++i) {
+			trace.push_back(make_nmea_(36000 + i * 7));
+			bytes += trace.back().size();
+		}
+
+		// 結果の比較（１秒毎）
+		{
+			sci_sim so;
+			sci_sim sn;
+			old_nmea o(so);
+			new_nmea n(sn);
+			for(uint32_t i = 0; i < epochs; ++i) {
+				so.ptr_ = sn.ptr_ = trace[i].c_str();
+				so.end_ = sn.end_ = so.ptr_ + trace[i].size();
+				o.service();
+				n.service();
+				check_(std::strcmp(o.time_, n.get_time()) == 0, "NMEA time", i);
+				check_(std::strcmp(o.date_, n.get_date()) == 0, "NMEA date", i);
+				check_(std::strcmp(o.lat_, n.get_lat()) == 0, "NMEA lat", i);
+				check_(std::strcmp(o.lon_, n.get_lon()) == 0, "NMEA lon", i);
+				check_(std::strcmp(o.q_, n.get_quality()) == 0, "NMEA quality", i);
+				check_(std::strcmp(o.satellite_, n.get_satellite()) == 0, "NMEA satellite", i);
+				check_(std::strcmp(o.hq_, n.get_holizontal_quality()) == 0, "NMEA hq", i);
+				check_(std::strcmp(o.alt_, n.get_altitude()) == 0, "NMEA altitude", i);
+				check_(std::strcmp(o.alt_unit_, n.get_altitude_unit()) == 0, "NMEA unit", i);
+				check_(o.id_ == n.get_id() && o.iid_ == n.get_iid(), "NMEA id", i);
+			}
+		}
+
+		// 時間
+		double t[2];
+		for(int k = 0; k < 2; ++k) {
+			sci_sim sci;
+			old_nmea o(sci);
+			new_nmea n(sci);
+			auto org = std::chrono::steady_clock::now();
+			for(int loop = 0; loop < 20; ++loop) {
+				for(const auto& s : trace) {
+					sci.ptr_ = s.c_str();
+					sci.end_ = sci.ptr_ + s.size();
+					if(k == 0) o.service();
+					else n.service();
+				}
+			}
+			t[k] = nsec_(org) / (20.0 * epochs * 8);
+			sink_ = o.id_ + n.get_id();
+		}
+		printf("  NMEA: %u lines, %u bytes, old %.1f ns/line, tokenizer %.1f ns/line (%.2fx)\n",
+			epochs * 8, bytes, t[0], t[1], t[0] / t[1]);
+	}
+
+
+	//-----------------------------------------------------------------//
+	// HTTP
+	//-----------------------------------------------------------------//
+
+	// ブラウザの要求（行に分けたもの、line_man の内容と同じ）
+	const char* http_trace_[][10] = {
+		{ "GET / HTTP/1.1",
+		  "Host: 192.168.3.20",
+		  "Connection: keep-alive",
+		  "Upgrade-Insecure-Requests: 1",
+		  "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/61.0.3163.100 Safari/537.36",
+		  "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,image/apng,*/*;q=0.8",
+		  "Accept-Encoding: gzip, deflate",
+		  "Accept-Language: ja,en-US;q=0.8,en;q=0.6",
+		  nullptr },
+		{ "GET /favicon.ico HTTP/1.1",
+		  "Host: 192.168.3.20",
+		  "Connection: keep-alive",
+		  "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/61.0.3163.100 Safari/537.36",
+		  "Accept: image/webp,image/apng,image/*,*/*;q=0.8",
+		  "Referer: http://192.168.3.20/",
+		  "Accept-Encoding: gzip, deflate",
+		  "Accept-Language: ja,en-US;q=0.8,en;q=0.6",
+		  nullptr },
+		{ "POST /cgi/set_rtc.cgi HTTP/1.1",
+		  "Host: 192.168.3.20",
+		  "Connection: keep-alive",
+		  "Content-Length: 36",
+		  "Cache-Control: max-age=0",
+		  "Origin: http://192.168.3.20",
+		  "Content-Type: application/x-www-form-urlencoded",
+		  "Referer: http://192.168.3.20/setup",
+		  "Accept-Language: ja,en-US;q=0.8,en;q=0.6",
+		  nullptr },
+		{ "GET /image/photo_0012.jpg HTTP/1.1",
+		  "Host: 192.168.3.20",
+		  "Range: bytes=65536-",
+		  "If-Range: \"5a1b-2f3c\"",
+		  "User-Agent: curl/7.55.1",
+		  "Accept: */*",
+		  nullptr },
+	};
+
+	struct request_t {
+		int		method;		///< 0: GET, 1: POST, -1: その他
+		char	path[256];
+		int		length;		///< Content-Length（無い場合 -1）
+	};
+
+	// 以前の http_server の解析（get_path_、strncmp）
+	void old_http_(const char* const* lines, request_t& r)
+	{
+		r.method = -1;
+		r.path[0] = 0;
+		r.length = -1;
+		const char* t = lines[0];
+		const char* p = nullptr;
+		if(strncmp(t, "GET ", 4) == 0) {
+			r.method = 0;
+			p = t + 4;
+		} else if(strncmp(t, "POST ", 5) == 0) {
+			r.method = 1;
+			p = t + 5;
+		}
+		if(p != nullptr) {
+			int n = 0;
+			char ch;
+			while((ch = p[n]) != 0) {
+				if(ch == ' ') break;
+				r.path[n] = ch;
+				++n;
+			}
+			r.path[n] = 0;
+		}
+		if(r.method == 1) {
+			for(int i = 0; lines[i] != nullptr; ++i) {
+				static const char* key = { "Content-Length: " };
+				if(strncmp(lines[i], key, strlen(key)) == 0) {
+					r.length = atoi(lines[i] + strlen(key));
+					break;
+				}
+			}
+		}
+	}
+
+	static constexpr const char* method_tbl_[] = { "GET", "POST" };
+	static constexpr auto method_ = utils::make_key_hash(method_tbl_);
+	static constexpr const char* header_tbl_[] = { "Content-Length" };
+	static constexpr auto header_ = utils::make_key_hash(header_tbl_);
+
+	// 現在の http_server の解析（tokenizer、key_hash）
+	void new_http_(const char* const* lines, request_t& r)
+	{
+		r.length = -1;
+		utils::tokenizer<3> req;  // メソッド、パス、バージョン
+		req.words(lines[0]);
+		req[1].copy(r.path, sizeof(r.path));
+		r.method = method_.find(req[0]);
+		if(r.method == 1) {
+			for(int i = 1; lines[i] != nullptr; ++i) {
+				const char* p = lines[i];
+				const char* d = std::strchr(p, ':');
+				if(d == nullptr) continue;
+				if(header_.find(p, d - p) == 0) {  // Content-Length
+					++d;
+					while(*d == ' ') ++d;
+					r.length = atoi(d);
+					break;
+				}
+			}
+		}
+	}
+
+
+	void http_test_(uint32_t loops)
+	{
+		const uint32_t num = sizeof(http_trace_) / sizeof(http_trace_[0]);
+		uint32_t lines = 0;
+		for(uint32_t i = 0; i < num; ++i) {
+			request_t o;
+			request_t n;
+			old_http_(http_trace_[i], o);
+			new_http_(http_trace_[i], n);
+			check_(o.method == n.method, "HTTP method", i);
+			check_(std::strcmp(o.path, n.path) == 0, "HTTP path", i);
+			check_(o.length == n.length, "HTTP Content-Length", i);
+			for(const char* const* p = http_trace_[i]; *p != nullptr; ++p) ++lines;
+		}
+
+		double t[2];
+		for(int k = 0; k < 2; ++k) {
+			request_t r;
+			uint32_t sum = 0;
+			auto org = std::chrono::steady_clock::now();
+			for(uint32_t loop = 0; loop < loops; ++loop) {
+				for(uint32_t i = 0; i < num; ++i) {
+					if(k == 0) old_http_(http_trace_[i], r);
+					else new_http_(http_trace_[i], r);
+					sum += r.method + r.length + r.path[1];
+				}
+			}
+			t[k] = nsec_(org) / (static_cast<double>(loops) * num);
+			sink_ = sum;
+		}
+		printf("  HTTP: %u requests, %u lines, old %.1f ns/request, tokenizer %.1f ns/request (%.2fx)\n",
+			num, lines, t[0], t[1], t[0] / t[1]);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t epochs = 3600;
+	if(argc > 1) epochs = strtoul(argv[1], nullptr, 0);
+
+	printf("tokenizer: old parsers against tokenizer/key_hash\n");
+	nmea_test_(epochs);
+	http_test_(epochs * 50);
+
+	printf("tokenizer: errors %d\n", bad_);
+	return bad_ != 0;
+}
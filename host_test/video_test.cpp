@@ -0,0 +1,295 @@
+//=====================================================================//
+/*!	@file
+	@brief	InvadersVideo の転送テスト（ホスト） @n
+			ビデオ・メモリーを書き換えるプログラムを走らせ、blitRGB565()、@n
+			blitPage()（全画面と窓）、savePPM() の結果を、１ピクセルずつ @n
+			展開した参照と比較する。@n
+			・ゲームに近いプログラム（割り込みでインベーダーを１つずつ動かし、@n
+			  弾を動かす）と全画面を書き換えるプログラムで、フレーム毎の @n
+			  変化したカラム、転送で読み書きするバイト数、時間を表示する @n
+			・変化したカラムだけの転送を続けた結果が、全画面の展開と同じ事
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include "rx64m_SIDE/side/video.h"
+
+namespace {
+
+	enum {
+		W = InvadersMachine::ScreenWidth,
+		H = InvadersMachine::ScreenHeight
+	};
+
+	InvadersMachine	mach_;
+	InvadersVideo	video_;
+
+	bool			ref_[W * H];
+	uint16_t		rgb_[W * H];
+	uint8_t			page_[W * H / 8];
+	uint16_t		rgb_win_[100 * 50];
+	uint8_t			page_win_[64 * 8];
+	unsigned char	ppm_[W * H * 3 + 15];
+
+	// ビデオ・メモリーを１ピクセルずつ展開（９０度回転）
+	void expand_()
+	{
+		const unsigned char* vram = mach_.getVideo();
+		for(unsigned x = 0; x < W; ++x) {
+			for(unsigned y = 0; y < H; ++y) {
+				unsigned b = (H - 1) - y;
+				ref_[y * W + x] = (vram[x * 32 + b / 8] >> (b & 7)) & 1;
+			}
+		}
+	}
+
+
+	// 全画面を書き換える（B を足しながら）
+	// 0000: LXI H,2400
+	// 0003: MOV A,L; XRA H; ADD B; MOV M,A; INX H; MOV A,H; CPI 40; JNZ 0003
+	// 000E: INR B; JMP 0000
+	const unsigned char full_prog_[] = {
+		0x21, 0x00, 0x24, 0x7D, 0xAC, 0x80, 0x77, 0x23, 0x7C, 0xFE, 0x40, 0xC2, 0x03, 0x00,
+		0x04, 0xC3, 0x00, 0x00
+	};
+
+	// ゲームに近いプログラム（インベーダー ４０、弾 １）@n
+	// RST 2（画面の終わり）毎に、インベーダーを１つ、１カラム右に動かし、@n
+	// RST 1（画面の中央）毎に、弾を１バイト上に動かす。
+	const unsigned char game_prog_[] = {
+		0xC3, 0x20, 0x00,		// 0000: JMP  0020
+		0, 0, 0, 0, 0,
+		0xC3, 0x40, 0x00,		// 0008: JMP  0040（RST 1）
+		0, 0, 0, 0, 0,
+		0xC3, 0x60, 0x00,		// 0010: JMP  0060（RST 2）
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0x31, 0x00, 0x24,		// 0020: LXI  SP,2400
+		0x21, 0x00, 0x02,		//       LXI  H,0200（位置の表を 2100 に）
+		0x11, 0x00, 0x21,		//       LXI  D,2100
+		0x06, 0x50,				//       MVI  B,80
+		0x7E,					// 002B: MOV  A,M
+		0x12,					//       STAX D
+		0x23,					//       INX  H
+		0x13,					//       INX  D
+		0x05,					//       DCR  B
+		0xC2, 0x2B, 0x00,		//       JNZ  002B
+		0x21, 0x80, 0x30,		//       LXI  H,3080（弾、カラム 100）
+		0x22, 0x10, 0x20,		//       SHLD 2010
+		0xFB,					//       EI
+		0xC3, 0x3A, 0x00,		// 003A: JMP  003A
+		0, 0, 0,
+		0xF5,					// 0040: PUSH PSW（弾）
+		0xE5,					//       PUSH H
+		0x2A, 0x10, 0x20,		//       LHLD 2010
+		0x36, 0x00,				//       MVI  M,0
+		0x23,					//       INX  H
+		0x7D,					//       MOV  A,L
+		0xE6, 0x1F,				//       ANI  1F
+		0xC2, 0x56, 0x00,		//       JNZ  0056
+		0x7D,					//       MOV  A,L（カラムの下に戻る）
+		0xD6, 0x20,				//       SUI  20
+		0x6F,					//       MOV  L,A
+		0xD2, 0x56, 0x00,		//       JNC  0056
+		0x25,					//       DCR  H
+		0x36, 0x3C,				// 0056: MVI  M,3C
+		0x22, 0x10, 0x20,		//       SHLD 2010
+		0xE1,					//       POP  H
+		0xF1,					//       POP  PSW
+		0xFB,					//       EI
+		0xC9,					//       RET
+		0,
+		0xF5, 0xC5, 0xD5, 0xE5,	// 0060: PUSH PSW, B, D, H（インベーダー）
+		0x3A, 0x02, 0x20,		//       LDA  2002
+		0x3C,					//       INR  A
+		0xFE, 0x28,				//       CPI  40
+		0xDA, 0x6E, 0x00,		//       JC   006E
+		0xAF,					//       XRA  A
+		0x32, 0x02, 0x20,		// 006E: STA  2002
+		0x87,					//       ADD  A
+		0x6F,					//       MOV  L,A
+		0x26, 0x21,				//       MVI  H,21
+		0xE5,					//       PUSH H（表の位置）
+		0x5E,					//       MOV  E,M
+		0x23,					//       INX  H
+		0x56,					//       MOV  D,M
+		0xEB,					//       XCHG（HL: ビデオ・メモリー）
+		0x7C,					//       MOV  A,H
+		0xFE, 0x3A,				//       CPI  3A（カラム 176 で、128 カラム戻る）
+		0xDA, 0x8C, 0x00,		//       JC   008C
+		0xE5,					//       PUSH H
+		0x11, 0x20, 0x01,		//       LXI  D,0120（消す）
+		0xCD, 0xC0, 0x00,		//       CALL 00C0
+		0xE1,					//       POP  H
+		0x7C,					//       MOV  A,H
+		0xD6, 0x10,				//       SUI  10
+		0x67,					//       MOV  H,A
+		0xE5,					// 008C: PUSH H
+		0x11, 0x00, 0x01,		//       LXI  D,0100（先頭の空白で、前の左端を消す）
+		0xCD, 0xC0, 0x00,		//       CALL 00C0
+		0xE1,					//       POP  H
+		0x11, 0x20, 0x00,		//       LXI  D,0020
+		0x19,					//       DAD  D（１カラム右）
+		0xEB,					//       XCHG
+		0xE1,					//       POP  H
+		0x73,					//       MOV  M,E
+		0x23,					//       INX  H
+		0x72,					//       MOV  M,D
+		0xE1, 0xD1, 0xC1, 0xF1,	//       POP  H, D, B, PSW
+		0xFB,					//       EI
+		0xC9,					//       RET
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0x0E, 0x11,				// 00C0: MVI  C,17（DE の 17 バイトを、17 カラムに）
+		0x1A,					// 00C2: LDAX D
+		0x77,					//       MOV  M,A
+		0x13,					//       INX  D
+		0x7D,					//       MOV  A,L
+		0xC6, 0x20,				//       ADI  20
+		0x6F,					//       MOV  L,A
+		0xD2, 0xCD, 0x00,		//       JNC  00CD
+		0x24,					//       INR  H
+		0x0D,					// 00CD: DCR  C
+		0xC2, 0xC2, 0x00,		//       JNZ  00C2
+		0xC9,					//       RET
+	};
+
+	// 0100: インベーダー（空白、１６カラム）
+	const unsigned char invader_[] = {
+		0x00, 0x00, 0x00, 0x98, 0x5C, 0xB6, 0x5F, 0x5F, 0xB6, 0x5C, 0x98, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00
+	};
+
+	InvadersMachine	bench_mach_;
+	uint16_t		bench_rgb_[W * H];
+	uint8_t			bench_page_[W * H / 8];
+	int				bench_bad_ = 0;
+
+	// 最適化で結果が消えないように
+	volatile uint32_t	sink_;
+
+	void bench_(const char* title, const unsigned char* prog, unsigned len, unsigned frames)
+	{
+		static char rom[0x2000];
+		memset(rom, 0, sizeof(rom));
+		memcpy(rom, prog, len);
+		memcpy(&rom[0x0100], invader_, sizeof(invader_));
+		// 0200: 位置の表（8 列 × 5 行、左端は空白のカラム）
+		for(unsigned i = 0; i < 40; ++i) {
+			unsigned a = InvadersMachine::VideoAddress + (48 + (i % 8) * 16) * 32 + 12 + (i / 8) * 3;
+			rom[0x200 + i * 2] = a & 0xFF;
+			rom[0x200 + i * 2 + 1] = a >> 8;
+		}
+		InvadersMachine& m = bench_mach_;
+		m.setROM(rom);
+		m.reset();
+		memset(bench_rgb_, 0, sizeof(bench_rgb_));
+		memset(bench_page_, 0, sizeof(bench_page_));
+
+		uint64_t cols = 0;
+		uint64_t nrgb = 0;
+		uint64_t npage = 0;
+		double tstep = 0.0;
+		double trgb = 0.0;
+		double tpage = 0.0;
+		for(unsigned f = 0; f < frames; ++f) {
+			auto t0 = std::chrono::steady_clock::now();
+			m.step();
+			auto t1 = std::chrono::steady_clock::now();
+			for(unsigned x = 0; x < W; ++x) cols += m.isDirty(x);
+			nrgb += video_.blitRGB565(m, bench_rgb_, W, H);
+			auto t2 = std::chrono::steady_clock::now();
+			npage += video_.blitPage(m, bench_page_, W, H / 8);
+			auto t3 = std::chrono::steady_clock::now();
+			m.clearDirty();
+			tstep += std::chrono::duration<double, std::micro>(t1 - t0).count();
+			trgb  += std::chrono::duration<double, std::micro>(t2 - t1).count();
+			tpage += std::chrono::duration<double, std::micro>(t3 - t2).count();
+		}
+		sink_ = bench_rgb_[frames % (W * H)] + bench_page_[frames % (W * H / 8)];
+
+		// 変化したカラムだけの転送を続けた結果は、全画面の展開と同じ
+		const unsigned char* vram = m.getVideo();
+		unsigned on = 0;
+		for(unsigned x = 0; x < W; ++x) {
+			for(unsigned y = 0; y < H; ++y) {
+				unsigned b = (H - 1) - y;
+				bool v = (vram[x * 32 + b / 8] >> (b & 7)) & 1;
+				on += v;
+				if((bench_rgb_[y * W + x] == 0xFFFF) != v) ++bench_bad_;
+				if(((bench_page_[(y >> 3) * W + x] >> (y & 7)) & 1) != v) ++bench_bad_;
+			}
+		}
+		if(on == 0) ++bench_bad_;  // 何も描かれていない
+
+		double c = static_cast<double>(cols) / frames;
+		printf("  %-7s %u frames, step %6.1f us/frame, %5.1f dirty columns/frame (VRAM read %.0f bytes)\n",
+			title, frames, tstep / frames, c, c * InvadersMachine::VideoPitch);
+		printf("    blitRGB565 %7.0f bytes/frame (full %u), %6.2f us/frame\n",
+			static_cast<double>(nrgb) / frames, W * H * 2, trgb / frames);
+		printf("    blitPage   %7.0f bytes/frame (full %u), %6.2f us/frame\n",
+			static_cast<double>(npage) / frames, W * H / 8, tpage / frames);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* file = "video_test.ppm";
+	if(argc > 1) file = argv[1];
+
+	static char rom[0x2000];
+	memcpy(rom, full_prog_, sizeof(full_prog_));
+	mach_.setROM(rom);
+	mach_.reset();
+
+	int bad = 0;
+	for(int f = 0; f < 4; ++f) {
+		mach_.step();
+		expand_();
+		video_.blitRGB565(mach_, rgb_, W, H);
+		video_.blitPage(mach_, page_, W, H / 8);
+		video_.blitRGB565(mach_, rgb_win_, 100, 50, 30, 13);
+		video_.blitPage(mach_, page_win_, 64, 8, 100, 5);
+		for(unsigned y = 0; y < H; ++y) {
+			for(unsigned x = 0; x < W; ++x) {
+				bool on = ref_[y * W + x];
+				if((rgb_[y * W + x] == 0xFFFF) != on) ++bad;
+				if(((page_[(y >> 3) * W + x] >> (y & 7)) & 1) != on) ++bad;
+				if(x >= 30 && x < 130 && y >= 13 && y < 63) {
+					if((rgb_win_[(y - 13) * 100 + x - 30] == 0xFFFF) != on) ++bad;
+				}
+				if(x >= 100 && x < 164 && y >= 40 && y < 104) {
+					if(((page_win_[((y - 40) >> 3) * 64 + x - 100] >> (y & 7)) & 1) != on) ++bad;
+				}
+			}
+		}
+		mach_.clearDirty();
+	}
+
+	if(!video_.savePPM(mach_, file)) {
+		printf("NG save: '%s'\n", file);
+		return 1;
+	}
+	FILE* fp = fopen(file, "rb");
+	bool ok = fp != nullptr && fread(ppm_, 1, sizeof(ppm_), fp) == sizeof(ppm_);
+	if(fp != nullptr) fclose(fp);
+	remove(file);
+	if(!ok) {
+		printf("NG load: '%s'\n", file);
+		return 1;
+	}
+	for(unsigned i = 0; i < W * H; ++i) {
+		if((ppm_[15 + i * 3] == 255) != ref_[i]) ++bad;
+	}
+
+	printf("video: frame benchmark (before: %u bytes of video_ rescanned per frame)\n", W * H);
+	bench_("game", game_prog_, sizeof(game_prog_), 6000);
+	bench_("fill", full_prog_, sizeof(full_prog_), 300);
+	bad += bench_bad_;
+
+	printf("video: errors %d\n", bad);
+	return bad != 0;
+}
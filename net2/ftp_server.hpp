@@ -26,6 +26,7 @@
 #include "common/format.hpp"
 #include "common/time.h"
 #include "common/string_utils.hpp"
+#include "common/tokenizer.hpp"
 #include "net2/tcp.hpp"
 
 #define FTP_DEBUG
@@ -85,13 +86,29 @@ namespace net {
 		MLSD,	///< 引数に指定したディレクトリのファイル一覧を詳細な最終更新時間をつけて返す。
 		MLST,	///< 引数に指定したディレクトリの詳細な情報を返す。
 		SIZE,	///< ファイルサイズを返す 
+
+		NUM_	///< コマンドの数（NONE_ を含む、最後に置く事）
 	};
 
 
-	struct ftp_key_t {
-		const char*	key;
-		ftp_command	cmd;
-	};
+	namespace ftp_key {
+		// ftp_command の順番（NONE_ を除く）
+		static constexpr const char* tbl[] = {
+			// RFC 959
+			"ABOR", "ACCT", "ALLO", "APPE", "CDUP", "CWD",  "DELE", "HELP",
+			"LIST", "MKD",  "NLST", "NOOP", "MODE", "PASS", "PASV", "PORT",
+			"PWD",  "XPWD", "QUIT", "REIN", "REST", "RETR", "RMD",  "RNFR",
+			"RNTO", "SITE", "SMNT", "STAT", "STOR", "STOU", "STRU", "SYST",
+			"TYPE", "USER",
+			// RFC 2389
+			"FEAT", "OPTS",
+			// RFC 3659
+			"MDTM", "MLSD", "MLST", "SIZE",
+		};
+		static_assert((sizeof(tbl) / sizeof(tbl[0])) == (static_cast<uint32_t>(ftp_command::NUM_) - 1),
+			"ftp_key::tbl mismatch");
+		static constexpr auto hash = utils::make_key_hash(tbl);
+	}
 
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -124,8 +141,6 @@ namespace net {
 		static const uint16_t DATA_PORT = 20;
 		static const uint16_t DATA_PORT_PASV = 55600;
 
-		static const ftp_key_t key_tbl_[];
-
 		ETHERNET&		eth_;
 		SDC&			sdc_;
 
@@ -290,23 +305,12 @@ namespace net {
 			const char* term = strchr(para, ' ');
 			param_ = nullptr;
 
-			for(const ftp_key_t& t : key_tbl_) {
-				if(t.key == nullptr) break;  // end of..
+			uint32_t len = term != nullptr ? (term - para) : strlen(para);
+			auto idx = ftp_key::hash.find(para, len);
+			if(idx < 0) return ftp_command::NONE_;
 
-				if(term == nullptr) {
-					if(strcmp(t.key, para) == 0) {
-						return t.cmd;
-					}
-				} else {
-					uint32_t len = term - para;
-					if(len != 3 && len != 4) return ftp_command::NONE_;
-					if(strncmp(t.key, para, len) == 0) {
-						param_ = term + 1;
-						return t.cmd;
-					}
-				}
-			}
-			return ftp_command::NONE_;
+			if(term != nullptr) param_ = term + 1;
+			return static_cast<ftp_command>(idx + 1);
 		}
 
 
@@ -1251,54 +1255,4 @@ utils::format("Reconnection CTRL\n");
 			}
 		}
 	};
-
-	template<class ETHERNET, class SDC> const ftp_key_t ftp_server<ETHERNET, SDC>::key_tbl_[] = {
-		// RFC 959
-		{ "ABOR", ftp_command::ABOR },
-		{ "ACCT", ftp_command::ACCT },
-		{ "ALLO", ftp_command::ALLO },
-		{ "APPE", ftp_command::APPE },
-		{ "CDUP", ftp_command::CDUP },
-		{ "CWD",  ftp_command::CWD  },
-		{ "DELE", ftp_command::DELE },
-		{ "HELP", ftp_command::HELP },
-		{ "LIST", ftp_command::LIST },
-		{ "MKD",  ftp_command::MKD  },
-		{ "NLST", ftp_command::NLST },
-		{ "NOOP", ftp_command::NOOP },
-		{ "MODE", ftp_command::MODE },
-		{ "PASS", ftp_command::PASS },
-		{ "PASV", ftp_command::PASV },
-		{ "PORT", ftp_command::PORT },
-		{ "PWD",  ftp_command::PWD  },
-		{ "QUIT", ftp_command::QUIT },
-		{ "REIN", ftp_command::REIN },
-		{ "REST", ftp_command::REST },
-		{ "RETR", ftp_command::RETR },
-		{ "RMD",  ftp_command::RMD  },
-		{ "RNFR", ftp_command::RNFR },
-		{ "RNTO", ftp_command::RNTO },
-		{ "SITE", ftp_command::SITE },
-		{ "SMNT", ftp_command::SMNT },
-		{ "STAT", ftp_command::STAT },
-		{ "STOR", ftp_command::STOR },
-		{ "STOU", ftp_command::STOU },
-		{ "STRU", ftp_command::STRU },
-		{ "SYST", ftp_command::SYST },
-		{ "TYPE", ftp_command::TYPE },
-		{ "USER", ftp_command::USER },
-
-		// RFC 2389
-		{ "FEAT", ftp_command::FEAT },
-
-		// RFC 3659
-		{ "MDTM", ftp_command::MDTM },
-		{ "MLSD", ftp_command::MLSD },
-		{ "MLST", ftp_command::MLST },
-		{ "SIZE", ftp_command::SIZE },
-
-		{ "XPWD", ftp_command::XPWD },
-
-		{ nullptr, ftp_command::NONE_ },
-	};
 }
@@ -15,6 +15,7 @@
 #include "common/fixed_string.hpp"
 #include "common/color.hpp"
 #include "common/format.hpp"
+#include "common/tokenizer.hpp"
 #include "net2/tcp.hpp"
 
 #define HTTP_DEBUG
@@ -25,6 +26,14 @@ extern "C" {
 
 namespace net {
 
+	namespace http_key {
+		static constexpr const char* method_tbl[] = { "GET", "POST" };
+		static constexpr auto method = utils::make_key_hash(method_tbl);
+
+		static constexpr const char* header_tbl[] = { "Content-Length" };
+		static constexpr auto header = utils::make_key_hash(header_tbl);
+	}
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  http_server class テンプレート
@@ -119,18 +128,61 @@ namespace net {
 		bool			favicon_;
 		bool			other_link_;
 
-		static void get_path_(const char* src, char* dst) {
-			int n = 0;
-			char ch;
-			while((ch = src[n]) != 0) {
-				if(ch == ' ') break;
-				dst[n] = ch;
-				++n;
+		utils::sdc_map<>	map_;		///< 送信ファイル（高速シーク、オープンしたまま保持）
+		char			map_path_[256];
+		uint32_t		map_count_;	///< オープンした時の変更カウンター
+
+		enum class range {
+			none,	///< 「Range:」無し（全体）
+			part,	///< 部分
+			bad,	///< 満たせない範囲
+		};
+
+		// 「Range: bytes=first-last」を解析（単一範囲のみ対応） @n
+		// 書式が解釈出来ない場合は、ヘッダーを無視して全体を送る
+		range get_range_(uint32_t fsz, uint32_t& org, uint32_t& end) const
+		{
+			static const char* key = { "Range: bytes=" };
+			for(uint32_t i = 0; i < line_man_.size(); ++i) {
+				const char* p = line_man_[i];
+				if(strncmp(p, key, strlen(key)) != 0) continue;
+				p += strlen(key);
+				bool first = false;
+				uint32_t a = 0;
+				while(*p >= '0' && *p <= '9') {
+					a = a * 10 + (*p - '0');
+					++p;
+					first = true;
+				}
+				if(*p != '-') return range::none;
+				++p;
+				bool last = false;
+				uint32_t b = 0;
+				while(*p >= '0' && *p <= '9') {
+					b = b * 10 + (*p - '0');
+					++p;
+					last = true;
+				}
+				uint32_t s;
+				uint32_t e;
+				if(first) {
+					if(a >= fsz || (last && b < a)) return range::bad;
+					s = a;
+					e = (last && b < fsz) ? (b + 1) : fsz;
+				} else if(last) {  // 終端からのサイズ
+					if(b == 0 || fsz == 0) return range::bad;
+					s = b < fsz ? (fsz - b) : 0;
+					e = fsz;
+				} else {
+					return range::none;
+				}
+				org = s;
+				end = e;
+				return range::part;
 			}
-			dst[n] = 0;
+			return range::none;
 		}
 
-
 		void render_404page(const char* path)
 		{
 			exec_link(path);
@@ -181,7 +233,7 @@ namespace net {
 			link_num_(0), link_{ },
 			task_(task::none),
 			back_color_(255, 255, 255), fore_color_(0, 0, 0),
-			favicon_(false), other_link_(false)
+			favicon_(false), other_link_(false), map_(), map_path_{ 0 }, map_count_(0)
 		{ }
 
 
@@ -257,19 +309,19 @@ namespace net {
 		uint32_t make_info(int status, int length, bool keep = false)
 		{
 			uint32_t lp = 0;
-			http_format("HTTP/1.1 %d ") % status;
+			http_format::ct("HTTP/1.1 %d "_fmt) % status;
 			if(status == 200) {
-				http_format("OK\n");
+				http_format::ct("OK\n"_fmt);
 			} else if(status == 404) {
-				http_format("Not Found\n");
+				http_format::ct("Not Found\n"_fmt);
 			} else {
-				http_format("NG\n");
+				http_format::ct("NG\n"_fmt);
 			}
 
 			time_t t = get_time();
 			struct tm *m = gmtime(&t);
 			// Sun, 11 Jan 2004 16:06:23 GMT
-			http_format("Date: %s, %02d %s %4d %02d:%02d:%02d GMT\n")
+			http_format::ct("Date: %s, %02d %s %4d %02d:%02d:%02d GMT\n"_fmt)
 				% get_wday(m->tm_wday)
 				% static_cast<uint32_t>(m->tm_mon + 1)
 				% get_mon(m->tm_mon)
@@ -277,9 +329,9 @@ namespace net {
 				% static_cast<uint32_t>(m->tm_hour)
 				% static_cast<uint32_t>(m->tm_min)
 				% static_cast<uint32_t>(m->tm_sec);
-			http_format("Server: %s\n") % server_name_;
+			http_format::ct("Server: %s\n"_fmt) % server_name_;
 
-			http_format("Last-Modified: %s,%02d %s %4d %02d:%02d:%02d GMT\n")
+			http_format::ct("Last-Modified: %s,%02d %s %4d %02d:%02d:%02d GMT\n"_fmt)
 				% get_wday(m->tm_wday)
 				% static_cast<uint32_t>(m->tm_mon + 1)
 				% get_mon(m->tm_mon)
@@ -287,20 +339,20 @@ namespace net {
 				% static_cast<uint32_t>(m->tm_hour)
 				% static_cast<uint32_t>(m->tm_min)
 				% static_cast<uint32_t>(m->tm_sec);
-			http_format("Accept_ranges: bytes\n");
+			http_format::ct("Accept_ranges: bytes\n"_fmt);
 			if(length >= 0) {
-				http_format("Content-Length: %d\n") % length;
+				http_format::ct("Content-Length: %d\n"_fmt) % length;
 			} else {
-				http_format("Content-Length: ");
+				http_format::ct("Content-Length: "_fmt);
 				lp = http_format::chaout().size();
 				// % http_format::chaout().at_str().capacity();
-				http_format("     \n");
+				http_format::ct("     \n"_fmt);
 			}
 			if(keep) {
-				http_format("Keep-Alive: timeout=%u,max=%u\n") % timeout_ % max_;
+				http_format::ct("Keep-Alive: timeout=%u,max=%u\n"_fmt) % timeout_ % max_;
 			}
-			http_format("Connection: %s\n") % (keep == true ? "keep-alive" : "close");
-			http_format("Content-Type: text/html\n\n");
+			http_format::ct("Connection: %s\n"_fmt) % (keep == true ? "keep-alive" : "close");
+			http_format::ct("Content-Type: text/html\n\n"_fmt);
 
 			return lp;
 		}
@@ -401,11 +453,14 @@ namespace net {
 		void parse_cgi(int pos)
 		{
 			int len = 0;
-			for(int i = 0; i < static_cast<int>(line_man_.size()); ++i) {
+			for(int i = 1; i < static_cast<int>(line_man_.size()); ++i) {
 				const char* p = line_man_[i];
-				static const char* key = { "Content-Length: " };
-				if(strncmp(p, key, strlen(key)) == 0) {
-					utils::input("%d", p + strlen(key)) % len;
+				const char* d = std::strchr(p, ':');
+				if(d == nullptr) continue;
+				if(http_key::header.find(p, d - p) == 0) {  // Content-Length
+					++d;
+					while(*d == ' ') ++d;
+					utils::input("%d", d) % len;
 					break;
 				}
 			}
@@ -503,21 +558,63 @@ namespace net {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  ファイル送信
+			@brief  送信ファイルのキャッシュを破棄 @n
+					※書き換え、削除は変更カウンターで検出するので、@n
+					FatFs を直接使って書き換えた場合に呼ぶ
+		*/
+		//-----------------------------------------------------------------//
+		void close_file()
+		{
+			map_.close();
+			map_path_[0] = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ファイル送信 @n
+					「Range:」ヘッダーがある場合、部分（２０６）応答を返す @n
+					満たせない範囲には、４１６応答を返す
 			@param[in]	path	ファイル・パス
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
 		bool send_file(const char* path)
 		{
-			FILE* fp = fopen(path, "rb");
-			if(fp == nullptr) {
+			// 別のファイル、又は、オープン後に書き換え、削除があれば開き直す
+			if(!map_.probe() || map_count_ != sdc_.get_modify_count()
+			  || strcmp(path, map_path_) != 0) {
+				close_file();
+				if(!sdc_.open_map(map_, path)) {
+					return false;
+				}
+				strncpy(map_path_, path, sizeof(map_path_) - 1);
+				map_count_ = sdc_.get_modify_count();
+			}
+			uint32_t fsz = map_.size();
+			uint32_t org = 0;
+			uint32_t end = fsz;
+			auto rng = get_range_(fsz, org, end);
+			if(rng == range::bad) {
+				http_format::chaout().clear();
+				http_format("HTTP/1.1 416 Range Not Satisfiable\n");
+				http_format("Content-Range: bytes */%u\n") % fsz;
+				http_format("Content-Length: 0\n");
+				http_format("Connection: close\n\n");
+				http_format::chaout().flush();
+				return true;
+			}
+			if(!map_.seek(org)) {
+				close_file();
 				return false;
 			}
-			uint32_t fsz = sdc_.size(path);
 
 			http_format::chaout().clear();
-			http_format("HTTP/1.1 200 OK\n");
+			if(rng == range::part) {
+				http_format("HTTP/1.1 206 Partial Content\n");
+			} else {
+				http_format("HTTP/1.1 200 OK\n");
+			}
 			http_format("Content-Type: ");
 			const char* ext = strrchr(path, '.');
 			if(ext != nullptr) {
@@ -530,21 +627,23 @@ namespace net {
 			} else {
 				http_format("text/plain\n");
 			}
-			http_format("Content-Length: %u\n") % fsz;
+			if(rng == range::part) {
+				http_format("Content-Range: bytes %u-%u/%u\n") % org % (end - 1) % fsz;
+			}
+			http_format("Content-Length: %u\n") % (end - org);
 			http_format("Connection: close\n\n");
 			http_format::chaout().flush();				
 			uint8_t tmp[512];
-			uint32_t total = 0;
-			uint32_t len;
-			while((len = fread(tmp, 1, sizeof(tmp), fp)) == sizeof(tmp)) {
-				eth_.at_tcp().send(desc_, tmp, sizeof(tmp));
-				total += len;
-			}
-			if(len > 0) {
+			uint32_t total = org;
+			while(total < end) {
+				uint32_t len = end - total;
+				if(len > sizeof(tmp)) len = sizeof(tmp);
+				len = map_.read(tmp, len);
+				if(len == 0) break;
 				eth_.at_tcp().send(desc_, tmp, len);
 				total += len;
 			}
-			fclose(fp);
+			return total == end;
 		}
 
 
@@ -618,8 +717,11 @@ namespace net {
 							char path[256];
 							path[0] = 0;
 							const char* t = line_man_[0];
-							if(strncmp(t, "GET ", 4) == 0) {
-								get_path_(t + 4, path);
+							utils::tokenizer<3> req;  // メソッド、パス、バージョン
+							req.words(t);
+							req[1].copy(path, sizeof(path));
+							auto method = http_key::method.find(req[0]);
+							if(method == 0) {  // GET
 								debug_format("HTTP Server: GET '%s' (%d)\n") % path % len;
 								bool find = exec_link(path, false);
 								if(!find) {
@@ -627,8 +729,7 @@ namespace net {
 									make_info(404, -1, false);
 									http_format::chaout().flush();
 								}
-							} else if(strncmp(t, "POST ", 5) == 0) {
-								get_path_(t + 5, path);
+							} else if(method == 1) {  // POST
 								debug_format("HTTP Server: POST '%s' (%d)\n") % path % len;
 								parse_cgi(pos);
 								bool find = exec_link(path, true);
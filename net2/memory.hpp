@@ -1,7 +1,8 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	ネット、メモリー・テンプレート
+	@brief	ネット、メモリー・テンプレート @n
+			※実装は utils::spsc_ring（common/spsc_ring.hpp）
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -10,6 +11,7 @@
 //=====================================================================//
 #include <cstdint>
 #include "common/net_tools.hpp"
+#include "common/spsc_ring.hpp"
 
 namespace net {
 
@@ -18,13 +20,9 @@ namespace net {
         @brief  memory(fifo) クラス
     */
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	class memory {
+	class memory : public utils::spsc_ring<uint8_t> {
 
-		volatile uint16_t	get_;
-		volatile uint16_t	put_;
-
-		uint8_t*	buff_;
-		uint16_t	size_;
+		typedef utils::spsc_ring<uint8_t> base;
 
 	public:
         //-----------------------------------------------------------------//
@@ -35,7 +33,7 @@ namespace net {
         */
         //-----------------------------------------------------------------//
 		memory(void* buff = nullptr, uint16_t size = 0) noexcept :
-			get_(0), put_(0), buff_(static_cast<uint8_t*>(buff)), size_(size)
+			base(static_cast<uint8_t*>(buff), size)
 		{ }
 
 
@@ -46,55 +44,9 @@ namespace net {
 			@param[in]	size	バッファのサイズ
         */
         //-----------------------------------------------------------------//
-		void set_buff(void* buff, uint16_t size)
+		void set_buff(void* buff, uint16_t size) noexcept
 		{
-			buff_ = static_cast<uint8_t*>(buff);
-			size_ = size;
-		}
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  バッファのサイズを返す
-			@return	バッファのサイズ
-        */
-        //-----------------------------------------------------------------//
-		uint32_t size() const noexcept { return size_; }
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  長さを返す
-			@return	長さ
-        */
-        //-----------------------------------------------------------------//
-		uint32_t length() const noexcept {
-			if(put_ >= get_) return (put_ - get_);
-			else return (size_ + put_ - get_);
-		}
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  クリア
-        */
-        //-----------------------------------------------------------------//
-		void clear() noexcept { get_ = put_ = 0; }
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  格納ポイントの移動
-			@param[in]	n	移動量
-        */
-        //-----------------------------------------------------------------//
-		inline void put_go(uint16_t n) noexcept {
-			volatile uint16_t put = put_;
-			put += n;
-			if(put >= size_) {
-				put -= size_;
-			}
-			put_ = put;
+			base::set_buff(static_cast<uint8_t*>(buff), size);
 		}
 
 
@@ -104,41 +56,13 @@ namespace net {
 			@param[in]	src	ソース
 			@param[in]	len	長さ
 			@param[in]	go	ポインターを更新しない場合「false」
+			@return 格納した長さ（空きで制限される）
         */
         //-----------------------------------------------------------------//
-		void put(const void* src, uint16_t len, bool go = true) noexcept {
-			uint16_t all = len;
-			uint16_t fsz = size_ - put_;
-			uint16_t pos = put_;
-			if(fsz <= len) {
-				std::memcpy(&buff_[pos], src, fsz);
-				len -= fsz;
-				pos += fsz;
-				if(pos >= size_) pos -= size_;
-				src = static_cast<const void*>(static_cast<const uint8_t*>(src) + fsz);
-			}
-			if(len > 0) {
-				std::memcpy(&buff_[pos], src, len);
-			}
-			if(go) put_go(all);
-		}
-
-
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  取得ポイントの移動
-			@param[in]	n	移動量
-        */
-        //-----------------------------------------------------------------//
-		inline void get_go(uint16_t n) noexcept {
-			volatile uint16_t get = get_;
-			get += n;
-			if(get >= size_) {
-				get -= size_;
-			}
-			get_ = get;
+		uint16_t put(const void* src, uint16_t len, bool go = true) noexcept {
+			len = poke(static_cast<const uint8_t*>(src), len);
+			if(go && len > 0) put_go(len);
+			return len;
 		}
 
 
@@ -148,41 +72,13 @@ namespace net {
 			@param[out]	dst	コピー先
 			@param[in]	len	長さ
 			@param[in]	go	ポインターを更新しない場合「false」
+			@return 取得した長さ（格納数で制限される）
         */
         //-----------------------------------------------------------------//
-		void get(void* dst, uint16_t len, bool go = true) noexcept {
-			uint16_t all = len;
-			uint16_t fsz = size_ - get_;
-			uint16_t pos = get_;
-			if(fsz <= len) {
-				std::memcpy(dst, &buff_[pos], fsz);
-				len -= fsz;
-				pos += fsz;
-				if(pos >= size_) pos -= size_;
-				dst = static_cast<void*>(static_cast<uint8_t*>(dst) + fsz);
-			}
-			if(len > 0) {
-				std::memcpy(dst, &buff_[pos], len);
-			}
-			if(go) get_go(all);
+		uint16_t get(void* dst, uint16_t len, bool go = true) noexcept {
+			len = peek(static_cast<uint8_t*>(dst), len);
+			if(go && len > 0) get_go(len);
+			return len;
 		}
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  get 位置を返す
-			@return	位置
-        */
-        //-----------------------------------------------------------------//
-		uint16_t pos_get() const noexcept { return get_; }
-
-
-        //-----------------------------------------------------------------//
-        /*!
-            @brief  put 位置を返す
-			@return	位置
-        */
-        //-----------------------------------------------------------------//
-		uint16_t pos_put() const noexcept { return put_; }
 	};
 }
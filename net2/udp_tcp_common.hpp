@@ -227,6 +227,28 @@ namespace net {
 			}
 		}
 
+		void write(const char* str, uint32_t len) {
+			while(len > 0) {
+				uint32_t n = 0;
+				while(n < len && str[n] != '\n') ++n;
+				while(n > 0) {
+					uint32_t l = str_.capacity() - 1 - str_.size();
+					if(l > n) l = n;
+					str_.append(str, l);
+					str += l;
+					len -= l;
+					n -= l;
+					if(str_.size() >= (str_.capacity() - 1)) {
+						flush();
+					}
+				}
+				if(len > 0) {  // 改行
+					operator() (*str++);
+					--len;
+				}
+			}
+		}
+
 		uint32_t size() const { return str_.size(); }
 
 		void set_desc(uint32_t desc) { desc_ = desc; }
@@ -21,15 +21,18 @@
 #define ARCADE_H_
 
 #include <string.h>
+#include <stdint.h>
 
 #include "i8080.h"
+#include "i8080mem.h"
 
 /**
     Space Invaders arcade machine emulator.
 
     This class emulates in software the original Space Invaders arcade machine. It uses
-    the I8080 emulator to emulate the CPU and extends the I8080Environment to provide
-    the required functions to the CPU emulation.
+    the I8080 emulator to emulate the CPU and is itself the environment of the CPU, that
+    provides the required functions to the CPU emulation (memory is accessed through
+    an I8080Memory page table).
 
     For portability, this class does not make direct use of functions that may depend
     on a specific system, such as sound and video. However, it does provide access to
@@ -43,17 +46,23 @@
 
     @see I8080
     @see I8080Environment
+    @see I8080Memory
 */
 class InvadersMachine
 {
-	I8080Environment env_;
-    I8080            cpu_;
+    friend class I8080<InvadersMachine>;
+
+    I8080<InvadersMachine>  cpu_;
+    I8080Memory             mem_;
 
 public:
     /** Machine-related definitions. */
     enum Constants {
         ScreenWidth     = 224,
-        ScreenHeight    = 256
+        ScreenHeight    = 256,
+        VideoAddress    = 0x2400,
+        VideoPitch      = ScreenHeight / 8,    // Bytes per video scanline (screen column)
+        Blocks          = 1024                  // Predecoded CPU blocks
     };
 
     /** Sounds played by the machine. */
@@ -86,9 +95,13 @@ public:
 
 public:
     /** Constructor. */
-    InvadersMachine() : cpu_(env_) {
+    InvadersMachine() : cpu_(*this) {
+        mem_.mapROM( 0x0000, 0x2000, ram_ );
+        mem_.mapRAM( 0x2000, 0x2000, ram_ + 0x2000 );
+        cpu_.setBlocks( blocks_, Blocks );
 	    reset();
 	    memset( ram_, 0, 0x2000 );  // Clear the ROM area
+	    cpu_.flushBlocks();
 		setFrameRate( 60 );
 	}
 
@@ -118,20 +131,36 @@ public:
     void fireEvent( int event );
 
     /** 
-        Returns a pointer to the game video memory in normalized form
-        (224x256, one byte per pixel).
+        Returns a pointer to the game video memory, as used by the machine.
+
+        The original machine uses a one bit per pixel monochrome video adapter, with
+        the monitor rotated by 90 degrees. A video scanline is a screen <i>column</i>:
+        column <b>x</b> starts at offset <b>x*32</b>, and each byte contains eight
+        <i>vertically aligned</i> pixels, with the bottom of the screen at bit 0 of the
+        first byte. So pixel (x,y) is bit <b>(255-y)&7</b> of byte <b>x*32+(255-y)/8</b>.
 
-        The original machine uses a one bit per pixel monochrome video adapter, where
-        a byte contains eight <i>vertically aligned</i> pixels. Since this format is not 
-        in use anymore, the emulator reorganizes video memory so that there is one <i>byte</i>
-        per pixel, with scanlines arranged <i>as usual</i>: the first scanline starts at offset
-        <b>0</b>, the second at offset <b>224</b> and so on. This "wastes" some memory,
-        but makes it much easier to render the video on current cards.
+        The video memory is not converted: use InvadersVideo to copy the columns that
+        have changed (see <i>isDirty()</i>) into the format of the display.
 
-        @return a pointer to a 224x256 byte array, where each byte corresponds to a screen pixel
+        @return a pointer to a 224x32 byte array (one bit per pixel)
     */
     const unsigned char * getVideo() const {
-        return video_;
+        return ram_ + VideoAddress;
+    }
+
+    /**
+        Returns true if the specified screen column has been written with a new value
+        since the last call to <i>clearDirty()</i>.
+
+        @param  x   screen column (0 to ScreenWidth-1)
+    */
+    bool isDirty( unsigned x ) const {
+        return (dirty_[x >> 5] >> (x & 31)) & 1;
+    }
+
+    /** Clears the dirty bits of all screen columns (after the display has been updated). */
+    void clearDirty() {
+        memset( dirty_, 0, sizeof(dirty_) );
     }
 
     /**
@@ -221,13 +250,45 @@ public:
     */
     void setROM( const char * rom ) {
         memcpy( ram_, rom, 0x2000 );
+        cpu_.flushBlocks();
+    }
+
+    /**
+        Selects how the CPU is emulated.
+
+        By default the CPU executes predecoded blocks of instructions (see I8080::runBlocks),
+        otherwise it interprets one instruction at a time. Both give the same results.
+
+        @param  enable  execute predecoded blocks if true
+    */
+    void setBlockMode( bool enable ) {
+        cpu_.setBlocks( enable ? blocks_ : 0, enable ? Blocks : 0 );
     }
 
 protected:
     // Implementation of the CpuEnvironment interface
-    unsigned char readByte( unsigned addr );
+    unsigned char readByte( unsigned addr ) const {
+        return mem_.readByte( addr );
+    }
 
-    void writeByte( unsigned, unsigned char );
+    unsigned readWord( unsigned addr ) const {
+        return mem_.readWord( addr );
+    }
+
+    void writeByte( unsigned addr, unsigned char b ) {
+        // Video memory is at 0x2400-0x3FFF, mark the column if the value changes
+        unsigned v = (addr - VideoAddress) & 0xFFFF;
+        if( v < ScreenWidth * VideoPitch && ram_[VideoAddress + v] != b ) {
+            v /= VideoPitch;
+            dirty_[v >> 5] |= 1UL << (v & 31);
+        }
+        mem_.writeByte( addr, b );
+    }
+
+    void writeWord( unsigned addr, unsigned value ) {
+        writeByte( addr, value & 0xFF );
+        writeByte( addr+1, (value >> 8) & 0xFF );
+    }
 
     unsigned char readPort( unsigned port );
 
@@ -242,7 +303,8 @@ private:
     unsigned char   port4hi_;   // Port 4 out (hi)
     unsigned char   port5o_;    // Port 5 out
     unsigned char   ram_[0x4000];
-    unsigned char   video_[ScreenWidth * ScreenHeight];
+    uint32_t        dirty_[ScreenWidth / 32];   // One bit per screen column
+    I8080<InvadersMachine>::Block   blocks_[Blocks];
     unsigned        sounds_;
     unsigned        fps_;
     unsigned        cycles_per_interrupt_;
@@ -20,6 +20,8 @@
 #ifndef I8080_H_
 #define I8080_H_
 
+#include <string.h>
+
 /**
     Environment for the I8080 CPU emulator.
 
@@ -30,6 +32,13 @@
     ports: users of the I8080 emulator should provide the desired behaviour by writing a
     descendant of this class that overrides the required functions.
 
+    The I8080 class is a template on its environment and calls these functions
+    directly, so any class that provides the same (non virtual) member functions
+    can be used instead, and its functions are then inlined into the CPU core.
+    This class is the default environment, for systems that need virtual dispatch.
+
+    @see I8080Memory
+
     @author Alessandro Scotti
 */
 class I8080Environment
@@ -150,8 +159,14 @@ public:
 /**
     I8080 CPU emulator.
 
+    The template parameter is the environment (memory and I/O ports) the CPU is
+    attached to: see I8080Environment for the required member functions.
+    Instructions are dispatched through a switch, so that the opcode handlers and
+    the environment accessors are expanded inline.
+
     @author Alessandro Scotti
 */
+template <class ENV = I8080Environment>
 class I8080
 {
 public:
@@ -167,6 +182,27 @@ public:
         Sign      = 0x80
     };
 
+    /** Maximum number of instructions in a predecoded block. */
+    enum {
+        BlockOps  = 16
+    };
+
+    /**
+        Predecoded basic block (see <i>runBlocks()</i>).
+
+        A block is a straight-line run of instructions, that ends with a jump, call,
+        return, restart or halt (or when it is full). Only the opcodes are kept:
+        operands are still read from memory when the block is executed.
+    */
+    struct Block {
+        unsigned short  pc;             // Address of the first instruction
+        unsigned short  cycles;         // Cycles of all the instructions (branch not taken)
+        unsigned short  lead;           // Cycles of all but the last instruction
+        unsigned char   size;           // Size of the block in bytes
+        unsigned char   count;          // Number of instructions (0 if the block is empty)
+        unsigned char   op[BlockOps];   // Opcodes
+    };
+
 public:
     /** 8-bit register B. */
     unsigned char   B;
@@ -198,27 +234,58 @@ public:
 
         @see I8080Environment
     */
-    I8080( I8080Environment & env );
+    I8080( ENV & env );
 
     /** Copy constructor. */
     I8080( const I8080 & cpu );
 
-    /** Destructor. */
-    virtual ~I8080() {
-    }
-
     /** Resets the CPU to its initial state. */
-    virtual void reset();
+    void reset();
 
     /** Executes one CPU instruction. */
-    virtual void step();
+    void step();
+
+    /**
+        Executes instructions until the cycle counter reaches the specified value.
+
+        The last instruction may overrun the limit by a few cycles, the caller
+        should subtract the limit from the counter rather than clearing it.
+
+        @param  cycles  value of the cycle counter to run to
+    */
+    void run( unsigned cycles );
+
+    /**
+        Sets the storage for the predecoded blocks, and enables <i>runBlocks()</i>.
+
+        Blocks are looked up by address in a direct mapped table. When a block is
+        written to, all the blocks in the same 256 byte page are discarded.
+
+        @param  blocks  block table (0 to disable)
+        @param  num     number of blocks in the table (must be a power of two)
+    */
+    void setBlocks( Block * blocks, unsigned num );
+
+    /** Discards all the predecoded blocks (must be called if memory is changed by others). */
+    void flushBlocks();
+
+    /**
+        Same as <i>run()</i>, but executes predecoded blocks.
+
+        A block is executed as a whole only if its last instruction starts before
+        the limit, otherwise the interpreter finishes the run, so the result is the
+        same as with <i>run()</i>. Without a block table this is <i>run()</i>.
+
+        @param  cycles  value of the cycle counter to run to
+    */
+    void runBlocks( unsigned cycles );
 
     /** 
         Informs the CPU that an interrupt has occurred.
 
         @param  address 16-bit address of the interrupt handler
     */
-    virtual void interrupt( unsigned address );
+    void interrupt( unsigned address );
 
     /** Returns the 16-bit pseudo-register AF. */
     unsigned AF() const {
@@ -544,21 +611,271 @@ protected:
     /** Subtracts byte OP from accumulator, with borrow CF. Flags are updated. */
     unsigned char subByte( unsigned char OP, unsigned char CF );
 
-private:
-    typedef void (I8080::* OpcodeHandler)();
+    /** Executes the specified opcode (the program counter is past the opcode byte). */
+    void execute( unsigned op );
 
-    typedef struct {
-        OpcodeHandler   handler;
-        unsigned        cycles;
-    } OpcodeInfo;
+    /** Writes a byte to memory, discarding the blocks predecoded from that page. */
+    void storeByte( unsigned addr, unsigned char value ) {
+        env_.writeByte( addr, value );
+        if( code_[ (addr >> 8) & 0xFF ] ) invalidate( addr );
+    }
+
+    /** Writes a 16-bit word to memory, discarding the blocks predecoded from that page. */
+    void storeWord( unsigned addr, unsigned value ) {
+        env_.writeWord( addr, value );
+        if( code_[ (addr >> 8) & 0xFF ] ) invalidate( addr );
+        if( code_[ ((addr + 1) >> 8) & 0xFF ] ) invalidate( addr + 1 );
+    }
+
+    /** Discards the blocks predecoded from the page of the specified address. */
+    void invalidate( unsigned addr );
+
+    /** Predecodes the block at the specified address. */
+    void decodeBlock( Block & b, unsigned pc );
 
-    static OpcodeInfo   Opcode_[256];   // Opcode table
+    /** Returns the length in bytes of the specified instruction. */
+    static unsigned opcodeLength( unsigned op );
 
-    static unsigned char    PSZ_[256];  // Parity, sign, zero table
+    /** Returns true if the specified instruction ends a block. */
+    static bool isBranch( unsigned op );
+
+private:
+    static const unsigned char  Cycles_[256];   // Cycles per opcode (branches add the rest)
+
+    static const unsigned char  PSZ_[256];      // Parity, sign, zero table
 
     unsigned            halted_;
     unsigned            cycles_;
-    I8080Environment &  env_;
+    ENV &               env_;
+
+    Block *             blocks_;
+    unsigned            block_mask_;
+    unsigned            stale_;         // Set when blocks are discarded
+    unsigned char       code_[256];     // Pages with predecoded blocks
 };
 
+template <class ENV>
+I8080<ENV>::I8080( ENV & env )
+    : env_( env ), blocks_( 0 ), block_mask_( 0 ), stale_( 0 )
+{
+    memset( code_, 0, sizeof(code_) );
+    reset();
+}
+
+template <class ENV>
+I8080<ENV>::I8080( const I8080 & cpu )
+    : env_( cpu.env_ ), blocks_( 0 ), block_mask_( 0 ), stale_( 0 )
+{
+    memset( code_, 0, sizeof(code_) );
+    operator = ( cpu );
+}
+
+template <class ENV>
+I8080<ENV> & I8080<ENV>::operator = ( const I8080 & cpu )
+{
+    B = cpu.B;
+    C = cpu.C;
+    D = cpu.D;
+    E = cpu.E;
+    H = cpu.H;
+    L = cpu.L;
+    A = cpu.A;
+    F = cpu.F;
+    PC = cpu.PC;
+    SP = cpu.SP;
+
+//    halted_ = halted_;
+//    cycles_ = cycles_;
+
+    return *this;
+}
+
+template <class ENV>
+void I8080<ENV>::reset()
+{
+    B = 0; 
+    C = 0;
+    D = 0; 
+    E = 0;
+    H = 0;
+    L = 0;
+    A = 0;
+    F = 0;
+    PC = 0;
+    SP = 0xF000;
+
+    halted_ = 0;
+    cycles_ = 0;
+}
+
+template <class ENV>
+void I8080<ENV>::step()
+{
+    unsigned op = env_.readByte( PC++ );
+
+    // Execute
+    cycles_ += Cycles_[ op ];
+    execute( op );
+
+    PC &= 0xFFFF;
+}
+
+template <class ENV>
+void I8080<ENV>::run( unsigned cycles )
+{
+    // Same as step(), but keeps the loop inside the core
+    while( cycles_ < cycles ) {
+        unsigned op = env_.readByte( PC++ );
+
+        cycles_ += Cycles_[ op ];
+        execute( op );
+
+        PC &= 0xFFFF;
+    }
+}
+
+template <class ENV>
+void I8080<ENV>::interrupt( unsigned address )
+{
+    if( F & Interrupt ) {
+        if( halted_ ) {
+            PC++;
+            halted_ = 0;
+        }
+        storeByte( --SP, (PC >> 8) & 0xFF );
+        storeByte( --SP, PC & 0xFF );
+        PC = address & 0xFFFF;
+    }
+}
+
+template <class ENV>
+void I8080<ENV>::setBlocks( Block * blocks, unsigned num )
+{
+    blocks_ = num ? blocks : 0;
+    block_mask_ = blocks_ ? num - 1 : 0;
+    flushBlocks();
+}
+
+template <class ENV>
+void I8080<ENV>::flushBlocks()
+{
+    if( blocks_ ) {
+        for( unsigned i = 0; i <= block_mask_; i++ )
+            blocks_[i].count = 0;
+    }
+    memset( code_, 0, sizeof(code_) );
+    stale_ = 1;
+}
+
+template <class ENV>
+void I8080<ENV>::runBlocks( unsigned cycles )
+{
+    if( blocks_ == 0 ) {
+        run( cycles );
+        return;
+    }
+
+    while( cycles_ < cycles ) {
+        Block & b = blocks_[ (PC ^ (PC >> 6)) & block_mask_ ];
+        if( b.count == 0 || b.pc != PC )
+            decodeBlock( b, PC );
+
+        // The last instruction would start past the limit
+        if( cycles_ + b.lead >= cycles ) {
+            run( cycles );
+            return;
+        }
+
+        // Only the last instruction can branch, so the block runs from start to end
+        cycles_ += b.cycles;
+        stale_ = 0;
+        unsigned n = b.count;
+        for( unsigned i = 0; i < n; i++ ) {
+            PC++;
+            execute( b.op[i] );
+            if( stale_ ) {
+                // Code may have been changed: give back the cycles of the rest
+                while( ++i < n )
+                    cycles_ -= Cycles_[ b.op[i] ];
+            }
+        }
+
+        PC &= 0xFFFF;
+    }
+}
+
+template <class ENV>
+void I8080<ENV>::invalidate( unsigned addr )
+{
+    unsigned page = (addr >> 8) & 0xFF;
+
+    for( unsigned i = 0; i <= block_mask_; i++ ) {
+        Block & b = blocks_[i];
+        unsigned first = b.pc >> 8;
+        unsigned last = (b.pc + b.size - 1u) >> 8;
+        if( b.count && first <= page && page <= last )
+            b.count = 0;
+    }
+    code_[ page ] = 0;
+    stale_ = 1;
+}
+
+template <class ENV>
+void I8080<ENV>::decodeBlock( Block & b, unsigned pc )
+{
+    unsigned org = pc;
+
+    b.pc = pc;
+    b.cycles = 0;
+    b.count = 0;
+    for( ;; ) {
+        unsigned op = env_.readByte( pc );
+        b.op[ b.count++ ] = op;
+        b.lead = b.cycles;
+        b.cycles += Cycles_[ op ];
+        pc += opcodeLength( op );
+        // Stop at a branch, and before the program counter wraps around
+        if( isBranch( op ) || b.count == BlockOps || pc > 0xFFFF )
+            break;
+    }
+    b.size = pc - org;
+
+    // Writes to these pages will discard the block
+    for( unsigned p = org >> 8; p <= ((pc - 1) >> 8); p++ )
+        code_[ p & 0xFF ] = 1;
+}
+
+template <class ENV>
+unsigned I8080<ENV>::opcodeLength( unsigned op )
+{
+    switch( op ) {
+    case 0x01: case 0x11: case 0x21: case 0x31:     // LD   rr,nn
+    case 0x22: case 0x2A: case 0x32: case 0x3A:     // LD   (nn),HL / LD HL,(nn) / LD (nn),A / LD A,(nn)
+    case 0xC3: case 0xCD:                           // JP   nn / CALL nn
+        return 3;
+    case 0xD3: case 0xDB:                           // OUT  (n),A / IN A,(n)
+        return 2;
+    }
+    if( (op & 0xC7) == 0xC2 || (op & 0xC7) == 0xC4 )  // JP   cc,nn / CALL cc,nn
+        return 3;
+    if( (op & 0xC7) == 0x06 || (op & 0xC7) == 0xC6 )  // LD   r,n / ALU n
+        return 2;
+    return 1;
+}
+
+template <class ENV>
+bool I8080<ENV>::isBranch( unsigned op )
+{
+    switch( op ) {
+    case 0x76:                                      // HALT
+    case 0xC3: case 0xC9: case 0xCD: case 0xE9:     // JP   nn / RET / CALL nn / JP (HL)
+        return true;
+    }
+    // RET cc / JP cc,nn / CALL cc,nn / RST n
+    return (op & 0xC7) == 0xC0 || (op & 0xC7) == 0xC2 || (op & 0xC7) == 0xC4 || (op & 0xC7) == 0xC7;
+}
+
+#include "i8080sub.h"
+#include "i8080opc.h"
+
 #endif // I8080_H_
@@ -0,0 +1,179 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	I8080 メモリー・マップ（ページ・テーブル）クラス @n
+			６４K バイトの空間を、２５６バイトのページ毎に、読み出しと @n
+			書き込みのポインターで表す。@n
+			I8080 の環境（テンプレート・パラメーター）として使える。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <string.h>
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+/*!
+	@brief	I8080 メモリー・マップ・クラス @n
+			ROM と、割り当ての無いページへの書き込みは捨てる。@n
+			割り当ての無いページは「0xFF」を読み出す。
+*/
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+class I8080Memory
+{
+public:
+	enum Constants {
+		PageSize = 0x100,	///< ページの大きさ
+		Pages    = 0x100	///< ページ数（６４K バイト）
+	};
+
+private:
+	const unsigned char*	read_[Pages];
+	unsigned char*			write_[Pages];
+
+	unsigned char	open_[PageSize];	// 割り当ての無いページ（読み出し）
+	unsigned char	sink_[PageSize];	// ROM、割り当ての無いページ（書き込み）
+
+public:
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	コンストラクター（全て割り当て無し）
+	*/
+	//-----------------------------------------------------------------//
+	I8080Memory() {
+		memset(open_, 0xFF, sizeof(open_));
+		unmap(0, 0x10000);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	RAM を割り当てる（読み書き）
+		@param[in]	addr	開始アドレス（ページ単位）
+		@param[in]	size	大きさ（ページ単位）
+		@param[in]	ram		RAM
+	*/
+	//-----------------------------------------------------------------//
+	void mapRAM(unsigned addr, unsigned size, unsigned char* ram) {
+		for(unsigned i = 0; i < size; i += PageSize) {
+			unsigned page = ((addr + i) >> 8) & 0xFF;
+			read_[page]  = &ram[i];
+			write_[page] = &ram[i];
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ROM を割り当てる（読み出しのみ）
+		@param[in]	addr	開始アドレス（ページ単位）
+		@param[in]	size	大きさ（ページ単位）
+		@param[in]	rom		ROM
+	*/
+	//-----------------------------------------------------------------//
+	void mapROM(unsigned addr, unsigned size, const unsigned char* rom) {
+		for(unsigned i = 0; i < size; i += PageSize) {
+			unsigned page = ((addr + i) >> 8) & 0xFF;
+			read_[page]  = &rom[i];
+			write_[page] = sink_;
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	割り当てを外す
+		@param[in]	addr	開始アドレス（ページ単位）
+		@param[in]	size	大きさ（ページ単位）
+	*/
+	//-----------------------------------------------------------------//
+	void unmap(unsigned addr, unsigned size) {
+		for(unsigned i = 0; i < size; i += PageSize) {
+			unsigned page = ((addr + i) >> 8) & 0xFF;
+			read_[page]  = open_;
+			write_[page] = sink_;
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	書き込めるページか
+		@param[in]	addr	アドレス
+		@return 書き込めるなら「true」
+	*/
+	//-----------------------------------------------------------------//
+	bool isWritable(unsigned addr) const {
+		return write_[(addr >> 8) & 0xFF] != sink_;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	バイトの読み出し
+		@param[in]	addr	アドレス（６４K で折り返す）
+		@return 値
+	*/
+	//-----------------------------------------------------------------//
+	unsigned char readByte(unsigned addr) const {
+		return read_[(addr >> 8) & 0xFF][addr & 0xFF];
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ワードの読み出し（リトル・エンディアン）
+		@param[in]	addr	アドレス（６４K で折り返す）
+		@return 値
+	*/
+	//-----------------------------------------------------------------//
+	unsigned readWord(unsigned addr) const {
+		return readByte(addr) | (static_cast<unsigned>(readByte(addr + 1)) << 8);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	バイトの書き込み
+		@param[in]	addr	アドレス（６４K で折り返す）
+		@param[in]	value	値
+	*/
+	//-----------------------------------------------------------------//
+	void writeByte(unsigned addr, unsigned char value) {
+		write_[(addr >> 8) & 0xFF][addr & 0xFF] = value;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ワードの書き込み（リトル・エンディアン）
+		@param[in]	addr	アドレス（６４K で折り返す）
+		@param[in]	value	値
+	*/
+	//-----------------------------------------------------------------//
+	void writeWord(unsigned addr, unsigned value) {
+		writeByte(addr, value & 0xFF);
+		writeByte(addr + 1, (value >> 8) & 0xFF);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ポートの読み出し（ポートは無い）
+		@param[in]	port	ポート
+		@return 値
+	*/
+	//-----------------------------------------------------------------//
+	unsigned char readPort(unsigned port) { return 0xFF; }
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ポートへの書き込み（ポートは無い）
+		@param[in]	port	ポート
+		@param[in]	value	値
+	*/
+	//-----------------------------------------------------------------//
+	void writePort(unsigned port, unsigned char value) { }
+};
@@ -0,0 +1,2226 @@
+/*
+    I8080 emulator
+    Copyright (c) 1996-2002,2003 Alessandro Scotti
+    http://www.walkofmind.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+#ifndef I8080OPC_H_
+#define I8080OPC_H_
+
+#include "i8080.h"
+
+template <class ENV>
+const unsigned char I8080<ENV>::Cycles_[256] = {
+     4,   // NOP
+    10,   // LD   BC,nn
+     7,   // LD   (BC),A
+     6,   // INC  BC
+     5,   // INC  B
+     5,   // DEC  B
+     7,   // LD   B,n
+     4,   // RLCA
+     4,
+    11,   // ADD  HL,BC
+     7,   // LD   A,(BC)
+     6,   // DEC  BC
+     5,   // INC  C
+     5,   // DEC  C
+     7,   // LD   C,n
+     4,   // RRCA
+     4,
+    10,   // LD   DE,nn
+     7,   // LD   (DE),A
+     6,   // INC  DE
+     5,   // INC  D
+     5,   // DEC  D
+     7,   // LD   D,n
+     4,   // RLA
+     4,
+    11,   // ADD  HL,DE
+     7,   // LD   A,(DE)
+     6,   // DEC  DE
+     5,   // INC  E
+     5,   // DEC  E
+     7,   // LD   E,n
+     4,   // RRA
+     4,
+    10,   // LD   HL,nn
+    16,   // LD   (nn),HL
+     6,   // INC  HL
+     5,   // INC  H
+     5,   // DEC  H
+     7,   // LD   H,n
+     4,   // DAA
+     4,
+    11,   // ADD  HL,HL
+    16,   // LD   HL,(nn)
+     6,   // DEC  HL
+     5,   // INC  L
+     5,   // DEC  L
+     7,   // LD   L,n
+     4,   // CPL
+     4,
+    10,   // LD   SP,nn
+    13,   // LD   (nn),A
+     6,   // INC  SP
+    10,   // INC  (HL)
+    10,   // DEC  (HL)
+    10,   // LD   (HL),n
+     4,   // SCF
+     4,
+    11,   // ADD  HL,SP
+    13,   // LD   A,(nn)
+     6,   // DEC  SP
+     5,   // INC  A
+     5,   // DEC  A
+     7,   // LD   A,n
+     4,   // CCF
+     5,   // LD   B,B
+     5,   // LD   B,C
+     5,   // LD   B,D
+     5,   // LD   B,E
+     5,   // LD   B,H
+     5,   // LD   B,L
+     7,   // LD   B,(HL)
+     5,   // LD   B,A
+     5,   // LD   C,B
+     5,   // LD   C,C
+     5,   // LD   C,D
+     5,   // LD   C,E
+     5,   // LD   C,H
+     5,   // LD   C,L
+     7,   // LD   C,(HL)
+     5,   // LD   C,A
+     5,   // LD   D,B
+     5,   // LD   D,C
+     5,   // LD   D,D
+     5,   // LD   D,E
+     5,   // LD   D,H
+     5,   // LD   D,L
+     7,   // LD   D,(HL)
+     5,   // LD   D,A
+     5,   // LD   E,B
+     5,   // LD   E,C
+     5,   // LD   E,D
+     5,   // LD   E,E
+     5,   // LD   E,H
+     5,   // LD   E,L
+     7,   // LD   E,(HL)
+     5,   // LD   E,A
+     5,   // LD   H,B
+     5,   // LD   H,C
+     5,   // LD   H,D
+     5,   // LD   H,E
+     5,   // LD   H,H
+     5,   // LD   H,L
+     7,   // LD   H,(HL)
+     5,   // LD   H,A
+     5,   // LD   L,B
+     5,   // LD   L,C
+     5,   // LD   L,D
+     5,   // LD   L,E
+     5,   // LD   L,H
+     5,   // LD   L,L
+     7,   // LD   L,(HL)
+     5,   // LD   L,A
+     7,   // LD   (HL),B
+     7,   // LD   (HL),C
+     7,   // LD   (HL),D
+     7,   // LD   (HL),E
+     7,   // LD   (HL),H
+     7,   // LD   (HL),L
+     7,   // HALT
+     7,   // LD   (HL),A
+     5,   // LD   A,B
+     5,   // LD   A,C
+     5,   // LD   A,D
+     5,   // LD   A,E
+     5,   // LD   A,H
+     5,   // LD   A,L
+     7,   // LD   A,(HL)
+     5,   // LD   A,A
+     4,   // ADD  A,B
+     4,   // ADD  A,C
+     4,   // ADD  A,D
+     4,   // ADD  A,E
+     4,   // ADD  A,H
+     4,   // ADD  A,L
+     7,   // ADD  A,(HL)
+     4,   // ADD  A,A
+     4,   // ADC  A,B
+     4,   // ADC  A,C
+     4,   // ADC  A,D
+     4,   // ADC  A,E
+     4,   // ADC  A,H
+     4,   // ADC  A,L
+     7,   // ADC  A,(HL)
+     4,   // ADC  A,A
+     4,   // SUB  B
+     4,   // SUB  C
+     4,   // SUB  D
+     4,   // SUB  E
+     4,   // SUB  H
+     4,   // SUB  L
+     7,   // SUB  (HL)
+     4,   // SUB  A
+     4,   // SBC  A,B
+     4,   // SBC  A,C
+     4,   // SBC  A,D
+     4,   // SBC  A,E
+     4,   // SBC  A,H
+     4,   // SBC  A,L
+     7,   // SBC  A,(HL)
+     4,   // SBC  A,A
+     4,   // AND  B
+     4,   // AND  C
+     4,   // AND  D
+     4,   // AND  E
+     4,   // AND  H
+     4,   // AND  L
+     7,   // AND  (HL)
+     4,   // AND  A
+     4,   // XOR  B
+     4,   // XOR  C
+     4,   // XOR  D
+     4,   // XOR  E
+     4,   // XOR  H
+     4,   // XOR  L
+     7,   // XOR  (HL)
+     4,   // XOR  A
+     4,   // OR   B
+     4,   // OR   C
+     4,   // OR   D
+     4,   // OR   E
+     4,   // OR   H
+     4,   // OR   L
+     7,   // OR   (HL)
+     4,   // OR   A
+     4,   // CP   B
+     4,   // CP   C
+     4,   // CP   D
+     4,   // CP   E
+     4,   // CP   H
+     4,   // CP   L
+     7,   // CP   (HL)
+     4,   // CP   A
+     5,   // RET  NZ
+    10,   // POP  BC
+    10,   // JP   NZ,nn
+    10,   // JP   nn
+    11,   // CALL NZ,nn
+    11,   // PUSH BC
+     7,   // ADD  A,n
+    11,   // RST  0
+     5,   // RET  Z
+    10,   // RET
+    10,   // JP   Z,nn
+     4,
+    11,   // CALL Z,nn
+    17,   // CALL nn
+     7,   // ADC  A,n
+    11,   // RST  8
+     5,   // RET  NC
+    10,   // POP  DE
+    10,   // JP   NC,nn
+    10,   // OUT  (n),A
+    11,   // CALL NC,nn
+    11,   // PUSH DE
+     7,   // SUB  n
+    11,   // RST  10H
+     5,   // RET  C
+     4,
+    10,   // JP   C,nn
+    10,   // IN   A,(n)
+    11,   // CALL C,nn
+     4,
+     7,   // SBC  A,n
+    11,   // RST  18H
+     5,   // RET  PO
+    10,   // POP  HL
+    10,   // JP   PO,nn
+     4,   // EX   (SP),HL
+    11,   // CALL PO,nn
+    11,   // PUSH HL
+     7,   // AND  n
+    11,   // RST  20H
+     5,   // RET  PE
+     4,   // JP   (HL)
+    10,   // JP   PE,nn
+     4,   // EX   DE,HL
+    11,   // CALL PE,nn
+     4,
+     7,   // XOR  n
+    11,   // RST  28H
+     5,   // RET  P
+    10,   // POP  AF
+    10,   // JP   P,nn
+     4,   // DI
+    11,   // CALL P,nn
+    11,   // PUSH AF
+     7,   // OR   n
+    11,   // RST  30H
+     5,   // RET  M
+     6,   // LD   SP,HL
+    10,   // JP   M,nn
+     4,   // EI
+    11,   // CALL M,nn
+     4,
+     7,   // CP   n
+    11    // RST  38H
+};
+
+template <class ENV>
+inline void I8080<ENV>::opcode_00()    // NOP
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_01()    // LD   BC,nn
+{
+    C = env_.readByte( PC++ );
+    B = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_02()    // LD   (BC),A
+{
+    storeByte( BC(), A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_03()    // INC  BC
+{
+    if( ++C == 0 ) ++B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_04()    // INC  B
+{
+    B = incByte( B );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_05()    // DEC  B
+{
+    B = decByte( B );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_06()    // LD   B,n
+{
+    B = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_07()    // RLCA
+{
+    A = (A << 1) | (A >> 7);
+    F &= ~(AddSub | HalfCarry | Carry);
+    if( A & 0x01 ) F |= Carry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_09()    // ADD  HL,BC
+{
+    unsigned hl = HL();
+    unsigned rp = BC();
+    unsigned x  = hl + rp;
+
+    F &= (Flag3 | Flag5 | Sign | Zero | Parity);
+    if( x > 0xFFFF ) F |= Carry;
+    if( ((hl & 0xFFF) + (rp & 0xFFF)) > 0xFFF ) F |= HalfCarry;
+
+    L = x & 0xFF;
+    H = (x >> 8) & 0xFF;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_0a()    // LD   A,(BC)
+{
+    A = env_.readByte( BC() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_0b()    // DEC  BC
+{
+    if( C-- == 0 ) --B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_0c()    // INC  C
+{
+    C = incByte( C );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_0d()    // DEC  C
+{
+    C = decByte( C );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_0e()    // LD   C,n
+{
+    C = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_0f()    // RRCA
+{
+    A = (A >> 1) | (A << 7);
+    F &= ~(AddSub | HalfCarry | Carry);
+    if( A & 0x80 ) F |= Carry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_11()    // LD   DE,nn
+{
+    E = env_.readByte( PC++ );
+    D = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_12()    // LD   (DE),A
+{
+    storeByte( DE(), A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_13()    // INC  DE
+{
+    if( ++E == 0 ) ++D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_14()    // INC  D
+{
+    D = incByte( D );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_15()    // DEC  D
+{
+    D = decByte( D );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_16()    // LD   D,n
+{
+    D = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_17()    // RLA
+{
+    unsigned char   a = A;
+
+    A <<= 1;
+    if( F & Carry ) A |= 0x01;
+    F &= ~(AddSub | HalfCarry | Carry);
+    if( a & 0x80 ) F |= Carry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_19()    // ADD  HL,DE
+{
+    unsigned hl = HL();
+    unsigned rp = DE();
+    unsigned x  = hl + rp;
+
+    F &= (Flag3 | Flag5 | Sign | Zero | Parity);
+    if( x > 0xFFFF ) F |= Carry;
+    if( ((hl & 0xFFF) + (rp & 0xFFF)) > 0xFFF ) F |= HalfCarry;
+
+    L = x & 0xFF;
+    H = (x >> 8) & 0xFF;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_1a()    // LD   A,(DE)
+{
+    A = env_.readByte( DE() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_1b()    // DEC  DE
+{
+    if( E-- == 0 ) --D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_1c()    // INC  E
+{
+    E = incByte( E );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_1d()    // DEC  E
+{
+    E = decByte( E );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_1e()    // LD   E,n
+{
+    E = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_1f()    // RRA
+{
+    unsigned char   a = A;
+
+    A >>= 1;
+    if( F & Carry ) A |= 0x80;
+    F &= ~(AddSub | HalfCarry | Carry);
+    if( a & 0x01 ) F |= Carry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_21()    // LD   HL,nn
+{
+    L = env_.readByte( PC++ );
+    H = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_22()    // LD   (nn),HL
+{
+    unsigned x = nextWord();
+
+    storeByte( x  , L );
+    storeByte( x+1, H );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_23()    // INC  HL
+{
+    if( ++L == 0 ) ++H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_24()    // INC  H
+{
+    H = incByte( H );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_25()    // DEC  H
+{
+    H = decByte( H );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_26()    // LD   H,n
+{
+    H = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_27()    // DAA
+{
+    // Both corrections are decided from the original A: adding 6 first
+    // would wrap A >= 0xFA and lose the carry out of the high digit
+    unsigned lo = A & 0x0F;
+    unsigned corr = 0;
+
+    if( (lo > 9) || (F & HalfCarry) ) {
+        corr = 0x06;
+    }
+
+    if( (A > 0x99) || (F & Carry) ) {
+        corr |= 0x60;
+        F |= Carry;
+    }
+    else {
+        F &= ~Carry;
+    }
+
+    if( (lo + (corr & 0x0F)) > 0x0F ) {
+        F |= HalfCarry;
+    }
+    else {
+        F &= ~HalfCarry;
+    }
+
+    A = (A + corr) & 0xFF;
+
+    setFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_29()    // ADD  HL,HL
+{
+    unsigned hl = HL();
+    unsigned rp = hl;
+    unsigned x  = hl + rp;
+
+    F &= (Flag3 | Flag5 | Sign | Zero | Parity);
+    if( x > 0xFFFF ) F |= Carry;
+    if( ((hl & 0xFFF) + (rp & 0xFFF)) > 0xFFF ) F |= HalfCarry;
+
+    L = x & 0xFF;
+    H = (x >> 8) & 0xFF;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_2a()    // LD   HL,(nn)
+{
+    unsigned x = nextWord();
+
+    L = env_.readByte( x );
+    H = env_.readByte( x+1 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_2b()    // DEC  HL
+{
+    if( L-- == 0 ) --H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_2c()    // INC  L
+{
+    L = incByte( L );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_2d()    // DEC  L
+{
+    L = decByte( L );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_2e()    // LD   L,n
+{
+    L = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_2f()    // CPL
+{
+    A ^= 0xFF;
+    F |= AddSub | HalfCarry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_31()    // LD   SP,nn
+{
+    SP = nextWord();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_32()    // LD   (nn),A
+{
+    storeByte( nextWord(), A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_33()    // INC  SP
+{
+    SP = (SP + 1) & 0xFFFF;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_34()    // INC  (HL)
+{
+    storeByte( HL(), incByte( env_.readByte( HL() ) ) );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_35()    // DEC  (HL)
+{
+    storeByte( HL(), decByte( env_.readByte( HL() ) ) );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_36()    // LD   (HL),n
+{
+    storeByte( HL(), env_.readByte( PC++ ) );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_37()    // SCF
+{
+    F |= Carry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_39()    // ADD  HL,SP
+{
+    unsigned hl = HL();
+    unsigned rp = SP;
+    unsigned x  = hl + rp;
+
+    F &= (Flag3 | Flag5 | Sign | Zero | Parity);
+    if( x > 0xFFFF ) F |= Carry;
+    if( ((hl & 0xFFF) + (rp & 0xFFF)) > 0xFFF ) F |= HalfCarry;
+
+    L = x & 0xFF;
+    H = (x >> 8) & 0xFF;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_3a()    // LD   A,(nn)
+{
+    A = env_.readByte( nextWord() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_3b()    // DEC  SP
+{
+    SP = (SP - 1) & 0xFFFF;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_3c()    // INC  A
+{
+    A = incByte( A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_3d()    // DEC  A
+{
+    A = decByte( A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_3e()    // LD   A,n
+{
+    A = env_.readByte( PC++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_3f()    // CCF
+{
+    F ^= Carry;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_40()    // LD   B,B
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_41()    // LD   B,C
+{
+    B = C;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_42()    // LD   B,D
+{
+    B = D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_43()    // LD   B,E
+{
+    B = E;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_44()    // LD   B,H
+{
+    B = H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_45()    // LD   B,L
+{
+    B = L;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_46()    // LD   B,(HL)
+{
+    B = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_47()    // LD   B,A
+{
+    B = A;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_48()    // LD   C,B
+{
+    C = B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_49()    // LD   C,C
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_4a()    // LD   C,D
+{
+    C = D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_4b()    // LD   C,E
+{
+    C = E;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_4c()    // LD   C,H
+{
+    C = H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_4d()    // LD   C,L
+{
+    C = L;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_4e()    // LD   C,(HL)
+{
+    C = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_4f()    // LD   C,A
+{
+    C = A;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_50()    // LD   D,B
+{
+    D = B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_51()    // LD   D,C
+{
+    D = C;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_52()    // LD   D,D
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_53()    // LD   D,E
+{
+    D = E;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_54()    // LD   D,H
+{
+    D = H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_55()    // LD   D,L
+{
+    D = L;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_56()    // LD   D,(HL)
+{
+    D = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_57()    // LD   D,A
+{
+    D = A;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_58()    // LD   E,B
+{
+    E = B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_59()    // LD   E,C
+{
+    E = C;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_5a()    // LD   E,D
+{
+    E = D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_5b()    // LD   E,E
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_5c()    // LD   E,H
+{
+    E = H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_5d()    // LD   E,L
+{
+    E = L;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_5e()    // LD   E,(HL)
+{
+    E = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_5f()    // LD   E,A
+{
+    E = A;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_60()    // LD   H,B
+{
+    H = B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_61()    // LD   H,C
+{
+    H = C;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_62()    // LD   H,D
+{
+    H = D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_63()    // LD   H,E
+{
+    H = E;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_64()    // LD   H,H
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_65()    // LD   H,L
+{
+    H = L;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_66()    // LD   H,(HL)
+{
+    H = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_67()    // LD   H,A
+{
+    H = A;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_68()    // LD   L,B
+{
+    L = B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_69()    // LD   L,C
+{
+    L = C;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_6a()    // LD   L,D
+{
+    L = D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_6b()    // LD   L,E
+{
+    L = E;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_6c()    // LD   L,H
+{
+    L = H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_6d()    // LD   L,L
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_6e()    // LD   L,(HL)
+{
+    L = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_6f()    // LD   L,A
+{
+    L = A;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_70()    // LD   (HL),B
+{
+    storeByte( HL(), B );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_71()    // LD   (HL),C
+{
+    storeByte( HL(), C );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_72()    // LD   (HL),D
+{
+    storeByte( HL(), D );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_73()    // LD   (HL),E
+{
+    storeByte( HL(), E );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_74()    // LD   (HL),H
+{
+    storeByte( HL(), H );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_75()    // LD   (HL),L
+{
+    storeByte( HL(), L );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_76()    // HALT
+{
+    halted_ = 1;
+    PC--;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_77()    // LD   (HL),A
+{
+    storeByte( HL(), A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_78()    // LD   A,B
+{
+    A = B;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_79()    // LD   A,C
+{
+    A = C;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_7a()    // LD   A,D
+{
+    A = D;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_7b()    // LD   A,E
+{
+    A = E;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_7c()    // LD   A,H
+{
+    A = H;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_7d()    // LD   A,L
+{
+    A = L;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_7e()    // LD   A,(HL)
+{
+    A = env_.readByte( HL() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_7f()    // LD   A,A
+{
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_80()    // ADD  A,B
+{
+    addByte( B, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_81()    // ADD  A,C
+{
+    addByte( C, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_82()    // ADD  A,D
+{
+    addByte( D, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_83()    // ADD  A,E
+{
+    addByte( E, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_84()    // ADD  A,H
+{
+    addByte( H, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_85()    // ADD  A,L
+{
+    addByte( L, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_86()    // ADD  A,(HL)
+{
+    addByte( env_.readByte( HL() ), 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_87()    // ADD  A,A
+{
+    addByte( A, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_88()    // ADC  A,B
+{
+    addByte( B, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_89()    // ADC  A,C
+{
+    addByte( C, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_8a()    // ADC  A,D
+{
+    addByte( D, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_8b()    // ADC  A,E
+{
+    addByte( E, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_8c()    // ADC  A,H
+{
+    addByte( H, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_8d()    // ADC  A,L
+{
+    addByte( L, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_8e()    // ADC  A,(HL)
+{
+    addByte( env_.readByte( HL() ), F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_8f()    // ADC  A,A
+{
+    addByte( A, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_90()    // SUB  B
+{
+    A = subByte( B, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_91()    // SUB  C
+{
+    A = subByte( C, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_92()    // SUB  D
+{
+    A = subByte( D, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_93()    // SUB  E
+{
+    A = subByte( E, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_94()    // SUB  H
+{
+    A = subByte( H, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_95()    // SUB  L
+{
+    A = subByte( L, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_96()    // SUB  (HL)
+{
+    A = subByte( env_.readByte( HL() ), 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_97()    // SUB  A
+{
+    A = subByte( A, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_98()    // SBC  A,B
+{
+    A = subByte( B, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_99()    // SBC  A,C
+{
+    A = subByte( C, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_9a()    // SBC  A,D
+{
+    A = subByte( D, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_9b()    // SBC  A,E
+{
+    A = subByte( E, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_9c()    // SBC  A,H
+{
+    A = subByte( H, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_9d()    // SBC  A,L
+{
+    A = subByte( L, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_9e()    // SBC  A,(HL)
+{
+    A = subByte( env_.readByte( HL() ), F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_9f()    // SBC  A,A
+{
+    A = subByte( A, F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a0()    // AND  B
+{
+    A &= B;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a1()    // AND  C
+{
+    A &= C;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a2()    // AND  D
+{
+    A &= D;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a3()    // AND  E
+{
+    A &= E;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a4()    // AND  H
+{
+    A &= H;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a5()    // AND  L
+{
+    A &= L;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a6()    // AND  (HL)
+{
+    A &= env_.readByte( HL() );
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a7()    // AND  A
+{
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a8()    // XOR  B
+{
+    A ^= B;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_a9()    // XOR  C
+{
+    A ^= C;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_aa()    // XOR  D
+{
+    A ^= D;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ab()    // XOR  E
+{
+    A ^= E;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ac()    // XOR  H
+{
+    A ^= H;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ad()    // XOR  L
+{
+    A ^= L;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ae()    // XOR  (HL)
+{
+    A ^= env_.readByte( HL() );
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_af()    // XOR  A
+{
+    A = 0;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b0()    // OR   B
+{
+    A |= B;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b1()    // OR   C
+{
+    A |= C;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b2()    // OR   D
+{
+    A |= D;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b3()    // OR   E
+{
+    A |= E;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b4()    // OR   H
+{
+    A |= H;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b5()    // OR   L
+{
+    A |= L;
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b6()    // OR   (HL)
+{
+    A |= env_.readByte( HL() );
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b7()    // OR   A
+{
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b8()    // CP   B
+{
+    subByte( B, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_b9()    // CP   C
+{
+    subByte( C, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ba()    // CP   D
+{
+    subByte( D, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_bb()    // CP   E
+{
+    subByte( E, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_bc()    // CP   H
+{
+    subByte( H, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_bd()    // CP   L
+{
+    subByte( L, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_be()    // CP   (HL)
+{
+    subByte( env_.readByte( HL() ), 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_bf()    // CP   A
+{
+    subByte( A, 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c0()    // RET  NZ
+{
+    if( ! (F & Zero) ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c1()    // POP  BC
+{
+    C = env_.readByte( SP++ );
+    B = env_.readByte( SP++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c2()    // JP   NZ,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Zero) ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c3()    // JP   nn
+{
+     PC = env_.readWord( PC );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c4()    // CALL NZ,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Zero) ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c5()    // PUSH BC
+{
+    storeByte( --SP, B );
+    storeByte( --SP, C );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c6()    // ADD  A,n
+{
+    addByte( env_.readByte( PC++ ), 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c7()    // RST  0
+{
+    callSub( 0x00 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c8()    // RET  Z
+{
+    if( F & Zero ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_c9()    // RET
+{
+     retFromSub();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ca()    // JP   Z,nn
+{
+    unsigned    pc = nextWord();
+
+     if( F & Zero ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_cc()    // CALL Z,nn
+{
+    unsigned    pc = nextWord();
+
+    if( F & Zero ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_cd()    // CALL nn
+{
+    callSub( nextWord() );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ce()    // ADC  A,n
+{
+    addByte( env_.readByte( PC++ ), F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_cf()    // RST  8
+{
+    callSub( 0x08 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d0()    // RET  NC
+{
+    if( ! (F & Carry) ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d1()    // POP  DE
+{
+    E = env_.readByte( SP++ );
+    D = env_.readByte( SP++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d2()    // JP   NC,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Carry) ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d3()    // OUT  (n),A
+{
+    env_.writePort( env_.readByte( PC++ ), A );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d4()    // CALL NC,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Carry) ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d5()    // PUSH DE
+{
+    storeByte( --SP, D );
+    storeByte( --SP, E );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d6()    // SUB  n
+{
+    A = subByte( env_.readByte( PC++ ), 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d7()    // RST  10H
+{
+    callSub( 0x10 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_d8()    // RET  C
+{
+    if( F & Carry ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_da()    // JP   C,nn
+{
+    unsigned    pc = nextWord();
+
+     if( F & Carry ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_db()    // IN   A,(n)
+{
+    A = env_.readPort( env_.readByte( PC++ ) );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_dc()    // CALL C,nn
+{
+    unsigned    pc = nextWord();
+
+    if( F & Carry ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_de()    // SBC  A,n
+{
+    A = subByte( env_.readByte( PC++ ), F & Carry );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_df()    // RST  18H
+{
+    callSub( 0x18 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e0()    // RET  PO
+{
+    if( ! (F & Parity) ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e1()    // POP  HL
+{
+    L = env_.readByte( SP++ );
+    H = env_.readByte( SP++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e2()    // JP   PO,nn
+{
+    unsigned    pc = nextWord();
+
+     if( ! (F & Parity) ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e3()    // EX   (SP),HL
+{
+    unsigned char   x;
+
+    x = env_.readByte( SP   ); storeByte( SP,   L ); L = x;
+    x = env_.readByte( SP+1 ); storeByte( SP+1, H ); H = x;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e4()    // CALL PO,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Parity) ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e5()    // PUSH HL
+{
+    storeByte( --SP, H );
+    storeByte( --SP, L );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e6()    // AND  n
+{
+    A &= env_.readByte( PC++ );
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e7()    // RST  20H
+{
+    callSub( 0x20 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e8()    // RET  PE
+{
+    if( F & Parity ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_e9()    // JP   (HL)
+{
+    PC = HL();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ea()    // JP   PE,nn
+{
+    unsigned    pc = nextWord();
+
+    if( F & Parity ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_eb()    // EX   DE,HL
+{
+    unsigned char x;
+
+    x = D; D = H; H = x;
+    x = E; E = L; L = x;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ec()    // CALL PE,nn
+{
+    unsigned    pc = nextWord();
+
+    if( F & Parity ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ee()    // XOR  n
+{
+    A ^= env_.readByte( PC++ );
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ef()    // RST  28H
+{
+    callSub( 0x28 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f0()    // RET  P
+{
+    if( ! (F & Sign) ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f1()    // POP  AF
+{
+    F = env_.readByte( SP++ );
+    A = env_.readByte( SP++ );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f2()    // JP   P,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Sign) ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f3()    // DI
+{
+    F &= ~Interrupt;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f4()    // CALL P,nn
+{
+    unsigned    pc = nextWord();
+
+    if( ! (F & Sign) ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f5()    // PUSH AF
+{
+    storeByte( --SP, A );
+    storeByte( --SP, F );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f6()    // OR   n
+{
+    A |= env_.readByte( PC++ );
+    clearAndSetFlagsPSZ();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f7()    // RST  30H
+{
+    callSub( 0x30 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f8()    // RET  M
+{
+    if( F & Sign ) {
+        retFromSub();
+        cycles_ += 6;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_f9()    // LD   SP,HL
+{
+    SP = HL();
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_fa()    // JP   M,nn
+{
+    unsigned    pc = nextWord();
+
+    if( F & Sign ) {
+        PC = pc;
+        cycles_ += 5;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_fb()    // EI
+{
+    // Interrupt should be enabled only when another instruction (after this EI) has
+    // been executed. We don't emulate that for now.
+    F |= Interrupt;
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_fc()    // CALL M,nn
+{
+    unsigned    pc = nextWord();
+
+    if( F & Sign ) {
+        callSub( pc );
+        cycles_ += 7;
+    }
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_fe()    // CP   n
+{
+    subByte( env_.readByte( PC++ ), 0 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::opcode_ff()    // RST  38H
+{
+    callSub( 0x38 );
+}
+
+template <class ENV>
+inline void I8080<ENV>::execute( unsigned op )
+{
+    switch( op ) {
+    case 0x00: opcode_00(); break;
+    case 0x01: opcode_01(); break;
+    case 0x02: opcode_02(); break;
+    case 0x03: opcode_03(); break;
+    case 0x04: opcode_04(); break;
+    case 0x05: opcode_05(); break;
+    case 0x06: opcode_06(); break;
+    case 0x07: opcode_07(); break;
+    case 0x09: opcode_09(); break;
+    case 0x0a: opcode_0a(); break;
+    case 0x0b: opcode_0b(); break;
+    case 0x0c: opcode_0c(); break;
+    case 0x0d: opcode_0d(); break;
+    case 0x0e: opcode_0e(); break;
+    case 0x0f: opcode_0f(); break;
+    case 0x11: opcode_11(); break;
+    case 0x12: opcode_12(); break;
+    case 0x13: opcode_13(); break;
+    case 0x14: opcode_14(); break;
+    case 0x15: opcode_15(); break;
+    case 0x16: opcode_16(); break;
+    case 0x17: opcode_17(); break;
+    case 0x19: opcode_19(); break;
+    case 0x1a: opcode_1a(); break;
+    case 0x1b: opcode_1b(); break;
+    case 0x1c: opcode_1c(); break;
+    case 0x1d: opcode_1d(); break;
+    case 0x1e: opcode_1e(); break;
+    case 0x1f: opcode_1f(); break;
+    case 0x21: opcode_21(); break;
+    case 0x22: opcode_22(); break;
+    case 0x23: opcode_23(); break;
+    case 0x24: opcode_24(); break;
+    case 0x25: opcode_25(); break;
+    case 0x26: opcode_26(); break;
+    case 0x27: opcode_27(); break;
+    case 0x29: opcode_29(); break;
+    case 0x2a: opcode_2a(); break;
+    case 0x2b: opcode_2b(); break;
+    case 0x2c: opcode_2c(); break;
+    case 0x2d: opcode_2d(); break;
+    case 0x2e: opcode_2e(); break;
+    case 0x2f: opcode_2f(); break;
+    case 0x31: opcode_31(); break;
+    case 0x32: opcode_32(); break;
+    case 0x33: opcode_33(); break;
+    case 0x34: opcode_34(); break;
+    case 0x35: opcode_35(); break;
+    case 0x36: opcode_36(); break;
+    case 0x37: opcode_37(); break;
+    case 0x39: opcode_39(); break;
+    case 0x3a: opcode_3a(); break;
+    case 0x3b: opcode_3b(); break;
+    case 0x3c: opcode_3c(); break;
+    case 0x3d: opcode_3d(); break;
+    case 0x3e: opcode_3e(); break;
+    case 0x3f: opcode_3f(); break;
+    case 0x40: opcode_40(); break;
+    case 0x41: opcode_41(); break;
+    case 0x42: opcode_42(); break;
+    case 0x43: opcode_43(); break;
+    case 0x44: opcode_44(); break;
+    case 0x45: opcode_45(); break;
+    case 0x46: opcode_46(); break;
+    case 0x47: opcode_47(); break;
+    case 0x48: opcode_48(); break;
+    case 0x49: opcode_49(); break;
+    case 0x4a: opcode_4a(); break;
+    case 0x4b: opcode_4b(); break;
+    case 0x4c: opcode_4c(); break;
+    case 0x4d: opcode_4d(); break;
+    case 0x4e: opcode_4e(); break;
+    case 0x4f: opcode_4f(); break;
+    case 0x50: opcode_50(); break;
+    case 0x51: opcode_51(); break;
+    case 0x52: opcode_52(); break;
+    case 0x53: opcode_53(); break;
+    case 0x54: opcode_54(); break;
+    case 0x55: opcode_55(); break;
+    case 0x56: opcode_56(); break;
+    case 0x57: opcode_57(); break;
+    case 0x58: opcode_58(); break;
+    case 0x59: opcode_59(); break;
+    case 0x5a: opcode_5a(); break;
+    case 0x5b: opcode_5b(); break;
+    case 0x5c: opcode_5c(); break;
+    case 0x5d: opcode_5d(); break;
+    case 0x5e: opcode_5e(); break;
+    case 0x5f: opcode_5f(); break;
+    case 0x60: opcode_60(); break;
+    case 0x61: opcode_61(); break;
+    case 0x62: opcode_62(); break;
+    case 0x63: opcode_63(); break;
+    case 0x64: opcode_64(); break;
+    case 0x65: opcode_65(); break;
+    case 0x66: opcode_66(); break;
+    case 0x67: opcode_67(); break;
+    case 0x68: opcode_68(); break;
+    case 0x69: opcode_69(); break;
+    case 0x6a: opcode_6a(); break;
+    case 0x6b: opcode_6b(); break;
+    case 0x6c: opcode_6c(); break;
+    case 0x6d: opcode_6d(); break;
+    case 0x6e: opcode_6e(); break;
+    case 0x6f: opcode_6f(); break;
+    case 0x70: opcode_70(); break;
+    case 0x71: opcode_71(); break;
+    case 0x72: opcode_72(); break;
+    case 0x73: opcode_73(); break;
+    case 0x74: opcode_74(); break;
+    case 0x75: opcode_75(); break;
+    case 0x76: opcode_76(); break;
+    case 0x77: opcode_77(); break;
+    case 0x78: opcode_78(); break;
+    case 0x79: opcode_79(); break;
+    case 0x7a: opcode_7a(); break;
+    case 0x7b: opcode_7b(); break;
+    case 0x7c: opcode_7c(); break;
+    case 0x7d: opcode_7d(); break;
+    case 0x7e: opcode_7e(); break;
+    case 0x7f: opcode_7f(); break;
+    case 0x80: opcode_80(); break;
+    case 0x81: opcode_81(); break;
+    case 0x82: opcode_82(); break;
+    case 0x83: opcode_83(); break;
+    case 0x84: opcode_84(); break;
+    case 0x85: opcode_85(); break;
+    case 0x86: opcode_86(); break;
+    case 0x87: opcode_87(); break;
+    case 0x88: opcode_88(); break;
+    case 0x89: opcode_89(); break;
+    case 0x8a: opcode_8a(); break;
+    case 0x8b: opcode_8b(); break;
+    case 0x8c: opcode_8c(); break;
+    case 0x8d: opcode_8d(); break;
+    case 0x8e: opcode_8e(); break;
+    case 0x8f: opcode_8f(); break;
+    case 0x90: opcode_90(); break;
+    case 0x91: opcode_91(); break;
+    case 0x92: opcode_92(); break;
+    case 0x93: opcode_93(); break;
+    case 0x94: opcode_94(); break;
+    case 0x95: opcode_95(); break;
+    case 0x96: opcode_96(); break;
+    case 0x97: opcode_97(); break;
+    case 0x98: opcode_98(); break;
+    case 0x99: opcode_99(); break;
+    case 0x9a: opcode_9a(); break;
+    case 0x9b: opcode_9b(); break;
+    case 0x9c: opcode_9c(); break;
+    case 0x9d: opcode_9d(); break;
+    case 0x9e: opcode_9e(); break;
+    case 0x9f: opcode_9f(); break;
+    case 0xa0: opcode_a0(); break;
+    case 0xa1: opcode_a1(); break;
+    case 0xa2: opcode_a2(); break;
+    case 0xa3: opcode_a3(); break;
+    case 0xa4: opcode_a4(); break;
+    case 0xa5: opcode_a5(); break;
+    case 0xa6: opcode_a6(); break;
+    case 0xa7: opcode_a7(); break;
+    case 0xa8: opcode_a8(); break;
+    case 0xa9: opcode_a9(); break;
+    case 0xaa: opcode_aa(); break;
+    case 0xab: opcode_ab(); break;
+    case 0xac: opcode_ac(); break;
+    case 0xad: opcode_ad(); break;
+    case 0xae: opcode_ae(); break;
+    case 0xaf: opcode_af(); break;
+    case 0xb0: opcode_b0(); break;
+    case 0xb1: opcode_b1(); break;
+    case 0xb2: opcode_b2(); break;
+    case 0xb3: opcode_b3(); break;
+    case 0xb4: opcode_b4(); break;
+    case 0xb5: opcode_b5(); break;
+    case 0xb6: opcode_b6(); break;
+    case 0xb7: opcode_b7(); break;
+    case 0xb8: opcode_b8(); break;
+    case 0xb9: opcode_b9(); break;
+    case 0xba: opcode_ba(); break;
+    case 0xbb: opcode_bb(); break;
+    case 0xbc: opcode_bc(); break;
+    case 0xbd: opcode_bd(); break;
+    case 0xbe: opcode_be(); break;
+    case 0xbf: opcode_bf(); break;
+    case 0xc0: opcode_c0(); break;
+    case 0xc1: opcode_c1(); break;
+    case 0xc2: opcode_c2(); break;
+    case 0xc3: opcode_c3(); break;
+    case 0xc4: opcode_c4(); break;
+    case 0xc5: opcode_c5(); break;
+    case 0xc6: opcode_c6(); break;
+    case 0xc7: opcode_c7(); break;
+    case 0xc8: opcode_c8(); break;
+    case 0xc9: opcode_c9(); break;
+    case 0xca: opcode_ca(); break;
+    case 0xcc: opcode_cc(); break;
+    case 0xcd: opcode_cd(); break;
+    case 0xce: opcode_ce(); break;
+    case 0xcf: opcode_cf(); break;
+    case 0xd0: opcode_d0(); break;
+    case 0xd1: opcode_d1(); break;
+    case 0xd2: opcode_d2(); break;
+    case 0xd3: opcode_d3(); break;
+    case 0xd4: opcode_d4(); break;
+    case 0xd5: opcode_d5(); break;
+    case 0xd6: opcode_d6(); break;
+    case 0xd7: opcode_d7(); break;
+    case 0xd8: opcode_d8(); break;
+    case 0xda: opcode_da(); break;
+    case 0xdb: opcode_db(); break;
+    case 0xdc: opcode_dc(); break;
+    case 0xde: opcode_de(); break;
+    case 0xdf: opcode_df(); break;
+    case 0xe0: opcode_e0(); break;
+    case 0xe1: opcode_e1(); break;
+    case 0xe2: opcode_e2(); break;
+    case 0xe3: opcode_e3(); break;
+    case 0xe4: opcode_e4(); break;
+    case 0xe5: opcode_e5(); break;
+    case 0xe6: opcode_e6(); break;
+    case 0xe7: opcode_e7(); break;
+    case 0xe8: opcode_e8(); break;
+    case 0xe9: opcode_e9(); break;
+    case 0xea: opcode_ea(); break;
+    case 0xeb: opcode_eb(); break;
+    case 0xec: opcode_ec(); break;
+    case 0xee: opcode_ee(); break;
+    case 0xef: opcode_ef(); break;
+    case 0xf0: opcode_f0(); break;
+    case 0xf1: opcode_f1(); break;
+    case 0xf2: opcode_f2(); break;
+    case 0xf3: opcode_f3(); break;
+    case 0xf4: opcode_f4(); break;
+    case 0xf5: opcode_f5(); break;
+    case 0xf6: opcode_f6(); break;
+    case 0xf7: opcode_f7(); break;
+    case 0xf8: opcode_f8(); break;
+    case 0xf9: opcode_f9(); break;
+    case 0xfa: opcode_fa(); break;
+    case 0xfb: opcode_fb(); break;
+    case 0xfc: opcode_fc(); break;
+    case 0xfe: opcode_fe(); break;
+    case 0xff: opcode_ff(); break;
+    default:    // 0x08, 0x10, 0x18, ... (undocumented, executed as NOP)
+        break;
+    }
+}
+
+#endif // I8080OPC_H_
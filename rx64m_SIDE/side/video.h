@@ -0,0 +1,195 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	Space Invaders ビデオ転送クラス @n
+			ビデオ・メモリー（１ビット／ピクセル、９０度回転）から、@n
+			変化したカラムだけを、表示の形式に変換して転送する。@n
+			・monograph のページ形式（８ライン／バイト、LSB が上）@n
+			・RGB565（GLCDC 等）@n
+			・PPM ファイル（ホストでのダンプ用、全画面）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <stdio.h>
+#include "arcade.h"
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+/*!
+	@brief	Space Invaders ビデオ転送クラス @n
+			ビデオ・メモリーの１バイトは、縦に並んだ８ピクセル（MSB が上）@n
+			なので、回転はテーブル引きで、バイト単位に行える。@n
+			転送後、InvadersMachine::clearDirty() を呼ぶ事。
+*/
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+class InvadersVideo
+{
+	enum Constants {
+		Width  = InvadersMachine::ScreenWidth,
+		Height = InvadersMachine::ScreenHeight,
+		Pitch  = InvadersMachine::VideoPitch
+	};
+
+	uint8_t		rev_[256];			// ビット反転（ページ形式用）
+	uint16_t	expand_[16][4];		// ４ピクセル展開（MSB が上）
+	uint16_t	fore_;
+	uint16_t	back_;
+
+	static void rgb_(uint16_t c, uint8_t* rgb) {
+		rgb[0] = ((c >> 11) & 0x1F) * 255 / 31;
+		rgb[1] = ((c >>  5) & 0x3F) * 255 / 63;
+		rgb[2] = ( c        & 0x1F) * 255 / 31;
+	}
+
+public:
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	コンストラクター
+	*/
+	//-----------------------------------------------------------------//
+	InvadersVideo() {
+		for(unsigned i = 0; i < 256; ++i) {
+			uint8_t r = 0;
+			for(unsigned j = 0; j < 8; ++j) {
+				if(i & (1 << j)) r |= 0x80 >> j;
+			}
+			rev_[i] = r;
+		}
+		setColor(0xFFFF, 0x0000);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	色を設定（RGB565）
+		@param[in]	fore	ピクセルの色
+		@param[in]	back	背景の色
+	*/
+	//-----------------------------------------------------------------//
+	void setColor(uint16_t fore, uint16_t back) {
+		fore_ = fore;
+		back_ = back;
+		for(unsigned i = 0; i < 16; ++i) {
+			for(unsigned j = 0; j < 4; ++j) {
+				expand_[i][j] = (i & (8 >> j)) ? fore : back;
+			}
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	monograph のページ形式に転送（変化したカラムだけ）@n
+				転送先は「pitch」バイト／ページで、page 番目のページ、x 番目 @n
+				のバイトが、画面の（ox + x, (op + page) * 8）から下の８ピクセル
+		@param[in]	m		マシン
+		@param[out]	dst		転送先
+		@param[in]	pitch	転送先の横幅（バイト／ページ）
+		@param[in]	pages	転送先のページ数
+		@param[in]	ox		転送先の左端の、画面のカラム
+		@param[in]	op		転送先の上端の、画面のページ
+		@return 書き込んだバイト数
+	*/
+	//-----------------------------------------------------------------//
+	uint32_t blitPage(const InvadersMachine& m, uint8_t* dst, unsigned pitch, unsigned pages,
+		unsigned ox = 0, unsigned op = 0) const {
+		if(op >= Height / 8) return 0;
+		if(pages > Height / 8 - op) pages = Height / 8 - op;
+		unsigned ex = ox + pitch;
+		if(ex > Width) ex = Width;
+
+		uint32_t n = 0;
+		const uint8_t* vram = m.getVideo();
+		for(unsigned x = ox; x < ex; ++x) {
+			if(!m.isDirty(x)) continue;
+			// 画面のページ p は、カラムの (31 - p) バイト目
+			const uint8_t* src = &vram[x * Pitch + (Pitch - 1 - op)];
+			uint8_t* out = &dst[x - ox];
+			for(unsigned i = 0; i < pages; ++i) {
+				*out = rev_[*src--];
+				out += pitch;
+			}
+			n += pages;
+		}
+		return n;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	RGB565 に転送（変化したカラムだけ）@n
+				転送先の（x, y）が、画面の（ox + x, oy + y）
+		@param[in]	m		マシン
+		@param[out]	dst		転送先
+		@param[in]	pitch	転送先の横幅（ピクセル）
+		@param[in]	height	転送先の高さ（ピクセル）
+		@param[in]	ox		転送先の左端の、画面のカラム
+		@param[in]	oy		転送先の上端の、画面のライン
+		@return 書き込んだバイト数
+	*/
+	//-----------------------------------------------------------------//
+	uint32_t blitRGB565(const InvadersMachine& m, uint16_t* dst, unsigned pitch, unsigned height,
+		unsigned ox = 0, unsigned oy = 0) const {
+		if(oy >= Height) return 0;
+		unsigned ey = oy + height;
+		if(ey > Height) ey = Height;
+		unsigned ex = ox + pitch;
+		if(ex > Width) ex = Width;
+
+		uint32_t n = 0;
+		const uint8_t* vram = m.getVideo();
+		for(unsigned x = ox; x < ex; ++x) {
+			if(!m.isDirty(x)) continue;
+			const uint8_t* src = &vram[x * Pitch];
+			uint16_t* out = &dst[x - ox];
+			// ８ライン単位に、上（31 バイト目）から
+			for(unsigned y = oy & ~7; y < ey; y += 8) {
+				uint8_t v = src[Pitch - 1 - y / 8];
+				uint16_t px[8];
+				memcpy(&px[0], expand_[v >> 4],  sizeof(expand_[0]));
+				memcpy(&px[4], expand_[v & 15], sizeof(expand_[0]));
+				unsigned i = y < oy ? oy - y : 0;
+				unsigned e = y + 8 > ey ? ey - y : 8;
+				for(; i < e; ++i) {
+					out[(y + i - oy) * pitch] = px[i];
+					n += 2;
+				}
+			}
+		}
+		return n;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	PPM（P6）ファイルに保存（全画面）
+		@param[in]	m		マシン
+		@param[in]	file	ファイル名
+		@return 成功なら「true」
+	*/
+	//-----------------------------------------------------------------//
+	bool savePPM(const InvadersMachine& m, const char* file) const {
+		FILE* fp = fopen(file, "wb");
+		if(fp == nullptr) return false;
+
+		fprintf(fp, "P6\n%d %d\n255\n", Width, Height);
+		uint8_t col[2][3];
+		rgb_(back_, col[0]);
+		rgb_(fore_, col[1]);
+		const uint8_t* vram = m.getVideo();
+		bool ok = true;
+		uint8_t line[Width * 3];
+		for(unsigned y = 0; y < Height; ++y) {
+			unsigned b = (Height - 1) - y;
+			const uint8_t* src = &vram[b / 8];
+			for(unsigned x = 0; x < Width; ++x) {
+				memcpy(&line[x * 3], col[(src[x * Pitch] >> (b & 7)) & 1], 3);
+			}
+			if(fwrite(line, sizeof(line), 1, fp) != 1) ok = false;
+		}
+		if(fclose(fp) != 0) ok = false;
+		return ok;
+	}
+};
@@ -58,11 +58,11 @@ namespace seeda {
 //					if(abs_) {
 						a = std::abs(a);
 //					}
-					utils::sformat("%3.2f", dst, size, true) % a;
+					utils::sformat::ct("%3.2f"_fmt, dst, size, true) % a;
 				}
 				break;
 			default:
-				utils::sformat("%d", dst, size, true) % value;
+				utils::sformat::ct("%d"_fmt, dst, size, true) % value;
 				break;
 			}
 		}
@@ -72,18 +72,18 @@ namespace seeda {
 		{
 			static const char* modes[] = { "value", "real" };
 
-			utils::sformat("%d,%s", dst, size, append) % ch_ % modes[static_cast<uint32_t>(mode_)];
-			utils::sformat(",",     dst, size, true);
-			value_convert(min_,     dst, size);
-			utils::sformat(",",     dst, size, true);
-			value_convert(max_,     dst, size);
-			utils::sformat(",",     dst, size, true);
-			value_convert(average_, dst, size);
-			utils::sformat("%d,",   dst, size, true) % static_cast<uint32_t>(limit_lo_level_);
-			utils::sformat("%d,",   dst, size, true) % static_cast<uint32_t>(limit_lo_count_);
-			utils::sformat("%d,",   dst, size, true) % static_cast<uint32_t>(limit_hi_level_);
-			utils::sformat("%d,",   dst, size, true) % static_cast<uint32_t>(limit_hi_count_);
-			value_convert(median_,  dst, size);
+			utils::sformat::ct("%d,%s"_fmt, dst, size, append) % ch_ % modes[static_cast<uint32_t>(mode_)];
+			utils::sformat::ct(","_fmt,     dst, size, true);
+			value_convert(min_,             dst, size);
+			utils::sformat::ct(","_fmt,     dst, size, true);
+			value_convert(max_,             dst, size);
+			utils::sformat::ct(","_fmt,     dst, size, true);
+			value_convert(average_,         dst, size);
+			utils::sformat::ct("%d,"_fmt,   dst, size, true) % static_cast<uint32_t>(limit_lo_level_);
+			utils::sformat::ct("%d,"_fmt,   dst, size, true) % static_cast<uint32_t>(limit_lo_count_);
+			utils::sformat::ct("%d,"_fmt,   dst, size, true) % static_cast<uint32_t>(limit_hi_level_);
+			utils::sformat::ct("%d,"_fmt,   dst, size, true) % static_cast<uint32_t>(limit_hi_count_);
+			value_convert(median_,          dst, size);
 		}
 
 
@@ -91,15 +91,15 @@ namespace seeda {
 		{
 			uint32_t count = limit_lo_count_ + limit_hi_count_;
 
-			utils::sformat("%d,",   dst, size, append) % ch_;
-			value_convert(max_,     dst, size);
-			utils::sformat(",",     dst, size, true);
-			value_convert(min_,     dst, size);
-			utils::sformat(",",     dst, size, true);
-			value_convert(average_, dst, size);
-			utils::sformat(",",     dst, size, true);
-			value_convert(median_,  dst, size);
-			utils::sformat(",%u",   dst, size, true) % count;
+			utils::sformat::ct("%d,"_fmt, dst, size, append) % ch_;
+			value_convert(max_,           dst, size);
+			utils::sformat::ct(","_fmt,   dst, size, true);
+			value_convert(min_,           dst, size);
+			utils::sformat::ct(","_fmt,   dst, size, true);
+			value_convert(average_,       dst, size);
+			utils::sformat::ct(","_fmt,   dst, size, true);
+			value_convert(median_,        dst, size);
+			utils::sformat::ct(",%u"_fmt, dst, size, true) % count;
 		}
 	};
 
@@ -2,6 +2,7 @@
 //=====================================================================//
 /*! @file
     @brief  ファイル書き込みクラス@n
+			CSV ファイルは、sdc_stream で連続領域を事前確保して書き込む。@n
 			Copyright 2017 Kunihito Hiramatsu
     @author 平松邦仁 (hira@rvf-rc45.net)
 */
@@ -10,6 +11,7 @@
 #include <cstring>
 #include "common/fifo.hpp"
 #include "common/format.hpp"
+#include "common/sdc_stream.hpp"
 
 // #define WRITE_FILE_DEBUG
 
@@ -41,7 +43,11 @@ namespace seeda {
 		typedef utils::fifo<uint16_t, BUF_SIZE, sample_t> FIFO;
 		FIFO	fifo_;
 
-		FILE	*fp_;
+		// １ファイルは１分（ヘッダー、６０行 × ８チャネル）、閉じる時に切り詰める
+		static const uint32_t FILE_ALLOC = 1024 + 60 * 8 * 512;
+
+		typedef utils::sdc_stream<8> STREAM;
+		STREAM	stream_;
 
 		time_t	time_ref_;
 
@@ -77,7 +83,7 @@ namespace seeda {
 		//-----------------------------------------------------------------//
 		write_file() : limit_(5), count_(0), path_{ "00000" },
 			enable_(false), state_(false),
-			fp_(nullptr), time_ref_(0), task_(task::wait_request), last_data_(false), second_(0) { }
+			stream_(), time_ref_(0), task_(task::wait_request), last_data_(false), second_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -178,10 +184,9 @@ namespace seeda {
 			bool back = state_;
 			state_ = enable_;
 			if(!enable_) {
-				if(back && fp_ != nullptr) {
+				if(back && stream_.probe()) {
 					debug_format("Write file aborted\n");
-					fclose(fp_);
-					fp_ = nullptr;
+					at_sdc().close_stream(stream_);
 					task_ = task::wait_request;
 				}
 				return;
@@ -220,8 +225,7 @@ namespace seeda {
 				break;
 
 			case task::open_file:
-				fp_ = fopen(filename_, "wb");
-				if(fp_ == nullptr) {  // error then disable write.
+				if(!at_sdc().open_stream(stream_, filename_, FILE_ALLOC)) {  // error then disable write.
 					debug_format("File open error: '%s'\n") % filename_;
 					enable_ = false;
 					task_ = task::wait_request;
@@ -240,7 +244,7 @@ namespace seeda {
 					}
 					utils::sformat("\n", data, sizeof(data), true);
 
-					fwrite(data, 1, utils::sformat::chaout().size(), fp_);
+					stream_.write(data, utils::sformat::chaout().size());
 					fifo_.clear();
 					task_ = task::push_data;
 				}
@@ -285,7 +289,9 @@ namespace seeda {
 				break;
 
 			case task::write_body:
-				fwrite(data_, 1, data_len_, fp_);
+				if(stream_.write(data_, data_len_) != data_len_) {
+					debug_format("Write file full: '%s'\n") % filename_;
+				}
 				if(last_data_) {
 					if(second_ == 59) {  // change file.
 						task_ = task::next_file;
@@ -308,11 +314,9 @@ namespace seeda {
 				break;
 
 			case task::next_file:
-				fclose(fp_);
-				fp_ = nullptr;
+				at_sdc().close_stream(stream_);
 				++count_;
 				if(count_ >= limit_) {
-					fp_ = nullptr;
 					debug_format("Fin write file: %d files\n") % count_;
 					enable_ = false;
 					task_ = task::wait_request;
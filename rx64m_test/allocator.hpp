@@ -1,42 +1,45 @@
 #pragma once
 //=====================================================================//
 /*! @file
-    @brief  アロケーター・クラス
+    @brief  アロケーター・クラス @n
+			map16 用のメモリーは固定サイズ・メモリー（utils::fixed_memory）から確保する
 	@copyright Copyright 2018 Kunihito Hiramatsu All Right Reserved.
     @author 平松邦仁 (hira@rvf-rc45.net)
 */
 //=====================================================================//
-#include <new>
+#include "common/fixed_memory.hpp"
+
+// map16 のメモリー（８Ｋバイト、１６～２０４８バイトのブロック）
+typedef utils::fixed_memory<8192, 8> map16_memory;
+
+template <int N = 0>
+struct map16_pool {
+    static map16_memory memory_;
+};
+template <int N>
+map16_memory map16_pool<N>::memory_;
 
 template <class T>
-struct allocator_map16 {
+struct allocator_map16 : public utils::fixed_allocator<T, map16_memory> {
     // 要素の型
     using value_type = T;
 
     // 特殊関数
     // (デフォルトコンストラクタ、コピーコンストラクタ
     //  、ムーブコンストラクタ)
-    allocator_map16() {}
+    allocator_map16() : utils::fixed_allocator<T, map16_memory>(map16_pool<>::memory_) {}
 
     // 別な要素型のアロケータを受け取るコンストラクタ
     template <class U>
-    allocator_map16(const allocator_map16<U>&) {}
-
-    // メモリ確保
-    T* allocate(std::size_t n)
-    {
-        return reinterpret_cast<T*>(std::malloc(sizeof(T) * n));
-    }
-
-    // メモリ解放
-    void deallocate(T* p, std::size_t n)
-    {
-        static_cast<void>(n);
-        std::free(p);
-    }
+    allocator_map16(const allocator_map16<U>&) : allocator_map16() {}
+
+    template <class U>
+    struct rebind {
+        typedef allocator_map16<U> other;
+    };
 };
 
-// 比較演算子
+// 比較演算子（メモリーは共通）
 template <class T, class U>
 bool operator==(const allocator_map16<T>&, const allocator_map16<U>&)
 { return true; }
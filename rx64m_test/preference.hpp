@@ -9,12 +9,14 @@
 #include <cstdio>
 #include "common/renesas.hpp"
 #include "common/format.hpp"
+#include "common/flash_man.hpp"
 
 namespace seeda {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  preference class
+		@brief  preference class @n
+				データ・フラッシュには、flash_man のレコードとして保存する。
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class preference {
@@ -26,19 +28,13 @@ namespace seeda {
 #endif
 
 		typedef device::flash_io FLASH_IO;
+		typedef utils::flash_man<FLASH_IO> FLASH_MAN;
 
-	public:
-#ifndef PREFER_SD
-		struct seeda_h {
-			uint32_t	index_;
-			uint32_t	magic_;
-		};
-#endif
+		// flash_man のレコード ID
+		static const uint16_t PREFER_ID = 0;
 
+	public:
 		struct seeda_t {
-#ifndef PREFER_SD
-			uint32_t	index_;
-#endif
 			uint32_t	magic_;
 
 			float		gain_[8];
@@ -62,9 +58,6 @@ namespace seeda {
 			uint16_t	watchdog_time_;
 
 			seeda_t() :
-#ifndef PREFER_SD
-				index_(0),
-#endif
 				magic_(0),
 				gain_{ 1.0f },
 				limit_lo_level_{ 30000 }, limit_hi_level_{ 40000 },
@@ -85,7 +78,6 @@ namespace seeda {
 
 			void dump() const
 			{
-				utils::format("Index: %d\n") % index_;
 				utils::format("Magic: %08X\n") % magic_;
 				for(int i = 0; i < 8; ++i) {
 					utils::format("(%d) Gain: %f, ") % i % gain_[i];
@@ -104,113 +96,34 @@ namespace seeda {
 		seeda_t		seeda_;
 
 		FLASH_IO	fio_;
+		FLASH_MAN	fman_;
 
 #ifndef PREFER_SD
-
-		uint32_t block_size_()
-		{
-			uint32_t size = sizeof(seeda_t);
-			uint32_t mask = FLASH_IO::data_flash_block - 1;
-			if(size & mask) {
-				size |= mask;
-				++size;
-			}
-			return size;
-		}
-
-		uint32_t scan_flash_()
-		{
-			auto size = block_size_();
-
-			uint32_t pos = 0;
-			while(pos < FLASH_IO::data_flash_size) {
-				if(fio_.erase_check(pos, size)) {
-					return pos;
-				}
-				pos += size;
-			}
-			return FLASH_IO::data_flash_size;
-		}
-
-
-		uint32_t erase_flash_()
-		{
-			auto size = block_size_();
-
-			uint32_t pos = 0;
-			while(pos < FLASH_IO::data_flash_size) {
-				if(!fio_.erase_check(pos, size)) {
-					for(uint32_t p = pos; p < size; p += FLASH_IO::data_flash_block) {
-						fio_.erase(p);
-					}
-					return pos;
-				}
-				pos += size;
-			}
-			debug_format("Flash (preference) erase: %06X\n") % pos;
-			return FLASH_IO::data_flash_size;
-		}
-
-
-		uint32_t scan_new_file_(seeda_h& h)
-		{
-			auto size = block_size_();
-
-			h.index_ = 0;
-			h.magic_ = sizeof(seeda_t);
-
-			uint32_t back = FLASH_IO::data_flash_size;
-			uint32_t pos = 0;
-			while(pos < FLASH_IO::data_flash_size) {
-				if(!fio_.erase_check(pos, size)) {  // 使われているブロック
-					seeda_h tmp;
-					if(fio_.read(pos, &tmp, sizeof(seeda_h))) {
-						if(tmp.magic_ == sizeof(seeda_t) && tmp.index_ >= h.index_) {
-							h = tmp;
-							back = pos;
-						}
-					}
-				}
-				pos += size;
-			}
-			debug_format("Flash (preference) scan: %06X\n") % back;
-			return back;
-		}
-
-
 		bool read_flash_()
 		{
-			seeda_h h;
-			h.index_ = 0;
-			h.magic_ = sizeof(seeda_t);
-			auto pos = scan_new_file_(h);
-			if(pos >= FLASH_IO::data_flash_size) {
+			if(fman_.get_size(PREFER_ID) != sizeof(seeda_t)) {
 				debug_format("Flash (preference) read: can't find\n");
-
 				return false;
 			}
-			debug_format("Flash (preference) read: %06X\n") % pos;
-			auto ret = fio_.read(pos, &seeda_, sizeof(seeda_t));
+			seeda_t tmp;
+			if(!fman_.read(PREFER_ID, &tmp, sizeof(seeda_t)) || tmp.magic_ != sizeof(seeda_t)) {
+				debug_format("Flash (preference) read: error\n");
+				return false;
+			}
+			seeda_ = tmp;
+			debug_format("Flash (preference) read: erase count %d\n") % fman_.get_erase_count();
 
 			seeda_.dump();
 
-			return ret;
+			return true;
 		}
 
 
-		bool write_flash_(uint32_t pos)
+		bool write_flash_()
 		{
-			seeda_h h;
-			h.index_ = 0;
-			h.magic_ = sizeof(seeda_t);
-			if(scan_new_file_(h) < FLASH_IO::data_flash_size) {
-				seeda_.index_ = h.index_ + 1;
-			} else {
-				seeda_.index_ = 0;
-			}
 			seeda_.magic_ = sizeof(seeda_t);
-			debug_format("Flash (preference) write: %06X\n") % pos;
-			auto ret = fio_.write(pos, &seeda_, sizeof(seeda_t));
+			auto ret = fman_.write(PREFER_ID, &seeda_, sizeof(seeda_t));
+			debug_format("Flash (preference) write: %s\n") % (ret ? "OK" : "NG");
 
 			seeda_.dump();
 
@@ -225,7 +138,7 @@ namespace seeda {
 			@brief  コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		preference() : seeda_() { }
+		preference() : seeda_(), fio_(), fman_(fio_) { }
 
 
 		//-----------------------------------------------------------------//
@@ -245,6 +158,11 @@ namespace seeda {
 		void start()
 		{
 			fio_.start();
+#ifndef PREFER_SD
+			if(!fman_.start()) {
+				debug_format("Flash (preference) start: error\n");
+			}
+#endif
 		}
 
 
@@ -263,7 +181,7 @@ namespace seeda {
 			std::strcpy(&tmp[1], path);
 			auto f = at_sdc().remove(tmp);
 #else
-			auto f = fio_.erase_all();
+			auto f = !fman_.probe(PREFER_ID) || fman_.remove(PREFER_ID);
 #endif
 			if(f) {
 				seeda_t	tmp;
@@ -301,12 +219,7 @@ namespace seeda {
 
 			return ret;
 #else
-			auto pos = scan_flash_();  // save area + index
-			if(pos >= FLASH_IO::data_flash_size) {  // no space
-				pos = erase_flash_();
-			}
-
-			return write_flash_(pos);
+			return write_flash_();
 #endif
 		}
 
@@ -188,7 +188,7 @@ utils::format("Wait For THREG first Trigger\n");
 			uint32_t idx = 4;
 			for(uint32_t i = 0; i < num; ++i) {
 				char tmp[8];
-				utils::sformat("%04X", tmp, sizeof(tmp))
+				utils::sformat::ct("%04X"_fmt, tmp, sizeof(tmp))
 					% src[send_idx_ % WAVE_CH_SIZE];
 				++send_idx_;
 				memcpy(&wdm_buff_[idx], tmp, 4);
@@ -215,7 +215,7 @@ utils::format("Wait For THREG first Trigger\n");
 			uint32_t idx = 4;
 			for(uint32_t i = 0; i < num; ++i) {
 				char tmp[8];
-				utils::sformat("%04X", tmp, sizeof(tmp))
+				utils::sformat::ct("%04X"_fmt, tmp, sizeof(tmp))
 					% src[send_idx_ % WAVE_CH_SIZE];
 				++send_idx_;
 				memcpy(&wdm_buff_[idx], tmp, 4);
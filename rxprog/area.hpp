@@ -28,4 +28,42 @@ namespace utils {
 	};
 
 	typedef std::vector<area_t>	areas;
+
+
+	// 連続するページ（２５６バイト）を、最大 max バイトの領域にまとめる
+	inline areas make_runs(const std::vector<uint32_t>& pages, uint32_t max)
+	{
+		areas as;
+		for(auto adr : pages) {
+			if(!as.empty() && (as.back().end_ + 1) == adr && (as.back().length() + 256) <= max) {
+				as.back().end_ = adr + 255;
+			} else {
+				as.emplace_back(adr, adr + 255);
+			}
+		}
+		return as;
+	}
+
+
+	struct erase_block_t {
+		uint32_t	org_;
+		uint32_t	end_;
+		uint32_t	size_;	///< 消去単位
+		erase_block_t(uint32_t o = 0, uint32_t e = 0, uint32_t s = 0) : org_(o), end_(e), size_(s) { }
+
+		bool is_in(uint32_t adr) const {
+			if(org_ <= adr && adr <= end_) return true;
+			else return false;
+		}
+
+		// adr を含むブロック
+		area_t get_block(uint32_t adr) const {
+			uint32_t o = org_ + (adr - org_) / size_ * size_;
+			uint32_t e = o + size_ - 1;
+			if(e > end_ || e < o) e = end_;
+			return area_t(o, e);
+		}
+	};
+
+	typedef std::vector<erase_block_t>	erase_blocks;
 }
@@ -0,0 +1,220 @@
+#!/bin/bash
+#-----------------------------------------------------------------------
+#	rx_prog の検査（「make check」から呼ぶ）@n
+#	rx_sim（RX64M）を pty で起動し、実際のセッションを流して結果を調べる。@n
+#	・消去計画（ブロックの分割、ブランクのブロックは消去しない）@n
+#	・差分書き込み（変更なし、一部の変更、デバイスとキャッシュの不一致）@n
+#	・ギャング・プログラミング（一つのポートが失敗）@n
+#	・--verify-crc（一致すれば読み出さない、不一致は失敗）@n
+#	・--pipeline @n
+#	・-s auto（使える最大の速度、前回の速度の記録）
+#    @author 平松邦仁 (hira@rvf-rc45.net)
+#	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+#				Released under the MIT license @n
+#				https://github.com/hirakuni45/RX/blob/master/LICENSE
+#-----------------------------------------------------------------------
+PROG=./rx_prog
+SIM=./rx_sim
+
+if [ ! -x ${PROG} ] || [ ! -x ${SIM} ]; then
+  echo "Build '${PROG}' and '${SIM}' first (make all sim)"
+  exit 1
+fi
+
+# イメージ・キャッシュ、速度の記録は、作業ディレクトリーに置く
+WORK=`mktemp -d`
+export HOME=${WORK}
+PIDS=""
+
+cleanup() {
+  for pid in ${PIDS}; do
+    kill ${pid} 2> /dev/null
+  done
+  wait 2> /dev/null
+  rm -rf ${WORK}
+}
+trap cleanup EXIT
+
+# 固まった場合に備える（timeout が無ければ、そのまま）
+TIMEOUT=`command -v timeout`
+if [ -n "${TIMEOUT}" ]; then
+  TIMEOUT="${TIMEOUT} 60"
+fi
+
+PASS=0
+FAIL=0
+
+ok() {
+  echo "  OK  $1"
+  PASS=$((PASS + 1))
+}
+
+ng() {
+  echo "  NG  $1"
+  FAIL=$((FAIL + 1))
+}
+
+# シミュレーターの起動（リンクが出来るまで待つ）
+# start_sim NAME [options]
+start_sim() {
+  local name=$1
+  shift
+  ${SIM} -d RX64M --link=${WORK}/${name} --no-wire "$@" > ${WORK}/${name}.log 2>&1 &
+  PIDS="${PIDS} $!"
+  for i in `seq 50`; do
+    [ -e ${WORK}/${name} ] && return 0
+    sleep 0.1
+  done
+  echo "Can't start simulator: ${name}"
+  exit 1
+}
+
+# シミュレーターが表示した、最後のセッションの送信バイト数
+# last_send NAME SESSIONS（前回までのセッション数）
+last_send() {
+  local log=${WORK}/$1.log
+  for i in `seq 50`; do
+    [ `grep -c "^Session:" ${log}` -gt $2 ] && break
+    sleep 0.1
+  done
+  grep "^Session:" ${log} | tail -1 | sed -e 's/.*send: \([0-9]*\).*/\1/'
+}
+
+sessions() {
+  grep -c "^Session:" ${WORK}/$1.log
+}
+
+# rx_prog を実行（出力は ${WORK}/out）
+# prog PORT BASE FILE [options]
+prog() {
+  local port=$1
+  local base=$2
+  local file=$3
+  shift 3
+  ${TIMEOUT} ${PROG} -d RX64M -P ${WORK}/${port} --bin-base=${base} "$@" ${WORK}/${file} \
+    > ${WORK}/out 2>&1
+}
+
+# expect NAME PATTERN（直前の出力に含まれる事）
+expect() {
+  if grep -q -e "$2" ${WORK}/out; then
+    ok "$1"
+  else
+    ng "$1: '$2'"
+    sed -e 's/^/        /' ${WORK}/out
+  fi
+}
+
+# expect_rc NAME RESULT EXPECT（0: 成功、1: 失敗）
+expect_rc() {
+  local r=0
+  [ $2 -ne 0 ] && r=1
+  if [ ${r} -eq $3 ]; then
+    ok "$1"
+  else
+    ng "$1: exit status $2"
+    sed -e 's/^/        /' ${WORK}/out
+  fi
+}
+
+# バイナリー・イメージ（ROM 12K：８Ｋブロックが二つ、データ・フラッシュ 300 バイト）
+head -c 12288 /dev/urandom > ${WORK}/a.bin
+cp ${WORK}/a.bin ${WORK}/b.bin
+printf '\x5a' | dd of=${WORK}/b.bin bs=1 seek=9000 conv=notrunc 2> /dev/null
+head -c 12288 /dev/urandom > ${WORK}/c.bin
+head -c 300 /dev/urandom > ${WORK}/d.bin
+
+ROM=FFFF0000
+DATA=00100000
+
+start_sim tty0
+start_sim tty1 --max-baud=230400
+start_sim tty2 --protect
+start_sim tty3 --no-crc
+
+echo "Erase plan"
+prog tty0 ${ROM} a.bin -s 115200 -e -w -v --verbose
+expect_rc "write" $? 0
+expect "rom blocks" "# Erase plan: 2 blocks, 0 pages"
+expect "rom block 0" "#   FFFF0000 to FFFF1FFF"
+expect "rom block 1" "#   FFFF2000 to FFFF3FFF"
+expect "blank blocks are not erased" "(0 erased, 2 blank, 0 unchanged)"
+prog tty0 ${ROM} a.bin -s 115200 -e -w -v --verbose
+expect "written blocks are erased" "(2 erased, 0 blank, 0 unchanged)"
+prog tty0 ${DATA} d.bin -s 115200 -e -w -v --verbose
+expect "data flash blocks (64 bytes)" "# Erase plan: 8 blocks, 0 pages"
+expect "data flash last block" "#   001001C0 to 001001FF"
+prog tty0 ${DATA} d.bin -s 115200 -e -w -v --verbose
+expect "data flash, blank blocks" "(5 erased, 3 blank, 0 unchanged)"
+
+echo "Delta"
+prog tty0 ${ROM} a.bin -s 115200 -e -w -v --delta --serial=S1 --verbose
+expect_rc "first write" $? 0
+expect "no cache" "(none)"
+expect "all pages written" "Delta: 0 pages skipped, 48 pages written"
+prog tty0 ${ROM} a.bin -s 115200 -e -w -v --delta --serial=S1
+expect_rc "unchanged" $? 0
+expect "unchanged, nothing written" "Delta: 48 pages skipped, 0 pages written"
+prog tty0 ${ROM} b.bin -s 115200 -e -w -v --delta --serial=S1 --verbose
+expect_rc "one byte changed" $? 0
+expect "changed block only" "Delta: 32 pages skipped, 16 pages written"
+expect "unchanged block kept" "#   FFFF0000 to FFFF1FFF (unchanged)"
+# キャッシュを使わずに書き換え、デバイスとキャッシュを食い違わせる
+prog tty0 ${ROM} c.bin -s 115200 -e -w -v
+prog tty0 ${ROM} b.bin -s 115200 -e -w -v --delta --serial=S1
+expect_rc "stale cache" $? 0
+expect "stale cache detected" "Image cache mismatch at"
+expect "stale cache, full write" "Delta: 0 pages skipped, 48 pages written"
+prog tty0 ${ROM} b.bin -s 115200 -v
+expect_rc "stale cache, device contents" $? 0
+
+echo "Verify CRC"
+n=`sessions tty0`
+prog tty0 ${ROM} b.bin -s 115200 -v --verify-crc
+expect_rc "crc match" $? 0
+send=`last_send tty0 ${n}`
+if [ ${send} -lt 1024 ]; then
+  ok "crc match, not read (${send} bytes sent)"
+else
+  ng "crc match, read back (${send} bytes sent)"
+fi
+prog tty0 ${ROM} c.bin -s 115200 -v --verify-crc
+expect_rc "crc mismatch" $? 1
+expect "crc mismatch, error" "Verify error"
+prog tty3 ${ROM} a.bin -s 115200 -e -w -v --verify-crc
+expect_rc "no crc support, read back" $? 0
+
+echo "Pipeline"
+prog tty0 ${ROM} c.bin -s 115200 -e -w -v --pipeline
+expect_rc "pipelined write" $? 0
+prog tty0 ${ROM} c.bin -s 115200 -v
+expect_rc "pipelined write, device contents" $? 0
+prog tty0 ${ROM} a.bin -s 115200 -v --pipeline
+expect_rc "pipelined verify mismatch" $? 1
+
+echo "Auto speed"
+prog tty1 ${ROM} a.bin -s auto -e -w -v --progress
+expect_rc "auto" $? 0
+expect "fastest accepted rate" "# Baud rate: 230400 (auto)"
+prog tty1 ${ROM} a.bin -s auto -v --verbose
+expect_rc "auto, again" $? 0
+expect "last rate tried first" "Try baud rate: 230400 (last) OK"
+if grep -q "230400" ${WORK}/.rx_prog/speed.txt 2> /dev/null; then
+  ok "rate saved"
+else
+  ng "rate saved"
+fi
+
+echo "Gang"
+${TIMEOUT} ${PROG} -d RX64M --gang=${WORK}/tty0,${WORK}/tty1,${WORK}/tty2 -s 115200 \
+  --bin-base=${ROM} -e -w -v ${WORK}/a.bin > ${WORK}/out 2>&1
+expect_rc "one port fails" $? 1
+expect "failing port reported" "tty2 *FAIL .*erase"
+expect "other ports pass" "Gang: 2 pass, 1 fail"
+prog tty0 ${ROM} a.bin -s 115200 -v
+expect_rc "gang, port 0 contents" $? 0
+prog tty1 ${ROM} a.bin -s 115200 -v
+expect_rc "gang, port 1 contents" $? 0
+
+echo "rx_prog check: ${PASS} pass, ${FAIL} fail"
+[ ${FAIL} -eq 0 ]
@@ -69,6 +69,7 @@ namespace utils {
 			std::string speed_osx_;
 			std::string speed_linux_;
 			std::string id_;
+			std::string cache_;
 
 			bool analize(const std::string& s) {
 				bool ok = true;
@@ -85,6 +86,7 @@ namespace utils {
 					else if(ss[0] == "speed_osx") speed_osx_ = ss[1];
 					else if(ss[0] == "speed_linux") speed_linux_ = ss[1];
 					else if(ss[0] == "id") id_ = ss[1];
+					else if(ss[0] == "cache") cache_ = ss[1];
 					else ok = false;
 				} else {
 					ok = false;
@@ -133,6 +135,7 @@ namespace utils {
 			utils::areas	ram_area_;
 			utils::areas	data_area_;
 			utils::areas	rom_area_;
+			utils::erase_blocks	erase_block_;
 
 			bool parse_area_(const std::string& s, utils::areas& a) {
 				utils::strings ss = utils::split_text(s, ",");
@@ -153,6 +156,26 @@ namespace utils {
 				return true;
 			}
 
+			bool parse_erase_(const std::string& s, utils::erase_blocks& a) {
+				utils::strings ss = utils::split_text(s, ",");
+				if((ss.size() % 3) != 0) {
+					return false;  // org, end, size
+				}
+				for(uint32_t i = 0; i < ss.size() / 3; ++i) {
+					uint32_t v[3];
+					for(uint32_t j = 0; j < 3; ++j) {
+						if(!utils::string_to_hex(ss[i * 3 + j], v[j])) {
+							return false;
+						}
+					}
+					if(v[1] < v[0] || v[2] == 0) {
+						return false;
+					}
+					a.emplace_back(v[0], v[1], v[2]);
+				}
+				return true;
+			}
+
 			bool analize(const units& us) {
 				bool err = false;
 				for(const auto& u : us) {
@@ -176,6 +199,10 @@ namespace utils {
 						if(!parse_area_(u.body_, ram_area_)) {
 							err = true;
 						}
+					} else if(u.symbol_ == "erase-block") {
+						if(!parse_erase_(u.body_, erase_block_)) {
+							err = true;
+						}
 					} else {
 						err = true;
 					}
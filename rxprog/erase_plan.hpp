@@ -0,0 +1,110 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	消去計画クラス @n
+			消去ブロックの構成から、イメージを覆う最小のブロックの組を求める。@n
+			イメージが無いブロックは、ブランク・チェックも消去もしない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <algorithm>
+#include "area.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	消去計画クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class erase_plan {
+
+		erase_blocks	geometry_;
+		areas			blocks_;
+		areas			pages_;
+
+		const erase_block_t* find_(uint32_t adr) const {
+			for(const auto& g : geometry_) {
+				if(g.size_ > 0 && g.is_in(adr)) return &g;
+			}
+			return nullptr;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去ブロックの構成を設定
+			@param[in]	geometry	消去ブロックの構成
+		*/
+		//-----------------------------------------------------------------//
+		void set_geometry(const erase_blocks& geometry) { geometry_ = geometry; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去ブロックの構成を取得
+			@return 消去ブロックの構成
+		*/
+		//-----------------------------------------------------------------//
+		const erase_blocks& get_geometry() const { return geometry_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	計画を作る @n
+					構成に含まれないページは、ページ（２５６バイト）単位で残す
+			@param[in]	image	イメージの領域（min_、max_ を持つ事）
+		*/
+		//-----------------------------------------------------------------//
+		template <class AREAS>
+		void build(const AREAS& image) {
+			blocks_.clear();
+			pages_.clear();
+			for(const auto& a : image) {
+				// 書き込みはページ単位なので、ページ全体を覆う
+				uint64_t adr = a.min_ & 0xffffff00;
+				uint64_t end = a.max_ | 0xff;
+				while(adr <= end) {
+					auto g = find_(adr);
+					if(g != nullptr) {
+						auto b = g->get_block(adr);
+						if(blocks_.empty() || blocks_.back().org_ != b.org_) {
+							blocks_.push_back(b);
+						}
+						adr = static_cast<uint64_t>(b.end_) + 1;
+					} else {
+						pages_.emplace_back(adr, adr + 255);
+						adr += 256;
+					}
+				}
+			}
+			auto cmp = [](const area_t& l, const area_t& r) { return l.org_ < r.org_; };
+			auto eq = [](const area_t& l, const area_t& r) { return l.org_ == r.org_; };
+			std::sort(blocks_.begin(), blocks_.end(), cmp);
+			blocks_.erase(std::unique(blocks_.begin(), blocks_.end(), eq), blocks_.end());
+			std::sort(pages_.begin(), pages_.end(), cmp);
+			pages_.erase(std::unique(pages_.begin(), pages_.end(), eq), pages_.end());
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去するブロックを取得
+			@return 消去するブロック
+		*/
+		//-----------------------------------------------------------------//
+		const areas& get_blocks() const { return blocks_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去単位が分からないページを取得
+			@return ページ
+		*/
+		//-----------------------------------------------------------------//
+		const areas& get_pages() const { return pages_; }
+	};
+}
@@ -0,0 +1,222 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	書き込みイメージ・キャッシュ・クラス @n
+			最後に書き込んだイメージを、デバイス毎に保存しておき、@n
+			差分書き込み（変化したブロックだけ消去、書き込み）に使う。@n
+			キャッシュは「デバイス名、シリアル、ID」をキーとする S フォーマット。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdlib>
+#include <cstring>
+#include "motsx_io.hpp"
+#include "file_io.hpp"
+#include "area.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	書き込みイメージ・キャッシュ・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class image_cache {
+	public:
+		typedef std::vector<uint32_t> pages;
+
+	private:
+		std::string	dir_;
+		std::string	path_;
+		motsx_io	image_;
+		bool		valid_;
+
+		static void add_key_(const std::string& s, std::string& key) {
+			if(s.empty()) return;
+			if(!key.empty()) key += '_';
+			for(char ch : s) {
+				if((ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')
+					|| ch == '-' || ch == '.') {
+					key += ch;
+				} else {
+					key += '_';
+				}
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		image_cache() : dir_(), path_(), image_(), valid_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュ・ディレクトリーを設定 @n
+					空の場合、「$HOME/.rx_prog」とする
+			@param[in]	dir	ディレクトリー
+		*/
+		//-----------------------------------------------------------------//
+		void set_dir(const std::string& dir) {
+			if(!dir.empty()) {
+				dir_ = dir;
+			} else {
+				const char* home = getenv("HOME");
+				dir_ = home != nullptr ? home : ".";
+				dir_ += "/.rx_prog";
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュ・ディレクトリーを取得
+			@return キャッシュ・ディレクトリー
+		*/
+		//-----------------------------------------------------------------//
+		const std::string& get_dir() const { return dir_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュを開く（キーを決めて、あればロードする）
+			@param[in]	device	デバイス名
+			@param[in]	serial	デバイスのシリアル
+			@param[in]	id		ID コード
+			@return キャッシュがあれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open(const std::string& device, const std::string& serial, const std::string& id) {
+			std::string key;
+			add_key_(device, key);
+			add_key_(serial, key);
+			add_key_(id, key);
+			if(dir_.empty()) set_dir("");
+			path_ = dir_ + '/' + key + ".mot";
+			valid_ = false;
+			if(probe_file(path_)) {
+				valid_ = image_.load(path_);
+			}
+			return valid_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュ・ファイルのパスを取得
+			@return キャッシュ・ファイルのパス
+		*/
+		//-----------------------------------------------------------------//
+		const std::string& get_path() const { return path_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュが有効か
+			@return 有効なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_valid() const { return valid_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュを無効にする（書き込み前に呼ぶ）@n
+					途中で失敗した場合に、古いキャッシュが残らないようにする
+		*/
+		//-----------------------------------------------------------------//
+		void invalidate() {
+			valid_ = false;
+			if(!path_.empty() && probe_file(path_)) {
+				remove_file(path_);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュのイメージを取得
+			@return キャッシュのイメージ
+		*/
+		//-----------------------------------------------------------------//
+		const motsx_io& get_image() const { return image_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込んだイメージをキャッシュに保存
+			@param[in]	image	書き込んだイメージ
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool save(motsx_io& image) {
+			if(path_.empty()) return false;
+			if(!probe_file(dir_, true)) {
+				if(!create_directory(dir_)) return false;
+			}
+			if(!image.save(path_)) return false;
+			image_ = image;
+			valid_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブロックの内容が、キャッシュと同じか調べる
+			@param[in]	image	書き込むイメージ
+			@param[in]	blk		ブロック
+			@return 同じなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool compare(const motsx_io& image, const area_t& blk) const {
+			if(!valid_) return false;
+			uint64_t adr = blk.org_ & 0xffffff00;
+			while(adr <= blk.end_) {
+				const auto& a = image.get_memory(adr);
+				const auto& b = image_.get_memory(adr);
+				if(std::memcmp(&a[0], &b[0], a.size()) != 0) return false;
+				adr += 256;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	検査するページを選ぶ（ブロック内でキャッシュにあるページを等間隔で）
+			@param[in]	blocks	対象のブロック
+			@param[in]	num		最大数
+			@return 検査するページ
+		*/
+		//-----------------------------------------------------------------//
+		pages sample(const areas& blocks, uint32_t num) const {
+			pages all;
+			for(const auto& b : blocks) {
+				uint64_t adr = b.org_ & 0xffffff00;
+				while(adr <= b.end_) {
+					if(image_.find_page(adr)) all.push_back(adr);
+					adr += 256;
+				}
+			}
+			if(all.size() <= num) return all;
+			if(num < 2) {
+				all.resize(num);
+				return all;
+			}
+
+			pages ps;
+			for(uint32_t i = 0; i < num; ++i) {
+				// 最初と最後のページを含める
+				ps.push_back(all[static_cast<uint64_t>(i) * (all.size() - 1) / (num - 1)]);
+			}
+			return ps;
+		}
+	};
+}
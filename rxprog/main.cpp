@@ -8,11 +8,18 @@
 */
 //=====================================================================//
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
 #include "rx_prog.hpp"
 #include "conf_in.hpp"
 #include "motsx_io.hpp"
 #include "string_utils.hpp"
 #include "area.hpp"
+#include "erase_plan.hpp"
+#include "image_cache.hpp"
+#include "speed_memo.hpp"
+#include "rx_gang.hpp"
 
 namespace {
 
@@ -20,6 +27,8 @@ namespace {
 	const std::string conf_file_ = "rx_prog.conf";
 	const uint32_t progress_num_ = 50;
 	const char progress_cha_ = '#';
+	const uint32_t cache_sample_num_ = 8;
+	const uint32_t run_size_ = 8192;	///< 一度に書き込み、ベリファイする最大の長さ
 
 	utils::conf_in conf_in_;
 	utils::motsx_io motsx_;
@@ -90,6 +99,42 @@ namespace {
 	}
 
 
+	bool is_in_(const utils::areas& as, uint32_t adr)
+	{
+		for(const auto& a : as) {
+			if(a.is_in(adr)) return true;
+		}
+		return false;
+	}
+
+
+	typedef std::chrono::steady_clock clock_type;
+
+	double elapsed_(const clock_type::time_point& t)
+	{
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - t).count();
+		return static_cast<double>(us) / 1e6;
+	}
+
+
+	// Windwos系シリアル・ポート（COMx）の変換
+	std::string com_path_(const std::string& path)
+	{
+		if(path.empty() || path[0] == '/') return path;
+		std::string s = utils::to_lower_text(path);
+		if(s.size() > 3 && s[0] == 'c' && s[1] == 'o' && s[2] == 'm') {
+			int val;
+			if(utils::string_to_int(&s[3], val)) {
+				if(val >= 1 ) {
+					--val;
+					return "/dev/ttyS" + (boost::format("%d") % val).str();
+				}
+			}
+		}
+		return path;
+	}
+
+
 	struct options {
 		bool verbose = false;
 
@@ -110,6 +155,12 @@ namespace {
 		std::string id_val;
 		bool	id = false;
 
+		std::string serial;
+
+		std::string gang;
+
+		std::string bin_base;
+
 		utils::areas area_val;
 		bool	area = false;
 
@@ -119,6 +170,10 @@ namespace {
 		bool	verify = false;
 		bool	device_list = false;
 		bool	progress = false;
+		bool	delta = false;
+		bool	full = false;
+		bool	pipeline = false;
+		bool	verify_crc = false;
 		bool	erase_data = false;
 		bool	erase_rom = false;
 		bool	help = false;
@@ -184,11 +239,11 @@ namespace {
 		cout << "Renesas RX Series Programmer Version " << version_ << endl;
 		cout << "Copyright (C) 2016, Hiramatsu Kunihito (hira@rvf-rc45.net)" << endl;
 		cout << "usage:" << endl;
-		cout << c << " [options] [mot file] ..." << endl;
+		cout << c << " [options] [mot/hex/elf/bin file] ..." << endl;
 		cout << endl;
 		cout << "Options :" << endl;
 		cout << "    -P PORT,   --port=PORT     Specify serial port" << endl;
-		cout << "    -s SPEED,  --speed=SPEED   Specify serial speed" << endl;
+		cout << "    -s SPEED,  --speed=SPEED   Specify serial speed (auto: find max speed)" << endl;
 		cout << "    -d DEVICE, --device=DEVICE Specify device name" << endl;
 		cout << "    -e, --erase                Perform a device erase to a minimum" << endl;
 ///		cout << "    --erase-all, --erase-chip\tPerform rom and data flash erase" << endl;
@@ -200,10 +255,81 @@ namespace {
 		cout << "    -v, --verify               Perform data verify" << endl;
 		cout << "    -w, --write                Perform data write" << endl;
 		cout << "    --progress                 display Progress output" << endl;
+		cout << "    --delta                    Erase and write only changed blocks (image cache)" << endl;
+		cout << "    --full                     Force full write, and refresh image cache" << endl;
+		cout << "    --serial=SERIAL            Specify device serial (image cache key)" << endl;
+		cout << "    --gang=PORT,PORT,...       Gang programming with serial ports" << endl;
+		cout << "    --verify-crc               Verify with device CRC (if supported)" << endl;
+		cout << "    --pipeline                 Send next frame before response (experimental)" << endl;
+		cout << "    --bin-base=ADDR            Specify binary file load address (hex)" << endl;
 		cout << "    --device-list              Display device list" << endl;
 		cout << "    --verbose                  Verbose output" << endl;
 		cout << "    -h, --help                 Display this" << endl;
 	}
+
+
+	// ポート毎の進行状況を表示（前回の表に上書きする）
+	uint32_t gang_table_(const rx::gang& gang, uint32_t lines)
+	{
+		if(lines > 0) {
+			std::cout << boost::format("\033[%dA") % lines;
+		}
+		for(const auto& p : gang.get_ports()) {
+			uint32_t all = p->all_;
+			uint32_t per = all > 0 ? p->n_ * 100 / all : 0;
+			std::cout << boost::format("%-24s %-8s %3d%%\033[K") % p->path_
+				% rx::gang::get_name(p->phase_) % per << std::endl;
+		}
+		return gang.get_ports().size();
+	}
+
+
+	// ギャング・プログラミング：イメージと消去計画は全てのポートで共有
+	bool gang_(const options& opts, const rx::protocol::rx_t& rx, uint32_t speed)
+	{
+		if(opts.delta || opts.full) {
+			std::cerr << "Gang mode can't use image cache (--delta, --full)" << std::endl;
+			return false;
+		}
+
+		utils::erase_plan plan;
+		plan.set_geometry(conf_in_.get_device().erase_block_);
+
+		rx::gang gang(motsx_, plan, rx, speed);
+		for(const auto& s : utils::split_text(opts.gang, ",")) {
+			gang.add(com_path_(s));
+		}
+
+		auto t = clock_type::now();
+		gang.start(opts.erase, opts.write, opts.verify, opts.verify_crc);
+		bool table = opts.progress && isatty(fileno(stdout));
+		uint32_t lines = 0;
+		while(!gang.is_done()) {
+			if(table) {
+				lines = gang_table_(gang, lines);
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		}
+		gang.join();
+		if(table) {
+			gang_table_(gang, lines);
+		}
+
+		std::cout << boost::format("%-24s %-6s %8s  %s") % "Port" % "Result" % "Time[s]" % "Failed at"
+			<< std::endl;
+		uint32_t pass = 0;
+		for(const auto& p : gang.get_ports()) {
+			bool ok = p->phase_ == rx::gang::phase::pass;
+			if(ok) ++pass;
+			std::cout << boost::format("%-24s %-6s %8.3f  %s") % p->path_
+				% rx::gang::get_name(p->phase_) % p->time_
+				% (ok ? "" : rx::gang::get_name(p->fail_)) << std::endl;
+		}
+		uint32_t num = gang.get_ports().size();
+		std::cout << boost::format("Gang: %d pass, %d fail, %.3f [s]") % pass % (num - pass)
+			% elapsed_(t) << std::endl;
+		return pass == num;
+	}
 }
 
 int main(int argc, char* argv[])
@@ -285,6 +411,20 @@ int main(int argc, char* argv[])
 				opts.verify = true;
 			} else if(p == "--progress") {
 				opts.progress = true;
+			} else if(p == "--delta") {
+				opts.delta = true;
+			} else if(p == "--full") {
+				opts.full = true;
+			} else if(p.find("--serial=") == 0) {
+				opts.serial = &p[std::strlen("--serial=")];
+			} else if(p == "--verify-crc") {
+				opts.verify_crc = true;
+			} else if(p == "--pipeline") {
+				opts.pipeline = true;
+			} else if(p.find("--gang=") == 0) {
+				opts.gang = &p[std::strlen("--gang=")];
+			} else if(p.find("--bin-base=") == 0) {
+				opts.bin_base = &p[std::strlen("--bin-base=")];
 			} else if(p == "--device-list") {
 				opts.device_list = true;
 			} else if(p == "-e" || p == "--erase") {
@@ -318,7 +458,8 @@ int main(int argc, char* argv[])
 	}
 
 	// HELP 表示
-	if(opts.help || opts.com_path.empty() || (opts.inp_file.empty() && !opts.device_list)
+	if(opts.help || (opts.com_path.empty() && opts.gang.empty())
+		|| (opts.inp_file.empty() && !opts.device_list)
 ///			&& opts.sequrity_set.empty() && !opts.sequrity_get && !opts.sequrity_release)
 		|| opts.com_speed.empty() || opts.device.empty()) {
 		if(opts.device.empty()) {
@@ -344,45 +485,54 @@ int main(int argc, char* argv[])
 		if(opts.verbose) {
 			std::cout << "# Input file path: '" << opts.inp_file << '\'' << std::endl;
 		}
+		if(!opts.bin_base.empty()) {
+			uint32_t base = 0;
+			if(!utils::string_to_hex(opts.bin_base, base)) {
+				std::cerr << "Binary base address conversion error: '" << opts.bin_base << '\'' << std::endl;
+				return -1;
+			}
+			motsx_.set_binary_base(base);
+		}
+		auto t = clock_type::now();
 		if(!motsx_.load(opts.inp_file)) {
 			std::cerr << "Can't open input file: '" << opts.inp_file << "'" << std::endl;
 			return -1;
 		}
 		pageall = motsx_.get_total_page();
 		if(opts.verbose) {
+			std::cout << boost::format("# Load: %.3f [s]") % elapsed_(t) << std::endl;
 			motsx_.list_area_map("# ");
 		}
 	}
 
     // Windwos系シリアル・ポート（COMx）の変換
     if(!opts.com_path.empty() && opts.com_path[0] != '/') {
-		std::string s = utils::to_lower_text(opts.com_path);
-        if(s.size() > 3 && s[0] == 'c' && s[1] == 'o' && s[2] == 'm') {
-            int val;
-            if(utils::string_to_int(&s[3], val)) {
-                if(val >= 1 ) {
-                    --val;
-                    opts.com_name = opts.com_path;
-                    opts.com_path = "/dev/ttyS" + (boost::format("%d") % val).str();
-                }
-            }
-        }
+		auto path = com_path_(opts.com_path);
+		if(path != opts.com_path) {
+			opts.com_name = opts.com_path;
+			opts.com_path = path;
+		}
 		if(opts.verbose) {
 			std::cout << "# Serial port alias: " << opts.com_name << " ---> " << opts.com_path << std::endl;
 		}
     }
-	if(opts.com_path.empty()) {
+	if(opts.com_path.empty() && opts.gang.empty()) {
 		std::cerr << "Serial port path not found." << std::endl;
 		return -1;
 	}
 	if(opts.verbose) {
 		std::cout << "# Serial port path: '" << opts.com_path << '\'' << std::endl;
 	}
+	// 「auto」なら０（デバイスと使える最大の速度を探す）
 	int com_speed = 0;
-	if(!utils::string_to_int(opts.com_speed, com_speed)) {
+	if(opts.com_speed != "auto" && !utils::string_to_int(opts.com_speed, com_speed)) {
 		std::cerr << "Serial speed conversion error: '" << opts.com_speed << '\'' << std::endl;
 		return -1;		
 	}
+	if(com_speed == 0 && opts.device != "RX64M") {
+		std::cerr << "Serial speed 'auto' is RX64M only" << std::endl;
+		return -1;
+	}
 
 	if(!opts.erase && !opts.write && !opts.verify) return 0;
 //		&& opts.sequrity_set.empty() && !opts.sequrity_get && !opts.sequrity_release) return 0;
@@ -390,6 +540,7 @@ int main(int argc, char* argv[])
 	rx::protocol::rx_t rx;
 	{
 		rx.verbose_ = opts.verbose;
+		rx.pipeline_ = opts.pipeline;
 
 		rx.cpu_type_ = opts.device;
 
@@ -419,44 +570,140 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	if(!opts.gang.empty()) {
+		return gang_(opts, rx, com_speed) ? 0 : -1;
+	}
+
+	// 自動の場合、前回の速度を最初に試す
+	utils::image_cache cache;
+	cache.set_dir(conf_in_.get_default().cache_);
+	utils::speed_memo memo;
+	if(com_speed == 0) {
+		memo.load(cache.get_dir());
+		rx.speed_hint_ = memo.get(opts.com_path, opts.device);
+	}
+
 	rx::prog prog_(opts.verbose);
 	if(!prog_.start(opts.com_path, com_speed, rx)) {
 		prog_.end();
 		return -1;
 	}
+	if(com_speed == 0) {
+		auto speed = prog_.get_speed();
+		if(opts.verbose || opts.progress) {
+			std::cout << boost::format("# Baud rate: %d (auto)") % speed << std::endl;
+		}
+		if(!memo.save(opts.com_path, opts.device, speed)) {
+			std::cerr << "Baud rate can't save: '" << cache.get_dir() << "'" << std::endl;
+		}
+	}
+
+	// 消去ブロックの構成は、設定ファイルがあればそれを優先する
+	utils::erase_plan plan;
+	{
+		const auto& geometry = conf_in_.get_device().erase_block_;
+		if(!geometry.empty()) plan.set_geometry(geometry);
+		else plan.set_geometry(prog_.get_erase_blocks());
+		plan.build(motsx_.create_area_map());
+	}
+
+	//=====================================
+	// 差分書き込み：キャッシュと同じブロックは、消去も書き込みもしない
+	utils::areas keep;
+	bool use_cache = opts.write && (opts.delta || opts.full);
+	if(use_cache) {
+		bool valid = cache.open(opts.device, opts.serial, opts.id_val);
+		if(opts.verbose) {
+			std::cout << "# Image cache: '" << cache.get_path() << "' ("
+				<< (valid ? "found" : "none") << ")" << std::endl;
+		}
+		if(valid && opts.delta && !opts.full) {
+			for(const auto& b : plan.get_blocks()) {
+				if(cache.compare(motsx_, b)) keep.push_back(b);
+			}
+		}
+		// デバイスの内容が、キャッシュと同じか、いくつかのページを読んで確かめる
+		for(auto adr : cache.sample(keep, cache_sample_num_)) {
+			uint8_t dev[256];
+			if(!prog_.read_page(adr, dev)) {
+				prog_.end();
+				return -1;
+			}
+			const auto& mem = cache.get_image().get_memory(adr);
+			if(std::memcmp(dev, &mem[0], sizeof(dev)) != 0) {
+				std::cout << boost::format("Image cache mismatch at %08X, full write") % adr
+					<< std::endl;
+				keep.clear();
+				break;
+			}
+		}
+		// 途中で失敗した場合、デバイスの内容は分からない
+		cache.invalidate();
+	}
 
 	//=====================================
 	if(opts.erase) {  // erase
-		auto areas = motsx_.create_area_map();
+		auto t = clock_type::now();
+		const auto& blocks = plan.get_blocks();
+		const auto& pages = plan.get_pages();
+		if(opts.verbose) {
+			std::cout << boost::format("# Erase plan: %d blocks, %d pages")
+				% blocks.size() % pages.size() << std::endl;
+			for(const auto& b : blocks) {
+				std::cout << boost::format("#   %08X to %08X%s") % b.org_ % b.end_
+					% (is_in_(keep, b.org_) ? " (unchanged)" : "") << std::endl;
+			}
+		}
 
 		if(opts.progress) {
 			std::cout << "Erase:  " << std::flush;
 		}
 
+		uint32_t eraseall = blocks.size() + pages.size();
+		uint32_t erased_num = 0;
 		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				}
-				if(!prog_.erase_page(adr)) {  // 256 バイト単位で消去要求を送る
-					prog_.end();
-					return -1;
-				}
-				adr += 256;
-				len += 256;
+		for(const auto& b : blocks) {
+			if(opts.progress) {
+				progress_(eraseall, page);
+			}
+			if(is_in_(keep, b.org_)) {
 				++page.n;
+				continue;
+			}
+			// ブランクのブロックは消去しない
+			bool erased = false;
+			if(!prog_.erase_block(b.org_, b.end_, erased)) {
+				prog_.end();
+				return -1;
+			}
+			if(erased) ++erased_num;
+			++page.n;
+		}
+		for(const auto& p : pages) {
+			if(opts.progress) {
+				progress_(eraseall, page);
 			}
+			if(!prog_.erase_page(p.org_)) {  // 256 バイト単位で消去要求を送る
+				prog_.end();
+				return -1;
+			}
+			++page.n;
 		}
 		if(opts.progress) {
+			progress_(eraseall, page);
 			std::cout << std::endl << std::flush;
 		}
+		if(opts.verbose || opts.progress) {
+			std::cout << boost::format("# Erase: %d blocks (%d erased, %d blank, %d unchanged), "
+				"%d pages, %.3f [s]")
+				% blocks.size() % erased_num % (blocks.size() - erased_num - keep.size())
+				% keep.size() % pages.size() % elapsed_(t) << std::endl;
+		}
 	}
 
 	//=====================================
 	if(opts.write) {  // write
+		auto t = clock_type::now();
 		auto areas = motsx_.create_area_map();
 		if(!areas.empty()) {
 			if(!prog_.start_write(true)) {
@@ -469,61 +716,98 @@ int main(int argc, char* argv[])
 			std::cout << "Write:  " << std::flush;
 		}
 		page_t page;
+		uint32_t skip = 0;
+		std::vector<uint32_t> pages;
 		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				}
-				/// std::cout << boost::format("%08X to %08X") % adr % (adr + 255) << std::endl;
-				auto mem = motsx_.get_memory(adr);
-				if(!prog_.write(adr, &mem[0])) {
-					prog_.end();
-					return -1;
-				}
+			uint64_t adr = a.min_ & 0xffffff00;
+			while(adr <= a.max_) {
+				if(is_in_(keep, adr)) ++skip;
+				else pages.push_back(adr);
 				adr += 256;
-				len += 256;
-				++page.n;
 			}
 		}
+		page.n = skip;
+		// 連続したページは、まとめて送る
+		std::vector<uint8_t> buff(run_size_);
+		for(const auto& r : utils::make_runs(pages, run_size_)) {
+			if(opts.progress) {
+				progress_(pageall, page);
+			}
+			/// std::cout << boost::format("%08X to %08X") % r.org_ % r.end_ << std::endl;
+			motsx_.copy_memory(r.org_, &buff[0], r.length());
+			if(!prog_.write_area(r.org_, &buff[0], r.length())) {
+				prog_.end();
+				return -1;
+			}
+			page.n += r.length() / 256;
+		}
 		if(opts.progress) {
+			progress_(pageall, page);
 			std::cout << std::endl << std::flush;
 		}
 		if(!prog_.final_write()) {
 			prog_.end();
 			return -1;
 		}
+		double sec = elapsed_(t);
+		if(opts.verbose || opts.progress) {
+			std::cout << boost::format("# Write: %d pages, %.3f [s]") % (page.n - skip) % sec
+				<< std::endl;
+		}
+		if(opts.delta) {
+			std::cout << boost::format("Delta: %d pages skipped, %d pages written")
+				% skip % (page.n - skip);
+			// 時間は、今回書き込んだページの平均から見積もる
+			if(skip > 0 && page.n > skip) {
+				std::cout << boost::format(", about %.3f [s] saved")
+					% (sec / (page.n - skip) * skip);
+			}
+			std::cout << std::endl;
+		}
 	}
 
 	//=====================================
 	if(opts.verify) {  // verify
+		auto t = clock_type::now();
 		auto areas = motsx_.create_area_map();
 		if(opts.progress) {
 			std::cout << "Verify: " << std::flush;
 		}
 		page_t page;
+		std::vector<uint32_t> pages;
 		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				}
-				/// std::cout << boost::format("%08X to %08X") % adr % (adr + 255) << std::endl;
-				auto mem = motsx_.get_memory(adr);
-				if(!prog_.verify_page(adr, &mem[0])) {
-					prog_.end();
-					return -1;
-				}
+			uint64_t adr = a.min_ & 0xffffff00;
+			while(adr <= a.max_) {
+				pages.push_back(adr);
 				adr += 256;
-				len += 256;
-				++page.n;
 			}
 		}
+		std::vector<uint8_t> buff(run_size_);
+		for(const auto& r : utils::make_runs(pages, run_size_)) {
+			if(opts.progress) {
+				progress_(pageall, page);
+			}
+			motsx_.copy_memory(r.org_, &buff[0], r.length());
+			if(!prog_.verify_area(r.org_, &buff[0], r.length(), opts.verify_crc)) {
+				prog_.end();
+				return -1;
+			}
+			page.n += r.length() / 256;
+		}
 		if(opts.progress) {
+			progress_(pageall, page);
 			std::cout << std::endl << std::flush;
 		}
+		if(opts.verbose || opts.progress) {
+			std::cout << boost::format("# Verify: %d pages, %.3f [s]") % page.n % elapsed_(t)
+				<< std::endl;
+		}
+	}
+
+	if(use_cache) {
+		if(!cache.save(motsx_)) {
+			std::cerr << "Image cache can't save: '" << cache.get_path() << "'" << std::endl;
+		}
 	}
 
 	prog_.end();
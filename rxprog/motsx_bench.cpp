@@ -0,0 +1,375 @@
+//=====================================================================//
+/*!	@file
+	@brief	motsx_io ローダーのベンチマーク @n
+			数 MB の乱数イメージ（RX64M のコード・フラッシュ４M、データ・フラッシュ、@n
+			ベクター）を、S フォーマット、インテル HEX、ELF、バイナリーで生成し、@n
+			motsx_io で読んだ時間と、読んだ内容（ページ、エリア、実行アドレス）を調べる。@n
+			S フォーマットは、以前の方式（１文字毎の読み込み、１バイト毎の @n
+			std::map 検索）とも比較する。@n
+			Ex: motsx_bench [作業ディレクトリ] [seed]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <chrono>
+#include <map>
+#include <random>
+#include <cstdio>
+#include "motsx_io.hpp"
+
+namespace {
+
+	struct region_t {
+		uint32_t	org;
+		uint32_t	len;
+		uint32_t	vaddr;	///< ELF の仮想アドレス（物理アドレスと違う場合）
+	};
+
+	// データ・フラッシュは、ELF では仮想アドレスを別にする
+	const region_t regions_[] = {
+		{ 0x00100000, 0x8000,   0x00000000 },
+		{ 0xFFC00000, 0x3F0000, 0xFFC00000 },
+		{ 0xFFFFFF80, 0x80,     0xFFFFFF80 },
+	};
+	const uint32_t exec_ = 0xFFC00100;
+
+	std::vector<uint8_t>	image_[3];
+
+	int		bad_ = 0;
+
+	void check_(bool ok, const char* what)
+	{
+		if(ok) return;
+		if(bad_ < 10) std::cout << "NG " << what << std::endl;
+		++bad_;
+	}
+
+	uint32_t total_()
+	{
+		uint32_t n = 0;
+		for(const auto& r : regions_) n += r.len;
+		return n;
+	}
+
+
+	FILE* create_(const std::string& path)
+	{
+		FILE* fp = fopen(path.c_str(), "wb");
+		if(fp == nullptr) {
+			std::cerr << "Can't create: '" << path << "'" << std::endl;
+			exit(1);
+		}
+		return fp;
+	}
+
+
+	void put_srec_(FILE* fp, char type, uint32_t adr, const uint8_t* src, uint32_t len)
+	{
+		uint32_t sum = len + 5;
+		fprintf(fp, "S%c%02X%08X", type, sum, adr);
+		sum += (adr >> 24) + ((adr >> 16) & 0xff) + ((adr >> 8) & 0xff) + (adr & 0xff);
+		for(uint32_t i = 0; i < len; ++i) {
+			fprintf(fp, "%02X", src[i]);
+			sum += src[i];
+		}
+		fprintf(fp, "%02X\r\n", (~sum) & 0xff);
+	}
+
+
+	void make_srec_(const std::string& path)
+	{
+		FILE* fp = create_(path);
+		fprintf(fp, "S00F000068656C6C6F202020202000003C\r\n");
+		for(uint32_t i = 0; i < 3; ++i) {
+			for(uint32_t ofs = 0; ofs < regions_[i].len; ofs += 32) {
+				put_srec_(fp, '3', regions_[i].org + ofs, &image_[i][ofs], 32);
+			}
+		}
+		put_srec_(fp, '7', exec_, nullptr, 0);
+		fclose(fp);
+	}
+
+
+	void put_ihex_(FILE* fp, uint32_t type, uint32_t ofs, const uint8_t* src, uint32_t len)
+	{
+		uint32_t sum = len + (ofs >> 8) + (ofs & 0xff) + type;
+		fprintf(fp, ":%02X%04X%02X", len, ofs, type);
+		for(uint32_t i = 0; i < len; ++i) {
+			fprintf(fp, "%02X", src[i]);
+			sum += src[i];
+		}
+		fprintf(fp, "%02X\n", (-sum) & 0xff);
+	}
+
+
+	void make_ihex_(const std::string& path)
+	{
+		FILE* fp = create_(path);
+		uint32_t upper = 0;
+		for(uint32_t i = 0; i < 3; ++i) {
+			for(uint32_t ofs = 0; ofs < regions_[i].len; ofs += 32) {
+				uint32_t adr = regions_[i].org + ofs;
+				if((adr >> 16) != upper) {
+					upper = adr >> 16;
+					uint8_t t[2] = { static_cast<uint8_t>(upper >> 8), static_cast<uint8_t>(upper) };
+					put_ihex_(fp, 0x04, 0, t, 2);
+				}
+				put_ihex_(fp, 0x00, adr & 0xffff, &image_[i][ofs], 32);
+			}
+		}
+		uint8_t t[4] = { exec_ >> 24, (exec_ >> 16) & 0xff, (exec_ >> 8) & 0xff, exec_ & 0xff };
+		put_ihex_(fp, 0x05, 0, t, 4);
+		put_ihex_(fp, 0x01, 0, nullptr, 0);
+		fclose(fp);
+	}
+
+
+	void put32_(std::vector<uint8_t>& v, uint32_t ofs, uint32_t val)
+	{
+		for(uint32_t i = 0; i < 4; ++i) v[ofs + i] = val >> (i * 8);
+	}
+
+	void put16_(std::vector<uint8_t>& v, uint32_t ofs, uint32_t val)
+	{
+		v[ofs] = val;
+		v[ofs + 1] = val >> 8;
+	}
+
+
+	// ELF32（リトル・エンディアン）、領域毎に PT_LOAD
+	void make_elf_(const std::string& path)
+	{
+		static const uint32_t EHSIZE = 52;
+		static const uint32_t PHSIZE = 32;
+		uint32_t offset = EHSIZE + PHSIZE * 3;
+		std::vector<uint8_t> v(offset);
+		static const uint8_t ident[] = { 0x7f, 'E', 'L', 'F', 1, 1, 1 };
+		std::memcpy(&v[0], ident, sizeof(ident));
+		put16_(v, 0x10, 2);			// ET_EXEC
+		put16_(v, 0x12, 173);		// EM_RX
+		put32_(v, 0x14, 1);
+		put32_(v, 0x18, exec_);
+		put32_(v, 0x1c, EHSIZE);
+		put16_(v, 0x28, EHSIZE);
+		put16_(v, 0x2a, PHSIZE);
+		put16_(v, 0x2c, 3);
+		for(uint32_t i = 0; i < 3; ++i) {
+			uint32_t ph = EHSIZE + PHSIZE * i;
+			put32_(v, ph + 0x00, 1);	// PT_LOAD
+			put32_(v, ph + 0x04, offset);
+			put32_(v, ph + 0x08, regions_[i].vaddr);
+			put32_(v, ph + 0x0c, regions_[i].org);
+			put32_(v, ph + 0x10, regions_[i].len);
+			put32_(v, ph + 0x14, regions_[i].len);
+			v.insert(v.end(), image_[i].begin(), image_[i].end());
+			offset += regions_[i].len;
+		}
+		FILE* fp = create_(path);
+		fwrite(&v[0], 1, v.size(), fp);
+		fclose(fp);
+	}
+
+
+	// コード・フラッシュの先頭から 0xFFFFFFFF まで（間は 0xFF）
+	void make_bin_(const std::string& path)
+	{
+		std::vector<uint8_t> v(0x400000, 0xff);
+		std::memcpy(&v[0], &image_[1][0], regions_[1].len);
+		std::memcpy(&v[0x400000 - regions_[2].len], &image_[2][0], regions_[2].len);
+		FILE* fp = create_(path);
+		fwrite(&v[0], 1, v.size(), fp);
+		fclose(fp);
+	}
+
+
+	uint32_t file_size_(const std::string& path)
+	{
+		struct stat st;
+		if(stat(path.c_str(), &st) != 0) return 0;
+		return st.st_size;
+	}
+
+
+	// 読んだ内容を、生成したイメージと比較
+	void verify_(const utils::motsx_io& mot, const char* name, bool binary)
+	{
+		bool ok = true;
+		for(uint32_t i = 0; i < 3; ++i) {
+			if(binary && i == 0) continue;
+			for(uint32_t ofs = 0; ofs < regions_[i].len; ofs += 256) {
+				uint32_t adr = regions_[i].org + ofs;
+				const auto& m = mot.get_memory(adr);
+				uint32_t n = std::min(256 - (adr & 0xff), regions_[i].len - ofs);
+				if(std::memcmp(&m[adr & 0xff], &image_[i][ofs], n) != 0) ok = false;
+			}
+		}
+		std::string s = std::string(name) + " contents";
+		check_(ok, s.c_str());
+
+		auto as = mot.create_area_map();
+		if(binary) {
+			ok = as.size() == 1 && as[0].min_ == 0xFFC00000 && as[0].max_ == 0xFFFFFFFF;
+		} else {
+			ok = as.size() == 3;
+			for(uint32_t i = 0; ok && i < 3; ++i) {
+				ok = as[i].min_ == regions_[i].org && as[i].max_ == (regions_[i].org + regions_[i].len - 1);
+			}
+			if(ok) ok = mot.get_exec() == exec_;
+		}
+		s = std::string(name) + " area map";
+		check_(ok, s.c_str());
+	}
+
+
+	typedef std::chrono::steady_clock clock_type;
+
+	// ３回読んで、最も速い時間（秒）
+	double load_(utils::motsx_io& mot, const std::string& path)
+	{
+		double best = 0.0;
+		for(uint32_t n = 0; n < 3; ++n) {
+			auto t = clock_type::now();
+			bool ok = mot.load(path);
+			double sec = std::chrono::duration<double>(clock_type::now() - t).count();
+			check_(ok, path.c_str());
+			if(n == 0 || sec < best) best = sec;
+		}
+		return best;
+	}
+
+
+	// 以前の方式：１文字毎に読み、１バイト毎に std::map を探す
+	uint32_t old_load_(const std::string& path)
+	{
+		typedef std::map<uint32_t, utils::motsx_io::array> memory_map;
+		memory_map mm;
+		utils::file_io fio;
+		if(!fio.open(path, "rb")) return 0;
+		uint32_t value = 0;
+		uint32_t vcnt = 0;
+		uint32_t pos = 0;
+		uint32_t type = 0;
+		uint32_t alen = 0;
+		uint32_t len = 0;
+		uint32_t address = 0;
+		char ch;
+		while(fio.get_char(ch)) {
+			if(ch == '\r' || ch == '\n') continue;
+			if(ch == 'S') {
+				pos = 0;
+				vcnt = 0;
+				value = 0;
+				continue;
+			}
+			uint32_t h = (ch >= 'A') ? ch - 'A' + 10 : ch - '0';
+			value = (value << 4) | h;
+			++vcnt;
+			if(pos == 0) {
+				type = value;
+				alen = type == 3 ? 4 : 2;
+				++pos;
+				value = vcnt = 0;
+			} else if(vcnt == 2 && pos == 1) {
+				len = value - alen - 1;
+				++pos;
+				value = vcnt = 0;
+			} else if(vcnt == alen * 2 && pos == 2) {
+				address = value;
+				++pos;
+				value = vcnt = 0;
+			} else if(vcnt == 2 && pos == 3) {
+				if(len > 0) {
+					if(type == 3) {
+						auto it = mm.find(address & 0xffffff00);
+						if(it == mm.end()) {
+							utils::motsx_io::array a;
+							a.fill(0xff);
+							it = mm.emplace(address & 0xffffff00, a).first;
+						}
+						it->second[address & 0xff] = value;
+						++address;
+					}
+					--len;
+				}
+				value = vcnt = 0;
+			}
+		}
+		fio.close();
+		return mm.size();
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::string dir = ".";
+	if(argc > 1) dir = argv[1];
+	uint32_t seed = 1;
+	if(argc > 2) seed = strtoul(argv[2], nullptr, 0);
+
+	std::mt19937 rng(seed);
+	for(uint32_t i = 0; i < 3; ++i) {
+		image_[i].resize(regions_[i].len);
+		for(auto& b : image_[i]) b = rng();
+	}
+
+	std::string base = dir + "/motsx_bench";
+	std::string srec = base + ".mot";
+	std::string ihex = base + ".hex";
+	std::string elf  = base + ".elf";
+	std::string bin  = base + ".bin";
+	make_srec_(srec);
+	make_ihex_(ihex);
+	make_elf_(elf);
+	make_bin_(bin);
+
+	std::cout << boost::format("motsx_bench: seed %u, image %u bytes (3 areas)") % seed % total_()
+		<< std::endl;
+
+	static const char* title = "  %-10s %9u bytes  %7.4f s  %7.1f MB/s";
+	utils::motsx_io mot;
+	double mots = load_(mot, srec);
+	verify_(mot, "S format", false);
+	check_(mot.get_format() == utils::motsx_io::format::motorola, "S format detect");
+	std::cout << boost::format(title) % "S format" % file_size_(srec) % mots
+		% (file_size_(srec) / mots / 1e6) << std::endl;
+
+	double sec = load_(mot, ihex);
+	verify_(mot, "Intel HEX", false);
+	check_(mot.get_format() == utils::motsx_io::format::intel, "Intel HEX detect");
+	std::cout << boost::format(title) % "Intel HEX" % file_size_(ihex) % sec
+		% (file_size_(ihex) / sec / 1e6) << std::endl;
+
+	sec = load_(mot, elf);
+	verify_(mot, "ELF", false);
+	check_(mot.get_format() == utils::motsx_io::format::elf, "ELF detect");
+	std::cout << boost::format(title) % "ELF" % file_size_(elf) % sec
+		% (file_size_(elf) / sec / 1e6) << std::endl;
+
+	sec = load_(mot, bin);
+	verify_(mot, "Binary", true);
+	check_(mot.get_format() == utils::motsx_io::format::binary, "Binary detect");
+	std::cout << boost::format(title) % "Binary" % file_size_(bin) % sec
+		% (file_size_(bin) / sec / 1e6) << std::endl;
+
+	auto t = clock_type::now();
+	uint32_t pages = old_load_(srec);
+	sec = std::chrono::duration<double>(clock_type::now() - t).count();
+	uint32_t expect = 0;
+	for(const auto& r : regions_) expect += (r.len + 255) / 256;
+	check_(pages == expect, "old loader pages");
+	std::cout << boost::format(title) % "S (old)" % file_size_(srec) % sec
+		% (file_size_(srec) / sec / 1e6)
+		<< boost::format("  (%.1fx)") % (sec / mots) << std::endl;
+
+	std::remove(srec.c_str());
+	std::remove(ihex.c_str());
+	std::remove(elf.c_str());
+	std::remove(bin.c_str());
+
+	std::cout << "motsx_bench: errors " << bad_ << std::endl;
+	return bad_ != 0;
+}
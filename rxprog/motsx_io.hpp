@@ -1,18 +1,27 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	モトローラーＳフォーマット入出力
+	@brief	モトローラーＳフォーマット入出力 @n
+			・ファイルはメモリーにマップして、一回の走査で読む @n
+			・メモリーは、アドレス順に並んだページ（２５６バイト）の配列 @n
+			・Ｓフォーマットの他に、インテル HEX、ELF（PT_LOAD）、バイナリーを読める
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <vector>
-#include <map>
 #include <string>
 #include <array>
+#include <algorithm>
+#include <cstring>
 #include "file_io.hpp"
+#include "string_utils.hpp"
 #include <iomanip>
 #include <boost/format.hpp>
 
@@ -30,221 +39,366 @@ namespace utils {
 		struct area_t {
 			uint32_t	min_;
 			uint32_t	max_;
-			area_t(uint32_t min = 0xffffffff, uint32_t max = 0) : min_(min), max_(max) { } 			
+			area_t(uint32_t min = 0xffffffff, uint32_t max = 0) : min_(min), max_(max) { }
 		};
 		typedef std::vector<area_t> areas;
 
-		struct array_t {
-			area_t	area_;
-			array	array_;
 
-			array_t() : area_(), array_() { array_.fill(0xff); }
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	ファイル形式
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class format {
+			none,		///< 不明
+			motorola,	///< モトローラー S フォーマット
+			intel,		///< インテル HEX
+			elf,		///< ELF（PT_LOAD セグメント）
+			binary		///< バイナリー
+		};
+
+	private:
+		struct page_t {
+			uint32_t	base_;
+			area_t		area_;	///< 書き込まれた範囲
+			array		array_;
 
-			void set(uint32_t adr, uint8_t data) {
-				if(area_.min_ > adr) area_.min_ = adr;
-				if(area_.max_ < adr) area_.max_ = adr;
-				array_[adr & 0xff] = data;
+			page_t(uint32_t base) : base_(base), area_(), array_() { array_.fill(0xff); }
+		};
+		typedef std::vector<page_t> pages;
+
+		// ファイルを読み込み専用でメモリーにマップする
+		class file_map {
+			int			fd_;
+			void*		map_;
+			size_t		size_;
+		public:
+			file_map() : fd_(-1), map_(nullptr), size_(0) { }
+			file_map(const file_map&) = delete;
+			file_map& operator = (const file_map&) = delete;
+			~file_map() {
+				if(map_ != nullptr) munmap(map_, size_);
+				if(fd_ >= 0) ::close(fd_);
 			}
+
+			bool open(const std::string& path) {
+				fd_ = ::open(path.c_str(), O_RDONLY);
+				if(fd_ < 0) return false;
+				struct stat st;
+				if(fstat(fd_, &st) != 0) return false;
+				size_ = st.st_size;
+				if(size_ == 0) return true;
+				map_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+				if(map_ == MAP_FAILED) {
+					map_ = nullptr;
+					return false;
+				}
+				return true;
+			}
+
+			const uint8_t* get() const { return static_cast<const uint8_t*>(map_); }
+			size_t size() const { return size_; }
 		};
 
-	private:
 		area_t		area_;
 		uint32_t	exec_;
+		format		format_;
 
-		typedef std::map<uint32_t, array_t>	memory_map;
+		bool		bin_base_ena_;
+		uint32_t	bin_base_;
 
-		memory_map	memory_map_;
+		pages		pages_;
+		uint32_t	last_;	///< 最後に書き込んだページ
 
 		array		fill_array_;
 
-		void write_byte_(uint32_t address, uint8_t val) {
-			uint32_t base = address & 0xffff00;
-			memory_map::iterator it = memory_map_.find(base);
-			if(it == memory_map_.end()) {
-				array_t t;
-				t.set(address, val);
-				memory_map_.emplace(base, t);
-			} else {
-				array_t& t = it->second;
-				t.set(address, val);
+		// １６進数の文字の値（１６進数で無い場合「0xff」）
+		struct hex_table {
+			uint8_t	t_[256];
+			hex_table() {
+				for(uint32_t i = 0; i < 256; ++i) t_[i] = 0xff;
+				for(uint32_t i = 0; i < 10; ++i) t_['0' + i] = i;
+				for(uint32_t i = 0; i < 6; ++i) {
+					t_['A' + i] = 10 + i;
+					t_['a' + i] = 10 + i;
+				}
+			}
+		};
+
+		// ２文字単位で「len」バイトを変換、変換出来ない文字があれば「false」
+		static bool decode_hex_(const uint8_t* src, uint32_t len, uint8_t* dst) {
+			static const hex_table tbl;
+			uint32_t err = 0;
+			for(uint32_t i = 0; i < len; ++i) {
+				uint8_t h = tbl.t_[src[0]];
+				uint8_t l = tbl.t_[src[1]];
+				err |= h | l;
+				dst[i] = (h << 4) | l;
+				src += 2;
 			}
+			return (err & 0xf0) == 0;
 		}
 
+		page_t& get_page_(uint32_t base) {
+			if(last_ < pages_.size() && pages_[last_].base_ == base) {
+				return pages_[last_];
+			}
+			// アドレス順に読む場合は、最後に追加するだけ
+			if(pages_.empty() || pages_.back().base_ < base) {
+				pages_.emplace_back(base);
+				last_ = pages_.size() - 1;
+				return pages_.back();
+			}
+			auto it = std::lower_bound(pages_.begin(), pages_.end(), base,
+				[](const page_t& p, uint32_t b) { return p.base_ < b; });
+			if(it == pages_.end() || it->base_ != base) {
+				it = pages_.insert(it, page_t(base));
+			}
+			last_ = it - pages_.begin();
+			return *it;
+		}
 
-		bool load_(utils::file_io& fio) {
-			area_.min_ = 0xffffffff;
-			area_.max_ = 0x00000000;
+		const page_t* find_page_(uint32_t address) const {
+			uint32_t base = address & 0xffffff00;
+			auto it = std::lower_bound(pages_.begin(), pages_.end(), base,
+				[](const page_t& p, uint32_t b) { return p.base_ < b; });
+			if(it == pages_.end() || it->base_ != base) return nullptr;
+			return &(*it);
+		}
 
-			uint32_t value = 0;
-			uint32_t type = 0;
-			uint32_t length = 0;
-			uint32_t address = 0;
-			uint32_t sum = 0;
-			int vcnt = 0;
+		void write_(uint32_t address, const uint8_t* src, uint32_t len) {
+			while(len > 0) {
+				uint32_t ofs = address & 0xff;
+				uint32_t n = 256 - ofs;
+				if(n > len) n = len;
+				page_t& p = get_page_(address & 0xffffff00);
+				std::memcpy(&p.array_[ofs], src, n);
+				uint32_t end = address + n - 1;
+				if(p.area_.min_ > address) p.area_.min_ = address;
+				if(p.area_.max_ < end) p.area_.max_ = end;
+				if(area_.min_ > address) area_.min_ = address;
+				if(area_.max_ < end) area_.max_ = end;
+				if(end == 0xffffffff) break;
+				address += n;
+				src += n;
+				len -= n;
+			}
+		}
 
-			bool toend = false;
-			int mode = 0;
+		static void error_(const char* fmt, uint32_t lno) {
+			std::cerr << boost::format(fmt) % lno << std::endl;
+		}
 
-			while(1) {
-				char ch;
-				if(!fio.get_char(ch)) {
-					break;
+		bool load_motorola_(const uint8_t* p, const uint8_t* end) {
+			uint8_t buf[256];
+			uint32_t lno = 0;
+			while(p < end) {
+				const uint8_t* top = p;
+				while(p < end && *p != '\n') ++p;
+				const uint8_t* last = p;
+				if(p < end) ++p;
+				++lno;
+				while(top < last && (*top == ' ' || *top == '\t')) ++top;
+				while(top < last && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t')) --last;
+				if(top == last) continue;
+
+				if(top[0] != 'S' || (last - top) < 4 || top[1] < '0' || top[1] > '9') {
+					error_("(%d) S format illegual record", lno);
+					return false;
+				}
+				uint32_t type = top[1] - '0';
+				uint32_t num = (last - top - 2) / 2;
+				if(num > sizeof(buf)) {
+					error_("(%d) S format length error", lno);
+					return false;
+				}
+				if(((last - top) & 1) != 0 || !decode_hex_(top + 2, num, buf)) {
+					error_("(%d) S format illegual character", lno);
+					return false;
+				}
+				if(buf[0] != (num - 1)) {
+					error_("(%d) S format length error", lno);
+					return false;
+				}
+				uint8_t sum = 0;
+				for(uint32_t i = 0; i < num; ++i) sum += buf[i];
+				if(sum != 0xff) {
+					error_("(%d) S format SUM error", lno);
+					return false;
 				}
 
-			   	if(ch == ' ') {
-			   	} else if(ch == 0x0d || ch == 0x0a) {
-				   	if(toend) break;
-			   	} else if(mode == 0 && ch == 'S') {
-			   		mode = 1;
-			   		value = vcnt = 0;
-			   	} else if(ch >= '0' && ch <= '9') {
-			   		value <<= 4;
-			   		value |= ch - '0';
-			   		++vcnt;
-			   	} else if(ch >= 'A' && ch <= 'F') {
-			   		value <<= 4;
-			   		value |= ch - 'A' + 10;
-			   		++vcnt;
-			   	} else {
-					std::cerr << "S format illegual character: '";
-			   		if(ch >= 0x20 && ch <= 0x7f) {
-						std::cerr << ch;
-			   		} else {
-						std::cerr << boost::format("0x%02X") % static_cast<int>(ch);
-			   		}
-					std::cerr << "'" << std::endl;
-			   		return false;
-			   	}
-
-			   	if(mode == 1) {		// タイプ取得
-			   		if(vcnt == 1) {
-			   			type = value;
-			   			mode = 2;
-			   			value = vcnt = 0;
-			   		}
-			   	} else if(mode == 2) {	// レングス取得
-			   		if(vcnt == 2) {
-			   			length = value;
-			   			sum = value;
-			   			mode = 3;
-			   			value = vcnt = 0;
-			   		}
-			   	} else if(mode == 3) {	// アドレス取得
-			   		int alen = 0;
-			   		if(type == 0) {
-			   			alen = 4;
-			   		} else if(type == 1) {
-			   			alen = 4;
-			   		} else if(type == 2) {
-			   			alen = 6;
-			   		} else if(type == 3) {
-			   			alen = 8;
-			   		} else if(type == 5) {
-			   			alen = 4;
-			   		} else if(type == 7) {
-			   			alen = 8;
-			   		} else if(type == 8) {
-			   			alen = 6;
-			   		} else if(type == 9) {
-			   			alen = 4;
-			   		} else {
-			   			return false;
-			   		}
-
-			   		if(vcnt == alen) {
-			   			address = value;
-			   			if(type >= 1 && type <= 3) {
-			   				if(area_.min_ > address) area_.min_ = address;
-			   			}
-			   			alen >>= 1;
-			   			length -= alen;
-			   			length -= 1;	// SUM の分サイズを引く
-			   			while(alen > 0) {
-			   				sum += value;
-			   				value >>= 8;
-			   				--alen;
-			   			}
-				   		if(type >= 1 && type <= 3) {
-				   			mode = 4;
-				   		} else if(type >= 7 && type <= 9) {
-							exec_ = value;
-				   			mode = 5;
-				   		} else {
-				   			mode = 4;
-				   		}
-				   		value = vcnt = 0;
-				   	}
-			   	} else if(mode == 4) {	// データ・レコード
-			   		if(vcnt >= 2) {
-			   			if(type >= 1 && type <= 3) {
-			   				write_byte_(address, value);
-			   				if(area_.max_ < address) area_.max_ = address;
-			   				++address;
-			   			}
-			   			sum += value;
-			   			value = vcnt = 0;
-			   			--length;
-			   			if(length == 0) {
-			   				mode = 5;
-			   			}
-			   		}
-			   	} else if(mode == 5) {	// SUM
-			   		if(vcnt >= 2) {
-			   			value &= 0xff;
-			   			sum ^= 0xff;
-			   			sum &= 0xff;
-			   			if(sum != value) {	// SUM エラー
-							std::cerr << "S format SUM error: ";
-							std::cerr << boost::format("0x%02X -> %02X")
-							    % static_cast<int>(value)
-								% static_cast<int>(sum)
-								<< std::endl;
-			   				return false;
-			   			} else {
-			   				if(type >= 7 && type <= 9) {
-			   					toend = true;
-			   				}
-			   				mode = 0;
-			   				value = vcnt = 0;
-			   			}
-			   		}
-			   	}
-		   	}
-		   	return true;
+				uint32_t alen;
+				if(type == 0 || type == 1 || type == 5 || type == 9) alen = 2;
+				else if(type == 2 || type == 6 || type == 8) alen = 3;
+				else if(type == 3 || type == 7) alen = 4;
+				else {
+					error_("(%d) S format illegual type", lno);
+					return false;
+				}
+				if(num < (alen + 2)) {
+					error_("(%d) S format length error", lno);
+					return false;
+				}
+				uint32_t address = 0;
+				for(uint32_t i = 0; i < alen; ++i) {
+					address <<= 8;
+					address |= buf[1 + i];
+				}
+
+				if(type >= 1 && type <= 3) {
+					write_(address, &buf[1 + alen], num - alen - 2);
+				} else if(type >= 7) {
+					exec_ = address;
+					break;
+				}
+			}
+			return true;
 		}
 
+		bool load_intel_(const uint8_t* p, const uint8_t* end) {
+			uint8_t buf[256 + 5];
+			uint32_t lno = 0;
+			uint32_t base = 0;
+			while(p < end) {
+				const uint8_t* top = p;
+				while(p < end && *p != '\n') ++p;
+				const uint8_t* last = p;
+				if(p < end) ++p;
+				++lno;
+				while(top < last && (*top == ' ' || *top == '\t')) ++top;
+				while(top < last && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t')) --last;
+				if(top == last) continue;
+
+				uint32_t num = (last - top - 1) / 2;
+				if(top[0] != ':' || ((last - top) & 1) == 0 || num < 5 || num > sizeof(buf)
+					|| !decode_hex_(top + 1, num, buf)) {
+					error_("(%d) Intel HEX illegual record", lno);
+					return false;
+				}
+				if(buf[0] != (num - 5)) {
+					error_("(%d) Intel HEX length error", lno);
+					return false;
+				}
+				uint8_t sum = 0;
+				for(uint32_t i = 0; i < num; ++i) sum += buf[i];
+				if(sum != 0) {
+					error_("(%d) Intel HEX SUM error", lno);
+					return false;
+				}
+
+				uint32_t ofs = (static_cast<uint32_t>(buf[1]) << 8) | buf[2];
+				const uint8_t* data = &buf[4];
+				uint32_t val = 0;
+				for(uint32_t i = 0; i < buf[0] && i < 4; ++i) {
+					val <<= 8;
+					val |= data[i];
+				}
+				switch(buf[3]) {
+				case 0x00:	// データ
+					write_(base + ofs, data, buf[0]);
+					break;
+				case 0x01:	// 終了
+					return true;
+				case 0x02:	// 拡張セグメント・アドレス
+					base = val << 4;
+					break;
+				case 0x03:	// 開始セグメント・アドレス（CS:IP）
+					exec_ = ((val >> 16) << 4) + (val & 0xffff);
+					break;
+				case 0x04:	// 拡張リニア・アドレス
+					base = val << 16;
+					break;
+				case 0x05:	// 開始リニア・アドレス
+					exec_ = val;
+					break;
+				default:
+					error_("(%d) Intel HEX illegual type", lno);
+					return false;
+				}
+			}
+			return true;
+		}
 
-		bool save_(utils::file_io& fio, const memory_map::value_type& m) {
-			const array_t& a = m.second;
-			fio.put_char('S');
+		bool load_elf_(const uint8_t* top, size_t size) {
+			if(size < 52 || top[4] != 1) {  // ELFCLASS32 のみ
+				std::cerr << "ELF format error: not 32 bits" << std::endl;
+				return false;
+			}
+			bool le = top[5] == 1;
+			auto get16 = [=](size_t ofs) -> uint32_t {
+				const uint8_t* s = top + ofs;
+				return le ? (s[0] | (s[1] << 8)) : ((s[0] << 8) | s[1]);
+			};
+			auto get32 = [=](size_t ofs) -> uint32_t {
+				const uint8_t* s = top + ofs;
+				if(le) {
+					return s[0] | (s[1] << 8) | (s[2] << 16) | (static_cast<uint32_t>(s[3]) << 24);
+				} else {
+					return (static_cast<uint32_t>(s[0]) << 24) | (s[1] << 16) | (s[2] << 8) | s[3];
+				}
+			};
+			exec_ = get32(0x18);
+			uint32_t phoff = get32(0x1c);
+			uint32_t phsize = get16(0x2a);
+			uint32_t phnum = get16(0x2c);
+			if(phsize < 32 || (static_cast<uint64_t>(phoff) + phsize * phnum) > size) {
+				std::cerr << "ELF format error: program header" << std::endl;
+				return false;
+			}
+			for(uint32_t i = 0; i < phnum; ++i) {
+				size_t ph = phoff + i * phsize;
+				if(get32(ph) != 1) continue;  // PT_LOAD
+				uint32_t offset = get32(ph + 0x04);
+				uint32_t paddr  = get32(ph + 0x0c);  // ROM に置くのは物理アドレス
+				uint32_t filesz = get32(ph + 0x10);
+				if(filesz == 0) continue;
+				if((static_cast<uint64_t>(offset) + filesz) > size) {
+					std::cerr << "ELF format error: segment out of file" << std::endl;
+					return false;
+				}
+				write_(paddr, top + offset, filesz);
+			}
+			return true;
+		}
 
-			uint8_t sum = 0;
-			uint32_t len = (a.area_.max_ - a.area_.min_ + 1) * 2;
-			std::string adr;
-			if(a.area_.max_ <= 0xffff) {
-				adr = (boost::format("1%04X") % a.area_.max_).str();
-				len += 4;
-			} else if(a.area_.max_ <= 0xffffff) {
-				adr = (boost::format("2%06X") % a.area_.max_).str();
-				len += 6;
-			} else {
-				adr = (boost::format("3%08X") % a.area_.max_).str();
-				len += 8;
+		bool load_binary_(const uint8_t* top, size_t size) {
+			if(size == 0 || size > 0x100000000ULL) return false;
+			// 開始アドレスの指定が無い場合、最後が 0xFFFFFFFF になるように置く
+			uint32_t base = bin_base_ena_ ? bin_base_ : static_cast<uint32_t>(0x100000000ULL - size);
+			if((static_cast<uint64_t>(base) + size) > 0x100000000ULL) {
+				std::cerr << "Binary out of address space" << std::endl;
+				return false;
 			}
-			len += 2; // for check sum
-			fio.put((boost::format("%02X") % len).str());
-			fio.put(adr);
-
-			for(uint32_t i = a.area_.min_; i <= a.area_.max_; ++i) {
-				uint8_t data = a.array_[i & 255];
-				fio.put((boost::format("%02X") % data).str());
-				sum += data;
+			write_(base, top, size);
+			return true;
+		}
+
+
+		// レコードは全て S3（アドレス３２ビット）で、１行３２バイト
+		static bool put_record_(utils::file_io& fio, char type, uint32_t adr, const uint8_t* src, uint32_t len) {
+			uint32_t sum = len + 5;
+			std::string line = (boost::format("S%c%02X%08X") % type % sum % adr).str();
+			sum += (adr >> 24) + ((adr >> 16) & 0xff) + ((adr >> 8) & 0xff) + (adr & 0xff);
+			for(uint32_t i = 0; i < len; ++i) {
+				line += (boost::format("%02X") % static_cast<uint32_t>(src[i])).str();
+				sum += src[i];
 			}
+			line += (boost::format("%02X") % ((~sum) & 0xff)).str();
+			return fio.put_line(line);
+		}
 
-			fio.put((boost::format("%02X") % static_cast<uint32_t>(sum)).str());
 
-			fio.put_char('\n');
-			return false;
+		bool save_(utils::file_io& fio, const page_t& a) {
+			uint64_t adr = a.area_.min_;  // 0xFFFFFFFF で回らないように
+			while(adr <= a.area_.max_) {
+				uint32_t len = a.area_.max_ - adr + 1;
+				if(len > 32) len = 32;
+				if(!put_record_(fio, '3', adr, &a.array_[adr & 255], len)) {
+					return false;
+				}
+				adr += len;
+			}
+			return true;
 		}
 
 
@@ -254,34 +408,79 @@ namespace utils {
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		motsx_io() : area_(), exec_(0x000000) {
+		motsx_io() : area_(), exec_(0x000000), format_(format::none),
+			bin_base_ena_(false), bin_base_(0), pages_(), last_(0) {
 			fill_array_.fill(0xff);
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	ロード
+			@brief	バイナリーを置くアドレスを設定 @n
+					設定しない場合、最後が 0xFFFFFFFF になるように置く
+			@param[in]	base	開始アドレス
+		*/
+		//-----------------------------------------------------------------//
+		void set_binary_base(uint32_t base) {
+			bin_base_ena_ = true;
+			bin_base_ = base;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ロード @n
+					形式は内容から判断する（拡張子が「bin」の場合バイナリー）
 			@param[in]	path	ファイルパス
 			@return エラー無しなら「true」
 		*/
 		//-----------------------------------------------------------------//
 		bool load(const std::string& path) {
-			utils::file_io fio;
-			if(!fio.open(path, "rb")) {
+			file_map fm;
+			if(!fm.open(path)) {
 				return false;
 			}
 
-			memory_map_.clear();
+			pages_.clear();
+			last_ = 0;
+			area_ = area_t();
+			exec_ = 0;
+			format_ = format::none;
+
+			const uint8_t* top = fm.get();
+			size_t size = fm.size();
+			size_t n = 0;
+			while(n < size && (top[n] == ' ' || top[n] == '\t' || top[n] == '\r' || top[n] == '\n')) {
+				++n;
+			}
 
-			if(!load_(fio)) {
-				return false;
+			bool ret = false;
+			if(utils::to_lower_text(utils::get_file_ext(path)) == "bin") {
+				format_ = format::binary;
+				ret = load_binary_(top, size);
+			} else if(size >= 4 && top[0] == 0x7f && top[1] == 'E' && top[2] == 'L' && top[3] == 'F') {
+				format_ = format::elf;
+				ret = load_elf_(top, size);
+			} else if(n < size && top[n] == 'S') {
+				format_ = format::motorola;
+				ret = load_motorola_(top, top + size);
+			} else if(n < size && top[n] == ':') {
+				format_ = format::intel;
+				ret = load_intel_(top, top + size);
+			} else {
+				std::cerr << "Unknown file format: '" << path << "'" << std::endl;
 			}
+			return ret;
+		}
 
-			fio.close();
 
-			return true;
-		}
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ロードしたファイルの形式を取得
+			@return ファイル形式
+		*/
+		//-----------------------------------------------------------------//
+		format get_format() const { return format_; }
 
 
 		//-----------------------------------------------------------------//
@@ -292,18 +491,21 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		bool save(const std::string& path) {
-			if(memory_map_.empty()) return false;
+			if(pages_.empty()) return false;
 
 			utils::file_io fio;
 			if(!fio.open(path, "wb")) {
 				return false;
 			}
 
-			for(const auto& m : memory_map_) {
-				if(!save_(fio, m)) {
+			for(const auto& p : pages_) {
+				if(!save_(fio, p)) {
 					return false;
 				}
 			}
+			if(!put_record_(fio, '7', exec_, nullptr, 0)) {
+				return false;
+			}
 
 			fio.close();
 
@@ -320,9 +522,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		void write(uint32_t address, const uint8_t* data, uint32_t len) {
-			for(uint32_t i = 0; i < len; ++i) {
-				write_byte_(address + i, data[i]);
-			}
+			write_(address, data, len);
 		}
 
 
@@ -333,7 +533,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		uint32_t get_total_page() const {
-			return memory_map_.size();
+			return pages_.size();
 		}
 
 
@@ -345,14 +545,14 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		areas create_area_map() const {
 			areas as;
-			for(const auto& m : memory_map_) {
+			for(const auto& p : pages_) {
 				if(as.empty()) {
-					as.emplace_back(m.second.area_);
+					as.emplace_back(p.area_);
 				} else {
-					if((as.back().max_ + 1) == m.second.area_.min_) {
-						as.back().max_ = m.second.area_.max_;
+					if((as.back().max_ + 1) == p.area_.min_) {
+						as.back().max_ = p.area_.max_;
 					} else {
-						as.emplace_back(m.second.area_);
+						as.emplace_back(p.area_);
 					}
 				}
 			}
@@ -367,7 +567,11 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		void list_area_map(const std::string& head) const {
-			std::cout << head << boost::format("Motolola Sx format load map: (exec: 0x%08X)") % exec_;
+			const char* name = "Motolola Sx";
+			if(format_ == format::intel) name = "Intel HEX";
+			else if(format_ == format::elf) name = "ELF";
+			else if(format_ == format::binary) name = "Binary";
+			std::cout << head << boost::format("%s format load map: (exec: 0x%08X)") % name % exec_;
 			std::cout << std::endl;
 
 			auto as = create_area_map();
@@ -408,7 +612,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		bool find_page(uint32_t address) const {
-			return memory_map_.find(address & 0xffff00) != memory_map_.end();
+			return find_page_(address) != nullptr;
 		}
 
 
@@ -421,11 +625,27 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		const array& get_memory(uint32_t address) const {
-			memory_map::const_iterator cit = memory_map_.find(address & 0xffff00);
-			if(cit == memory_map_.end()) {
+			auto p = find_page_(address);
+			if(p == nullptr) {
 				return fill_array_;
 			}
-			return cit->second.array_;
+			return p->array_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	連続したページを、バッファにコピー
+			@param[in]	address	開始アドレス（ページの先頭）
+			@param[out]	dst		コピー先
+			@param[in]	len		長さ（２５６の倍数）
+		*/
+		//-----------------------------------------------------------------//
+		void copy_memory(uint32_t address, uint8_t* dst, uint32_t len) const {
+			for(uint32_t ofs = 0; ofs < len; ofs += 256) {
+				const auto& m = get_memory(address + ofs);
+				std::memcpy(&dst[ofs], &m[0], 256);
+			}
 		}
 	};
 }
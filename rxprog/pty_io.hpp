@@ -0,0 +1,355 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	疑似端末（pty）入出力クラス @n
+			シミュレーターのデバイス側（マスター）として使う。@n
+			・ボーレートに応じて、送受信にかかる時間を再現する @n
+			・ホスト側（スレーブ）の速度と合わない場合、受信データを壊す
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pty.h>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <chrono>
+#include <thread>
+#include "rs232c_io.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	pty I/O クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class pty_io {
+	public:
+		typedef std::chrono::steady_clock clock;
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	受信の状態
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class state {
+			ok,			///< 正常
+			timeout,	///< タイムアウト
+			hangup		///< ホスト側がクローズした
+		};
+
+	private:
+		int			fd_;
+		std::string	path_;
+		std::string	link_;
+
+		uint32_t	baud_;
+		bool		wire_;
+		uint32_t	limit_;		///< これより速いと、受信データが壊れる（線路の限界）
+		clock::time_point	send_line_;	///< 送信線路が空く時間
+		clock::time_point	recv_line_;	///< 受信線路が空く時間
+		clock::time_point	recv_idle_;	///< 最後に受信バッファが空だった時間
+
+		uint32_t	recv_count_;
+		uint32_t	send_count_;
+		uint32_t	error_count_;
+
+		// n バイトが線路を通過するまで待つ（スタート、ストップを含め１０ビット）@n
+		// 送信と受信は別の線路（全二重）で、start より前には始まらない
+		void wire_wait_(clock::time_point& line, const clock::time_point& start, uint32_t n) {
+			if(!wire_ || baud_ == 0) return;
+			if(line < start) line = start;
+			line += std::chrono::microseconds(static_cast<uint64_t>(n) * 10000000 / baud_);
+			std::this_thread::sleep_until(line);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		pty_io() : fd_(-1), baud_(9600), wire_(true), limit_(0), send_line_(), recv_line_(), recv_idle_(),
+			recv_count_(0), send_count_(0), error_count_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~pty_io() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン
+			@param[in]	link	スレーブのシンボリック・リンク（空なら作らない）
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open(const std::string& link = "") {
+			int slave;
+			char name[256];
+			if(openpty(&fd_, &slave, name, nullptr, nullptr) == -1) {
+				fd_ = -1;
+				return false;
+			}
+			path_ = name;
+			// スレーブは閉じておき、ホストのクローズを検出できるようにする
+			::close(slave);
+
+			if(!link.empty()) {
+				::unlink(link.c_str());
+				if(::symlink(name, link.c_str()) == -1) {
+					close();
+					return false;
+				}
+				link_ = link;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		*/
+		//-----------------------------------------------------------------//
+		void close() {
+			if(!link_.empty()) {
+				::unlink(link_.c_str());
+				link_.clear();
+			}
+			if(fd_ >= 0) {
+				::close(fd_);
+				fd_ = -1;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スレーブ（ホストが開く）のパスを取得
+			@return スレーブのパス
+		*/
+		//-----------------------------------------------------------------//
+		const std::string& get_path() const { return path_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デバイス側のボーレートを設定
+			@param[in]	baud	ボーレート
+		*/
+		//-----------------------------------------------------------------//
+		void set_baud(uint32_t baud) { baud_ = baud; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デバイス側のボーレートを取得
+			@return ボーレート
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_baud() const { return baud_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ホスト側のボーレートを取得
+			@return ボーレート（不明なら「０」）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_host_baud() const {
+			return rs232c_io::get_baud(fd_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	転送時間の再現を許可
+			@param[in]	ena	「false」なら転送時間無し
+		*/
+		//-----------------------------------------------------------------//
+		void enable_wire(bool ena = true) { wire_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	線路の限界を設定（これより速いと、受信データが壊れる）
+			@param[in]	baud	ボーレート（０なら制限無し）
+		*/
+		//-----------------------------------------------------------------//
+		void set_limit(uint32_t baud) { limit_ = baud; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信（タイムアウト）
+			@param[out]	dst	受信先
+			@param[in]	len	受信長さ
+			@param[in]	ms	タイムアウト（ミリ秒）
+			@return 受信の状態
+		*/
+		//-----------------------------------------------------------------//
+		state recv(uint8_t* dst, uint32_t len, uint32_t ms) {
+			uint32_t total = 0;
+			while(total < len) {
+				pollfd pfd;
+				pfd.fd = fd_;
+				pfd.events = POLLIN;
+				pfd.revents = 0;
+				int ret = poll(&pfd, 1, 0);
+				if(ret == 0) {
+					// 待っている間に届いたデータは、届いた時から線路を通る
+					ret = poll(&pfd, 1, ms);
+					recv_idle_ = clock::now();
+				}
+				if(ret == 0) return state::timeout;
+				if(ret < 0) {
+					if(errno == EINTR) continue;
+					return state::hangup;
+				}
+				if(pfd.revents & POLLIN) {
+					auto rl = ::read(fd_, dst + total, len - total);
+					if(rl > 0) {
+						total += rl;
+						continue;
+					}
+				}
+				if(pfd.revents & (POLLHUP | POLLERR)) return state::hangup;
+			}
+			wire_wait_(recv_line_, recv_idle_, len);
+			recv_count_ += len;
+			// 速度が合わない、線路の限界を超えた場合、フレーミング・エラー
+			if(get_host_baud() != baud_ || (limit_ > 0 && baud_ > limit_)) {
+				++error_count_;
+				for(uint32_t i = 0; i < len; ++i) dst[i] = 0xff;
+			}
+			return state::ok;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信済みのデータを捨てる
+			@return 捨てた数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t drain() {
+			uint32_t n = 0;
+			uint8_t tmp[64];
+			pollfd pfd;
+			pfd.fd = fd_;
+			pfd.events = POLLIN;
+			while(1) {
+				pfd.revents = 0;
+				if(poll(&pfd, 1, 0) <= 0 || (pfd.revents & POLLIN) == 0) break;
+				auto rl = ::read(fd_, tmp, sizeof(tmp));
+				if(rl <= 0) break;
+				n += rl;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ホスト側がオープンしているか確認（していなければ待つ）
+			@param[in]	ms	オープンしていない場合に待つ時間（ミリ秒）
+			@return オープンしていれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool wait_open(uint32_t ms = 10) {
+			pollfd pfd;
+			pfd.fd = fd_;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			poll(&pfd, 1, 0);
+			if((pfd.revents & POLLHUP) == 0) return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信
+			@param[in]	src	送信元
+			@param[in]	len	送信長さ
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool send(const uint8_t* src, uint32_t len) {
+			wire_wait_(send_line_, clock::now(), len);
+			uint32_t total = 0;
+			while(total < len) {
+				auto wl = ::write(fd_, src + total, len - total);
+				if(wl < 0) {
+					if(errno == EINTR || errno == EAGAIN) continue;
+					return false;
+				}
+				total += wl;
+			}
+			send_count_ += len;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１バイト送信
+			@param[in]	ch	送信データ
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool send(uint8_t ch) { return send(&ch, 1); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信バイト数を取得
+			@return 受信バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_recv_count() const { return recv_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信バイト数を取得
+			@return 送信バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_send_count() const { return send_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	速度不一致による受信エラー数を取得
+			@return エラー数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_error_count() const { return error_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計のリセット
+		*/
+		//-----------------------------------------------------------------//
+		void reset_count() {
+			recv_count_ = 0;
+			send_count_ = 0;
+			error_count_ = 0;
+		}
+	};
+}
@@ -20,6 +20,27 @@
 #include <iostream>
 #include <cstring>
 #include <cstdio>
+#include <cerrno>
+#include <cstdint>
+
+#ifdef __linux__
+// 任意のボーレート（BOTHER）の設定に使う、カーネルの termios2
+// （asm/termbits.h は termios.h と衝突するので、ここで宣言する）
+struct termios2 {
+	tcflag_t	c_iflag;
+	tcflag_t	c_oflag;
+	tcflag_t	c_cflag;
+	tcflag_t	c_lflag;
+	cc_t		c_line;
+	cc_t		c_cc[19];
+	speed_t		c_ispeed;
+	speed_t		c_ospeed;
+};
+#include <asm/ioctls.h>
+#ifndef BOTHER
+#define BOTHER	CBAUDEX
+#endif
+#endif
 
 namespace utils {
 
@@ -76,6 +97,47 @@ namespace utils {
 			fd_ = -1;
 		}
 
+		// モデム制御線が無いデバイス（疑似端末など）か？
+		static bool no_modem_() {
+			return errno == ENOTTY || errno == EINVAL;
+		}
+
+		struct baud_t {
+			uint32_t	baud_;
+			speed_t		speed_;
+		};
+
+		static const baud_t* speed_table_(uint32_t& num) {
+			static const baud_t tbl[] = {
+				{     9600, B9600 },
+				{    19200, B19200 },
+				{    38400, B38400 },
+				{    57600, B57600 },
+				{   115200, B115200 },
+				{   230400, B230400 },
+#ifdef B460800
+				{   460800, B460800 },
+#endif
+#ifdef B500000
+				{   500000, B500000 },
+#endif
+#ifdef B576000
+				{   576000, B576000 },
+#endif
+#ifdef B921600
+				{   921600, B921600 },
+#endif
+#ifdef B1000000
+				{  1000000, B1000000 },
+#endif
+#ifdef B1500000
+				{  1500000, B1500000 },
+#endif
+			};
+			num = sizeof(tbl) / sizeof(tbl[0]);
+			return tbl;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -175,7 +237,7 @@ namespace utils {
 			}
 
 			int status;
-			if(ioctl(fd_, TIOCMGET, &status) == -1) {
+			if(ioctl(fd_, TIOCMGET, &status) == -1 && !no_modem_()) {
 				close_();
 				return false;
 			}
@@ -207,6 +269,106 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボーレートから、速度定数を得る
+			@param[in]	baud	ボーレート
+			@param[out]	spd		速度定数
+			@return 定数があれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool to_speed(uint32_t baud, speed_t& spd) {
+			uint32_t num;
+			auto tbl = speed_table_(num);
+			for(uint32_t i = 0; i < num; ++i) {
+				if(tbl[i].baud_ == baud) {
+					spd = tbl[i].speed_;
+					return true;
+				}
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ホストで設定出来るボーレートか @n
+					Linux では、定数が無い速度も BOTHER で設定出来る
+			@param[in]	baud	ボーレート
+			@return 設定出来るなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool is_supported(uint32_t baud) {
+			speed_t spd;
+			if(to_speed(baud, spd)) return true;
+#ifdef __linux__
+			return baud > 0;
+#else
+			return false;
+#endif
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ポートのボーレートを取得（BOTHER を含む）
+			@param[in]	fd	ファイル・ディスクリプター
+			@return ボーレート（不明なら「０」）
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t get_baud(int fd) {
+#ifdef __linux__
+			termios2 t2;
+			if(ioctl(fd, TCGETS2, &t2) == 0 && (t2.c_cflag & CBAUD) == BOTHER) {
+				return t2.c_ospeed;
+			}
+#endif
+			termios t;
+			if(tcgetattr(fd, &t) == -1) return 0;
+			auto spd = cfgetospeed(&t);
+			uint32_t num;
+			auto tbl = speed_table_(num);
+			for(uint32_t i = 0; i < num; ++i) {
+				if(tbl[i].speed_ == spd) return tbl[i].baud_;
+			}
+			return 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボーレートを変更（失敗してもクローズしない） @n
+					定数が無い速度は、Linux では termios2 の BOTHER で設定する
+			@param[in]	baud	ボーレート
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool set_baud(uint32_t baud) {
+			if(fd_ < 0) return false;
+
+			speed_t spd;
+			if(to_speed(baud, spd)) {
+				termios t = attr_;
+				if(cfsetspeed(&t, spd) == -1) return false;
+				if(tcsetattr(fd_, TCSANOW, &t) == -1) return false;
+				attr_ = t;
+				return true;
+			}
+#ifdef __linux__
+			termios2 t2;
+			if(ioctl(fd_, TCGETS2, &t2) == -1) return false;
+			t2.c_cflag &= ~CBAUD;
+			t2.c_cflag |= BOTHER;
+			t2.c_ispeed = baud;
+			t2.c_ospeed = baud;
+			if(ioctl(fd_, TCSETS2, &t2) == -1) return false;
+			return true;
+#else
+			return false;
+#endif
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	クローズ
@@ -218,8 +380,9 @@ namespace utils {
 
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
+				bool f = no_modem_();
 				close_();
-				return false;
+				return f;
 			}
 
 			status &= ~TIOCM_DTR;    /* turn off DTR */
@@ -447,7 +610,7 @@ namespace utils {
 
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
-				return false;
+				return no_modem_();
 			}
 
 			if(ena) status |= TIOCM_DTR;
@@ -473,7 +636,7 @@ namespace utils {
 
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
-				return false;
+				return no_modem_();
 			}
 
 			if(ena) status |= TIOCM_RTS;
@@ -700,6 +700,15 @@ namespace rx24t {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボーレートを取得
+			@return ボーレート
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_speed() const { return baud_speed_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	P/E ステータス遷移
@@ -761,6 +770,37 @@ namespace rx24t {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去ブロックの構成を取得
+			@return 消去ブロックの構成
+		*/
+		//-----------------------------------------------------------------//
+		utils::erase_blocks get_erase_blocks() const {
+			utils::erase_blocks bs;
+			for(const auto& a : blocks_) {
+				if(a.size_ == 0 || a.num_ == 0) continue;
+				bs.emplace_back(a.org_, a.org_ + a.size_ * a.num_ - 1, a.size_);
+			}
+			return bs;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イレース・ブロック
+			@param[in]	org		ブロックの開始アドレス
+			@param[in]	end		ブロックの終了アドレス
+			@param[out]	erased	消去した場合「true」（ブランクなら「false」）
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool erase_block(uint32_t org, uint32_t end, bool& erased) {
+			erased = false;  // P/E ステータスへの移行で、全て消去されている
+			return connection_ && pe_turn_on_;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ユーザー・ブート／データ領域書き込み選択
@@ -874,15 +914,30 @@ namespace rx24t {
 		*/
 		//-----------------------------------------------------------------//
 		bool read_page(uint32_t adr, uint8_t* dst) {
+			return read_area(adr, dst, 256);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リード・エリア（一つのコマンドで読む）
+			@param[in]	adr	アドレス
+			@param[out]	dst	リード・データ
+			@param[in]	len	長さ
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+				bool read_area(uint32_t adr, uint8_t* dst, uint32_t len) {
 			if(!connection_) return false;
 			if(!pe_turn_on_) return false;
+			if(len == 0) return false;
 
 			uint8_t cmd[12];
 			cmd[0] = 0x52;
 			cmd[1] = 9;
 			cmd[2] = 0x01;  // user-area, data-area
 			put32_big_(&cmd[3], adr);
-			put32_big_(&cmd[7], 256);
+			put32_big_(&cmd[7], len);
 			cmd[11] = sum_(cmd, 11);
 			if(!write_(cmd, 12)) {
 				return false;
@@ -901,6 +956,9 @@ namespace rx24t {
 				}
 				auto rs = get32_big_(&head[1]);
 				/// std::cout << "Read size: " << rs << std::endl;
+				if(rs != len) {
+					return false;
+				}
 				tv.tv_sec  = 5;
 				tv.tv_usec = 0;
 				if(!read_(dst, rs, tv)) {
@@ -956,6 +1014,44 @@ namespace rx24t {
 		}
 
 #endif
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・エリア（２５６バイト単位） @n
+					このプロトコルは、ページ毎に応答を待つ
+			@param[in]	org	開始アドレス
+			@param[in]	src	ライト・データ
+			@param[in]	len	長さ（２５６の倍数）
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_area(uint32_t org, const uint8_t* src, uint32_t len) {
+			if(len == 0 || (len & 0xff) != 0) return false;
+			for(uint32_t ofs = 0; ofs < len; ofs += 256) {
+				if(!write_page(org + ofs, &src[ofs])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	CRC エリア @n
+					デバイスで計算するコマンドが無いので、support に「false」を返す
+			@param[in]	org		開始アドレス
+			@param[in]	len		長さ
+			@param[out]	crc		CRC-32
+			@param[out]	support	コマンドがある場合「true」
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool crc_area(uint32_t org, uint32_t len, uint32_t& crc, bool& support) {
+			support = false;
+			return connection_ && pe_turn_on_;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	終了
@@ -12,6 +12,7 @@
 #include "rx_protocol.hpp"
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <boost/format.hpp>
 
 namespace rx64m {
@@ -26,6 +27,7 @@ namespace rx64m {
 		utils::rs232c_io	rs232c_;
 
 		bool				verbose_ = false;
+		bool				pipeline_ = false;
 
 		bool				connection_ = false;
 
@@ -35,7 +37,7 @@ namespace rx64m {
 		uint32_t			device_clock_ = 0;
 
 		uint32_t	   		baud_speed_ = 0;
-		speed_t				baud_rate_ = B9600;
+		uint32_t			timeout_ = 5000;	///< 受信タイムアウト [ms]
 
 		bool				enable_id_ = false;
 
@@ -48,6 +50,9 @@ namespace rx64m {
 
 		uint8_t				last_error_ = 0;
 
+		static const uint32_t	packet_max_ = 1024;	///< データ・パケットの最大長
+		static const uint32_t	window_ = 2;		///< 応答を待たずに送るパケット数
+
 
 		static uint32_t get16_big_(const uint8_t* p) {
 			uint32_t v;
@@ -97,8 +102,8 @@ namespace rx64m {
 
 		bool read_(void* buff, uint32_t len) {
 			timeval tv;
-			tv.tv_sec  = 5;
-			tv.tv_usec = 0;
+			tv.tv_sec  = timeout_ / 1000;
+			tv.tv_usec = (timeout_ % 1000) * 1000;
 			return rs232c_.recv(buff, len, tv) == len;
 		}
 
@@ -252,6 +257,152 @@ namespace rx64m {
 		}
 
 
+		// 長さが最大 max のデータを受け取る（長さを len に返す）
+		bool recv_data_(uint8_t res, uint8_t* dst, uint32_t max, uint32_t& len) {
+			uint8_t tmp[4 + packet_max_ + 2];
+			if(!read_(tmp, 4)) {
+				return false;
+			}
+			if(tmp[0] != 0x81 || tmp[3] != res) {
+				return false;
+			}
+			auto l = get16_big_(&tmp[1]);
+			if(l < 2 || (l - 1) > max || (l - 1) > packet_max_) {
+				return false;
+			}
+			len = l - 1;
+			if(!read_(&tmp[4], len + 2)) {
+				return false;
+			}
+			if(sum_(&tmp[1], len + 3) != tmp[4 + len] || tmp[4 + len + 1] != 0x03) {
+				return false;
+			}
+			std::memcpy(dst, &tmp[4], len);
+			return true;
+		}
+
+
+		// 消去コマンドを送り、応答を確認
+		bool erase_(uint32_t org) {
+			uint8_t tmp[4];
+			put32_big_(&tmp[0], org);
+			if(!command_(0x12, tmp, 4)) {  // erase command
+				return false;
+			}
+			uint8_t res;
+			uint8_t err;
+			if(!response_(res, err)) {
+				return false;
+			}
+			if(res == 0x12) ;
+			else if(res == 0x92) {
+				std::cout << boost::format("Erase response: %02X") % static_cast<uint32_t>(err)
+					<< std::endl;
+				return false;
+			} else {
+				return false;
+			}
+			return true;
+		}
+
+
+		// デバイスのクロックで、誤差が２％以内のボーレートか（ＳＣＩ：１６、３２分周）
+		bool is_clock_ok_(uint32_t speed) const {
+			if(device_clock_ == 0 || speed == 0) return false;
+			static const uint32_t divs[] = { 16, 32 };
+			for(auto div : divs) {
+				uint64_t n = (static_cast<uint64_t>(device_clock_) + div * speed / 2) / (div * speed);
+				if(n < 1 || n > 256) continue;
+				double err = static_cast<double>(device_clock_) / (div * n) / speed - 1.0;
+				if(err >= -0.02 && err <= 0.02) return true;
+			}
+			return false;
+		}
+
+
+		// 速度を変えて、同期と問い合わせの往復で確かめる @n
+		// alive には、失敗しても前の速度で通信出来る場合「true」を返す
+		bool try_speed_(uint32_t speed, bool& alive) {
+			alive = false;
+			uint8_t tmp[4];
+			put32_big_(&tmp[0], speed);
+			if(!command_(0x34, tmp, sizeof(tmp))) {
+				return false;
+			}
+			uint8_t res;
+			uint8_t err;
+			if(!response_(res, err)) {
+				return false;
+			}
+			if(res == 0xB4) {  // デバイスが受け付けない速度
+				alive = true;
+				return false;
+			} else if(res != 0x34) {
+				return false;
+			}
+
+			usleep(1000);	// 1[ms]
+
+			if(!rs232c_.set_baud(speed)) {
+				return false;
+			}
+
+			auto type = device_type_;
+			auto tmo = timeout_;
+			timeout_ = 500;
+			bool ok = command_(0x00) && status_(0x00) && inquiry_device_type()
+				&& std::memcmp(type.TYP, device_type_.TYP, sizeof(type.TYP)) == 0;
+			timeout_ = tmo;
+			if(!ok) {
+				device_type_ = type;
+				return false;
+			}
+			baud_speed_ = speed;
+			alive = true;
+			return true;
+		}
+
+
+		// ホストとデバイスの両方で使える速度を、低い方から順に試す @n
+		// 通信出来なくなった場合「false」を返し、baud_speed_ に確かめた速度が残る
+		bool negotiate_speed_(const rx::protocol::rx_t& rx) {
+			static const uint32_t speeds[] = {
+				115200, 230400, 460800, 500000, 576000, 921600, 1000000, 1500000
+			};
+			baud_speed_ = 9600;
+			std::vector<uint32_t> list;
+			for(auto s : speeds) {
+				if(utils::rs232c_io::is_supported(s) && is_clock_ok_(s)) list.push_back(s);
+			}
+
+			// 前回の速度があれば、最初に試す
+			if(rx.speed_hint_ > 0 && std::find(list.begin(), list.end(), rx.speed_hint_) != list.end()) {
+				bool alive;
+				bool ok = try_speed_(rx.speed_hint_, alive);
+				if(verbose_) {
+					std::cout << out_section_(1, 1) << boost::format("Try baud rate: %d (last) %s")
+						% rx.speed_hint_ % (ok ? "OK" : "NG") << std::endl;
+				}
+				if(ok) return true;
+				if(!alive) return false;
+			}
+
+			for(auto s : list) {
+				if(s <= baud_speed_) continue;
+				bool alive;
+				bool ok = try_speed_(s, alive);
+				if(verbose_) {
+					std::cout << out_section_(1, 1) << boost::format("Try baud rate: %d %s")
+						% s % (ok ? "OK" : "NG") << std::endl;
+				}
+				if(ok) continue;
+				if(!alive) return false;
+				break;
+			}
+			return true;
+		}
+
+
 		std::string out_section_(uint32_t n, uint32_t num) const {
 			return (boost::format("#%02d/%02d: ") % n % num).str();
 		}
@@ -277,6 +428,7 @@ namespace rx64m {
 		bool bind(const std::string& path, uint32_t brate, const rx::protocol::rx_t& rx)
 		{
 			verbose_ = rx.verbose_;
+			pipeline_ = rx.pipeline_;
 
 			if(!start(path)) {
 				std::cerr << "Can't open path: '" << path << "'" << std::endl;
@@ -328,15 +480,21 @@ namespace rx64m {
 				}
 			}
 
-			// ボーレート変更
+			// ボーレート変更（０なら、使える最大の速度を探す）
 			{
-				if(!change_speed(rx, brate)) {
-					std::cerr << "Can't change speed." << std::endl;
+				if(brate > 0) {
+					if(!change_speed(rx, brate)) {
+						std::cerr << "Can't change speed." << std::endl;
+						return false;
+					}
+				} else if(!negotiate_speed_(rx)) {
+					std::cerr << boost::format("Baud rate negotiation error (last good: %d)")
+						% baud_speed_ << std::endl;
 					return false;
 				}
 				if(verbose_) {
 					auto sect = out_section_(1, 1);
-					std::cout << sect << boost::format("Change baud rate: %d") % brate << std::endl;
+					std::cout << sect << boost::format("Change baud rate: %d") % baud_speed_ << std::endl;
 				}
 			}
 
@@ -534,32 +692,7 @@ namespace rx64m {
 		bool change_speed(const rx::protocol::rx_t& rx, uint32_t speed) {
 			if(!connection_) return false;
 
-			switch(speed) {
-			case 19200:
-				baud_rate_ = B19200;
-				break;
-			case 38400:
-				baud_rate_ = B38400;
-				break;
-			case 57600:
-				baud_rate_ = B57600;
-				break;
-			case 115200:
-				baud_rate_ = B115200;
-				break;
-			case 230400:
-				baud_rate_ = B230400;
-				break;
-			case 460800:
-				baud_rate_ = B460800;
-				break;
-			case 500000:
-				baud_rate_ = B500000;
-				break;
-			case 576000:
-				baud_rate_ = B576000;
-				break;
-			default:
+			if(!utils::rs232c_io::is_supported(speed)) {
 				return false;
 			}
 			baud_speed_ = speed; 
@@ -576,7 +709,7 @@ namespace rx64m {
 
 			usleep(1000);	// 1[ms]
 
-			if(!rs232c_.change_speed(baud_rate_)) {
+			if(!rs232c_.set_baud(speed)) {
 				return false;
 			}
 
@@ -592,6 +725,15 @@ namespace rx64m {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボーレートを取得
+			@return ボーレート
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_speed() const { return baud_speed_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ID 認証モード取得コマンド
@@ -658,24 +800,13 @@ namespace rx64m {
 				}
 				// erase NG;
 				// std::cout << boost::format("Erase NG: %08X") % address << std::endl;
-				if(address >= 0xFFFF0000) {  // 8K block
-					org = address & 0xFFFFE000;
-				} else if(address >= 0xFFC00000) {  // 32K block
-					org = address & 0xFFFF8000;
-				}
-				put32_big_(&tmp[0], org);
-				if(!command_(0x12, tmp, 4)) {  // erase command
-					return false;
+				for(const auto& g : get_erase_blocks()) {
+					if(g.is_in(address)) {
+						org = g.get_block(address).org_;
+						break;
+					}
 				}
-				if(!response_(res, err)) {
-					return false;
-				}
-				if(res == 0x12) ;
-				else if(res == 0x92) {
-					std::cout << boost::format("Erase response: %02X") % static_cast<uint32_t>(err)
-						<< std::endl;
-					return false;
-				} else {
+				if(!erase_(org)) {
 					return false;
 				}
 			}
@@ -683,6 +814,60 @@ namespace rx64m {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去ブロックの構成を取得 @n
+					RX64M にはブロック問い合わせが無いので、固定の構成を返す
+			@return 消去ブロックの構成
+		*/
+		//-----------------------------------------------------------------//
+		utils::erase_blocks get_erase_blocks() const {
+			utils::erase_blocks bs;
+			bs.emplace_back(0xFFFF0000, 0xFFFFFFFF,  8 * 1024);  // 8K block
+			bs.emplace_back(0xFFC00000, 0xFFFEFFFF, 32 * 1024);  // 32K block
+			bs.emplace_back(0x00100000, 0x0010FFFF, 64);         // data flash
+			return bs;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イレース・ブロック @n
+					ブロック全体を一度でブランク・チェックし、ブランクで無い場合だけ消去する
+			@param[in]	org		ブロックの開始アドレス
+			@param[in]	end		ブロックの終了アドレス
+			@param[out]	erased	消去した場合「true」（ブランクなら「false」）
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool erase_block(uint32_t org, uint32_t end, bool& erased) {
+			erased = false;
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+
+			uint8_t tmp[8];
+			put32_big_(&tmp[0], org);
+			put32_big_(&tmp[4], end);
+			if(!command_(0x10, tmp, sizeof(tmp))) {
+				return false;
+			}
+			uint8_t res;
+			uint8_t err;
+			if(!response_(res, err)) {
+				return false;
+			}
+			if(res == 0x10) return true;  // blank
+			else if(res != 0x90 || err != 0xe0) {
+				return false;
+			}
+			if(!erase_(org)) {
+				return false;
+			}
+			erased = true;
+			return true;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ユーザー・ブート／データ領域書き込み選択
@@ -718,10 +903,30 @@ namespace rx64m {
 			if(address == 0xFFFFFFFF || src == nullptr) {
 				return true;
 			}
+			return write_area(address, src, 256);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・エリア（２５６バイト単位） @n
+					範囲を一つのコマンドで送り、データ・パケット（最大１０２４バイト）は、@n
+					前のパケットの応答を待たずに送る（パイプライン）
+			@param[in]	org	開始アドレス
+			@param[in]	src	ライト・データ
+			@param[in]	len	長さ（２５６の倍数）
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_area(uint32_t org, const uint8_t* src, uint32_t len) {
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+			if(!select_write_area_) return false;
+			if(len == 0 || (len & 0xff) != 0) return false;
 
 			uint8_t tmp[8];
-			put32_big_(&tmp[0], address);
-			put32_big_(&tmp[4], address + 255);
+			put32_big_(&tmp[0], org);
+			put32_big_(&tmp[4], org + len - 1);
 			if(!command_(0x13, tmp, sizeof(tmp))) {
 				return false;
 			}
@@ -730,23 +935,34 @@ namespace rx64m {
 				return false;
 			}
 
-			if(!com_(0x81, 0x13, 0x03, src, 256)) {
-				return false;
-			}
+			uint32_t num = (len + packet_max_ - 1) / packet_max_;
+			uint32_t depth = pipeline_ ? window_ : 1;
+			uint32_t sent = 0;
+			for(uint32_t ack = 0; ack < num; ++ack) {
+				while(sent < num && sent < (ack + depth)) {
+					uint32_t ofs = sent * packet_max_;
+					uint32_t l = (len - ofs) > packet_max_ ? packet_max_ : (len - ofs);
+					if(!com_(0x81, 0x13, 0x03, &src[ofs], l)) {
+						return false;
+					}
+					++sent;
+				}
 
-			uint8_t res;
-			uint8_t err;
-			if(!response_(res, err)) {
-				return false;
-			}
-			if(res == 0x13) {  // write OK
-				return true;
-			} else if(res == 0x93) { // write error
-				std::cerr << std::endl;
-				std::cerr << boost::format("Write error (%08X), status: %02X")
-					% address % static_cast<uint32_t>(err) << std::endl;
+				uint8_t res;
+				uint8_t err;
+				if(!response_(res, err)) {
+					return false;
+				}
+				if(res == 0x93) { // write error
+					std::cerr << std::endl;
+					std::cerr << boost::format("Write error (%08X), status: %02X")
+						% (org + ack * packet_max_) % static_cast<uint32_t>(err) << std::endl;
+					return false;
+				} else if(res != 0x13) {
+					return false;
+				}
 			}
-			return false;
+			return true;
 		}
 
 
@@ -759,12 +975,28 @@ namespace rx64m {
 		*/
 		//-----------------------------------------------------------------//
 		bool read_page(uint32_t adr, uint8_t* dst) {
+			return read_area(adr, dst, 256);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リード・エリア @n
+					範囲を一つのコマンドで送り、データ要求は、前のデータを待たずに送る
+			@param[in]	org	開始アドレス
+			@param[out]	dst	リード・データ
+			@param[in]	len	長さ
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool read_area(uint32_t org, uint8_t* dst, uint32_t len) {
 			if(!connection_) return false;
 			if(!pe_turn_on_) return false;
+			if(len == 0) return false;
 
 			uint8_t tmp[8];
-			put32_big_(&tmp[0], adr);
-			put32_big_(&tmp[4], adr + 255);
+			put32_big_(&tmp[0], org);
+			put32_big_(&tmp[4], org + len - 1);
 			if(!command_(0x15, tmp, sizeof(tmp))) {
 				return false;
 			}
@@ -773,13 +1005,73 @@ namespace rx64m {
 				return false;
 			}
 
-			if(!com_(0x81, 0x15, 0x03)) {
-				return false;
+			// デバイスが返す長さは最大長以下なので、要求が余る事は無い
+			uint32_t depth = pipeline_ ? window_ : 1;
+			uint32_t pos = 0;
+			uint32_t req = 0;
+			while(pos < len) {
+				while(req < depth && (pos + req * packet_max_) < len) {
+					if(!com_(0x81, 0x15, 0x03)) {
+						return false;
+					}
+					++req;
+				}
+				uint32_t l;
+				if(!recv_data_(0x15, &dst[pos], len - pos, l)) {
+					return false;
+				}
+				pos += l;
+				--req;
 			}
-			if(!status_data_(0x15, dst, 256)) {
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	CRC エリア（デバイスで CRC-32 を計算する） @n
+					コマンドが無いデバイスでは、support に「false」を返す
+			@param[in]	org		開始アドレス
+			@param[in]	len		長さ
+			@param[out]	crc		CRC-32
+			@param[out]	support	コマンドがある場合「true」
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool crc_area(uint32_t org, uint32_t len, uint32_t& crc, bool& support) {
+			support = false;
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+			if(len == 0) return false;
+
+			uint8_t tmp[4 + 4 + 2];
+			put32_big_(&tmp[0], org);
+			put32_big_(&tmp[4], org + len - 1);
+			if(!command_(0x18, tmp, 8)) {
 				return false;
 			}
 
+			if(!read_(tmp, 4)) {
+				return false;
+			}
+			auto l = get16_big_(&tmp[1]);
+			if(tmp[0] != 0x81 || l < 1 || l > 5) {
+				return false;
+			}
+			--l;
+			if(!read_(&tmp[4], l + 2)) {
+				return false;
+			}
+			if(sum_(&tmp[1], 3 + l) != tmp[4 + l] || tmp[4 + l + 1] != 0x03) {
+				return false;
+			}
+			if(tmp[3] == 0x98) {  // コマンド・エラー
+				return true;
+			} else if(tmp[3] != 0x18 || l != 4) {
+				return false;
+			}
+			crc = get32_big_(&tmp[4]);
+			support = true;
 			return true;
 		}
 
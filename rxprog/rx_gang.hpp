@@ -0,0 +1,288 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RX ギャング・プログラミング・クラス @n
+			複数のシリアル・ポートに繋いだデバイスを、ポート毎のスレッドで @n
+			同時に書き込む。@n
+			イメージと消去計画は、全てのポートで共有する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "rx_prog.hpp"
+#include "motsx_io.hpp"
+#include "erase_plan.hpp"
+
+namespace rx {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	gang クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class gang {
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	ポートの状態
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class phase : uint8_t {
+			wait,		///< 開始前
+			connect,	///< 接続中
+			erase,		///< 消去中
+			write,		///< 書き込み中
+			verify,		///< ベリファイ中
+			pass,		///< 成功
+			fail		///< 失敗
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	ポート
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct port_t {
+			std::string				path_;
+			std::atomic<phase>		phase_;
+			std::atomic<phase>		fail_;	///< 失敗した処理
+			std::atomic<uint32_t>	n_;
+			std::atomic<uint32_t>	all_;
+			double					time_;
+
+			port_t(const std::string& path) : path_(path), phase_(phase::wait), fail_(phase::wait),
+				n_(0), all_(0), time_(0.0) { }
+
+			void set(phase ph, uint32_t all) {
+				n_ = 0;
+				all_ = all;
+				phase_ = ph;
+			}
+		};
+
+	private:
+		typedef std::chrono::steady_clock clock_type;
+
+		const utils::motsx_io&	image_;
+		utils::erase_plan&		plan_;
+		rx::protocol::rx_t		rx_;
+		uint32_t				speed_;
+
+		bool	do_erase_;
+		bool	do_write_;
+		bool	do_verify_;
+		bool	do_crc_;
+
+		static const uint32_t run_size_ = 8192;
+
+		std::vector<uint32_t>	pages_;
+		utils::areas			runs_;
+
+		std::vector<std::unique_ptr<port_t> >	ports_;
+		std::vector<std::thread>	threads_;
+
+		std::mutex	plan_lock_;
+		bool		plan_ready_;
+
+		// 消去ブロックの構成を、最初に接続出来たデバイスから得る
+		void make_plan_(rx::prog& prog) {
+			std::lock_guard<std::mutex> lock(plan_lock_);
+			if(plan_ready_) return;
+			if(plan_.get_geometry().empty()) {
+				plan_.set_geometry(prog.get_erase_blocks());
+			}
+			plan_.build(image_.create_area_map());
+			plan_ready_ = true;
+		}
+
+		bool erase_(rx::prog& prog, port_t& port) {
+			const auto& blocks = plan_.get_blocks();
+			const auto& pages = plan_.get_pages();
+			port.set(phase::erase, blocks.size() + pages.size());
+			for(const auto& b : blocks) {
+				bool erased;
+				if(!prog.erase_block(b.org_, b.end_, erased)) return false;
+				++port.n_;
+			}
+			for(const auto& p : pages) {
+				if(!prog.erase_page(p.org_)) return false;
+				++port.n_;
+			}
+			return true;
+		}
+
+		bool write_(rx::prog& prog, port_t& port) {
+			port.set(phase::write, pages_.size());
+			if(!prog.start_write(true)) return false;
+			std::vector<uint8_t> buff(run_size_);
+			for(const auto& r : runs_) {
+				image_.copy_memory(r.org_, &buff[0], r.length());
+				if(!prog.write_area(r.org_, &buff[0], r.length())) return false;
+				port.n_ += r.length() / 256;
+			}
+			return prog.final_write();
+		}
+
+		bool verify_(rx::prog& prog, port_t& port) {
+			port.set(phase::verify, pages_.size());
+			std::vector<uint8_t> buff(run_size_);
+			for(const auto& r : runs_) {
+				image_.copy_memory(r.org_, &buff[0], r.length());
+				if(!prog.verify_area(r.org_, &buff[0], r.length(), do_crc_)) return false;
+				port.n_ += r.length() / 256;
+			}
+			return true;
+		}
+
+		void run_(port_t& port) {
+			auto t = clock_type::now();
+			rx::prog prog(false);
+			port.set(phase::connect, 1);
+			bool ok = prog.start(port.path_, speed_, rx_);
+			if(ok) {
+				++port.n_;
+				make_plan_(prog);
+			}
+			if(ok && do_erase_) ok = erase_(prog, port);
+			if(ok && do_write_) ok = write_(prog, port);
+			if(ok && do_verify_) ok = verify_(prog, port);
+			prog.end();
+
+			auto us = std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - t).count();
+			port.time_ = static_cast<double>(us) / 1e6;
+			if(!ok) port.fail_ = port.phase_.load();
+			port.phase_ = ok ? phase::pass : phase::fail;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	image	書き込むイメージ
+			@param[in]	plan	消去計画（構成が空なら、デバイスから得る）
+			@param[in]	rx		CPU 設定
+			@param[in]	speed	ボーレート
+		*/
+		//-----------------------------------------------------------------//
+		gang(const utils::motsx_io& image, utils::erase_plan& plan, const rx::protocol::rx_t& rx,
+			uint32_t speed) : image_(image), plan_(plan), rx_(rx), speed_(speed),
+			do_erase_(false), do_write_(false), do_verify_(false), do_crc_(false),
+			pages_(), runs_(), ports_(), threads_(), plan_lock_(), plan_ready_(false) {
+			rx_.verbose_ = false;
+			for(const auto& a : image_.create_area_map()) {
+				uint64_t adr = a.min_ & 0xffffff00;
+				while(adr <= a.max_) {
+					pages_.push_back(adr);
+					adr += 256;
+				}
+			}
+			runs_ = utils::make_runs(pages_, run_size_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~gang() { join(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ポートを追加
+			@param[in]	path	シリアル・デバイス・パス
+		*/
+		//-----------------------------------------------------------------//
+		void add(const std::string& path) {
+			ports_.emplace_back(new port_t(path));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始（ポート毎にスレッドを起動する）
+			@param[in]	erase	消去する場合「true」
+			@param[in]	write	書き込む場合「true」
+			@param[in]	verify	ベリファイする場合「true」
+			@param[in]	crc		デバイスの CRC でベリファイする場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		void start(bool erase, bool write, bool verify, bool crc = false) {
+			do_erase_ = erase;
+			do_write_ = write;
+			do_verify_ = verify;
+			do_crc_ = crc;
+			for(auto& p : ports_) {
+				port_t* port = p.get();
+				threads_.emplace_back([this, port]() { run_(*port); });
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのポートが終了したか
+			@return 終了したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_done() const {
+			for(const auto& p : ports_) {
+				auto ph = p->phase_.load();
+				if(ph != phase::pass && ph != phase::fail) return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのスレッドの終了を待つ
+		*/
+		//-----------------------------------------------------------------//
+		void join() {
+			for(auto& t : threads_) {
+				if(t.joinable()) t.join();
+			}
+			threads_.clear();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ポートを取得
+			@return ポート
+		*/
+		//-----------------------------------------------------------------//
+		const std::vector<std::unique_ptr<port_t> >& get_ports() const { return ports_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	状態の名前を取得
+			@param[in]	ph	状態
+			@return 名前
+		*/
+		//-----------------------------------------------------------------//
+		static const char* get_name(phase ph) {
+			switch(ph) {
+			case phase::wait:    return "wait";
+			case phase::connect: return "connect";
+			case phase::erase:   return "erase";
+			case phase::write:   return "write";
+			case phase::verify:  return "verify";
+			case phase::pass:    return "PASS";
+			case phase::fail:    return "FAIL";
+			}
+			return "";
+		}
+	};
+}
@@ -50,6 +50,16 @@ namespace rx {
 		};
 
 
+		struct speed_visitor {
+			using result_type = uint32_t;
+
+    		template <class T>
+    		uint32_t operator()(T& x) {
+				return x.get_speed();
+			}
+		};
+
+
 		struct erase_page_visitor {
 			using result_type = bool;
 
@@ -63,6 +73,32 @@ namespace rx {
 		};
 
 
+		struct erase_blocks_visitor {
+			using result_type = utils::erase_blocks;
+
+    		template <class T>
+    		utils::erase_blocks operator()(T& x) {
+				return x.get_erase_blocks();
+			}
+		};
+
+
+		struct erase_block_visitor {
+			using result_type = bool;
+
+			uint32_t org_;
+			uint32_t end_;
+			bool& erased_;
+			erase_block_visitor(uint32_t org, uint32_t end, bool& erased) :
+				org_(org), end_(end), erased_(erased) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.erase_block(org_, end_, erased_);
+			}
+		};
+
+
 		struct read_page_visitor {
 			using result_type = bool;
 
@@ -77,6 +113,39 @@ namespace rx {
 		};
 
 
+		struct read_area_visitor {
+			using result_type = bool;
+
+			uint32_t adr_;
+			uint8_t* dst_;
+			uint32_t len_;
+			read_area_visitor(uint32_t adr, uint8_t* dst, uint32_t len) :
+				adr_(adr), dst_(dst), len_(len) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.read_area(adr_, dst_, len_);
+			}
+		};
+
+
+		struct crc_area_visitor {
+			using result_type = bool;
+
+			uint32_t adr_;
+			uint32_t len_;
+			uint32_t& crc_;
+			bool& support_;
+			crc_area_visitor(uint32_t adr, uint32_t len, uint32_t& crc, bool& support) :
+				adr_(adr), len_(len), crc_(crc), support_(support) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.crc_area(adr_, len_, crc_, support_);
+			}
+		};
+
+
 		struct select_write_visitor {
 			using result_type = bool;
 
@@ -104,6 +173,22 @@ namespace rx {
 		};
 
 
+		struct write_area_visitor {
+			using result_type = bool;
+
+			uint32_t adr_;
+			const uint8_t* src_;
+			uint32_t len_;
+			write_area_visitor(uint32_t adr, const uint8_t* src, uint32_t len) :
+				adr_(adr), src_(src), len_(len) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.write_area(adr_, src_, len_);
+			}
+		};
+
+
 		struct end_visitor {
 			using result_type = void;
 
@@ -124,9 +209,12 @@ namespace rx {
 
 		//-------------------------------------------------------------//
 		/*!
-			@brief	接続速度を変更する
+			@brief	接続速度を変更する @n
+					brate が０なら、使える最大の速度を探す。@n
+					途中で通信出来なくなった場合、ポートを開き直し（デバイスのリセットを期待）、@n
+					確かめた速度で接続し直す
 			@param[in]	path	シリアル・デバイス・パス
-			@param[in]	brate	ボーレート
+			@param[in]	brate	ボーレート（０なら自動）
 			@param[in]	rx		CPU 設定
 			@return エラー無ければ「true」
 		*/
@@ -148,8 +236,22 @@ namespace rx {
 			{  // 開始
 				bind_visitor vis(path, brate, rx);
             	if(!boost::apply_visitor(vis, protocol_)) {
+					uint32_t last = get_speed();
 					end();
-					return false;
+					if(brate != 0 || last == 0) {
+						return false;
+					}
+					// 前回の速度で失敗した場合は探し直し、探す途中なら確かめた速度にする
+					rx::protocol::rx_t r = rx;
+					uint32_t b = last;
+					if(r.speed_hint_ > 0) {
+						r.speed_hint_ = 0;
+						b = 0;
+					}
+					std::cerr << "Reconnect, baud rate: " << (b > 0 ? std::to_string(b) : "auto")
+						<< std::endl;
+					usleep(100000);	// 100[ms]
+					return start(path, b, r);
 				}
 			}
 
@@ -157,6 +259,18 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ボーレートを取得
+			@return ボーレート
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_speed() {
+			speed_visitor vis;
+			return boost::apply_visitor(vis, protocol_);
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ページ消去
@@ -175,6 +289,39 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	消去ブロックの構成を取得
+			@return 消去ブロックの構成
+		*/
+		//-------------------------------------------------------------//
+		utils::erase_blocks get_erase_blocks() {
+			erase_blocks_visitor vis;
+			return boost::apply_visitor(vis, protocol_);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ブロック消去（ブランクなら消去しない）
+			@param[in]	org		ブロックの開始アドレス
+			@param[in]	last	ブロックの終了アドレス
+			@param[out]	erased	消去した場合「true」
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool erase_block(uint32_t org, uint32_t last, bool& erased) {
+			erase_block_visitor vis(org, last, erased);
+           	if(!boost::apply_visitor(vis, protocol_)) {
+				end();
+				std::cerr << std::endl << boost::format("Erase block error: %08X to %08X") % org % last
+					<< std::endl;
+				return false;
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	リード・ページ（２５６バイト）
@@ -194,6 +341,27 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	リード・エリア
+			@param[in]	adr	開始アドレス
+			@param[out]	dst	書き込みアドレス
+			@param[in]	len	長さ
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool read_area(uint32_t adr, uint8_t* dst, uint32_t len) {
+			read_area_visitor vis(adr, dst, len);
+           	if(!boost::apply_visitor(vis, protocol_)) {
+				end();
+				std::cerr << std::endl << boost::format("Read area error: %08X to %08X")
+					% adr % (adr + len - 1) << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ベリファイ・ページ（２５６バイト）
@@ -203,12 +371,44 @@ namespace rx {
 		*/
 		//-------------------------------------------------------------//
 		bool verify_page(uint32_t adr, const uint8_t* src) {
-			uint8_t dev[256];
-			if(!read_page(adr, &dev[0])) {
+			return verify_area(adr, src, 256);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ベリファイ・エリア @n
+					crc が「true」で、デバイスが CRC を計算出来る場合、読み出さずに比べる。@n
+					CRC が合わない場合は、読み出して違う場所を調べる
+			@param[in]	adr	開始アドレス
+			@param[in]	src	書き込みアドレス
+			@param[in]	len	長さ
+			@param[in]	crc	デバイスの CRC で比べる場合「true」
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool verify_area(uint32_t adr, const uint8_t* src, uint32_t len, bool crc = false) {
+			if(crc) {
+				uint32_t dev = 0;
+				bool support = false;
+				crc_area_visitor vis(adr, len, dev, support);
+				if(!boost::apply_visitor(vis, protocol_)) {
+					end();
+					std::cerr << std::endl << boost::format("CRC area error: %08X to %08X")
+						% adr % (adr + len - 1) << std::endl;
+					return false;
+				}
+				if(support && dev == ~rx::protocol::crc32(0xffffffff, src, len)) {
+					return true;
+				}
+			}
+
+			std::vector<uint8_t> dev(len);
+			if(!read_area(adr, &dev[0], len)) {
 				return false;
 			}
 			uint32_t errcnt = 0;
-			for(uint32_t i = 0; i < 256; ++i) {
+			for(uint32_t i = 0; i < len; ++i) {
 				auto m = *src++;
 				if(dev[i] != m) {
 					++errcnt;
@@ -220,7 +420,7 @@ namespace rx {
 				++adr;
 			}
 			if(errcnt > 0) {
-				std::cerr << "Verify page error: " << errcnt << std::endl;
+				std::cerr << "Verify error: " << errcnt << std::endl;
 				return false;
 			}
 			return true;
@@ -264,6 +464,27 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ライト・エリア（２５６バイト単位）
+			@param[in]	adr	開始アドレス
+			@param[in]	src	書き込みアドレス
+			@param[in]	len	長さ（２５６の倍数）
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool write_area(uint32_t adr, const uint8_t* src, uint32_t len) {
+			write_area_visitor vis(adr, src, len);
+           	if(!boost::apply_visitor(vis, protocol_)) {
+				end();
+				std::cerr << std::endl << boost::format("Write area error: %08X to %08X")
+					% adr % (adr + len - 1) << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ライト終了
@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <boost/format.hpp>
+#include "area.hpp"
 
 namespace rx {
 
@@ -161,6 +162,8 @@ namespace rx {
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		struct rx_t {
 			bool	verbose_ = false;
+			bool	pipeline_ = false;	///< 応答を待たずに、次のフレームを送る（実機で未確認）
+			uint32_t	speed_hint_ = 0;	///< 速度を探す時、最初に試す速度（前回の速度）
 
 			std::string	cpu_type_;		///< CPU タイプ
 
@@ -168,5 +171,32 @@ namespace rx {
 			uint32_t	sys_div_ = 8;	///< システム・ディバイダー設定
 			uint32_t	ext_div_ = 4;	///< 周辺ディバイダー設定
 		};
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	CRC-32 の計算（多項式 0xEDB88320、初期値 0xFFFFFFFF） @n
+					最初は crc に 0xFFFFFFFF を与え、最後に反転する
+			@param[in]	crc	前回の値
+			@param[in]	src	データ
+			@param[in]	len	データ長
+			@return CRC
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t crc32(uint32_t crc, const void* src, uint32_t len) {
+			static const uint32_t tbl[16] = {
+				0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+				0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+				0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+				0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+			};
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(uint32_t i = 0; i < len; ++i) {
+				crc ^= p[i];
+				crc = (crc >> 4) ^ tbl[crc & 15];
+				crc = (crc >> 4) ^ tbl[crc & 15];
+			}
+			return crc;
+		}
 	};
 }
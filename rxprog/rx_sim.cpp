@@ -0,0 +1,252 @@
+//=====================================================================//
+/*!	@file
+	@brief	Renesas RX Series Boot-Mode Simulator @n
+			疑似端末を開き、rx_prog の接続先となる RX マイコンを再現する。@n
+			rx_prog の動作確認、書き込み時間の測定に使う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <csignal>
+#include <memory>
+#include "rx_sim.hpp"
+#include "string_utils.hpp"
+
+namespace {
+
+	const std::string version_ = "0.10";
+
+	volatile sig_atomic_t quit_ = 0;
+
+	void signal_(int sig) { quit_ = 1; }
+
+	struct options {
+		bool	verbose = false;
+
+		std::string	device = "RX64M";
+		std::string	link;
+
+		bool	rom_set = false;
+		utils::area_t	rom;
+		bool	data_set = false;
+		utils::area_t	data;
+
+		rx::sim::timing	tm;
+
+		bool	wire = true;
+		bool	protect = false;
+		bool	crc = true;
+		uint32_t	max_baud = 0;
+		uint32_t	line_limit = 0;
+		bool	once = false;
+		bool	help = false;
+
+		static bool get_area_(const std::string& s, utils::area_t& a) {
+			std::vector<uint32_t> v;
+			if(!utils::string_to_hex(s, v) || v.size() != 2 || v[1] < v[0]) return false;
+			a.org_ = v[0];
+			a.end_ = v[1];
+			return true;
+		}
+
+		static bool get_us_(const std::string& s, uint32_t& us) {
+			int32_t v;
+			if(!utils::string_to_int(s, v) || v < 0) return false;
+			us = v;
+			return true;
+		}
+
+		bool set(const std::string& p) {
+			if(p == "--verbose") verbose = true;
+			else if(p.find("--device=") == 0) device = &p[std::strlen("--device=")];
+			else if(p.find("--link=") == 0) link = &p[std::strlen("--link=")];
+			else if(p.find("--rom=") == 0) {
+				rom_set = get_area_(&p[std::strlen("--rom=")], rom);
+				return rom_set;
+			} else if(p.find("--data=") == 0) {
+				data_set = get_area_(&p[std::strlen("--data=")], data);
+				return data_set;
+			} else if(p.find("--cmd-time=") == 0) {
+				return get_us_(&p[std::strlen("--cmd-time=")], tm.cmd_us);
+			} else if(p.find("--blank-time=") == 0) {
+				return get_us_(&p[std::strlen("--blank-time=")], tm.blank_us);
+			} else if(p.find("--erase-time=") == 0) {
+				return get_us_(&p[std::strlen("--erase-time=")], tm.erase_us);
+			} else if(p.find("--write-time=") == 0) {
+				return get_us_(&p[std::strlen("--write-time=")], tm.write_us);
+			} else if(p.find("--read-time=") == 0) {
+				return get_us_(&p[std::strlen("--read-time=")], tm.read_us);
+			} else if(p == "--no-wire") wire = false;
+			else if(p == "--protect") protect = true;
+			else if(p == "--no-crc") crc = false;
+			else if(p.find("--max-baud=") == 0) {
+				return get_us_(&p[std::strlen("--max-baud=")], max_baud);
+			} else if(p.find("--line-limit=") == 0) {
+				return get_us_(&p[std::strlen("--line-limit=")], line_limit);
+			}
+			else if(p == "--once") once = true;
+			else if(p == "-h" || p == "--help") help = true;
+			else return false;
+			return true;
+		}
+	};
+
+
+	void help_(const std::string& cmd)
+	{
+		using namespace std;
+
+		std::string c = utils::get_file_base(cmd);
+
+		cout << "Renesas RX Series Boot-Mode Simulator Version " << version_ << endl;
+		cout << "Copyright (C) 2017, Hiramatsu Kunihito (hira@rvf-rc45.net)" << endl;
+		cout << "usage:" << endl;
+		cout << c << " [options]" << endl;
+		cout << endl;
+		cout << "Options :" << endl;
+		cout << "    -d DEVICE, --device=DEVICE Specify device group (RX63T, RX24T, RX64M)" << endl;
+		cout << "    --link=PATH                Create symbolic link to pty" << endl;
+		cout << "    --rom=ORG,END              Specify rom area (hex)" << endl;
+		cout << "    --data=ORG,END             Specify data flash area (hex)" << endl;
+		cout << "    --cmd-time=US              Command latency [us]" << endl;
+		cout << "    --blank-time=US            Blank check time per 256 bytes [us]" << endl;
+		cout << "    --erase-time=US            Erase time per 1K bytes [us]" << endl;
+		cout << "    --write-time=US            Write time per 256 bytes [us]" << endl;
+		cout << "    --read-time=US             Read time per 256 bytes [us]" << endl;
+		cout << "    --no-wire                  No baud rate transfer time" << endl;
+		cout << "    --protect                  ID protect enable" << endl;
+		cout << "    --no-crc                   Reject CRC command (RX64M)" << endl;
+		cout << "    --max-baud=BAUD            Reject faster baud rate (RX64M)" << endl;
+		cout << "    --line-limit=BAUD          Corrupt received data above this baud rate" << endl;
+		cout << "    --once                     Exit after first session" << endl;
+		cout << "    --verbose                  Verbose output" << endl;
+		cout << "    -h, --help                 Display this" << endl;
+	}
+
+
+	// デバイス標準の領域と消去単位
+	bool setup_flash_(const options& opts, rx::sim::flash& fl)
+	{
+		utils::area_t rom;
+		utils::area_t data;
+		if(opts.device == "RX64M") {
+			rom  = utils::area_t(0xFFC00000, 0xFFFFFFFF);
+			data = utils::area_t(0x00100000, 0x0010FFFF);
+		} else if(opts.device == "RX63T") {
+			rom  = utils::area_t(0xFFF80000, 0xFFFFFFFF);
+			data = utils::area_t(0x00100000, 0x00107FFF);
+		} else if(opts.device == "RX24T") {
+			rom  = utils::area_t(0xFFFC0000, 0xFFFFFFFF);
+			data = utils::area_t(0x00100000, 0x00101FFF);
+		} else {
+			return false;
+		}
+		if(opts.rom_set) rom = opts.rom;
+		if(opts.data_set) data = opts.data;
+
+		if(opts.device == "RX64M") {
+			// コード・フラッシュは、最後の６４Ｋが８Ｋブロック、それ以外は３２Ｋブロック
+			if(rom.org_ < 0xFFFF0000) {
+				uint32_t end = rom.end_ < 0xFFFF0000 ? rom.end_ : 0xFFFEFFFF;
+				fl.add(rom.org_, end, 32 * 1024, false);
+			}
+			if(rom.end_ >= 0xFFFF0000) {
+				uint32_t org = rom.org_ > 0xFFFF0000 ? rom.org_ : 0xFFFF0000;
+				fl.add(org, rom.end_, 8 * 1024, false);
+			}
+			fl.add(data.org_, data.end_, 64, true);
+		} else if(opts.device == "RX63T") {
+			fl.add(rom.org_, rom.end_, 16 * 1024, false);
+			fl.add(data.org_, data.end_, 2 * 1024, true);
+		} else {
+			fl.add(rom.org_, rom.end_, 2 * 1024, false);
+			fl.add(data.org_, data.end_, 1 * 1024, true);
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	options	opts;
+
+	bool opterr = false;
+	for(int i = 1; i < argc; ++i) {
+		const std::string p = argv[i];
+		if(p == "-d" && (i + 1) < argc) {
+			opts.device = argv[++i];
+		} else if(!opts.set(p)) {
+			std::cerr << "Option error: '" << p << "'" << std::endl;
+			opterr = true;
+		}
+	}
+	if(opterr || opts.help) {
+		help_(argv[0]);
+		return opterr ? -1 : 0;
+	}
+
+	rx::sim::flash fl;
+	if(!setup_flash_(opts, fl)) {
+		std::cerr << "Device error: '" << opts.device << "'" << std::endl;
+		return -1;
+	}
+
+	utils::pty_io io;
+	if(!io.open(opts.link)) {
+		std::cerr << "Can't open pty." << std::endl;
+		return -1;
+	}
+	io.enable_wire(opts.wire);
+	io.set_limit(opts.line_limit);
+
+	std::unique_ptr<rx::sim::device_base> dev;
+	if(opts.device == "RX64M") {
+		auto p = new rx::sim::rx64m(io, fl, opts.tm, opts.verbose, opts.crc);
+		p->set_max_baud(opts.max_baud);
+		dev.reset(p);
+	} else {
+		dev.reset(new rx::sim::rx63t(io, fl, opts.tm, opts.verbose, opts.device == "RX24T"));
+	}
+	dev->set_protect(opts.protect);
+
+	std::signal(SIGINT, signal_);
+	std::signal(SIGTERM, signal_);
+
+	std::cout << opts.device << " boot-mode simulator: '" << io.get_path() << "'";
+	if(!opts.link.empty()) std::cout << " (" << opts.link << ")";
+	std::cout << std::endl;
+
+	while(quit_ == 0) {
+		if(!io.wait_open()) continue;
+
+		dev->reset();
+		io.reset_count();
+		fl.reset_count();
+		auto t = utils::pty_io::clock::now();
+		bool active = false;
+		while(quit_ == 0) {
+			auto st = dev->service(100);
+			if(st == utils::pty_io::state::hangup) break;
+			if(st == utils::pty_io::state::ok) active = true;
+		}
+		if(!active) continue;
+
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+			utils::pty_io::clock::now() - t).count();
+		std::cout << boost::format("Session: %.3f [s], recv: %d, send: %d, "
+			"erase: %d, write: %d, read: %d, baud error: %d")
+			% (static_cast<double>(us) / 1e6)
+			% io.get_recv_count() % io.get_send_count()
+			% fl.get_erase_count() % fl.get_write_count() % fl.get_read_count()
+			% io.get_error_count() << std::endl;
+
+		if(opts.once) break;
+	}
+
+	io.close();
+	return 0;
+}
@@ -0,0 +1,1152 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RX ブート・モード・シミュレーター・クラス @n
+			疑似端末上で、RX63T、RX24T、RX64M のブート・モードを再現する。@n
+			・フラッシュ・メモリーは消去単位（ブロック）と、ブランクを管理する @n
+			・コマンド毎の処理時間（消去、書き込み、読み出し）を再現する @n
+			・フレームの形式、サムの範囲は rx_prog の各プロトコル・クラスに合わせている
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include <boost/format.hpp>
+#include "pty_io.hpp"
+#include "area.hpp"
+#include "rx_protocol.hpp"
+
+namespace rx {
+namespace sim {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	処理時間（マイクロ秒）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct timing {
+		uint32_t	cmd_us   = 20;		///< コマンドの解釈
+		uint32_t	blank_us = 100;		///< ブランク・チェック（２５６バイト）
+		uint32_t	erase_us = 3000;	///< 消去（１Ｋバイト）
+		uint32_t	write_us = 600;		///< 書き込み（２５６バイト）
+		uint32_t	read_us  = 20;		///< 読み出し（２５６バイト）
+
+		static void wait(uint32_t us) {
+			if(us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	フラッシュ・メモリー・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class flash {
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	書き込みの結果
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class result {
+			ok,			///< 正常
+			address,	///< 範囲外
+			not_blank	///< 消去されていない
+		};
+
+	private:
+		struct bank_t {
+			uint32_t	org_;
+			uint32_t	end_;
+			uint32_t	block_;
+			bool		data_;
+			std::vector<uint8_t>	mem_;
+		};
+		std::vector<bank_t>	banks_;
+
+		uint32_t	erase_count_ = 0;
+		uint32_t	write_count_ = 0;
+		uint32_t	read_count_ = 0;
+
+		const bank_t* find_(uint32_t org, uint32_t len) const {
+			if(len == 0) return nullptr;
+			uint32_t end = org + len - 1;
+			if(end < org) return nullptr;
+			for(const auto& b : banks_) {
+				if(b.org_ <= org && end <= b.end_) return &b;
+			}
+			return nullptr;
+		}
+
+		bank_t* find_(uint32_t org, uint32_t len) {
+			return const_cast<bank_t*>(static_cast<const flash*>(this)->find_(org, len));
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	領域の追加（消去した状態で始まる）
+			@param[in]	org		開始アドレス
+			@param[in]	end		終了アドレス
+			@param[in]	block	消去単位
+			@param[in]	data	データ・フラッシュなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		void add(uint32_t org, uint32_t end, uint32_t block, bool data) {
+			bank_t b;
+			b.org_ = org;
+			b.end_ = end;
+			b.block_ = block;
+			b.data_ = data;
+			b.mem_.resize(end - org + 1, 0xff);
+			banks_.push_back(b);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	領域を取得（隣接する領域はまとめる）
+			@param[in]	data	データ・フラッシュなら「true」
+			@return 領域
+		*/
+		//-----------------------------------------------------------------//
+		utils::areas get_area(bool data) const {
+			utils::areas as;
+			for(const auto& b : banks_) {
+				if(b.data_ != data) continue;
+				if(!as.empty() && as.back().end_ + 1 == b.org_) as.back().end_ = b.end_;
+				else if(!as.empty() && b.end_ + 1 == as.back().org_) as.back().org_ = b.org_;
+				else as.emplace_back(b.org_, b.end_);
+			}
+			return as;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブロックを取得
+			@param[in]	data	データ・フラッシュなら「true」
+			@return ブロック
+		*/
+		//-----------------------------------------------------------------//
+		utils::areas get_block(bool data) const {
+			utils::areas as;
+			for(const auto& b : banks_) {
+				if(b.data_ != data) continue;
+				for(uint64_t a = b.org_; a <= b.end_; a += b.block_) {
+					as.emplace_back(a, a + b.block_ - 1);
+				}
+			}
+			return as;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去単位を取得
+			@param[in]	data	データ・フラッシュなら「true」
+			@return 消去単位（最初の領域）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_block_size(bool data) const {
+			for(const auto& b : banks_) {
+				if(b.data_ == data) return b.block_;
+			}
+			return 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	範囲の確認
+			@param[in]	org		開始アドレス
+			@param[in]	len		長さ
+			@return 一つの領域に収まっていれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_in(uint32_t org, uint32_t len) const { return find_(org, len) != nullptr; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブランク・チェック
+			@param[in]	org		開始アドレス
+			@param[in]	len		長さ
+			@param[out]	blank	消去されていれば「true」
+			@return 範囲外なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_blank(uint32_t org, uint32_t len, bool& blank) const {
+			auto b = find_(org, len);
+			if(b == nullptr) return false;
+			const uint8_t* p = &b->mem_[org - b->org_];
+			blank = true;
+			for(uint32_t i = 0; i < len; ++i) {
+				if(p[i] != 0xff) {
+					blank = false;
+					break;
+				}
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブロック消去
+			@param[in]	adr	ブロック内のアドレス
+			@return 消去したサイズ（範囲外なら「０」）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t erase(uint32_t adr) {
+			auto b = find_(adr, 1);
+			if(b == nullptr) return 0;
+			uint32_t ofs = (adr - b->org_) / b->block_ * b->block_;
+			uint32_t len = b->block_;
+			if(len > (b->mem_.size() - ofs)) len = b->mem_.size() - ofs;
+			std::memset(&b->mem_[ofs], 0xff, len);
+			++erase_count_;
+			return len;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全消去
+			@return 消去したサイズ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t erase_all() {
+			uint32_t total = 0;
+			for(auto& b : banks_) {
+				std::fill(b.mem_.begin(), b.mem_.end(), 0xff);
+				total += b.mem_.size();
+				erase_count_ += (b.mem_.size() + b.block_ - 1) / b.block_;
+			}
+			return total;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み（消去されている所だけ書ける）
+			@param[in]	org	開始アドレス
+			@param[in]	src	書き込みデータ
+			@param[in]	len	長さ
+			@return 結果
+		*/
+		//-----------------------------------------------------------------//
+		result write(uint32_t org, const uint8_t* src, uint32_t len) {
+			auto b = find_(org, len);
+			if(b == nullptr) return result::address;
+			uint8_t* p = &b->mem_[org - b->org_];
+			for(uint32_t i = 0; i < len; ++i) {
+				if(p[i] != 0xff && src[i] != 0xff) return result::not_blank;
+			}
+			for(uint32_t i = 0; i < len; ++i) {
+				p[i] &= src[i];
+			}
+			++write_count_;
+			return result::ok;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み出し
+			@param[in]	org	開始アドレス
+			@param[out]	dst	読み出し先
+			@param[in]	len	長さ
+			@return 範囲外なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool read(uint32_t org, uint8_t* dst, uint32_t len) {
+			auto b = find_(org, len);
+			if(b == nullptr) return false;
+			std::memcpy(dst, &b->mem_[org - b->org_], len);
+			++read_count_;
+			return true;
+		}
+
+
+		uint32_t get_erase_count() const { return erase_count_; }
+		uint32_t get_write_count() const { return write_count_; }
+		uint32_t get_read_count() const { return read_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計のリセット
+		*/
+		//-----------------------------------------------------------------//
+		void reset_count() {
+			erase_count_ = 0;
+			write_count_ = 0;
+			read_count_ = 0;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	シミュレーター基本クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class device_base {
+	protected:
+		typedef utils::pty_io::state state;
+
+		utils::pty_io&	io_;
+		flash&			flash_;
+		const timing&	tm_;
+		bool			verbose_;
+
+		bool			protect_ = false;
+		bool			sync_ = false;
+		bool			connect_ = false;
+
+		static const uint32_t timeout_ = 1000;  // 受信タイムアウト [ms]
+
+		static uint32_t get32_big_(const uint8_t* p) {
+			uint32_t v;
+			v = p[3];
+			v |= static_cast<uint32_t>(p[2]) << 8;
+			v |= static_cast<uint32_t>(p[1]) << 16;
+			v |= static_cast<uint32_t>(p[0]) << 24;
+			return v;
+		}
+
+		static void put16_big_(uint8_t* p, uint32_t val) {
+			p[0] = (val >> 8) & 0xff;
+			p[1] = val & 0xff;
+		}
+
+		static void put32_big_(uint8_t* p, uint32_t val) {
+			p[0] = (val >> 24) & 0xff;
+			p[1] = (val >> 16) & 0xff;
+			p[2] = (val >> 8) & 0xff;
+			p[3] =  val & 0xff;
+		}
+
+		static uint8_t sum_(const uint8_t* buff, uint32_t len) {
+			uint16_t sum = 0;
+			for(uint32_t i = 0; i < len; ++i) {
+				sum += *buff++;
+			}
+			return (0 - sum) & 0xff;
+		}
+
+		// 消去にかかる時間
+		void erase_wait_(uint32_t size) const {
+			timing::wait(static_cast<uint64_t>(tm_.erase_us) * size / 1024);
+		}
+
+		// ページ（２５６バイト）単位の処理時間
+		static void page_wait_(uint32_t us, uint32_t len) {
+			timing::wait(static_cast<uint64_t>(us) * ((len + 255) / 256));
+		}
+
+		void log_(const std::string& s) const {
+			if(verbose_) std::cout << s << std::endl;
+		}
+
+		// 接続（同期の０ｘ００に一度だけ応答し、０ｘ５５で接続）
+		void connection_(uint8_t ch, uint8_t ack) {
+			if(ch == 0x00) {
+				if(!sync_) {
+					io_.send(0x00);
+					sync_ = true;
+				}
+			} else if(ch == 0x55 && sync_) {
+				io_.send(ack);
+				connect_ = true;
+				log_("Connection");
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	io		pty I/O
+			@param[in]	fl		フラッシュ・メモリー
+			@param[in]	tm		処理時間
+			@param[in]	verbose	コマンドを表示する場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		device_base(utils::pty_io& io, flash& fl, const timing& tm, bool verbose) :
+			io_(io), flash_(fl), tm_(tm), verbose_(verbose) { }
+
+
+		virtual ~device_base() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ID プロテクトの設定
+			@param[in]	ena	有効なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		void set_protect(bool ena) { protect_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リセット（ホストがポートを開き直した時）
+		*/
+		//-----------------------------------------------------------------//
+		virtual void reset() {
+			sync_ = false;
+			connect_ = false;
+			io_.set_baud(9600);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（１コマンド）
+			@param[in]	ms	最初のバイトを待つ時間（ミリ秒）
+			@return 受信の状態
+		*/
+		//-----------------------------------------------------------------//
+		virtual state service(uint32_t ms) = 0;
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	RX63T/RX24T ブート・モード・シミュレーター
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class rx63t : public device_base {
+
+		bool		rx24t_;
+		bool		pe_ = false;
+		bool		select_write_area_ = false;
+
+		static const uint8_t err_sum_     = 0x11;
+		static const uint8_t err_device_  = 0x21;
+		static const uint8_t err_baud_    = 0x24;
+		static const uint8_t err_address_ = 0x2A;
+		static const uint8_t err_program_ = 0x53;
+
+		uint32_t code_() const {
+			// 「RX63」、「RX24」（リトル・エンディアン）
+			return rx24t_ ? 0x34325852 : 0x36335852;
+		}
+
+		const char* name_() const {
+			return rx24t_ ? "RX24T" : "RX63T";
+		}
+
+		bool recv_(uint8_t* dst, uint32_t len) {
+			return io_.recv(dst, len, timeout_) == state::ok;
+		}
+
+		void error_(uint8_t res, uint8_t err) {
+			uint8_t tmp[2];
+			tmp[0] = res;
+			tmp[1] = err;
+			io_.send(tmp, 2);
+			log_((boost::format("  Error: %02X %02X") % static_cast<uint32_t>(res)
+				% static_cast<uint32_t>(err)).str());
+		}
+
+		// 「res, size, num, org/end ..., sum」形式の領域応答
+		void send_areas_(uint8_t res, const utils::areas& as) {
+			uint8_t tmp[3 + 31 * 8 + 1];
+			uint32_t num = as.size();
+			if(num > 31) num = 31;
+			tmp[0] = res;
+			tmp[1] = 1 + num * 8;
+			tmp[2] = num;
+			for(uint32_t i = 0; i < num; ++i) {
+				put32_big_(&tmp[3 + i * 8], as[i].org_);
+				put32_big_(&tmp[3 + i * 8 + 4], as[i].end_);
+			}
+			uint32_t n = 3 + num * 8;
+			tmp[n] = sum_(tmp, n);
+			io_.send(tmp, n + 1);
+		}
+
+		void inquiry_device_() {
+			const char* name = name_();
+			uint32_t nl = std::strlen(name);
+			uint8_t tmp[16 + 16];
+			tmp[0] = 0x30;
+			tmp[1] = 1 + 1 + 4 + nl;
+			tmp[2] = 1;
+			tmp[3] = 4 + nl;
+			uint32_t code = code_();
+			for(uint32_t i = 0; i < 4; ++i) tmp[4 + i] = (code >> (i * 8)) & 0xff;
+			std::memcpy(&tmp[8], name, nl);
+			uint32_t n = 8 + nl;
+			if(rx24t_) {
+				tmp[n] = sum_(tmp, n);
+			} else {
+				// RX63T の rx_prog は、デバイス数の後ろだけでサムを確認している
+				tmp[n] = sum_(&tmp[3], n - 3);
+			}
+			io_.send(tmp, n + 1);
+		}
+
+		void select_device_() {
+			uint8_t tmp[7];
+			tmp[0] = 0x10;
+			if(!recv_(&tmp[1], 6)) return;
+			if(sum_(tmp, 7) != 0) {
+				error_(0x90, err_sum_);
+				return;
+			}
+			uint32_t code = tmp[2] | (tmp[3] << 8) | (tmp[4] << 16) | (tmp[5] << 24);
+			if(code != code_()) {
+				error_(0x90, err_device_);
+				return;
+			}
+			io_.send(rx24t_ ? 0x46 : 0x06);
+		}
+
+		void inquiry_clock_mode_() {
+			uint8_t tmp[4] = { 0x31, 0x01, 0x00, 0x00 };
+			tmp[3] = sum_(tmp, 3);
+			io_.send(tmp, 4);
+		}
+
+		void select_clock_mode_() {
+			uint8_t tmp[4];
+			tmp[0] = 0x11;
+			if(!recv_(&tmp[1], 3)) return;
+			if(sum_(tmp, 4) != 0) {
+				error_(0x91, err_sum_);
+				return;
+			}
+			io_.send(0x06);
+		}
+
+		void inquiry_multiplier_() {
+			// システム・クロック、周辺クロック、それぞれ ×１、×２、×４、×８
+			uint8_t tmp[3 + 10 + 1] = { 0x32, 11, 2, 4, 1, 2, 4, 8, 4, 1, 2, 4, 8, 0 };
+			tmp[13] = sum_(tmp, 13);
+			io_.send(tmp, sizeof(tmp));
+		}
+
+		void inquiry_frequency_() {
+			// 8.00MHz to 100.00MHz, 8.00MHz to 50.00MHz（単位 10KHz）
+			uint8_t tmp[3 + 8 + 1];
+			tmp[0] = 0x33;
+			tmp[1] = 1 + 8;
+			tmp[2] = 2;
+			put16_big_(&tmp[3], 800);
+			put16_big_(&tmp[5], 10000);
+			put16_big_(&tmp[7], 800);
+			put16_big_(&tmp[9], 5000);
+			tmp[11] = sum_(tmp, 11);
+			io_.send(tmp, sizeof(tmp));
+		}
+
+		void change_speed_() {
+			uint8_t tmp[10];
+			tmp[0] = 0x3F;
+			if(!recv_(&tmp[1], 9)) return;
+			if(sum_(tmp, 10) != 0) {
+				error_(0xBF, err_sum_);
+				return;
+			}
+			uint32_t baud = ((tmp[2] << 8) | tmp[3]) * 100;
+			if(baud < 9600 || baud > 230400) {
+				error_(0xBF, err_baud_);
+				return;
+			}
+			io_.send(0x06);
+			io_.set_baud(baud);
+			log_((boost::format("  Baud rate: %d") % baud).str());
+		}
+
+		void inquiry_block_() {
+			if(rx24t_) {
+				// 「36, size16, num, (org, size, num) x 2, sum」
+				uint8_t tmp[4 + 24 + 1];
+				tmp[0] = 0x36;
+				put16_big_(&tmp[1], 1 + 24);
+				tmp[3] = 2;
+				for(uint32_t i = 0; i < 2; ++i) {
+					auto as = flash_.get_area(i != 0);
+					auto bs = flash_.get_block_size(i != 0);
+					uint32_t org = as.empty() ? 0 : as[0].org_;
+					uint32_t num = (as.empty() || bs == 0) ? 0 : as[0].length() / bs;
+					put32_big_(&tmp[4 + i * 12], org);
+					put32_big_(&tmp[4 + i * 12 + 4], bs);
+					put32_big_(&tmp[4 + i * 12 + 8], num);
+				}
+				tmp[28] = sum_(tmp, 28);
+				io_.send(tmp, sizeof(tmp));
+			} else {
+				// 「36, size16, num, (org, end) x num, sum」
+				auto as = flash_.get_block(false);
+				uint32_t num = as.size();
+				if(num > 255) num = 255;
+				std::vector<uint8_t> tmp(4 + num * 8 + 1);
+				tmp[0] = 0x36;
+				put16_big_(&tmp[1], 1 + num * 8);
+				tmp[3] = num;
+				for(uint32_t i = 0; i < num; ++i) {
+					put32_big_(&tmp[4 + i * 8], as[i].org_);
+					put32_big_(&tmp[4 + i * 8 + 4], as[i].end_);
+				}
+				tmp[4 + num * 8] = sum_(&tmp[0], 4 + num * 8);
+				io_.send(&tmp[0], tmp.size());
+			}
+		}
+
+		void inquiry_prog_size_() {
+			uint8_t tmp[5] = { 0x37, 0x02, 0x01, 0x00, 0x00 };
+			tmp[4] = sum_(tmp, 4);
+			io_.send(tmp, 5);
+		}
+
+		void inquiry_data_() {
+			uint8_t tmp[4] = { 0x3A, 0x01, 0x21, 0x00 };
+			if(flash_.get_area(true).empty()) tmp[2] = 0x00;
+			tmp[3] = sum_(tmp, 3);
+			io_.send(tmp, 4);
+		}
+
+		void turn_pe_() {
+			if(protect_) {
+				io_.send(0x16);
+				log_("  ID protect");
+			} else {
+				// ID プロテクトが無い場合、ユーザー領域、データ領域を全消去する
+				erase_wait_(flash_.erase_all());
+				io_.send(0x26);
+			}
+			pe_ = true;
+		}
+
+		void write_() {
+			uint8_t tmp[5 + 256 + 1];
+			tmp[0] = 0x50;
+			if(!recv_(&tmp[1], 4)) return;
+			uint32_t adr = get32_big_(&tmp[1]);
+			if(adr == 0xffffffff) {
+				if(!recv_(&tmp[5], 1)) return;
+				if(sum_(tmp, 6) != 0) {
+					error_(0xD0, err_sum_);
+					return;
+				}
+				select_write_area_ = false;
+				io_.send(0x06);
+				log_("  Write end");
+				return;
+			}
+			if(!recv_(&tmp[5], 256 + 1)) return;
+			if(sum_(tmp, sizeof(tmp)) != 0) {
+				error_(0xD0, err_sum_);
+				return;
+			}
+			if(!pe_ || !select_write_area_ || protect_) {
+				error_(0xD0, err_program_);
+				return;
+			}
+			log_((boost::format("  Write: %08X") % adr).str());
+			auto ret = flash_.write(adr, &tmp[5], 256);
+			page_wait_(tm_.write_us, 256);
+			if(ret == flash::result::address) {
+				error_(0xD0, err_address_);
+			} else if(ret == flash::result::not_blank) {
+				error_(0xD0, err_program_);
+			} else {
+				io_.send(0x06);
+			}
+		}
+
+		void read_() {
+			uint8_t tmp[12];
+			tmp[0] = 0x52;
+			if(!recv_(&tmp[1], 11)) return;
+			if(sum_(tmp, 12) != 0) {
+				error_(0xD2, err_sum_);
+				return;
+			}
+			uint32_t adr = get32_big_(&tmp[3]);
+			uint32_t len = get32_big_(&tmp[7]);
+			log_((boost::format("  Read: %08X, %d") % adr % len).str());
+			std::vector<uint8_t> out(5 + len + 1);
+			if(!pe_ || protect_ || len == 0 || len > 0x10000 || !flash_.read(adr, &out[5], len)) {
+				error_(0xD2, err_address_);
+				return;
+			}
+			page_wait_(tm_.read_us, len);
+			out[0] = 0x52;
+			put32_big_(&out[1], len);
+			out[5 + len] = sum_(&out[0], 5 + len);
+			io_.send(&out[0], out.size());
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	io		pty I/O
+			@param[in]	fl		フラッシュ・メモリー
+			@param[in]	tm		処理時間
+			@param[in]	verbose	コマンドを表示する場合「true」
+			@param[in]	rx24t	RX24T の場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		rx63t(utils::pty_io& io, flash& fl, const timing& tm, bool verbose, bool rx24t) :
+			device_base(io, fl, tm, verbose), rx24t_(rx24t) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リセット
+		*/
+		//-----------------------------------------------------------------//
+		void reset() override {
+			device_base::reset();
+			pe_ = false;
+			select_write_area_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（１コマンド）
+			@param[in]	ms	最初のバイトを待つ時間（ミリ秒）
+			@return 受信の状態
+		*/
+		//-----------------------------------------------------------------//
+		state service(uint32_t ms) override {
+			uint8_t cmd;
+			auto st = io_.recv(&cmd, 1, ms);
+			if(st != state::ok) return st;
+
+			if(!connect_) {
+				connection_(cmd, 0xE6);
+				return st;
+			}
+
+			timing::wait(tm_.cmd_us);
+			log_((boost::format("Command: %02X") % static_cast<uint32_t>(cmd)).str());
+			switch(cmd) {
+			case 0x06:  // ボーレート変更後の確認
+				io_.send(0x06);
+				break;
+			case 0x10:
+				select_device_();
+				break;
+			case 0x11:
+				select_clock_mode_();
+				break;
+			case 0x20:
+				inquiry_device_();
+				break;
+			case 0x21:
+				inquiry_clock_mode_();
+				break;
+			case 0x22:
+				inquiry_multiplier_();
+				break;
+			case 0x23:
+				inquiry_frequency_();
+				break;
+			case 0x24:  // ユーザー・ブート領域
+				send_areas_(0x34, utils::areas { utils::area_t(0xFF7FC000, 0xFF7FFFFF) });
+				break;
+			case 0x25:
+				send_areas_(0x35, flash_.get_area(false));
+				break;
+			case 0x26:
+				inquiry_block_();
+				break;
+			case 0x27:
+				inquiry_prog_size_();
+				break;
+			case 0x2A:
+				inquiry_data_();
+				break;
+			case 0x2B:
+				send_areas_(0x3B, flash_.get_area(true));
+				break;
+			case 0x3F:
+				change_speed_();
+				break;
+			case 0x40:
+				turn_pe_();
+				break;
+			case 0x42:
+			case 0x43:
+				select_write_area_ = pe_;
+				io_.send(pe_ ? 0x06 : 0xC2);
+				break;
+			case 0x50:
+				write_();
+				break;
+			case 0x52:
+				read_();
+				break;
+			default:
+				log_((boost::format("  Unknown command: %02X") % static_cast<uint32_t>(cmd)).str());
+				break;
+			}
+			return st;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	RX64M ブート・モード・シミュレーター
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class rx64m : public device_base {
+
+		static const uint8_t err_command_ = 0xC1;
+		static const uint8_t err_sum_     = 0xC2;
+		static const uint8_t err_flow_    = 0xC3;
+		static const uint8_t err_address_ = 0xD0;
+		static const uint8_t err_baud_    = 0xD4;
+		static const uint8_t err_blank_   = 0xE0;
+		static const uint8_t err_write_   = 0xE2;
+
+		uint8_t		buff_[4 + 1024 + 2];
+
+		uint32_t	sys_clock_ = 0;
+		uint32_t	dev_clock_ = 0;
+
+		bool		crc_cmd_;
+		uint32_t	max_baud_ = 0;
+
+		// 「sod, len16, cmd, data..., sum, etx」を受信、データ長を返す（エラーなら負）
+		int32_t recv_packet_(uint8_t sod, bool head) {
+			if(!head) {
+				if(io_.recv(buff_, 1, timeout_) != state::ok) return -1;
+			}
+			if(buff_[0] != sod) return -1;
+			if(io_.recv(&buff_[1], 3, timeout_) != state::ok) return -1;
+			uint32_t len = (buff_[1] << 8) | buff_[2];
+			if(len == 0 || len > 1024 + 1) return -1;
+			if(io_.recv(&buff_[4], len + 1, timeout_) != state::ok) return -1;
+			if(buff_[4 + len] != 0x03) return -1;
+			if(sum_(&buff_[1], 3 + len) != 0) return -2;
+			return len - 1;
+		}
+
+		void send_(uint8_t res, const uint8_t* src, uint32_t len) {
+			uint8_t tmp[4 + 1024 + 2];
+			tmp[0] = 0x81;
+			put16_big_(&tmp[1], 1 + len);
+			tmp[3] = res;
+			if(len > 0) std::memcpy(&tmp[4], src, len);
+			tmp[4 + len] = sum_(&tmp[1], 3 + len);
+			tmp[4 + len + 1] = 0x03;
+			io_.send(tmp, 4 + len + 2);
+		}
+
+		void status_(uint8_t res) { send_(res, nullptr, 0); }
+
+		void error_(uint8_t res, uint8_t err) {
+			send_(res | 0x80, &err, 1);
+			log_((boost::format("  Error: %02X %02X") % static_cast<uint32_t>(res | 0x80)
+				% static_cast<uint32_t>(err)).str());
+		}
+
+		// データ要求を待って、データを送る @n
+		// rx_prog は、ステータスを返す要求の後ろに余分な１バイトを送るので、読み捨てる
+		// （リードのデータ要求は、続けて送られるので読み捨てない）
+		void send_data_(uint8_t res, const uint8_t* src, uint32_t len, bool drain = true) {
+			if(recv_packet_(0x81, false) < 0 || buff_[3] != res) {
+				io_.drain();
+				return;
+			}
+			if(drain) io_.drain();
+			send_(res, src, len);
+		}
+
+		void inquiry_device_type_() {
+			uint8_t tmp[24];
+			std::memset(tmp, 0, sizeof(tmp));
+			std::memcpy(tmp, "RX64M", 5);
+			put32_big_(&tmp[8],      24000000);  // OSA
+			put32_big_(&tmp[8 + 4],   8000000);  // OSI
+			put32_big_(&tmp[8 + 8], 120000000);  // CPA
+			put32_big_(&tmp[8 + 12],  1000000);  // CPI
+			status_(0x38);
+			send_data_(0x38, tmp, sizeof(tmp));
+		}
+
+		void select_frequency_(const uint8_t* data) {
+			sys_clock_ = get32_big_(&data[0]);
+			dev_clock_ = get32_big_(&data[4]);
+			uint8_t tmp[8];
+			put32_big_(&tmp[0], sys_clock_);
+			put32_big_(&tmp[4], dev_clock_);
+			status_(0x32);
+			send_data_(0x32, tmp, sizeof(tmp));
+		}
+
+		// 周辺クロックで、誤差２％以内に出来るボーレートか（ＳＣＩ：１６、３２分周）
+		bool is_baud_(uint32_t baud) const {
+			if(baud == 0 || (max_baud_ > 0 && baud > max_baud_)) return false;
+			static const uint32_t divs[] = { 16, 32 };
+			for(auto div : divs) {
+				uint64_t n = (static_cast<uint64_t>(dev_clock_) + div * baud / 2) / (div * baud);
+				if(n < 1 || n > 256) continue;
+				double err = static_cast<double>(dev_clock_) / (div * n) / baud - 1.0;
+				if(err >= -0.02 && err <= 0.02) return true;
+			}
+			return false;
+		}
+
+		void change_speed_(const uint8_t* data) {
+			uint32_t baud = get32_big_(data);
+			if(!is_baud_(baud)) {
+				error_(0x34, err_baud_);
+				return;
+			}
+			status_(0x34);
+			io_.set_baud(baud);
+			log_((boost::format("  Baud rate: %d") % baud).str());
+		}
+
+		void blank_check_(const uint8_t* data) {
+			uint32_t org = get32_big_(&data[0]);
+			uint32_t end = get32_big_(&data[4]);
+			log_((boost::format("  Blank check: %08X to %08X") % org % end).str());
+			bool blank = false;
+			if(protect_) {
+				error_(0x10, err_flow_);
+			} else if(end < org || !flash_.is_blank(org, end - org + 1, blank)) {
+				error_(0x10, err_address_);
+			} else {
+				page_wait_(tm_.blank_us, end - org + 1);
+				if(blank) status_(0x10);
+				else error_(0x10, err_blank_);
+			}
+		}
+
+		void erase_(const uint8_t* data) {
+			uint32_t adr = get32_big_(data);
+			log_((boost::format("  Erase: %08X") % adr).str());
+			if(protect_) {
+				error_(0x12, err_flow_);
+				return;
+			}
+			auto sz = flash_.erase(adr);
+			if(sz == 0) {
+				error_(0x12, err_address_);
+				return;
+			}
+			erase_wait_(sz);
+			status_(0x12);
+		}
+
+		void write_(const uint8_t* data) {
+			uint32_t org = get32_big_(&data[0]);
+			uint32_t end = get32_big_(&data[4]);
+			log_((boost::format("  Write: %08X to %08X") % org % end).str());
+			if(protect_) {
+				error_(0x13, err_flow_);
+				return;
+			}
+			if(end < org || (org & 0xff) != 0 || ((end + 1) & 0xff) != 0) {
+				error_(0x13, err_address_);
+				return;
+			}
+			status_(0x13);
+			uint32_t adr = org;
+			uint64_t rem = static_cast<uint64_t>(end) - org + 1;
+			while(rem > 0) {  // データ・パケット毎に応答する
+				auto len = recv_packet_(0x81, false);
+				if(len == -2) {
+					error_(0x13, err_sum_);
+					return;
+				} else if(len <= 0 || buff_[3] != 0x13) {
+					return;
+				}
+				auto ret = flash_.write(adr, &buff_[4], len);
+				page_wait_(tm_.write_us, len);
+				if(ret == flash::result::address) {
+					error_(0x13, err_address_);
+					return;
+				} else if(ret == flash::result::not_blank) {
+					error_(0x13, err_write_);
+					return;
+				}
+				status_(0x13);
+				adr += len;
+				rem -= static_cast<uint64_t>(len) < rem ? len : rem;
+			}
+		}
+
+		void read_(const uint8_t* data) {
+			uint32_t org = get32_big_(&data[0]);
+			uint32_t end = get32_big_(&data[4]);
+			log_((boost::format("  Read: %08X to %08X") % org % end).str());
+			if(protect_) {
+				error_(0x15, err_flow_);
+				return;
+			}
+			if(end < org || !flash_.is_in(org, end - org + 1)) {
+				error_(0x15, err_address_);
+				return;
+			}
+			status_(0x15);
+			uint32_t adr = org;
+			uint64_t rem = static_cast<uint64_t>(end) - org + 1;
+			while(rem > 0) {  // データ要求毎に、最大１０２４バイト送る
+				uint32_t len = rem > 1024 ? 1024 : rem;
+				uint8_t tmp[1024];
+				flash_.read(adr, tmp, len);
+				page_wait_(tm_.read_us, len);
+				send_data_(0x15, tmp, len, false);
+				adr += len;
+				rem -= len;
+			}
+		}
+
+		void crc_(const uint8_t* data) {
+			uint32_t org = get32_big_(&data[0]);
+			uint32_t end = get32_big_(&data[4]);
+			log_((boost::format("  CRC: %08X to %08X") % org % end).str());
+			if(protect_) {
+				error_(0x18, err_flow_);
+				return;
+			}
+			if(end < org || !flash_.is_in(org, end - org + 1)) {
+				error_(0x18, err_address_);
+				return;
+			}
+			uint32_t crc = 0xffffffff;
+			uint32_t adr = org;
+			uint64_t rem = static_cast<uint64_t>(end) - org + 1;
+			while(rem > 0) {
+				uint32_t len = rem > 1024 ? 1024 : rem;
+				uint8_t tmp[1024];
+				flash_.read(adr, tmp, len);
+				crc = rx::protocol::crc32(crc, tmp, len);
+				adr += len;
+				rem -= len;
+			}
+			page_wait_(tm_.read_us, end - org + 1);
+			uint8_t tmp[4];
+			put32_big_(tmp, ~crc);
+			send_(0x18, tmp, sizeof(tmp));
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	io		pty I/O
+			@param[in]	fl		フラッシュ・メモリー
+			@param[in]	tm		処理時間
+			@param[in]	verbose	コマンドを表示する場合「true」
+			@param[in]	crc		CRC コマンドを受け付ける場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		rx64m(utils::pty_io& io, flash& fl, const timing& tm, bool verbose, bool crc = true) :
+			device_base(io, fl, tm, verbose), crc_cmd_(crc) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受け付ける最大のボーレートを設定
+			@param[in]	baud	ボーレート（０なら制限無し）
+		*/
+		//-----------------------------------------------------------------//
+		void set_max_baud(uint32_t baud) { max_baud_ = baud; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（１コマンド）
+			@param[in]	ms	最初のバイトを待つ時間（ミリ秒）
+			@return 受信の状態
+		*/
+		//-----------------------------------------------------------------//
+		state service(uint32_t ms) override {
+			auto st = io_.recv(buff_, 1, ms);
+			if(st != state::ok) return st;
+
+			if(!connect_) {
+				connection_(buff_[0], 0xC1);
+				return st;
+			}
+
+			auto len = recv_packet_(0x01, true);
+			if(len == -2) {
+				error_(buff_[3], err_sum_);
+				return st;
+			} else if(len < 0) {
+				io_.drain();
+				return st;
+			}
+
+			uint8_t cmd = buff_[3];
+			uint8_t data[16];
+			std::memcpy(data, &buff_[4], len < 16 ? len : 16);
+
+			timing::wait(tm_.cmd_us);
+			log_((boost::format("Command: %02X") % static_cast<uint32_t>(cmd)).str());
+			switch(cmd) {
+			case 0x00:  // 同期
+				status_(0x00);
+				break;
+			case 0x10:
+				if(len == 8) blank_check_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x12:
+				if(len == 4) erase_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x13:
+				if(len == 8) write_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x15:
+				if(len == 8) read_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x18:  // CRC（シミュレーターの拡張）
+				if(len == 8 && crc_cmd_) crc_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x2C:  // ID 認証モード
+				{
+					uint8_t tmp = protect_ ? 0x00 : 0xFF;
+					status_(0x2C);
+					send_data_(0x2C, &tmp, 1);
+				}
+				break;
+			case 0x32:
+				if(len == 8) select_frequency_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x34:
+				if(len == 4) change_speed_(data);
+				else error_(cmd, err_command_);
+				break;
+			case 0x36:  // エンディアン
+				if(len == 1) status_(0x36);
+				else error_(cmd, err_command_);
+				break;
+			case 0x38:
+				inquiry_device_type_();
+				break;
+			default:
+				error_(cmd, err_command_);
+				break;
+			}
+			return st;
+		}
+	};
+}
+}
@@ -0,0 +1,120 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ボーレート記録クラス @n
+			自動で探した最大のボーレートを、「ポート、デバイス」の組毎に記録し、@n
+			次回の接続で最初に試す。@n
+			ファイルは「ポート,デバイス,ボーレート」の行からなるテキスト。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <map>
+#include <boost/format.hpp>
+#include "file_io.hpp"
+#include "string_utils.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ボーレート記録クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class speed_memo {
+
+		std::string	dir_;
+		std::string	path_;
+
+		typedef std::map<std::string, uint32_t> map;
+		map		map_;
+
+		static std::string key_(const std::string& port, const std::string& device) {
+			return port + ',' + device;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		speed_memo() : dir_(), path_(), map_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	記録を読み込む（ファイルが無い場合は空）
+			@param[in]	dir	ディレクトリー
+			@return 読み込めたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool load(const std::string& dir) {
+			dir_ = dir;
+			path_ = dir + "/speed.txt";
+			map_.clear();
+
+			utils::file_io fio;
+			if(!fio.open(path_, "rb")) {
+				return false;
+			}
+			while(!fio.eof()) {
+				auto line = fio.get_line();
+				auto ss = utils::split_text(line, ",");
+				if(ss.size() != 3) continue;
+				int32_t val;
+				if(!utils::string_to_int(ss[2], val) || val <= 0) continue;
+				map_[key_(ss[0], ss[1])] = val;
+			}
+			fio.close();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	記録したボーレートを取得
+			@param[in]	port	シリアル・ポート
+			@param[in]	device	デバイス
+			@return ボーレート（無ければ「０」）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get(const std::string& port, const std::string& device) const {
+			auto it = map_.find(key_(port, device));
+			if(it == map_.end()) return 0;
+			return it->second;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ボーレートを記録して保存
+			@param[in]	port	シリアル・ポート
+			@param[in]	device	デバイス
+			@param[in]	speed	ボーレート
+			@return 保存できたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool save(const std::string& port, const std::string& device, uint32_t speed) {
+			if(path_.empty()) return false;
+			auto& v = map_[key_(port, device)];
+			if(v == speed) return true;
+			v = speed;
+
+			if(!probe_file(dir_, true)) {
+				if(!create_directory(dir_)) return false;
+			}
+			utils::file_io fio;
+			if(!fio.open(path_, "wb")) {
+				return false;
+			}
+			for(const auto& m : map_) {
+				fio.put_line(m.first + ',' + (boost::format("%d") % m.second).str());
+			}
+			fio.close();
+			return true;
+		}
+	};
+}